@@ -1,6 +1,7 @@
 #!/usr/bin/env python3
 import asyncio
 import json
+import os
 import threading
 import struct
 import traceback
@@ -30,16 +31,38 @@ TCP_PORT = 9000
 # RTP payload type
 PT = 96
 
+# AUDIO_INGEST=rtp: el motor C manda RTP (AUDIO_TRANSPORT=rtp) directo a udpsrc,
+# sin TCP ni reempaquetado en Python. RTP_ADDRESS puede ser un grupo multicast.
+AUDIO_INGEST = os.environ.get("AUDIO_INGEST", "tcp")
+RTP_ADDRESS  = os.environ.get("RTP_ADDRESS", "127.0.0.1")
+RTP_PORT     = int(os.environ.get("RTP_PORT", "5004"))
+
 # Formato del header del motor C
 HDR_FMT  = "!IIIHH"  # magic, seq, sample_rate, channels, payload_len
 HDR_SIZE = struct.calcsize(HDR_FMT)
 MAGIC    = 0x4F505530  # 'OPU0'
+MAGIC_TS = 0x4F505531  # 'OPU1': OPUS_TS_EXT=1 en el motor, header + TS_FMT + payload
+TS_FMT   = "!QQ"       # captura de la primera muestra IQ, salida del encoder (ns Unix)
+TS_SIZE  = struct.calcsize(TS_FMT)
 
 # Si el motor manda 20ms por frame (típico Opus)
 DEFAULT_FRAME_MS = 20
 
 RETRY_SECONDS = 2
 
+# Duración por configuración del TOC Opus (RFC 6716, 3.1): SILK, híbrido, CELT
+_TOC_MS = [10, 20, 40, 60] * 3 + [10, 20] * 2 + [2.5, 5, 10, 20] * 4
+
+
+def opus_frame_ms(payload: bytes, default=DEFAULT_FRAME_MS):
+    """Duración del paquete según su TOC: el motor puede usar 2.5..60 ms (AUDIO_LOW_LATENCY)."""
+    if not payload:
+        return default
+    toc = payload[0]
+    code = toc & 0x03
+    count = 1 if code == 0 else 2 if code in (1, 2) else (payload[1] & 0x3F if len(payload) > 1 else 1)
+    return _TOC_MS[toc >> 3] * count
+
 Gst.init(None)
 
 # =========================
@@ -57,6 +80,16 @@ appsrc name=opussrc is-live=true format=time do-timestamp=true !
   wb.
 """
 
+PIPELINE_DESC_RTP = f"""
+webrtcbin name=wb bundle-policy=max-bundle stun-server="{STUN_SERVER}"
+
+udpsrc address={RTP_ADDRESS} port={RTP_PORT}
+  caps="application/x-rtp,media=audio,encoding-name=OPUS,clock-rate=48000,payload={PT}" !
+  rtpjitterbuffer latency=40 !
+  queue !
+  wb.
+"""
+
 def sdp_to_text(sdp_msg) -> str:
     try:
         return sdp_msg.as_text()
@@ -86,22 +119,25 @@ class Publisher:
         self.glib_loop = GLib.MainLoop()
         self.glib_thread = threading.Thread(target=self.glib_loop.run, daemon=True)
 
-        self.pipe = Gst.parse_launch(PIPELINE_DESC)
+        self.rtp_ingest = (AUDIO_INGEST == "rtp")
+        self.pipe = Gst.parse_launch(PIPELINE_DESC_RTP if self.rtp_ingest else PIPELINE_DESC)
 
         self.webrtc = self.pipe.get_by_name("wb")
         if not self.webrtc:
             raise RuntimeError("webrtcbin 'wb' not found")
 
-        self.appsrc = self.pipe.get_by_name("opussrc")
-        if not self.appsrc:
-            raise RuntimeError("appsrc 'opussrc' not found")
+        self.appsrc = None
+        if not self.rtp_ingest:
+            self.appsrc = self.pipe.get_by_name("opussrc")
+            if not self.appsrc:
+                raise RuntimeError("appsrc 'opussrc' not found")
 
-        # Caps para Opus "raw" (paquetes Opus) que vienen del motor C
-        # Nota: opusparse suele funcionar bien si le entregas frames Opus completos.
-        caps = Gst.Caps.from_string(
-            "audio/x-opus, rate=(int)48000, channels=(int)1, channel-mapping-family=(int)0"
-        )
-        self.appsrc.set_property("caps", caps)
+            # Caps para Opus "raw" (paquetes Opus) que vienen del motor C
+            # Nota: opusparse suele funcionar bien si le entregas frames Opus completos.
+            caps = Gst.Caps.from_string(
+                "audio/x-opus, rate=(int)48000, channels=(int)1, channel-mapping-family=(int)0"
+            )
+            self.appsrc.set_property("caps", caps)
 
 
         self.webrtc.connect("on-negotiation-needed", self.on_negotiation_needed)
@@ -120,7 +156,10 @@ class Publisher:
             self.glib_thread.start()
         self.pipe.set_state(Gst.State.PLAYING)
         self._running = True
-        print("[SENSOR] Pipeline PLAYING (Opus over TCP -> WebRTC)")
+        if self.rtp_ingest:
+            print(f"[SENSOR] Pipeline PLAYING (RTP/UDP {RTP_ADDRESS}:{RTP_PORT} -> WebRTC)")
+        else:
+            print("[SENSOR] Pipeline PLAYING (Opus over TCP -> WebRTC)")
 
     def stop(self):
         self._running = False
@@ -210,7 +249,7 @@ class Publisher:
             return False
         GLib.idle_add(_do)
 
-    def push_opus_frame(self, opus_bytes: bytes, frame_ms: int = DEFAULT_FRAME_MS):
+    def push_opus_frame(self, opus_bytes: bytes, frame_ms: float = DEFAULT_FRAME_MS):
         """
         Inyecta un frame Opus (payload) en appsrc.
         Se ejecuta vía GLib.idle_add para mantener thread-safety con GStreamer.
@@ -242,6 +281,20 @@ class Publisher:
 
         GLib.idle_add(_do)
 
+    def skip_frames(self, n: int, frame_ms: float = DEFAULT_FRAME_MS):
+        """
+        Squelch/DTX del motor: n frames sin audio. Solo avanza el reloj para que
+        el siguiente frame salga con su timestamp real (el receptor hace PLC/CNG).
+        """
+        if not self._running or n <= 0:
+            return
+
+        def _do():
+            self._pts += int(n * frame_ms * 1e6)
+            return False
+
+        GLib.idle_add(_do)
+
 
 async def tcp_reader_task(pub: Publisher):
     """
@@ -260,31 +313,53 @@ async def tcp_reader_task(pub: Publisher):
         bytes_ = 0
         t0 = time.time()
         last_seq = None
+        frame_ms = DEFAULT_FRAME_MS   # último visto en un TOC; los marcadores no traen payload
+        lat_ms = []   # captura -> llegada al gateway, sólo con headers OPU1
 
         try:
             while True:
                 hdr = await reader.readexactly(HDR_SIZE)
                 magic, seq, sr, ch, plen = struct.unpack(HDR_FMT, hdr)
 
-                if magic != MAGIC:
+                cap_ns = 0
+                if magic == MAGIC_TS:
+                    cap_ns, _enc_ns = struct.unpack(TS_FMT, await reader.readexactly(TS_SIZE))
+                elif magic != MAGIC:
                     print("[TCP] Magic inválido (no es OPU0). Cerrando.")
                     break
 
                 payload = await reader.readexactly(plen)
-
-                if last_seq is not None and seq != (last_seq + 1):
-                    print(f"[TCP] WARNING: salto de seq {last_seq} -> {seq}")
+                if cap_ns:
+                    lat_ms.append((time.time_ns() - cap_ns) / 1e6)
+
+                # Huecos de seq = frames omitidos por squelch/DTX, o descartados por la cola
+                # del motor mientras no hubo conexión. plen == 0 es un marcador: seq = último
+                # frame omitido.
+                gap = 0
+                if last_seq is not None and seq > last_seq:
+                    gap = seq - last_seq - (0 if plen == 0 else 1)
                 last_seq = seq
+                if plen > 0:
+                    frame_ms = opus_frame_ms(payload, frame_ms)
+                if gap > 0:
+                    pub.skip_frames(gap, frame_ms=frame_ms)
+                if plen == 0:
+                    continue
 
                 # Si tu motor puede cambiar sr/ch, aquí podrías validar:
                 # (por ahora asumimos 48kHz mono como en tu CFG)
-                pub.push_opus_frame(payload, frame_ms=DEFAULT_FRAME_MS)
+                pub.push_opus_frame(payload, frame_ms=frame_ms)
 
                 frames += 1
                 bytes_ += (HDR_SIZE + plen)
                 now = time.time()
                 if now - t0 >= 1.0:
-                    print(f"[TCP] RX {frames}/s {(bytes_/1024):.1f} KiB/s (last_seq={seq})")
+                    lat_txt = ""
+                    if lat_ms:
+                        lat_ms.sort()
+                        lat_txt = f" captura->gateway p50 {lat_ms[len(lat_ms)//2]:.1f} ms max {lat_ms[-1]:.1f} ms"
+                        lat_ms.clear()
+                    print(f"[TCP] RX {frames}/s {(bytes_/1024):.1f} KiB/s (last_seq={seq}){lat_txt}")
                     frames = 0
                     bytes_ = 0
                     t0 = now
@@ -320,8 +395,11 @@ async def run_one_session():
         pub = Publisher(loop, ws)
         pub.start()
 
-        # Arranca la recepción TCP del motor C (en paralelo)
-        tcp_task = asyncio.create_task(tcp_reader_task(pub))
+        # Arranca la recepción TCP del motor C (en paralelo); en RTP lo hace udpsrc
+        if AUDIO_INGEST == "rtp":
+            tcp_task = asyncio.create_task(asyncio.Event().wait())
+        else:
+            tcp_task = asyncio.create_task(tcp_reader_task(pub))
 
         try:
             async for msg in ws:
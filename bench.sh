@@ -0,0 +1,88 @@
+#!/usr/bin/env bash
+set -euo pipefail
+
+# =========================================================
+# Configuración general
+# =========================================================
+OUT="rf_bench"           # binario de benchmarks
+LIBDIR="./libs"
+BENCHDIR="./bench"
+
+# =========================================================
+# Flags de compilación (mismos que build.sh)
+# =========================================================
+CFLAGS=(
+  -O2
+  -Wall
+  -Wextra
+  -std=gnu11
+  -D_GNU_SOURCE
+  -I"$LIBDIR"
+  -I"$BENCHDIR"
+)
+
+# =========================================================
+# Fuentes: kernels DSP de libs/ + harness de bench/
+# =========================================================
+SRCS=(
+  "$BENCHDIR/rf_bench.c"
+  "$BENCHDIR/bench_common.c"
+  "$BENCHDIR/bench_alloc.c"     # cuenta mallocs del proceso (columna allocs)
+  "$BENCHDIR/bench_resampler.c"
+  "$BENCHDIR/bench_fm.c"
+  "$BENCHDIR/bench_ddc.c"
+  "$BENCHDIR/bench_pfb.c"
+  "$BENCHDIR/bench_demod.c"
+  "$BENCHDIR/bench_stereo.c"
+  "$BENCHDIR/bench_squelch.c"
+  "$BENCHDIR/bench_transport.c"
+  "$BENCHDIR/bench_jitter.c"    # jitter de un hilo periódico con / sin RT_POLICY
+  "$BENCHDIR/bench_pool.c"      # pool work-stealing vs un hilo por tarea
+  "$BENCHDIR/bench_ringbuf.c"   # rb_write / rb_read, 1 productor y 2 consumidores
+  "$BENCHDIR/bench_psd.c"       # load_iq, Welch (nperseg/overlap/ventana), scale_psd, publish
+  "$BENCHDIR/bench_opus.c"      # opus_tx_send_frame a un sink TCP / shm local
+  "$BENCHDIR/bench_golden.c"    # precisión: Welch + scale_psd y fm_radio vs referencia / vectores guardados
+  "$LIBDIR/resampler.c"
+  "$LIBDIR/fm_radio.c"
+  "$LIBDIR/ddc.c"
+  "$LIBDIR/demod.c"
+  "$LIBDIR/fm_stereo.c"
+  "$LIBDIR/squelch.c"
+  "$LIBDIR/channelizer.c"
+  "$LIBDIR/shm_ring.c"
+  "$LIBDIR/rt_policy.c"
+  "$LIBDIR/work_pool.c"
+  "$LIBDIR/trace.c"         # spans del pool (inactivos salvo trace_enable)
+  "$LIBDIR/latency.c"
+  "$LIBDIR/utils.c"
+  "$LIBDIR/ring_buffer.c"
+  "$LIBDIR/psd.c"
+  "$LIBDIR/arena.c"
+  "$LIBDIR/opus_tx.c"
+)
+
+LIBS=(
+  -lfftw3f
+  -lfftw3
+  -lopus
+  -lm
+  -lpthread
+  -lcjson
+)
+
+# =========================================================
+# Build + run
+# =========================================================
+echo "[BENCH] Compilando $OUT ..."
+gcc "${CFLAGS[@]}" "${SRCS[@]}" -o "$OUT" "${LIBS[@]}"
+echo "[BENCH] OK → ./$OUT"
+
+# Salida para seguimiento: BENCH_JSON=archivo agrega una línea JSON por resultado,
+# etiquetada con BENCH_REV (por defecto el commit actual)
+# Precisión: ./bench.sh golden compara con bench/golden (GOLDEN_DIR); GOLDEN_UPDATE=1 los
+# graba desde un build de confianza. Sale con 1 si algún chequeo falla.
+export BENCH_REV="${BENCH_REV:-$(git rev-parse --short HEAD 2>/dev/null || echo unknown)}"
+
+if [[ "${1:-}" != "--build-only" ]]; then
+  ./"$OUT" "$@"
+fi
@@ -0,0 +1,77 @@
+// bench/bench_alloc.c -- counts heap allocations made by the kernels under test
+//
+// The malloc family defined here replaces libc's for the whole process (the bench
+// binary and every shared library it loads) and forwards to glibc's __libc_* entry
+// points. Counting is two relaxed atomic adds per call.
+#include "bench_common.h"
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+
+#ifdef __GLIBC__
+
+extern void *__libc_malloc(size_t size);
+extern void *__libc_calloc(size_t n, size_t size);
+extern void *__libc_realloc(void *ptr, size_t size);
+extern void *__libc_memalign(size_t align, size_t size);
+extern void  __libc_free(void *ptr);
+
+static uint64_t n_calls, n_bytes;
+
+static inline void count(size_t bytes) {
+    __atomic_add_fetch(&n_calls, 1, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&n_bytes, bytes, __ATOMIC_RELAXED);
+}
+
+void *malloc(size_t size) {
+    count(size);
+    return __libc_malloc(size);
+}
+
+void *calloc(size_t n, size_t size) {
+    count(n * size);
+    return __libc_calloc(n, size);
+}
+
+void *realloc(void *ptr, size_t size) {
+    count(size);
+    return __libc_realloc(ptr, size);
+}
+
+void free(void *ptr) {
+    __libc_free(ptr);
+}
+
+void *memalign(size_t align, size_t size) {
+    count(size);
+    return __libc_memalign(align, size);
+}
+
+void *aligned_alloc(size_t align, size_t size) {
+    count(size);
+    return __libc_memalign(align, size);
+}
+
+int posix_memalign(void **out, size_t align, size_t size) {
+    if (align < sizeof(void*) || (align & (align - 1)) != 0) return EINVAL;
+    count(size);
+    void *p = __libc_memalign(align, size);
+    if (!p && size) return ENOMEM;
+    *out = p;
+    return 0;
+}
+
+int bench_allocs(bench_allocs_t *out) {
+    out->calls = __atomic_load_n(&n_calls, __ATOMIC_RELAXED);
+    out->bytes = __atomic_load_n(&n_bytes, __ATOMIC_RELAXED);
+    return 0;
+}
+
+#else
+
+int bench_allocs(bench_allocs_t *out) {
+    memset(out, 0, sizeof(*out));
+    return -1;
+}
+
+#endif
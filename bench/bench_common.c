@@ -0,0 +1,150 @@
+// bench/bench_common.c
+#include "bench_common.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <time.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+uint64_t bench_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+double bench_cpu_mhz(void) {
+    const char *env = getenv("BENCH_CPU_MHZ");
+    if (env && env[0]) return atof(env);
+
+    FILE *f = fopen("/sys/devices/system/cpu/cpu0/cpufreq/cpuinfo_max_freq", "r");
+    if (!f) return 0.0;
+    long khz = 0;
+    if (fscanf(f, "%ld", &khz) != 1) khz = 0;
+    fclose(f);
+    return (double)khz / 1000.0;
+}
+
+static int n_failed;
+
+/** BENCH_JSON opened for append with ts, rev, host, kernel and params written; NULL if unset */
+static FILE* json_begin(const char *kernel, const char *params) {
+    const char *path = getenv("BENCH_JSON");
+    if (!path || !path[0]) return NULL;
+    FILE *f = fopen(path, "a");
+    if (!f) {
+        fprintf(stderr, "[BENCH] Warning: cannot append to %s\n", path);
+        return NULL;
+    }
+    const char *rev = getenv("BENCH_REV");
+    char host[64] = "";
+    gethostname(host, sizeof(host) - 1);
+    fprintf(f, "{\"ts\":%lld,\"rev\":\"%s\",\"host\":\"%s\",\"kernel\":\"%s\",\"params\":\"%s\",",
+            (long long)time(NULL), rev ? rev : "", host, kernel, params);
+    return f;
+}
+
+/** One JSON object per result, appended to BENCH_JSON (outside the timed region) */
+static void report_json(const char *kernel, const char *params, double samples, uint64_t elapsed_ns,
+                        double msps, double ns_per_sample, long long allocs, long long alloc_bytes) {
+    FILE *f = json_begin(kernel, params);
+    if (!f) return;
+    fprintf(f, "\"samples\":%.0f,\"elapsed_ns\":%llu,\"msps\":%.6g,\"ns_per_sample\":%.6g,"
+               "\"allocs\":%lld,\"alloc_bytes\":%lld}\n",
+            samples, (unsigned long long)elapsed_ns, msps, ns_per_sample, allocs, alloc_bytes);
+    fclose(f);
+}
+
+static void report(const char *kernel, const char *params, double samples, uint64_t elapsed_ns,
+                   const bench_allocs_t *a0, const bench_allocs_t *a1) {
+    double secs = (double)elapsed_ns * 1e-9;
+    double ns_per_sample = (samples > 0) ? (double)elapsed_ns / samples : 0.0;
+    double msps = (secs > 0) ? samples / secs / 1e6 : 0.0;
+    double mhz = bench_cpu_mhz();
+    long long allocs = -1, alloc_bytes = -1;
+    bench_allocs_t now;
+    if (a0 && a1 && bench_allocs(&now) == 0) {
+        allocs = (long long)(a1->calls - a0->calls);
+        alloc_bytes = (long long)(a1->bytes - a0->bytes);
+    }
+
+    if (mhz > 0) {
+        printf("%-22s %-34s %10.2f MS/s %9.2f ns/S %9.2f cyc/S",
+               kernel, params, msps, ns_per_sample, ns_per_sample * mhz / 1000.0);
+    } else {
+        printf("%-22s %-34s %10.2f MS/s %9.2f ns/S", kernel, params, msps, ns_per_sample);
+    }
+    if (allocs >= 0) printf(" %8lld allocs", allocs);
+    printf("\n");
+    report_json(kernel, params, samples, elapsed_ns, msps, ns_per_sample, allocs, alloc_bytes);
+}
+
+void bench_report(const char *kernel, const char *params, double samples, uint64_t elapsed_ns) {
+    report(kernel, params, samples, elapsed_ns, NULL, NULL);
+}
+
+void bench_report_allocs(const char *kernel, const char *params, double samples, uint64_t elapsed_ns,
+                         const bench_allocs_t *a0, const bench_allocs_t *a1) {
+    report(kernel, params, samples, elapsed_ns, a0, a1);
+}
+
+bool bench_check(const char *kernel, const char *params, const char *metric, double value, double limit,
+                 bool upper) {
+    bool pass = upper ? value <= limit : value >= limit;     // NaN fails either way
+    if (!pass) n_failed++;
+    printf("%-22s %-34s %-16s %12.4g %s %-10.4g %s\n", kernel, params, metric, value, upper ? "<=" : ">=",
+           limit, pass ? "ok" : "FAIL");
+
+    FILE *f = json_begin(kernel, params);
+    if (!f) return pass;
+    if (isfinite(value)) {
+        fprintf(f, "\"metric\":\"%s\",\"value\":%.9g,\"limit\":%.9g,\"pass\":%s}\n",
+                metric, value, limit, pass ? "true" : "false");
+    } else {
+        // inf (identical outputs) or NaN: JSON has neither
+        fprintf(f, "\"metric\":\"%s\",\"value\":null,\"limit\":%.9g,\"pass\":%s}\n",
+                metric, limit, pass ? "true" : "false");
+    }
+    fclose(f);
+    return pass;
+}
+
+int bench_failures(void) {
+    return n_failed;
+}
+
+shm_ring_hdr_t* bench_shm_map(const char *name) {
+    int fd = shm_open(name, O_RDWR, 0);
+    if (fd < 0) return NULL;
+    struct stat st;
+    void *map = MAP_FAILED;
+    if (fstat(fd, &st) == 0) map = mmap(NULL, (size_t)st.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    return (map == MAP_FAILED) ? NULL : (shm_ring_hdr_t*)map;
+}
+
+void bench_shm_drain(shm_ring_hdr_t *hdr) {
+    if (hdr) __atomic_store_n(&hdr->tail, __atomic_load_n(&hdr->head, __ATOMIC_ACQUIRE), __ATOMIC_RELEASE);
+}
+
+void bench_shm_unmap(shm_ring_hdr_t *hdr) {
+    if (hdr) munmap(hdr, (size_t)(hdr->data_offset + hdr->capacity));
+}
+
+uint32_t bench_rand_u32(uint32_t *state) {
+    uint32_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *state = x;
+    return x;
+}
+
+float bench_rand_gauss(uint32_t *state) {
+    // Box-Muller
+    float u1 = ((float)(bench_rand_u32(state) >> 8) + 1.0f) / 16777217.0f;
+    float u2 = (float)(bench_rand_u32(state) >> 8) / 16777216.0f;
+    return sqrtf(-2.0f * logf(u1)) * cosf(2.0f * (float)M_PI * u2);
+}
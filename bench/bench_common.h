@@ -0,0 +1,92 @@
+// bench/bench_common.h
+#ifndef BENCH_COMMON_H
+#define BENCH_COMMON_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "shm_ring.h"
+
+/**
+ * @brief Monotonic clock in nanoseconds.
+ */
+uint64_t bench_now_ns(void);
+
+/**
+ * @brief Nominal CPU clock used to turn ns into cycles.
+ * Taken from BENCH_CPU_MHZ, else cpufreq max, else 0 (cycles not reported).
+ */
+double bench_cpu_mhz(void);
+
+/**
+ * @brief Prints one result line: kernel, parameters, throughput and cost per sample.
+ * With BENCH_JSON=<file> the result is also appended there as one JSON object per line
+ * (ts, rev = BENCH_REV, host, kernel, params, samples, elapsed_ns, msps, ns_per_sample,
+ * allocs, alloc_bytes; allocs = -1 when not measured).
+ * @param samples Input samples processed in elapsed_ns.
+ */
+void bench_report(const char *kernel, const char *params, double samples, uint64_t elapsed_ns);
+
+/**
+ * @brief Accuracy check: prints one line (and a BENCH_JSON object with metric, value,
+ * limit, pass) and counts a failure when value is outside the limit or not a number.
+ * @param upper true: value must be <= limit; false: >= limit.
+ * @return true if within the limit.
+ */
+bool bench_check(const char *kernel, const char *params, const char *metric, double value, double limit,
+                 bool upper);
+
+/** Checks failed so far; rf_bench exits 1 when non-zero. */
+int bench_failures(void);
+
+// --- Heap allocations (bench_alloc.c counts every malloc-family call, all threads) ---
+typedef struct {
+    uint64_t calls;     // malloc, calloc, realloc, posix_memalign, aligned_alloc, memalign
+    uint64_t bytes;     // requested
+} bench_allocs_t;
+
+/**
+ * @brief Totals since start. Take one before and one after the timed loop.
+ * @return 0, -1 if this libc cannot be interposed (counts stay 0).
+ */
+int bench_allocs(bench_allocs_t *out);
+
+/**
+ * @brief bench_report plus the allocations between a0 and a1 (also printed).
+ */
+void bench_report_allocs(const char *kernel, const char *params, double samples, uint64_t elapsed_ns,
+                         const bench_allocs_t *a0, const bench_allocs_t *a1);
+
+/**
+ * @brief Deterministic xorshift PRNG so every run sees the same workload.
+ */
+uint32_t bench_rand_u32(uint32_t *state);
+float bench_rand_gauss(uint32_t *state);
+
+// --- Local sink for shm_ring producers (bench_psd.c, bench_opus.c) ---
+/**
+ * @brief Maps the shm_ring created under name so the bench can consume it in-process.
+ * @return Header, NULL on error. Unmap with bench_shm_unmap.
+ */
+shm_ring_hdr_t* bench_shm_map(const char *name);
+
+/** Marks everything written so far as read (tail = head), like a reader that keeps up. */
+void bench_shm_drain(shm_ring_hdr_t *hdr);
+
+void bench_shm_unmap(shm_ring_hdr_t *hdr);
+
+// --- Shared synthetic workloads (bench_fm.c) ---
+#define BENCH_TONE_HZ  1000.0
+#define BENCH_DEV_HZ   75000.0
+
+/**
+ * @brief int8 IQ of a 1 kHz tone FM-modulated at 75 kHz deviation, with AWGN at snr_db.
+ */
+int8_t* make_fm_iq(double fs, size_t n, double snr_db, uint32_t *seed);
+
+/**
+ * @brief THD+N (dB, residual / fundamental) of a PCM tone at f0.
+ */
+double thdn_db(const int16_t *pcm, size_t n, double fs, double f0);
+
+#endif
@@ -0,0 +1,103 @@
+// bench/bench_demod.c
+#include "bench_common.h"
+#include "ddc.h"
+#include "demod.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#define DEMOD_BENCH_FS        2e6
+#define DEMOD_BENCH_OFFSET    250000.0
+#define DEMOD_BENCH_CHUNK     16384
+#define DEMOD_BENCH_AUDIO_FS  48000
+
+static const rf_mode_t demod_modes[] = { FM_MODE, NFM_MODE, AM_MODE, USB_MODE, LSB_MODE };
+
+/**
+ * @brief One carrier at +offset carrying a BENCH_TONE_HZ tone in the given mode.
+ * AM: 50% depth. NFM: 3 kHz deviation. WFM: BENCH_DEV_HZ. SSB: single tone on the sideband.
+ */
+static int8_t* make_mode_iq(rf_mode_t mode, double fs, size_t n, uint32_t *seed) {
+    int8_t *iq = (int8_t*)malloc(n * 2);
+    if (!iq) return NULL;
+
+    double ph = 0.0;
+    for (size_t i = 0; i < n; i++) {
+        double t = (double)i / fs;
+        double tone = sin(2.0 * M_PI * BENCH_TONE_HZ * t);
+        double carrier = 2.0 * M_PI * DEMOD_BENCH_OFFSET * t;
+        double amp = 60.0, arg = carrier;
+
+        switch (mode) {
+            case AM_MODE:  amp = 60.0 * (1.0 + 0.5 * tone); break;
+            case NFM_MODE: ph += 2.0 * M_PI * 3000.0 * tone / fs; arg += ph; break;
+            case USB_MODE: arg += 2.0 * M_PI * BENCH_TONE_HZ * t; break;
+            case LSB_MODE: arg -= 2.0 * M_PI * BENCH_TONE_HZ * t; break;
+            default:       ph += 2.0 * M_PI * BENCH_DEV_HZ * tone / fs; arg += ph; break;
+        }
+
+        double re = amp * cos(arg) + 2.0 * bench_rand_gauss(seed);
+        double im = amp * sin(arg) + 2.0 * bench_rand_gauss(seed);
+        iq[2*i]     = (int8_t)fmax(-127.0, fmin(127.0, lrint(re)));
+        iq[2*i + 1] = (int8_t)fmax(-127.0, fmin(127.0, lrint(im)));
+    }
+    return iq;
+}
+
+/**
+ * @brief Shared DDC front end + each demodulator: cost per input sample and tone THD+N.
+ */
+void bench_demod(void) {
+    const double fs = DEMOD_BENCH_FS;
+    size_t n = (size_t)(fs * 2.0);
+
+    printf("\n--- demod: DDC front end + demodulator per mode (fs=%.1fM, carrier +%.0f kHz) ---\n",
+           fs / 1e6, DEMOD_BENCH_OFFSET / 1e3);
+
+    for (size_t m = 0; m < sizeof(demod_modes) / sizeof(demod_modes[0]); m++) {
+        rf_mode_t mode = demod_modes[m];
+        const demod_ops_t *ops = demod_ops_for(mode, 0);
+        uint32_t seed = 0xA11Cu;
+
+        int8_t *iq = make_mode_iq(mode, fs, n, &seed);
+        ddc_t *ddc = (ddc_t*)calloc(1, sizeof(ddc_t));
+        demod_t *dm = (demod_t*)calloc(1, sizeof(demod_t));
+        float *chan = (float*)malloc(((size_t)DEMOD_BENCH_CHUNK + 64) * 2 * sizeof(float));
+        int16_t *pcm = (int16_t*)calloc(n, sizeof(int16_t));
+
+        if (!iq || !ddc || !dm || !chan || !pcm ||
+            demod_front_end_init(ddc, mode, 0, fs, DEMOD_BENCH_OFFSET, 0.0) != 0 ||
+            demod_init(dm, mode, 0, ddc->fs_out, DEMOD_BENCH_AUDIO_FS) != 0) {
+            free(iq); free(ddc); free(dm); free(chan); free(pcm);
+            continue;
+        }
+
+        size_t out = 0;
+        uint64_t t_ddc = 0, t_dem = 0;
+        for (size_t pos = 0; pos + DEMOD_BENCH_CHUNK <= n; pos += DEMOD_BENCH_CHUNK) {
+            uint64_t t0 = bench_now_ns();
+            int n_chan = ddc_process_s8(ddc, &iq[2 * pos], DEMOD_BENCH_CHUNK, chan);
+            uint64_t t1 = bench_now_ns();
+            out += (size_t)demod_process(dm, chan, (size_t)n_chan, &pcm[out]);
+            t_ddc += t1 - t0;
+            t_dem += bench_now_ns() - t1;
+        }
+
+        char params[64];
+        snprintf(params, sizeof(params), "%s bw=%.1fk ch=%.0f", ops->name, ops->default_bw_hz / 1e3, ddc->fs_out);
+        bench_report("ddc+demod", params, (double)n, t_ddc + t_dem);
+
+        // Skip the AGC settling time (AM carrier tracker: 100 ms time constant)
+        size_t settle = DEMOD_BENCH_AUDIO_FS;
+        if (out > settle) {
+            printf("    demod share %.1f%% | tone THD+N: %.1f dB\n",
+                   100.0 * (double)t_dem / (double)(t_ddc + t_dem),
+                   thdn_db(&pcm[settle], out - settle, DEMOD_BENCH_AUDIO_FS, BENCH_TONE_HZ));
+        }
+
+        demod_free(dm);
+        ddc_free(ddc);
+        free(iq); free(ddc); free(dm); free(chan); free(pcm);
+    }
+}
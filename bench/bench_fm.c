@@ -0,0 +1,177 @@
+// bench/bench_fm.c
+#include "bench_common.h"
+#include "fm_radio.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#define BENCH_AUDIO_FS 48000
+#define BENCH_CHUNK    16384
+
+static const double fm_rates[] = { 2e6, 8e6, 20e6 };
+
+/**
+ * @brief Synthetic broadcast FM: 1 kHz tone at 75 kHz deviation, AWGN, int8 quantized.
+ * @param snr_db Carrier-to-noise ratio of the IQ (in the full fs bandwidth).
+ */
+int8_t* make_fm_iq(double fs, size_t n, double snr_db, uint32_t *seed) {
+    int8_t *iq = (int8_t*)malloc(n * 2);
+    if (!iq) return NULL;
+
+    double amp = 90.0;
+    double sigma = amp / sqrt(2.0) * pow(10.0, -snr_db / 20.0);
+    double phase = 0.0;
+    for (size_t i = 0; i < n; i++) {
+        double m = sin(2.0 * M_PI * BENCH_TONE_HZ * (double)i / fs);
+        phase += 2.0 * M_PI * BENCH_DEV_HZ * m / fs;
+        double re = amp * cos(phase) + sigma * bench_rand_gauss(seed);
+        double im = amp * sin(phase) + sigma * bench_rand_gauss(seed);
+        iq[2*i]     = (int8_t)fmax(-127.0, fmin(127.0, lrint(re)));
+        iq[2*i + 1] = (int8_t)fmax(-127.0, fmin(127.0, lrint(im)));
+    }
+    return iq;
+}
+
+/**
+ * @brief THD+N of a PCM stream around f0 (least-squares sine + DC fit, residual / fundamental).
+ */
+double thdn_db(const int16_t *pcm, size_t n, double fs, double f0) {
+    if (n == 0) return 0.0;
+
+    // Normal equations for y ~ a*sin + b*cos + d
+    double m[3][4] = {{0}};
+    for (size_t i = 0; i < n; i++) {
+        double v[3] = { sin(2.0 * M_PI * f0 * (double)i / fs), cos(2.0 * M_PI * f0 * (double)i / fs), 1.0 };
+        for (int r = 0; r < 3; r++) {
+            for (int c = 0; c < 3; c++) m[r][c] += v[r] * v[c];
+            m[r][3] += v[r] * (double)pcm[i];
+        }
+    }
+    for (int p = 0; p < 3; p++) {
+        for (int r = p + 1; r < 3; r++) {
+            double f = m[r][p] / m[p][p];
+            for (int c = p; c < 4; c++) m[r][c] -= f * m[p][c];
+        }
+    }
+    double x[3];
+    for (int r = 2; r >= 0; r--) {
+        double acc = m[r][3];
+        for (int c = r + 1; c < 3; c++) acc -= m[r][c] * x[c];
+        x[r] = acc / m[r][r];
+    }
+
+    double fund = 0.0, resid = 0.0;
+    for (size_t i = 0; i < n; i++) {
+        double tone = x[0] * sin(2.0 * M_PI * f0 * (double)i / fs) + x[1] * cos(2.0 * M_PI * f0 * (double)i / fs);
+        double e = (double)pcm[i] - tone - x[2];
+        fund += tone * tone;
+        resid += e * e;
+    }
+    return 10.0 * log10((resid + 1e-12) / (fund + 1e-12));
+}
+
+/**
+ * @brief Runs one chain over the whole IQ stream in BENCH_CHUNK blocks.
+ * @param fast 1 = int8 float discriminator, 0 = double complex + atan2 reference.
+ * @param a0, a1 Allocation totals around the block loop (setup excluded).
+ */
+static size_t run_chain(double fs, const int8_t *iq, size_t n, int fast, int16_t *pcm, uint64_t *elapsed,
+                        bench_allocs_t *a0, bench_allocs_t *a1) {
+    fm_radio_t *radio = (fm_radio_t*)calloc(1, sizeof(fm_radio_t));
+    if (!radio || fm_radio_init(radio, fs, BENCH_AUDIO_FS, 75) != 0) {
+        free(radio);
+        return 0;
+    }
+
+    signal_iq_t sig;
+    sig.signal_iq = (double complex*)malloc(BENCH_CHUNK * sizeof(double complex));
+    size_t out = 0;
+    *elapsed = 0;
+
+    bench_allocs(a0);
+    for (size_t pos = 0; sig.signal_iq && pos + BENCH_CHUNK <= n; pos += BENCH_CHUNK) {
+        const int8_t *chunk = &iq[2 * pos];
+        uint64_t t0 = bench_now_ns();
+        if (fast) {
+            out += (size_t)fm_radio_iq8_to_pcm(radio, chunk, BENCH_CHUNK, &pcm[out]);
+        } else {
+            // Same conversion the audio thread does for the reference path
+            sig.n_signal = BENCH_CHUNK;
+            for (int i = 0; i < BENCH_CHUNK; i++) {
+                sig.signal_iq[i] = chunk[2*i] / 128.0 + (chunk[2*i + 1] / 128.0) * I;
+            }
+            out += (size_t)fm_radio_iq_to_pcm(radio, &sig, &pcm[out]);
+        }
+        *elapsed += bench_now_ns() - t0;
+    }
+    bench_allocs(a1);
+
+    free(sig.signal_iq);
+    fm_radio_free(radio);
+    free(radio);
+    return out;
+}
+
+/**
+ * @brief Reference vs float discriminator: speed, output SNR against reference, THD+N.
+ */
+void bench_fm_radio(void) {
+    printf("\n--- fm_radio: reference (double/atan2) vs fast (int8/float poly atan) ---\n");
+
+    // Kernel accuracy over the full circle
+    double max_err = 0.0;
+    for (int k = 0; k < 100000; k++) {
+        double ang = -M_PI + 2.0 * M_PI * (double)k / 100000.0;
+        float iq[2] = { (float)cos(ang), (float)sin(ang) };
+        float prev[2] = { 1.0f, 0.0f };
+        float out;
+        fm_discriminate_f32(iq, 1, prev, &out);
+        double err = fabs(remainder((double)out - ang, 2.0 * M_PI));
+        if (err > max_err) max_err = err;
+    }
+    printf("    poly atan2 max error: %.2e rad\n", max_err);
+
+    for (size_t r = 0; r < sizeof(fm_rates) / sizeof(fm_rates[0]); r++) {
+        double fs = fm_rates[r];
+        size_t n = (size_t)(fs * 0.5);
+        uint32_t seed = 0xC0FFEEu;
+        int8_t *iq = make_fm_iq(fs, n, 20.0, &seed);
+        int16_t *pcm_ref  = (int16_t*)calloc(n, sizeof(int16_t));
+        int16_t *pcm_fast = (int16_t*)calloc(n, sizeof(int16_t));
+        if (!iq || !pcm_ref || !pcm_fast) {
+            free(iq); free(pcm_ref); free(pcm_fast);
+            continue;
+        }
+
+        uint64_t t_ref = 0, t_fast = 0;
+        bench_allocs_t ar0, ar1, af0, af1;
+        size_t n_ref  = run_chain(fs, iq, n, 0, pcm_ref, &t_ref, &ar0, &ar1);
+        size_t n_fast = run_chain(fs, iq, n, 1, pcm_fast, &t_fast, &af0, &af1);
+        size_t n_cmp  = (n_ref < n_fast) ? n_ref : n_fast;
+        size_t settle = BENCH_AUDIO_FS / 20;     // skip 50 ms of filter start-up
+
+        char params[64];
+        snprintf(params, sizeof(params), "fs=%.1fM reference", fs / 1e6);
+        bench_report_allocs("fm_radio_iq_to_pcm", params, (double)n, t_ref, &ar0, &ar1);
+        snprintf(params, sizeof(params), "fs=%.1fM fast", fs / 1e6);
+        bench_report_allocs("fm_radio_iq8_to_pcm", params, (double)n, t_fast, &af0, &af1);
+
+        if (n_cmp > settle) {
+            double sig_p = 0, err_p = 0;
+            for (size_t i = settle; i < n_cmp; i++) {
+                double d = (double)pcm_fast[i] - (double)pcm_ref[i];
+                sig_p += (double)pcm_ref[i] * pcm_ref[i];
+                err_p += d * d;
+            }
+            printf("    fast vs ref SNR: %.1f dB | THD+N ref: %.1f dB fast: %.1f dB\n",
+                   10.0 * log10(sig_p / (err_p + 1e-12)),
+                   thdn_db(&pcm_ref[settle], n_cmp - settle, BENCH_AUDIO_FS, BENCH_TONE_HZ),
+                   thdn_db(&pcm_fast[settle], n_cmp - settle, BENCH_AUDIO_FS, BENCH_TONE_HZ));
+        }
+
+        free(iq);
+        free(pcm_ref);
+        free(pcm_fast);
+    }
+}
@@ -0,0 +1,397 @@
+// bench/bench_golden.c -- accuracy of the production DSP kernels against references
+//
+// Deterministic synthetic IQ goes through execute_welch_psd_ws + scale_psd and the three
+// fm_radio entry points. Every output is checked against
+//   - an independent reference computed here (plain radix-2 FFT Welch, the double/atan2
+//     FM chain), with per-kernel tolerances below, and
+//   - stored golden vectors in GOLDEN_DIR (default bench/golden), when present.
+// GOLDEN_UPDATE=1 records the current outputs as the golden vectors: do it on a build
+// whose numerics are trusted, before enabling a fast path, then compare against them.
+// Failed checks make rf_bench exit 1.
+#include "bench_common.h"
+#include "psd.h"
+#include "arena.h"
+#include "work_pool.h"
+#include "fm_radio.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <complex.h>
+#include <errno.h>
+#include <sys/stat.h>
+
+// --- Tolerances ---
+#define WELCH_TOL_DB          0.05    // max |engine - reference| per bin, dBm
+#define WELCH_RANGE_DB        90.0    // ... over bins within this of the peak
+#define WELCH_PARSEVAL_DB     0.10    // integrated PSD vs windowed signal power
+#define FM_THDN_MAX_DB        (-50.0) // reference chain, 1 kHz tone at 75 kHz deviation
+#define FM_FAST_SNR_MIN_DB    60.0    // int8 / cf32 paths vs the reference chain
+#define GOLDEN_PSD_TOL_DB     0.01    // vs stored vectors (same build: ~0)
+#define GOLDEN_PCM_SNR_DB     80.0
+
+#define GOLDEN_FS             2e6
+#define GOLDEN_SAMPLES        65536
+#define GOLDEN_AUDIO_FS       48000
+#define GOLDEN_FM_CHUNK       16384
+
+typedef struct {
+    PsdWindowType_t window;
+    const char *name;
+    int nperseg;
+    double overlap;
+    bool pool;
+} welch_case_t;
+
+static const welch_case_t welch_cases[] = {
+    { HAMMING_TYPE,     "hamming",  1024, 0.50, false },
+    { HANN_TYPE,        "hann",     4096, 0.50, false },
+    { BLACKMAN_TYPE,    "blackman", 4096, 0.75, false },
+    { FLAT_TOP_TYPE,    "flattop",  1024, 0.00, false },
+    { RECTANGULAR_TYPE, "rect",     2048, 0.50, false },
+    { HANN_TYPE,        "hann",     4096, 0.50, true  },   // sliced over the pool: same stored vector
+};
+
+static const double fm_rates[] = { 2e6, 8e6, 20e6 };
+
+// =========================================================
+// GOLDEN VECTORS (raw doubles, host byte order)
+
+static const char* golden_dir(void) {
+    const char *d = getenv("GOLDEN_DIR");
+    return (d && d[0]) ? d : "bench/golden";
+}
+
+static bool golden_update(void) {
+    const char *u = getenv("GOLDEN_UPDATE");
+    return u && strcmp(u, "1") == 0;
+}
+
+/**
+ * @brief GOLDEN_UPDATE=1: stores v as <name>.f64. Otherwise loads it into a new buffer.
+ * @return Stored vector (caller frees), NULL when recording or when there is none.
+ */
+static double* golden_load_or_store(const char *name, const double *v, size_t n, size_t *n_out) {
+    char path[512];
+    snprintf(path, sizeof(path), "%s/%s.f64", golden_dir(), name);
+    *n_out = 0;
+
+    if (golden_update()) {
+        mkdir(golden_dir(), 0755);
+        FILE *f = fopen(path, "wb");
+        if (!f || fwrite(v, sizeof(double), n, f) != n) {
+            fprintf(stderr, "[GOLDEN] Cannot write %s: %s\n", path, strerror(errno));
+        } else {
+            printf("    recorded %s (%zu values)\n", path, n);
+        }
+        if (f) fclose(f);
+        return NULL;
+    }
+
+    FILE *f = fopen(path, "rb");
+    if (!f) return NULL;
+    double *g = NULL;
+    if (fseek(f, 0, SEEK_END) == 0) {
+        long bytes = ftell(f);
+        rewind(f);
+        if (bytes > 0 && (g = (double*)malloc((size_t)bytes)) != NULL) {
+            *n_out = fread(g, sizeof(double), (size_t)bytes / sizeof(double), f);
+        }
+    }
+    fclose(f);
+    return g;
+}
+
+// =========================================================
+// REFERENCE WELCH (independent of FFTW and of psd.c's code)
+
+static void ref_fft(double complex *x, int n) {
+    for (int i = 1, j = 0; i < n; i++) {
+        int bit = n >> 1;
+        for (; j & bit; bit >>= 1) j ^= bit;
+        j ^= bit;
+        if (i < j) {
+            double complex t = x[i];
+            x[i] = x[j];
+            x[j] = t;
+        }
+    }
+    for (int len = 2; len <= n; len <<= 1) {
+        for (int i = 0; i < n; i += len) {
+            for (int k = 0; k < len / 2; k++) {
+                double complex w = cexp(-2.0 * M_PI * I * (double)k / (double)len);
+                double complex u = x[i + k], v = x[i + k + len / 2] * w;
+                x[i + k] = u + v;
+                x[i + k + len / 2] = u - v;
+            }
+        }
+    }
+}
+
+/** The window definitions the engine documents (symmetric, N - 1 in the denominator) */
+static double ref_window(PsdWindowType_t type, int i, int n) {
+    double x = 2.0 * M_PI * (double)i / (double)(n - 1);
+    switch (type) {
+    case HANN_TYPE:        return 0.5 - 0.5 * cos(x);
+    case RECTANGULAR_TYPE: return 1.0;
+    case BLACKMAN_TYPE:    return 0.42 - 0.5 * cos(x) + 0.08 * cos(2.0 * x);
+    case FLAT_TOP_TYPE:    return 1.0 - 1.93 * cos(x) + 1.29 * cos(2.0 * x) - 0.388 * cos(3.0 * x) + 0.032 * cos(4.0 * x);
+    default:               return 0.54 - 0.46 * cos(x);
+    }
+}
+
+/**
+ * @brief Density-scaled, two-sided, centred Welch PSD (scipy.signal.welch with
+ * return_onesided=False, detrend=False and the same window), with the engine's DC blanking.
+ * @param power_out Windowed mean signal power, for the Parseval check.
+ */
+static void ref_welch(const double complex *x, size_t n_x, PsdWindowType_t type, int nperseg, int noverlap,
+                      double fs, double *p, double *power_out) {
+    double *w = (double*)malloc((size_t)nperseg * sizeof(double));
+    double complex *seg = (double complex*)malloc((size_t)nperseg * sizeof(double complex));
+    double *acc = (double*)calloc((size_t)nperseg, sizeof(double));
+    if (!w || !seg || !acc) {
+        free(w);
+        free(seg);
+        free(acc);
+        memset(p, 0, (size_t)nperseg * sizeof(double));
+        return;
+    }
+
+    double s2 = 0.0;
+    for (int i = 0; i < nperseg; i++) {
+        w[i] = ref_window(type, i, nperseg);
+        s2 += w[i] * w[i];
+    }
+    int step = nperseg - noverlap;
+    int k_segments = (int)((n_x - (size_t)nperseg) / (size_t)step) + 1;
+    double power = 0.0;
+    for (int k = 0; k < k_segments; k++) {
+        const double complex *s = &x[(size_t)k * step];
+        for (int i = 0; i < nperseg; i++) {
+            seg[i] = s[i] * w[i];
+            power += creal(s[i] * conj(s[i])) * w[i] * w[i];
+        }
+        ref_fft(seg, nperseg);
+        for (int i = 0; i < nperseg; i++) acc[i] += creal(seg[i] * conj(seg[i]));
+    }
+    *power_out = power / (s2 * k_segments);
+
+    // fftshift, then flatten the DC bins (0.25 % of nperseg each side) with their neighbours
+    int half = nperseg / 2;
+    for (int i = 0; i < nperseg; i++) p[i] = acc[(i + half) % nperseg] / (fs * s2 * k_segments);
+    int hw = (int)(nperseg * 0.0025);
+    if (hw < 1) hw = 1;
+    double mean = 0.5 * (p[half - hw - 1] + p[half + hw + 1]);
+    for (int i = -hw; i <= hw; i++) p[half + i] = mean;
+
+    free(w);
+    free(seg);
+    free(acc);
+}
+
+/** scale_psd's "dbm": 50 ohm, 1e-20 W floor */
+static double ref_dbm(double p) {
+    double watts = p / 50.0;
+    return 10.0 * log10((watts < 1e-20 ? 1e-20 : watts) * 1000.0);
+}
+
+// =========================================================
+// CASES
+
+/** int8 capture: two tones (one off-bin) over noise, the same every run */
+static int8_t* make_capture(void) {
+    int8_t *raw = (int8_t*)malloc((size_t)GOLDEN_SAMPLES * 2);
+    if (!raw) return NULL;
+    uint32_t seed = 0x60D1u;
+    for (size_t i = 0; i < GOLDEN_SAMPLES; i++) {
+        double t = (double)i / GOLDEN_FS;
+        double complex v = 60.0 * cexp(2.0 * M_PI * I * 250e3 * t) + 6.0 * cexp(-2.0 * M_PI * I * 412.3e3 * t);
+        double re = creal(v) + 3.0 * bench_rand_gauss(&seed);
+        double im = cimag(v) + 3.0 * bench_rand_gauss(&seed);
+        raw[2*i]     = (int8_t)fmax(-127.0, fmin(127.0, lrint(re)));
+        raw[2*i + 1] = (int8_t)fmax(-127.0, fmin(127.0, lrint(im)));
+    }
+    return raw;
+}
+
+static void run_welch_case(const welch_case_t *c, const signal_iq_t *sig) {
+    char params[64], name[96];
+    snprintf(params, sizeof(params), "%s n=%d ov=%.0f%%%s", c->name, c->nperseg, 100.0 * c->overlap,
+             c->pool ? " pool" : "");
+    snprintf(name, sizeof(name), "welch_%s_%d_%.0f", c->name, c->nperseg, 100.0 * c->overlap);
+
+    PsdConfig_t cfg = { c->window, GOLDEN_FS, c->nperseg, (int)(c->overlap * c->nperseg) };
+    size_t n = (size_t)c->nperseg;
+    double *f = (double*)malloc(n * sizeof(double));
+    double *p = (double*)malloc(n * sizeof(double));
+    double *ref = (double*)malloc(n * sizeof(double));
+    arena_t arena;
+    arena_init(&arena);
+    psd_workspace_t ws;
+    memset(&ws, 0, sizeof(ws));
+    if (c->pool && work_pool_start(0) != 0) {
+        printf("%-22s %-34s no work pool\n", "golden welch", params);
+        free(f); free(p); free(ref);
+        return;
+    }
+
+    if (f && p && ref && arena_reserve(&arena, psd_workspace_bytes(&cfg)) == 0 &&
+        psd_workspace_init(&ws, &cfg, &arena) == 0) {
+        execute_welch_psd_ws(&ws, sig, f, p);
+
+        double power = 0.0;
+        ref_welch(sig->signal_iq, sig->n_signal, c->window, cfg.nperseg, cfg.noverlap, GOLDEN_FS, ref, &power);
+        double integral = 0.0;
+        for (size_t i = 0; i < n; i++) integral += p[i] * (GOLDEN_FS / (double)n);
+
+        scale_psd(p, c->nperseg, "dbm");
+        double peak = -INFINITY, max_err = 0.0;
+        for (size_t i = 0; i < n; i++) {
+            ref[i] = ref_dbm(ref[i]);
+            if (ref[i] > peak) peak = ref[i];
+        }
+        for (size_t i = 0; i < n; i++) {
+            if (ref[i] < peak - WELCH_RANGE_DB) continue;
+            double e = fabs(p[i] - ref[i]);
+            if (!(e <= max_err)) max_err = e;          // keeps NaN
+        }
+        bench_check("golden welch", params, "max |d| dB", max_err, WELCH_TOL_DB, true);
+        bench_check("golden welch", params, "parseval |d| dB", fabs(10.0 * log10(integral / power)),
+                    WELCH_PARSEVAL_DB, true);
+
+        size_t n_g;
+        double *g = golden_load_or_store(name, p, n, &n_g);
+        if (g) {
+            double g_err = 0.0;
+            for (size_t i = 0; i < n && n_g == n; i++) {
+                double e = fabs(p[i] - g[i]);
+                if (!(e <= g_err)) g_err = e;
+            }
+            bench_check("golden welch", params, "stored |d| dB", n_g == n ? g_err : NAN, GOLDEN_PSD_TOL_DB, true);
+            free(g);
+        }
+    } else {
+        printf("%-22s %-34s setup failed\n", "golden welch", params);
+    }
+
+    psd_workspace_release(&ws);
+    arena_free(&arena);
+    if (c->pool) work_pool_stop();
+    free(f);
+    free(p);
+    free(ref);
+}
+
+typedef enum { FM_PATH_REF, FM_PATH_INT8, FM_PATH_CF32 } fm_path_t;
+
+/** One fm_radio entry point over the whole capture in GOLDEN_FM_CHUNK blocks */
+static size_t run_fm(double fs, const int8_t *iq, size_t n, fm_path_t path, int16_t *pcm) {
+    fm_radio_t *radio = (fm_radio_t*)calloc(1, sizeof(fm_radio_t));
+    double complex *c = (double complex*)malloc(GOLDEN_FM_CHUNK * sizeof(double complex));
+    float *f = (float*)malloc(GOLDEN_FM_CHUNK * 2 * sizeof(float));
+    size_t out = 0;
+    if (radio && c && f && fm_radio_init(radio, fs, GOLDEN_AUDIO_FS, 75) == 0) {
+        for (size_t pos = 0; pos + GOLDEN_FM_CHUNK <= n; pos += GOLDEN_FM_CHUNK) {
+            const int8_t *chunk = &iq[2 * pos];
+            if (path == FM_PATH_INT8) {
+                out += (size_t)fm_radio_iq8_to_pcm(radio, chunk, GOLDEN_FM_CHUNK, &pcm[out]);
+            } else if (path == FM_PATH_CF32) {
+                for (int i = 0; i < 2 * GOLDEN_FM_CHUNK; i++) f[i] = (float)chunk[i] / 128.0f;
+                out += (size_t)fm_radio_cf32_to_pcm(radio, f, GOLDEN_FM_CHUNK, &pcm[out]);
+            } else {
+                signal_iq_t sig = { c, GOLDEN_FM_CHUNK };
+                for (int i = 0; i < GOLDEN_FM_CHUNK; i++) c[i] = chunk[2*i] / 128.0 + (chunk[2*i + 1] / 128.0) * I;
+                out += (size_t)fm_radio_iq_to_pcm(radio, &sig, &pcm[out]);
+            }
+        }
+        fm_radio_free(radio);
+    }
+    free(radio);
+    free(c);
+    free(f);
+    return out;
+}
+
+/** 10 log10(|ref|^2 / |x - ref|^2) over [from, n) */
+static double snr_db(const int16_t *ref, const double *x, size_t from, size_t n) {
+    double s = 0.0, e = 0.0;
+    for (size_t i = from; i < n; i++) {
+        double d = x[i] - (double)ref[i];
+        s += (double)ref[i] * ref[i];
+        e += d * d;
+    }
+    return e > 0 ? 10.0 * log10(s / e) : INFINITY;
+}
+
+static void run_fm_case(double fs) {
+    char params[64], name[64];
+    snprintf(params, sizeof(params), "fs=%.1fM", fs / 1e6);
+    snprintf(name, sizeof(name), "fm_%.0fk", fs / 1e3);
+
+    size_t n = (size_t)(fs * 0.5);
+    uint32_t seed = 0xC0FFEEu;
+    int8_t *iq = make_fm_iq(fs, n, 20.0, &seed);
+    int16_t *pcm[3];
+    for (int k = 0; k < 3; k++) pcm[k] = (int16_t*)calloc(n, sizeof(int16_t));
+    double *x = (double*)malloc(n * sizeof(double));
+    if (!iq || !pcm[0] || !pcm[1] || !pcm[2] || !x) goto done;
+
+    size_t got[3];
+    for (int k = 0; k < 3; k++) got[k] = run_fm(fs, iq, n, (fm_path_t)k, pcm[k]);
+    size_t settle = GOLDEN_AUDIO_FS / 20;        // filter start-up
+    if (got[0] <= settle) {
+        printf("%-22s %-34s no audio\n", "golden fm_radio", params);
+        goto done;
+    }
+
+    bench_check("golden fm_radio", params, "ref THD+N dB",
+                thdn_db(&pcm[0][settle], got[0] - settle, GOLDEN_AUDIO_FS, BENCH_TONE_HZ), FM_THDN_MAX_DB, true);
+    static const char *metric[3] = { "", "int8 SNR dB", "cf32 SNR dB" };
+    for (int k = 1; k < 3; k++) {
+        size_t m = got[k] < got[0] ? got[k] : got[0];
+        for (size_t i = 0; i < m; i++) x[i] = pcm[k][i];
+        bench_check("golden fm_radio", params, metric[k], m > settle ? snr_db(pcm[0], x, settle, m) : NAN,
+                    FM_FAST_SNR_MIN_DB, false);
+    }
+
+    for (size_t i = 0; i < got[0]; i++) x[i] = pcm[0][i];
+    size_t n_g;
+    double *g = golden_load_or_store(name, x, got[0], &n_g);
+    if (g) {
+        // Stored PCM as the reference: a changed chain shows up as a lower SNR
+        int16_t *gs = (int16_t*)malloc(n_g * sizeof(int16_t));
+        if (gs) {
+            for (size_t i = 0; i < n_g; i++) gs[i] = (int16_t)g[i];
+            double snr = n_g == got[0] ? snr_db(gs, x, settle, n_g) : NAN;
+            bench_check("golden fm_radio", params, "stored SNR dB", snr, GOLDEN_PCM_SNR_DB, false);
+            free(gs);
+        }
+        free(g);
+    }
+
+done:
+    free(iq);
+    for (int k = 0; k < 3; k++) free(pcm[k]);
+    free(x);
+}
+
+/**
+ * @brief Numerical regression gate for the PSD and FM kernels: one line per check with
+ * value, limit and ok / FAIL.
+ */
+void bench_golden(void) {
+    printf("\n--- golden: Welch + scale_psd and fm_radio vs references (GOLDEN_DIR=%s%s) ---\n",
+           golden_dir(), golden_update() ? ", recording" : "");
+
+    int8_t *raw = make_capture();
+    signal_iq_t sig;
+    sig.signal_iq = (double complex*)malloc((size_t)GOLDEN_SAMPLES * sizeof(double complex));
+    if (raw && sig.signal_iq && load_iq_into(&sig, GOLDEN_SAMPLES, raw, (size_t)GOLDEN_SAMPLES * 2) == 0) {
+        for (size_t i = 0; i < sizeof(welch_cases) / sizeof(welch_cases[0]); i++) run_welch_case(&welch_cases[i], &sig);
+    }
+    free(sig.signal_iq);
+    free(raw);
+
+    for (size_t r = 0; r < sizeof(fm_rates) / sizeof(fm_rates[0]); r++) run_fm_case(fm_rates[r]);
+}
@@ -0,0 +1,141 @@
+// bench/bench_jitter.c
+#include "bench_common.h"
+#include "rt_policy.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <pthread.h>
+#include <sched.h>
+#include <time.h>
+#include <unistd.h>
+
+#define JIT_PERIOD_NS     5000000ULL     // 5 ms: a quarter of an Opus frame
+#define JIT_PERIODS       1000
+#define JIT_WORK_SAMPLES  4800           // per-period work ~ one 20 ms block of 48 kHz PCM / 4
+#define JIT_FIFO_PRIO     70
+
+typedef struct {
+    volatile int running;
+    const rt_thread_cfg_t *cfg;
+    double sink;
+} jit_load_t;
+
+typedef struct {
+    const rt_thread_cfg_t *cfg;
+    uint64_t *late_ns;               // one slot per period: wake-up minus deadline
+    int applied;                     // rt_thread_apply result
+    int sched;                       // effective policy
+} jit_periodic_t;
+
+/** Burns CPU like the PSD loop does: FFT-sized blocks of transcendental math */
+static void* load_fn(void *arg) {
+    jit_load_t *l = (jit_load_t*)arg;
+    if (l->cfg) rt_thread_apply(l->cfg);
+    double acc = 0.0;
+    while (l->running) {
+        for (int i = 0; i < 4096; i++) acc += sin(acc + i) * 1e-3;
+    }
+    l->sink = acc;
+    return NULL;
+}
+
+/** The audio thread's shape: absolute-deadline wake-ups, a small block of work each */
+static void* periodic_fn(void *arg) {
+    jit_periodic_t *p = (jit_periodic_t*)arg;
+    p->applied = p->cfg ? rt_thread_apply(p->cfg) : 0;
+    struct sched_param sp;
+    pthread_getschedparam(pthread_self(), &p->sched, &sp);
+
+    float *blk = (float*)calloc(JIT_WORK_SAMPLES, sizeof(float));
+    uint32_t seed = 7;
+    struct timespec next;
+    clock_gettime(CLOCK_MONOTONIC, &next);
+
+    for (int k = 0; k < JIT_PERIODS; k++) {
+        uint64_t dl = (uint64_t)next.tv_sec * 1000000000ULL + (uint64_t)next.tv_nsec + JIT_PERIOD_NS;
+        next.tv_sec = (time_t)(dl / 1000000000ULL);
+        next.tv_nsec = (long)(dl % 1000000000ULL);
+        clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &next, NULL);
+        uint64_t now = bench_now_ns();
+        p->late_ns[k] = now > dl ? now - dl : 0;
+
+        if (blk) for (int i = 0; i < JIT_WORK_SAMPLES; i++) blk[i] = 0.5f * blk[i] + bench_rand_gauss(&seed);
+    }
+    free(blk);
+    return NULL;
+}
+
+static int cmp_u64(const void *a, const void *b) {
+    uint64_t x = *(const uint64_t*)a, y = *(const uint64_t*)b;
+    return (x > y) - (x < y);
+}
+
+/** One run: n_load spinning threads + the periodic thread, each with its own entry (NULL = inherit) */
+static void run(const char *name, int n_load, const rt_thread_cfg_t *load_cfg, const rt_thread_cfg_t *rt_cfg) {
+    uint64_t *late = (uint64_t*)calloc(JIT_PERIODS, sizeof(uint64_t));
+    pthread_t *th = (pthread_t*)calloc((size_t)n_load, sizeof(pthread_t));
+    if (!late || !th) {
+        free(late);
+        free(th);
+        return;
+    }
+
+    jit_load_t load = { 1, load_cfg, 0.0 };
+    int started = 0;
+    for (int i = 0; i < n_load; i++) {
+        if (pthread_create(&th[i], NULL, load_fn, &load) == 0) started++;
+    }
+
+    jit_periodic_t p = { rt_cfg, late, 0, SCHED_OTHER };
+    pthread_t pt;
+    if (pthread_create(&pt, NULL, periodic_fn, &p) == 0) pthread_join(pt, NULL);
+
+    load.running = 0;
+    for (int i = 0; i < started; i++) pthread_join(th[i], NULL);
+
+    qsort(late, JIT_PERIODS, sizeof(uint64_t), cmp_u64);
+    size_t missed = 0;           // woke after the next deadline had already passed
+    for (size_t i = 0; i < JIT_PERIODS; i++) if (late[i] > JIT_PERIOD_NS) missed++;
+    printf("  %-22s wake-up lateness p50 %7.1f us  p99 %8.1f us  max %8.1f us  missed %zu/%d  (%s%s, %d load)\n",
+           name, 1e-3 * (double)late[JIT_PERIODS / 2], 1e-3 * (double)late[JIT_PERIODS * 99 / 100],
+           1e-3 * (double)late[JIT_PERIODS - 1], missed, JIT_PERIODS,
+           rt_sched_name(p.sched), p.applied != 0 ? ", policy partly denied" : "", started);
+
+    free(th);
+    free(late);
+}
+
+/**
+ * @brief Audio-style jitter: a thread wakes every 5 ms on an absolute deadline while one
+ * CPU-bound thread per core competes. First with no policy (everything SCHED_OTHER,
+ * floating), then with the split RT_POLICY is meant for: the periodic thread SCHED_FIFO on
+ * the last CPU, the load niced and kept off that CPU. Without CAP_SYS_NICE / rtprio the
+ * FIFO part is denied and reported; affinity and nice still apply.
+ */
+void bench_jitter(void) {
+    long ncpu = sysconf(_SC_NPROCESSORS_ONLN);
+    if (ncpu < 1) ncpu = 1;
+    printf("\n--- jitter: %d x %llu ms periods under %ld CPU-bound threads, without / with RT policy ---\n",
+           JIT_PERIODS, (unsigned long long)(JIT_PERIOD_NS / 1000000ULL), ncpu);
+
+    run("no policy", (int)ncpu, NULL, NULL);
+
+    rt_thread_cfg_t rt_cfg, load_cfg;
+    memset(&rt_cfg, 0, sizeof(rt_cfg));
+    memset(&load_cfg, 0, sizeof(load_cfg));
+    rt_cfg.has_cpus = true;
+    CPU_ZERO(&rt_cfg.cpus);
+    CPU_SET((int)ncpu - 1, &rt_cfg.cpus);
+    rt_cfg.has_sched = true;
+    rt_cfg.sched = SCHED_FIFO;
+    rt_cfg.priority = JIT_FIFO_PRIO;
+    load_cfg.has_nice = true;
+    load_cfg.nice = 10;
+    if (ncpu > 1) {
+        load_cfg.has_cpus = true;
+        CPU_ZERO(&load_cfg.cpus);
+        for (int c = 0; c < ncpu - 1; c++) CPU_SET(c, &load_cfg.cpus);
+    }
+    run("fifo + isolated cpu", (int)ncpu, &load_cfg, &rt_cfg);
+}
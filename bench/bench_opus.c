@@ -0,0 +1,156 @@
+// bench/bench_opus.c
+#include "bench_common.h"
+#include "opus_tx.h"
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+
+#define OPUS_BENCH_FS         48000
+#define OPUS_BENCH_FRAME_MS   20
+#define OPUS_BENCH_FRAMES     1000            // 20 s of audio
+#define OPUS_BENCH_SHM_NAME   "/rf_bench_opus"
+
+typedef struct {
+    int listen_fd;
+    uint64_t bytes;
+} opus_sink_t;
+
+/** The gateway's side of the OPU0 stream: accept one connection, read until closed */
+static void* sink_fn(void *arg) {
+    opus_sink_t *s = (opus_sink_t*)arg;
+    int fd = accept(s->listen_fd, NULL, NULL);
+    if (fd < 0) return NULL;
+    char buf[16384];
+    ssize_t n;
+    while ((n = read(fd, buf, sizeof(buf))) > 0) s->bytes += (uint64_t)n;
+    close(fd);
+    return NULL;
+}
+
+static int sink_listen(int *port) {
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) return -1;
+    struct sockaddr_in sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sin_family = AF_INET;
+    sa.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t len = sizeof(sa);
+    if (bind(fd, (struct sockaddr*)&sa, sizeof(sa)) != 0 || listen(fd, 1) != 0 ||
+        getsockname(fd, (struct sockaddr*)&sa, &len) != 0) {
+        close(fd);
+        return -1;
+    }
+    *port = ntohs(sa.sin_port);
+    return fd;
+}
+
+static int16_t* make_tone(int frame_samples, int channels) {
+    size_t n = (size_t)frame_samples * OPUS_BENCH_FRAMES * (size_t)channels;
+    int16_t *pcm = (int16_t*)malloc(n * sizeof(int16_t));
+    if (!pcm) return NULL;
+    for (size_t i = 0; i < n; i++) {
+        double t = (double)(i / (size_t)channels) / OPUS_BENCH_FS;
+        pcm[i] = (int16_t)(12000.0 * sin(2.0 * M_PI * BENCH_TONE_HZ * t));
+    }
+    return pcm;
+}
+
+/** OPUS_BENCH_FRAMES through opus_tx_send_frame, once connected (TCP) or with the ring drained (shm) */
+static void run(const char *params, opus_tx_cfg_t cfg) {
+    const int frame_samples = OPUS_BENCH_FS * OPUS_BENCH_FRAME_MS / 1000;
+    int16_t *pcm = make_tone(frame_samples, cfg.channels);
+    if (!pcm) return;
+
+    opus_sink_t sink = { -1, 0 };
+    pthread_t th;
+    bool sink_started = false;
+    int port = 0;
+    const char *host = OPUS_BENCH_SHM_NAME;
+    if (cfg.transport == OPUS_TX_OPU0_TCP) {
+        sink.listen_fd = sink_listen(&port);
+        if (sink.listen_fd < 0 || pthread_create(&th, NULL, sink_fn, &sink) != 0) {
+            printf("%-22s %-34s no local sink\n", "opus_tx_send_frame", params);
+            if (sink.listen_fd >= 0) close(sink.listen_fd);
+            free(pcm);
+            return;
+        }
+        sink_started = true;
+        host = "127.0.0.1";
+    }
+
+    opus_tx_t *tx = opus_tx_create(host, port, &cfg);
+    shm_ring_hdr_t *hdr = (tx && cfg.transport == OPUS_TX_SHM) ? bench_shm_map(OPUS_BENCH_SHM_NAME) : NULL;
+    opus_tx_stats_t st;
+    memset(&st, 0, sizeof(st));
+    for (int i = 0; tx && cfg.transport == OPUS_TX_OPU0_TCP && i < 2000; i++) {
+        opus_tx_flush(tx);
+        opus_tx_get_stats(tx, &st);
+        if (st.connected) break;
+        usleep(1000);
+    }
+
+    if (tx) {
+        bench_allocs_t a0, a1;
+        bench_allocs(&a0);
+        uint64_t t0 = bench_now_ns();
+        for (int f = 0; f < OPUS_BENCH_FRAMES; f++) {
+            opus_tx_send_frame(tx, &pcm[(size_t)f * frame_samples * cfg.channels], frame_samples);
+            bench_shm_drain(hdr);
+        }
+        uint64_t elapsed = bench_now_ns() - t0;
+        bench_allocs(&a1);
+        opus_tx_flush(tx);
+        opus_tx_get_stats(tx, &st);
+
+        bench_report_allocs("opus_tx_send_frame", params, (double)frame_samples * OPUS_BENCH_FRAMES, elapsed, &a0, &a1);
+        printf("    %.1f us/frame, %llu frames sent, %llu dropped, %.1f B/frame\n",
+               1e-3 * (double)elapsed / OPUS_BENCH_FRAMES, (unsigned long long)st.frames_sent,
+               (unsigned long long)st.frames_dropped,
+               st.frames_sent ? (double)st.bytes_sent / (double)st.frames_sent : 0.0);
+        bench_shm_unmap(hdr);
+        opus_tx_destroy(tx);
+    } else {
+        printf("%-22s %-34s opus_tx_create failed\n", "opus_tx_send_frame", params);
+    }
+
+    if (sink_started) {
+        shutdown(sink.listen_fd, SHUT_RDWR);     // wakes accept if the sender never connected
+        pthread_join(th, NULL);
+        close(sink.listen_fd);
+    }
+    free(pcm);
+}
+
+/**
+ * @brief Opus encode + OPU0 framing + send of 20 ms frames to a local TCP sink (the
+ * gateway's end) and to the shm ring with a reader that keeps up. Samples are PCM
+ * samples per channel.
+ */
+void bench_opus_tx(void) {
+    printf("\n--- opus_tx: opus_tx_send_frame, %d ms frames to a local sink ---\n", OPUS_BENCH_FRAME_MS);
+    opus_tx_cfg_t cfg = {
+        .sample_rate = OPUS_BENCH_FS, .channels = 1, .bitrate = 32000, .complexity = 5,
+        .vbr = 0, .dtx = 0, .queue_frames = 0, .frame_ms = OPUS_BENCH_FRAME_MS,
+        .transport = OPUS_TX_OPU0_TCP,
+    };
+    run("tcp mono 32k c=5", cfg);
+    cfg.complexity = 0;
+    run("tcp mono 32k c=0", cfg);
+    cfg.complexity = 10;
+    run("tcp mono 32k c=10", cfg);
+    cfg.complexity = 5;
+    cfg.channels = 2;
+    cfg.bitrate = 64000;
+    run("tcp stereo 64k c=5", cfg);
+    cfg.channels = 1;
+    cfg.bitrate = 32000;
+    cfg.transport = OPUS_TX_SHM;
+    run("shm mono 32k c=5", cfg);
+}
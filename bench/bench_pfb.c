@@ -0,0 +1,163 @@
+// bench/bench_pfb.c
+#include "bench_common.h"
+#include "channelizer.h"
+#include "ddc.h"
+#include "fm_radio.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#define PFB_BENCH_FS        8e6
+#define PFB_BENCH_SPACING   200000.0
+#define PFB_BENCH_CHUNK     16384
+#define PFB_BENCH_AUDIO_FS  48000
+#define PFB_BENCH_MAX_CH    8
+
+static const int pfb_channel_counts[] = { 1, 2, 4, 8 };
+
+/**
+ * @brief Station j sits 30 kHz off a bin center, 400 kHz apart, each with its own tone.
+ */
+static double station_offset(int j) {
+    return -1400000.0 + 400000.0 * j + 30000.0;
+}
+
+static double station_tone(int j) {
+    return BENCH_TONE_HZ + 250.0 * j;
+}
+
+static int8_t* make_stations(double fs, size_t n, uint32_t *seed) {
+    int8_t *iq = (int8_t*)malloc(n * 2);
+    if (!iq) return NULL;
+
+    double ph[PFB_BENCH_MAX_CH] = {0};
+    for (size_t i = 0; i < n; i++) {
+        double t = (double)i / fs;
+        double re = 2.0 * bench_rand_gauss(seed);
+        double im = 2.0 * bench_rand_gauss(seed);
+        for (int j = 0; j < PFB_BENCH_MAX_CH; j++) {
+            ph[j] += 2.0 * M_PI * BENCH_DEV_HZ * sin(2.0 * M_PI * station_tone(j) * t) / fs;
+            double p = ph[j] + 2.0 * M_PI * station_offset(j) * t;
+            re += 12.0 * cos(p);
+            im += 12.0 * sin(p);
+        }
+        iq[2*i]     = (int8_t)fmax(-127.0, fmin(127.0, lrint(re)));
+        iq[2*i + 1] = (int8_t)fmax(-127.0, fmin(127.0, lrint(im)));
+    }
+    return iq;
+}
+
+typedef struct {
+    ddc_t ddc;
+    fm_radio_t radio;
+    int16_t *pcm;
+    size_t out;
+} pfb_bench_chan_t;
+
+static void chans_free(pfb_bench_chan_t *ch, int n) {
+    for (int j = 0; j < n; j++) {
+        ddc_free(&ch[j].ddc);
+        fm_radio_free(&ch[j].radio);
+        free(ch[j].pcm);
+    }
+    free(ch);
+}
+
+/**
+ * @brief One PFB + N light per-bin chains vs N full-rate DDCs, per input sample.
+ */
+void bench_pfb(void) {
+    const double fs = PFB_BENCH_FS;
+    size_t n = (size_t)(fs * 0.5);
+    uint32_t seed = 0xF00Du;
+
+    printf("\n--- pfb: %d-kHz-spaced channelizer vs independent DDCs (fs=%.1fM) ---\n",
+           (int)(PFB_BENCH_SPACING / 1e3), fs / 1e6);
+
+    int8_t *iq = make_stations(fs, n, &seed);
+    size_t stride = ((size_t)PFB_BENCH_CHUNK + 64) * 2;
+    float *bin_out = (float*)malloc(stride * PFB_BENCH_MAX_CH * sizeof(float));
+    float *chan = (float*)malloc(stride * sizeof(float));
+    channelizer_t *pfb = (channelizer_t*)calloc(1, sizeof(channelizer_t));
+    if (!iq || !bin_out || !chan || !pfb) {
+        free(iq); free(bin_out); free(chan); free(pfb);
+        return;
+    }
+
+    for (size_t c = 0; c < sizeof(pfb_channel_counts) / sizeof(pfb_channel_counts[0]); c++) {
+        int n_ch = pfb_channel_counts[c];
+        char params[64];
+        snprintf(params, sizeof(params), "fs=%.1fM N=%d", fs / 1e6, n_ch);
+
+        // --- A) PFB: one bank pass, then residual NCO + channel filter + FM per bin
+        if (channelizer_init(pfb, fs, PFB_BENCH_SPACING) != 0) break;
+        pfb_bench_chan_t *pc = (pfb_bench_chan_t*)calloc((size_t)n_ch, sizeof(pfb_bench_chan_t));
+        int bins[PFB_BENCH_MAX_CH];
+        int ok = (pc != NULL);
+        for (int j = 0; ok && j < n_ch; j++) {
+            double residual = 0.0;
+            bins[j] = channelizer_bin_for(pfb, station_offset(j), &residual);
+            pc[j].pcm = (int16_t*)calloc(n, sizeof(int16_t));
+            ok = pc[j].pcm &&
+                 ddc_init(&pc[j].ddc, pfb->fs_chan, residual, DDC_DEFAULT_BW_HZ) == 0 &&
+                 fm_radio_init(&pc[j].radio, pc[j].ddc.fs_out, PFB_BENCH_AUDIO_FS, 75) == 0;
+        }
+
+        uint64_t t_bank = 0, t_chan = 0;
+        for (size_t pos = 0; ok && pos + PFB_BENCH_CHUNK <= n; pos += PFB_BENCH_CHUNK) {
+            uint64_t t0 = bench_now_ns();
+            int n_bin = channelizer_process_s8(pfb, &iq[2 * pos], PFB_BENCH_CHUNK, bins, n_ch, bin_out, stride);
+            uint64_t t1 = bench_now_ns();
+            for (int j = 0; j < n_ch; j++) {
+                int n_iq = ddc_process_cf32(&pc[j].ddc, &bin_out[(size_t)j * stride], (size_t)n_bin, chan);
+                pc[j].out += (size_t)fm_radio_cf32_to_pcm(&pc[j].radio, chan, (size_t)n_iq, &pc[j].pcm[pc[j].out]);
+            }
+            t_bank += t1 - t0;
+            t_chan += bench_now_ns() - t1;
+        }
+
+        if (ok) {
+            bench_report("channelizer_s8", params, (double)n, t_bank);
+            bench_report("pfb+N*(ddc_cf32+fm)", params, (double)n, t_bank + t_chan);
+
+            // Worst channel quality (each bin carries its own tone next to 7 other stations)
+            size_t settle = PFB_BENCH_AUDIO_FS / 20;
+            double worst = -200.0;
+            for (int j = 0; j < n_ch; j++) {
+                if (pc[j].out <= settle) continue;
+                double d = thdn_db(&pc[j].pcm[settle], pc[j].out - settle, PFB_BENCH_AUDIO_FS, station_tone(j));
+                if (d > worst) worst = d;
+            }
+            printf("    M=%d bins, bin rate %.0f Hz | worst-channel THD+N: %.1f dB\n", pfb->M, pfb->fs_chan, worst);
+        }
+        if (pc) chans_free(pc, n_ch);
+        channelizer_free(pfb);
+        if (!ok) break;
+
+        // --- B) N independent full-rate DDCs on the same capture
+        pfb_bench_chan_t *dc = (pfb_bench_chan_t*)calloc((size_t)n_ch, sizeof(pfb_bench_chan_t));
+        ok = (dc != NULL);
+        for (int j = 0; ok && j < n_ch; j++) {
+            dc[j].pcm = (int16_t*)calloc(n, sizeof(int16_t));
+            ok = dc[j].pcm &&
+                 ddc_init(&dc[j].ddc, fs, station_offset(j), DDC_DEFAULT_BW_HZ) == 0 &&
+                 fm_radio_init(&dc[j].radio, dc[j].ddc.fs_out, PFB_BENCH_AUDIO_FS, 75) == 0;
+        }
+
+        uint64_t t_ddc = 0;
+        for (size_t pos = 0; ok && pos + PFB_BENCH_CHUNK <= n; pos += PFB_BENCH_CHUNK) {
+            uint64_t t0 = bench_now_ns();
+            for (int j = 0; j < n_ch; j++) {
+                int n_iq = ddc_process_s8(&dc[j].ddc, &iq[2 * pos], PFB_BENCH_CHUNK, chan);
+                dc[j].out += (size_t)fm_radio_cf32_to_pcm(&dc[j].radio, chan, (size_t)n_iq, &dc[j].pcm[dc[j].out]);
+            }
+            t_ddc += bench_now_ns() - t0;
+        }
+        if (ok) bench_report("N*(ddc_s8+fm)", params, (double)n, t_ddc);
+        if (dc) chans_free(dc, n_ch);
+        if (!ok) break;
+    }
+
+    free(iq); free(bin_out); free(chan); free(pfb);
+}
@@ -0,0 +1,141 @@
+// bench/bench_pool.c
+#include "bench_common.h"
+#include "work_pool.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <pthread.h>
+#include <unistd.h>
+
+#define POOL_BENCH_JOBS       16        // CHAN_BANK_MAX channels per bank pass
+#define POOL_BENCH_PASSES     400
+#define POOL_BENCH_JOB_ITERS  4000      // ~ one channel's DDC + demod on a 16k-sample pass
+#define POOL_BENCH_BG_ITERS   200000    // a Welch slice
+#define POOL_BENCH_BG_QUEUE   8
+
+typedef struct {
+    int iters;
+    double out;
+} pool_job_t;
+
+static void job_fn(void *arg) {
+    pool_job_t *j = (pool_job_t*)arg;
+    double acc = 0.0;
+    for (int i = 0; i < j->iters; i++) acc += sin(acc + i) * 1e-3;
+    j->out = acc;
+}
+
+static void* job_thread(void *arg) {
+    job_fn(arg);
+    return NULL;
+}
+
+// Background PSD load: keeps POOL_BENCH_BG_QUEUE NORMAL tasks in flight until stopped
+typedef struct {
+    volatile int running;
+    pool_job_t jobs[POOL_BENCH_BG_QUEUE];
+} pool_bg_t;
+
+static void* bg_feeder(void *arg) {
+    pool_bg_t *bg = (pool_bg_t*)arg;
+    wp_group_t g;
+    wp_group_init(&g);
+    while (bg->running) {
+        for (int i = 0; i < POOL_BENCH_BG_QUEUE; i++) {
+            bg->jobs[i].iters = POOL_BENCH_BG_ITERS;
+            work_pool_submit(&g, WP_PRIO_NORMAL, job_fn, &bg->jobs[i]);
+        }
+        wp_group_wait(&g);
+    }
+    wp_group_destroy(&g);
+    return NULL;
+}
+
+static int cmp_u64(const void *a, const void *b) {
+    uint64_t x = *(const uint64_t*)a, y = *(const uint64_t*)b;
+    return (x > y) - (x < y);
+}
+
+/** Runs POOL_BENCH_PASSES fan-out passes; use_pool = 0 spawns one thread per job */
+static void run(const char *name, int use_pool, int background) {
+    pool_job_t jobs[POOL_BENCH_JOBS];
+    pthread_t th[POOL_BENCH_JOBS];
+    uint64_t *pass_ns = (uint64_t*)calloc(POOL_BENCH_PASSES, sizeof(uint64_t));
+    if (!pass_ns) return;
+
+    pool_bg_t bg;
+    memset(&bg, 0, sizeof(bg));
+    pthread_t bg_th;
+    int bg_started = 0;
+    if (background) {
+        bg.running = 1;
+        bg_started = pthread_create(&bg_th, NULL, bg_feeder, &bg) == 0;
+    }
+
+    wp_stats_t s0, s1;
+    work_pool_get_stats(&s0);
+    wp_group_t g;
+    wp_group_init(&g);
+
+    uint64_t t_start = bench_now_ns();
+    for (int p = 0; p < POOL_BENCH_PASSES; p++) {
+        uint64_t t0 = bench_now_ns();
+        for (int i = 0; i < POOL_BENCH_JOBS; i++) jobs[i].iters = POOL_BENCH_JOB_ITERS;
+        if (use_pool) {
+            for (int i = 0; i < POOL_BENCH_JOBS; i++) work_pool_submit(&g, WP_PRIO_HIGH, job_fn, &jobs[i]);
+            wp_group_wait(&g);
+        } else {
+            int n = 0;
+            for (int i = 0; i < POOL_BENCH_JOBS; i++) {
+                if (pthread_create(&th[n], NULL, job_thread, &jobs[i]) == 0) n++;
+                else job_fn(&jobs[i]);
+            }
+            for (int i = 0; i < n; i++) pthread_join(th[i], NULL);
+        }
+        pass_ns[p] = bench_now_ns() - t0;
+    }
+    uint64_t elapsed = bench_now_ns() - t_start;
+
+    wp_group_destroy(&g);
+    if (bg_started) {
+        bg.running = 0;
+        pthread_join(bg_th, NULL);
+    }
+    work_pool_get_stats(&s1);
+
+    qsort(pass_ns, POOL_BENCH_PASSES, sizeof(uint64_t), cmp_u64);
+    printf("  %-26s %7.0f passes/s  pass p50 %7.1f us  p99 %7.1f us  max %8.1f us",
+           name, (double)POOL_BENCH_PASSES / ((double)elapsed * 1e-9),
+           1e-3 * (double)pass_ns[POOL_BENCH_PASSES / 2], 1e-3 * (double)pass_ns[POOL_BENCH_PASSES * 99 / 100],
+           1e-3 * (double)pass_ns[POOL_BENCH_PASSES - 1]);
+    if (use_pool) {
+        double wall = (double)(s1.uptime_ns - s0.uptime_ns);
+        printf("  busy %5.1f%%  steals %llu  helped %llu",
+               wall > 0 ? 100.0 * (double)(s1.busy_ns - s0.busy_ns) / (wall * s1.workers) : 0.0,
+               (unsigned long long)(s1.steals - s0.steals), (unsigned long long)(s1.helped - s0.helped));
+    }
+    printf("\n");
+    free(pass_ns);
+}
+
+/**
+ * @brief Fan-out / join of POOL_BENCH_JOBS channel-sized jobs per pass: one thread per
+ * job (create + join every pass) against the shared pool. The last row adds a backlog
+ * of Welch-sized NORMAL tasks; HIGH jobs still go first, so the pass time grows only by
+ * the NORMAL tasks already running when a pass starts.
+ */
+void bench_pool(void) {
+    long ncpu = sysconf(_SC_NPROCESSORS_ONLN);
+    printf("\n--- pool: %d jobs/pass x %d passes, thread per job vs work-stealing pool (%ld CPUs) ---\n",
+           POOL_BENCH_JOBS, POOL_BENCH_PASSES, ncpu);
+
+    run("thread per job", 0, 0);
+    if (work_pool_start(0) != 0) {
+        printf("  %-26s pool could not start\n", "pool");
+        return;
+    }
+    run("pool", 1, 0);
+    run("pool + PSD backlog", 1, 1);
+    work_pool_stop();
+}
@@ -0,0 +1,254 @@
+// bench/bench_psd.c
+#include "bench_common.h"
+#include "psd.h"
+#include "arena.h"
+#include "work_pool.h"
+#include "shm_ring.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#define PSD_BENCH_FS          2e6
+#define PSD_BENCH_SAMPLES     2000000         // one capture: 1 s at 2 MS/s (find_params_psd)
+#define PSD_BENCH_LOAD_REPS   20
+#define PSD_BENCH_SCALE_BINS  16384
+#define PSD_BENCH_SCALE_REPS  200
+#define PSD_BENCH_PUB_REPS    200
+#define PSD_BENCH_SHM_NAME    "/rf_bench_psd"
+#define PSD_BENCH_SHM_BYTES   (8 * 1024 * 1024)   // PSD_SHM_BYTES
+
+static const int psd_npersegs[] = { 1024, 4096, 16384 };
+static const double psd_overlaps[] = { 0.0, 0.5, 0.75 };
+
+static const struct {
+    PsdWindowType_t type;
+    const char *name;
+} psd_windows[] = {
+    { HAMMING_TYPE,   "hamming"  },
+    { HANN_TYPE,      "hann"     },
+    { BLACKMAN_TYPE,  "blackman" },
+    { FLAT_TOP_TYPE,  "flattop"  },
+    { KAISER_TYPE,    "kaiser"   },
+};
+
+/** int8 IQ capture: WFM station plus noise, the same every run */
+static int8_t* make_capture(size_t n) {
+    uint32_t seed = 0xC0FFEEu;
+    return make_fm_iq(PSD_BENCH_FS, n, 20.0, &seed);
+}
+
+static void run_load(const int8_t *raw) {
+    size_t bytes = (size_t)PSD_BENCH_SAMPLES * 2;
+    bench_allocs_t a0, a1;
+
+    // One-shot: what the loop did before the per-config arena (two allocations per frame)
+    bench_allocs(&a0);
+    uint64_t t0 = bench_now_ns();
+    for (int r = 0; r < PSD_BENCH_LOAD_REPS; r++) free_signal_iq(load_iq_from_buffer(raw, bytes));
+    uint64_t elapsed = bench_now_ns() - t0;
+    bench_allocs(&a1);
+    bench_report_allocs("load_iq_from_buffer", "2M samples", (double)PSD_BENCH_SAMPLES * PSD_BENCH_LOAD_REPS,
+                        elapsed, &a0, &a1);
+
+    signal_iq_t sig;
+    sig.signal_iq = (double complex*)malloc((size_t)PSD_BENCH_SAMPLES * sizeof(double complex));
+    if (!sig.signal_iq) return;
+    bench_allocs(&a0);
+    t0 = bench_now_ns();
+    for (int r = 0; r < PSD_BENCH_LOAD_REPS; r++) load_iq_into(&sig, PSD_BENCH_SAMPLES, raw, bytes);
+    elapsed = bench_now_ns() - t0;
+    bench_allocs(&a1);
+    bench_report_allocs("load_iq_into", "2M samples", (double)PSD_BENCH_SAMPLES * PSD_BENCH_LOAD_REPS,
+                        elapsed, &a0, &a1);
+    free(sig.signal_iq);
+}
+
+/** Welch on a prepared workspace (the engine's steady state); reps frames */
+static void run_welch_ws(const signal_iq_t *sig, const PsdConfig_t *cfg, const char *params, int reps) {
+    arena_t arena;
+    arena_init(&arena);
+    psd_workspace_t ws;
+    memset(&ws, 0, sizeof(ws));
+    double *f = (double*)malloc((size_t)cfg->nperseg * sizeof(double));
+    double *p = (double*)malloc((size_t)cfg->nperseg * sizeof(double));
+    if (!f || !p || arena_reserve(&arena, psd_workspace_bytes(cfg)) != 0 ||
+        psd_workspace_init(&ws, cfg, &arena) != 0) {
+        printf("%-22s %-34s setup failed\n", "execute_welch_psd", params);
+        free(f);
+        free(p);
+        arena_free(&arena);
+        return;
+    }
+
+    bench_allocs_t a0, a1;
+    bench_allocs(&a0);
+    uint64_t t0 = bench_now_ns();
+    for (int r = 0; r < reps; r++) execute_welch_psd_ws(&ws, sig, f, p);
+    uint64_t elapsed = bench_now_ns() - t0;
+    bench_allocs(&a1);
+    bench_report_allocs("execute_welch_psd_ws", params, (double)sig->n_signal * reps, elapsed, &a0, &a1);
+
+    psd_workspace_release(&ws);
+    arena_free(&arena);
+    free(f);
+    free(p);
+}
+
+static void run_welch(const signal_iq_t *sig) {
+    PsdConfig_t cfg = { HAMMING_TYPE, PSD_BENCH_FS, 4096, 2048 };
+    char params[64];
+
+    // One-shot wrapper: window, plan and buffers built on every call
+    double *f = (double*)malloc(16384 * sizeof(double));
+    double *p = (double*)malloc(16384 * sizeof(double));
+    if (f && p) {
+        bench_allocs_t a0, a1;
+        bench_allocs(&a0);
+        uint64_t t0 = bench_now_ns();
+        for (int r = 0; r < 3; r++) execute_welch_psd((signal_iq_t*)sig, &cfg, f, p);
+        uint64_t elapsed = bench_now_ns() - t0;
+        bench_allocs(&a1);
+        bench_report_allocs("execute_welch_psd", "n=4096 ov=50% hamming one-shot",
+                            (double)sig->n_signal * 3, elapsed, &a0, &a1);
+    }
+    free(f);
+    free(p);
+
+    for (size_t i = 0; i < sizeof(psd_npersegs) / sizeof(psd_npersegs[0]); i++) {
+        for (size_t k = 0; k < sizeof(psd_overlaps) / sizeof(psd_overlaps[0]); k++) {
+            cfg.nperseg = psd_npersegs[i];
+            cfg.noverlap = (int)(psd_overlaps[k] * cfg.nperseg);
+            snprintf(params, sizeof(params), "n=%d ov=%.0f%% hamming", cfg.nperseg, 100.0 * psd_overlaps[k]);
+            run_welch_ws(sig, &cfg, params, 3);
+        }
+    }
+    cfg.nperseg = 4096;
+    cfg.noverlap = 2048;
+    for (size_t w = 1; w < sizeof(psd_windows) / sizeof(psd_windows[0]); w++) {
+        cfg.window_type = psd_windows[w].type;
+        snprintf(params, sizeof(params), "n=4096 ov=50%% %s", psd_windows[w].name);
+        run_welch_ws(sig, &cfg, params, 3);
+    }
+
+    // Segments spread over the shared pool, as in the engine
+    if (work_pool_start(0) == 0) {
+        cfg.window_type = HAMMING_TYPE;
+        snprintf(params, sizeof(params), "n=4096 ov=50%% hamming pool=%d", work_pool_size());
+        run_welch_ws(sig, &cfg, params, 3);
+        work_pool_stop();
+    }
+}
+
+static void run_scale(void) {
+    static const char *units[] = { "dbm", "dbuv", "w", "v" };
+    double *ref = (double*)malloc(PSD_BENCH_SCALE_BINS * sizeof(double));
+    double *psd = (double*)malloc(PSD_BENCH_SCALE_BINS * sizeof(double));
+    if (!ref || !psd) {
+        free(ref);
+        free(psd);
+        return;
+    }
+    uint32_t seed = 0xBEEFu;
+    for (int i = 0; i < PSD_BENCH_SCALE_BINS; i++) ref[i] = 1e-9 * (1.0 + (double)(bench_rand_u32(&seed) & 0xFFFF));
+
+    for (size_t u = 0; u < sizeof(units) / sizeof(units[0]); u++) {
+        // In place: every rep starts again from the raw powers (copy not timed)
+        uint64_t elapsed = 0;
+        bench_allocs_t a0, a1;
+        bench_allocs(&a0);
+        for (int r = 0; r < PSD_BENCH_SCALE_REPS; r++) {
+            memcpy(psd, ref, PSD_BENCH_SCALE_BINS * sizeof(double));
+            uint64_t t0 = bench_now_ns();
+            scale_psd(psd, PSD_BENCH_SCALE_BINS, units[u]);
+            elapsed += bench_now_ns() - t0;
+        }
+        bench_allocs(&a1);
+        char params[64];
+        snprintf(params, sizeof(params), "%d bins %s", PSD_BENCH_SCALE_BINS, units[u]);
+        bench_report_allocs("scale_psd", params, (double)PSD_BENCH_SCALE_BINS * PSD_BENCH_SCALE_REPS,
+                            elapsed, &a0, &a1);
+    }
+    free(ref);
+    free(psd);
+}
+
+/**
+ * @brief Windowed Welch PSD pieces of the acquisition loop on one 2M-sample capture:
+ * int8 -> complex, the one-shot and per-config-workspace Welch over nperseg / overlap /
+ * window, and scale_psd. Samples are IQ samples in (bins for scale_psd).
+ */
+void bench_psd(void) {
+    printf("\n--- psd: load_iq, Welch (nperseg / overlap / window), scale_psd ---\n");
+    int8_t *raw = make_capture(PSD_BENCH_SAMPLES);
+    if (!raw) return;
+    run_load(raw);
+
+    signal_iq_t *sig = load_iq_from_buffer(raw, (size_t)PSD_BENCH_SAMPLES * 2);
+    if (sig) run_welch(sig);
+    free_signal_iq(sig);
+    free(raw);
+
+    run_scale();
+}
+
+/**
+ * @brief publish_results: the PSD message written with psd_json_write, alone and then
+ * into a PSD_TRANSPORT=shm ring drained by an in-process reader. Samples are bins.
+ */
+void bench_publish(void) {
+    printf("\n--- publish: PSD JSON message (psd_json_write) and shm ring write ---\n");
+    static const int bins[] = { 1024, 4096, 16384 };
+
+    shm_ring_t *ring = shm_ring_create(PSD_BENCH_SHM_NAME, PSD_BENCH_SHM_BYTES, NULL);
+    shm_ring_hdr_t *hdr = ring ? bench_shm_map(PSD_BENCH_SHM_NAME) : NULL;
+
+    for (size_t b = 0; b < sizeof(bins) / sizeof(bins[0]); b++) {
+        int n = bins[b];
+        double *pxx = (double*)malloc((size_t)n * sizeof(double));
+        size_t cap = PSD_JSON_BYTES(n);
+        char *out = (char*)malloc(cap);
+        if (!pxx || !out) {
+            free(pxx);
+            free(out);
+            continue;
+        }
+        // dBm values with a full mantissa, as scale_psd leaves them
+        uint32_t seed = 0xFEEDu;
+        for (int i = 0; i < n; i++) pxx[i] = -100.0 + 40.0 * (double)bench_rand_u32(&seed) / 4294967296.0;
+
+        char params[64];
+        bench_allocs_t a0, a1;
+        size_t len = 0;
+        bench_allocs(&a0);
+        uint64_t t0 = bench_now_ns();
+        for (int r = 0; r < PSD_BENCH_PUB_REPS; r++) {
+            len = psd_json_write(out, cap, 0, 0, 99e6, 101e6, pxx, n);
+        }
+        uint64_t elapsed = bench_now_ns() - t0;
+        bench_allocs(&a1);
+        snprintf(params, sizeof(params), "%d bins json (%zu KiB)", n, len / 1024);
+        bench_report_allocs("publish_results", params, (double)n * PSD_BENCH_PUB_REPS, elapsed, &a0, &a1);
+
+        if (hdr) {
+            int dropped = 0;
+            bench_allocs(&a0);
+            t0 = bench_now_ns();
+            for (int r = 0; r < PSD_BENCH_PUB_REPS; r++) {
+                len = psd_json_write(out, cap, 0, 0, 99e6, 101e6, pxx, n);
+                if (shm_ring_write(ring, out, len, NULL, 0) != 0) dropped++;
+                bench_shm_drain(hdr);
+            }
+            elapsed = bench_now_ns() - t0;
+            bench_allocs(&a1);
+            snprintf(params, sizeof(params), "%d bins json + shm ring", n);
+            bench_report_allocs("publish_results", params, (double)n * PSD_BENCH_PUB_REPS, elapsed, &a0, &a1);
+            if (dropped) printf("    %d frames dropped (ring full)\n", dropped);
+        }
+        free(pxx);
+        free(out);
+    }
+
+    bench_shm_unmap(hdr);
+    shm_ring_destroy(ring);
+}
@@ -0,0 +1,148 @@
+// bench/bench_ringbuf.c
+#include "bench_common.h"
+#include "ring_buffer.h"
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <sched.h>
+
+#define RB_BENCH_XFER        262144               // one HackRF USB transfer (rx_callback len)
+#define RB_BENCH_BIG         (16 * 1024 * 1024)   // PSD ring (100 MiB in the engine; smaller here)
+#define RB_BENCH_AUDIO       (16384 * 2 * 8)      // audio_rb: AUDIO_CHUNK_SAMPLES * 2 * 8
+#define RB_BENCH_PSD_READ    (2 * 1024 * 1024)    // one PSD capture
+#define RB_BENCH_AUDIO_READ  (16384 * 2)          // one audio block
+#define RB_BENCH_BYTES       (1024ULL * 1024 * 1024)
+#define RB_BENCH_SINGLE      (256ULL * 1024 * 1024)
+
+typedef struct {
+    ring_buffer_t *rb;
+    size_t block;
+    uint8_t *buf;                       // allocated up front, outside the timed region
+    volatile bool *done;
+    uint64_t bytes;
+} rb_consumer_t;
+
+static void* consumer_fn(void *arg) {
+    rb_consumer_t *c = (rb_consumer_t*)arg;
+    // Reads whole blocks like the PSD and audio threads; yields instead of sleeping so a
+    // consumer is ready as soon as the producer hands over the CPU
+    while (!*c->done || rb_available(c->rb) >= c->block) {
+        if (rb_available(c->rb) < c->block) {
+            sched_yield();
+            continue;
+        }
+        c->bytes += rb_read(c->rb, c->buf, c->block);
+    }
+    return NULL;
+}
+
+/**
+ * @brief rx_callback's fan-out: one producer writes every transfer into both rings
+ * (dropping what does not fit), the PSD and audio consumers drain them on their threads.
+ * Only the two rb_write calls are timed; the yield between transfers stands in for the
+ * gap until libhackrf delivers the next one, so the consumers get to run even on one core.
+ */
+static void run_fanout(void) {
+    ring_buffer_t big, audio;
+    rb_init(&big, RB_BENCH_BIG);
+    rb_init(&audio, RB_BENCH_AUDIO);
+    uint8_t *xfer = (uint8_t*)malloc(RB_BENCH_XFER);
+    uint8_t *psd_buf = (uint8_t*)malloc(RB_BENCH_PSD_READ);
+    uint8_t *audio_buf = (uint8_t*)malloc(RB_BENCH_AUDIO_READ);
+    if (!big.buffer || !audio.buffer || !xfer || !psd_buf || !audio_buf) {
+        free(xfer);
+        free(psd_buf);
+        free(audio_buf);
+        rb_free(&big);
+        rb_free(&audio);
+        return;
+    }
+    uint32_t seed = 0x5EEDu;
+    for (size_t i = 0; i < RB_BENCH_XFER; i++) xfer[i] = (uint8_t)bench_rand_u32(&seed);
+
+    volatile bool done = false;
+    rb_consumer_t cons[2] = {
+        { &big,   RB_BENCH_PSD_READ,   psd_buf,   &done, 0 },
+        { &audio, RB_BENCH_AUDIO_READ, audio_buf, &done, 0 },
+    };
+    pthread_t th[2];
+    int started = 0;
+    for (int i = 0; i < 2; i++) {
+        if (pthread_create(&th[i], NULL, consumer_fn, &cons[i]) == 0) started++;
+    }
+
+    uint64_t dropped[2] = { 0, 0 };
+    bench_allocs_t a0, a1;
+    bench_allocs(&a0);
+    uint64_t elapsed = 0;
+    for (uint64_t sent = 0; sent < RB_BENCH_BYTES; sent += RB_BENCH_XFER) {
+        uint64_t t0 = bench_now_ns();
+        dropped[0] += RB_BENCH_XFER - rb_write(&big, xfer, RB_BENCH_XFER);
+        dropped[1] += RB_BENCH_XFER - rb_write(&audio, xfer, RB_BENCH_XFER);
+        elapsed += bench_now_ns() - t0;
+        sched_yield();
+    }
+    bench_allocs(&a1);
+
+    done = true;
+    for (int i = 0; i < started; i++) pthread_join(th[i], NULL);
+
+    char params[64];
+    snprintf(params, sizeof(params), "1P/2C xfer=%dK", RB_BENCH_XFER / 1024);
+    bench_report_allocs("rb_write x2", params, (double)RB_BENCH_BYTES / 2.0, elapsed, &a0, &a1);
+    printf("    consumers: psd %.1f MiB (%.1f%% dropped), audio %.1f MiB (%.1f%% dropped)\n",
+           (double)cons[0].bytes / 1048576.0, 100.0 * (double)dropped[0] / (double)RB_BENCH_BYTES,
+           (double)cons[1].bytes / 1048576.0, 100.0 * (double)dropped[1] / (double)RB_BENCH_BYTES);
+
+    free(xfer);
+    free(psd_buf);
+    free(audio_buf);
+    rb_free(&big);
+    rb_free(&audio);
+}
+
+/** Write + read of one block on one thread: the copy and lock cost alone */
+static void run_single(size_t block) {
+    ring_buffer_t rb;
+    rb_init(&rb, RB_BENCH_BIG);
+    uint8_t *in = (uint8_t*)calloc(1, block);
+    uint8_t *out = (uint8_t*)malloc(block);
+    if (!rb.buffer || !in || !out) {
+        free(in);
+        free(out);
+        rb_free(&rb);
+        return;
+    }
+
+    bench_allocs_t a0, a1;
+    bench_allocs(&a0);
+    uint64_t t0 = bench_now_ns();
+    for (uint64_t moved = 0; moved < RB_BENCH_SINGLE; moved += block) {
+        rb_write(&rb, in, block);
+        rb_read(&rb, out, block);
+    }
+    uint64_t elapsed = bench_now_ns() - t0;
+    bench_allocs(&a1);
+
+    char params[64];
+    snprintf(params, sizeof(params), "1 thread block=%zuK", block / 1024);
+    bench_report_allocs("rb_write+rb_read", params, (double)RB_BENCH_SINGLE / 2.0, elapsed, &a0, &a1);
+
+    free(in);
+    free(out);
+    rb_free(&rb);
+}
+
+/**
+ * @brief ring_buffer_t as the engine uses it: per-sample cost of write + read, then the
+ * rx_callback fan-out into the PSD and audio rings with both consumers running.
+ * Samples are IQ pairs (2 bytes).
+ */
+void bench_ringbuf(void) {
+    printf("\n--- ring_buffer: rb_write / rb_read (1 producer, 2 consumers) ---\n");
+    run_single(RB_BENCH_AUDIO_READ);
+    run_single(RB_BENCH_XFER);
+    run_fanout();
+}
@@ -0,0 +1,119 @@
+// bench/bench_squelch.c
+#include "bench_common.h"
+#include "demod.h"
+#include "squelch.h"
+#include "opus_tx.h"
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#define SQ_BENCH_FS        2e6
+#define SQ_BENCH_CHUNK     16384
+#define SQ_BENCH_AUDIO_FS  48000
+#define SQ_BENCH_FRAME_MS  20
+#define SQ_BENCH_BITRATE   32000          // OPUS_BITRATE_DEFAULT, CBR
+#define SQ_BENCH_HDR_BYTES 16             // OPU0 header
+#define SQ_BENCH_SECONDS   3.0            // noise | carrier | noise, one second each
+
+/**
+ * @brief NFM channel at the tuner center: receiver noise only, with a 1 kHz tone
+ * transmission in the middle second.
+ */
+static int8_t* make_burst_iq(double fs, size_t n, uint32_t *seed) {
+    int8_t *iq = (int8_t*)malloc(n * 2);
+    if (!iq) return NULL;
+
+    double ph = 0.0;
+    for (size_t i = 0; i < n; i++) {
+        double t = (double)i / fs;
+        double a = (t >= 1.0 && t < 2.0) ? 40.0 : 0.0;
+        ph += 2.0 * M_PI * 2500.0 * sin(2.0 * M_PI * BENCH_TONE_HZ * t) / fs;
+        double re = a * cos(ph) + 3.0 * bench_rand_gauss(seed);
+        double im = a * sin(ph) + 3.0 * bench_rand_gauss(seed);
+        iq[2*i]     = (int8_t)fmax(-127.0, fmin(127.0, lrint(re)));
+        iq[2*i + 1] = (int8_t)fmax(-127.0, fmin(127.0, lrint(im)));
+    }
+    return iq;
+}
+
+/**
+ * @brief DDC + demod with the squelch off, at a fixed level and on the auto floor.
+ * Uplink is the OPU0 byte count: CBR frames while open, gap markers while closed.
+ */
+void bench_squelch(void) {
+    const double fs = SQ_BENCH_FS;
+    size_t n = (size_t)(fs * SQ_BENCH_SECONDS);
+    uint32_t seed = 0x5031u;
+
+    printf("\n--- squelch: idle NFM channel, 1 s burst in 3 s, fs=%.1fM ---\n", fs / 1e6);
+
+    int8_t *iq = make_burst_iq(fs, n, &seed);
+    float *chan = (float*)malloc(((size_t)SQ_BENCH_CHUNK + 64) * 2 * sizeof(float));
+    int16_t *pcm = (int16_t*)malloc(((size_t)SQ_BENCH_CHUNK + 64) * sizeof(int16_t));
+    ddc_t *ddc = (ddc_t*)calloc(1, sizeof(ddc_t));
+    demod_t *dm = (demod_t*)calloc(1, sizeof(demod_t));
+    if (!iq || !chan || !pcm || !ddc || !dm) {
+        free(iq); free(chan); free(pcm); free(ddc); free(dm);
+        return;
+    }
+
+    const squelch_cfg_t cfgs[] = {
+        { 0, 0, 0.0f,   SQUELCH_HYST_DB_DEFAULT, SQUELCH_HANG_MS_DEFAULT },
+        { 1, 0, -30.0f, SQUELCH_HYST_DB_DEFAULT, SQUELCH_HANG_MS_DEFAULT },
+        { 1, 1, SQUELCH_SNR_DB_DEFAULT, SQUELCH_HYST_DB_DEFAULT, SQUELCH_HANG_MS_DEFAULT },
+    };
+    const char *names[] = { "off", "-30 dBFS", "auto +10 dB" };
+    const double frame_bytes = SQ_BENCH_BITRATE / 8.0 * SQ_BENCH_FRAME_MS / 1000.0 + SQ_BENCH_HDR_BYTES;
+    const int frame_samples = SQ_BENCH_AUDIO_FS * SQ_BENCH_FRAME_MS / 1000;
+
+    for (size_t c = 0; c < sizeof(cfgs) / sizeof(cfgs[0]); c++) {
+        if (demod_front_end_init(ddc, NFM_MODE, 0, fs, 0.0, 0.0) != 0 ||
+            demod_init(dm, NFM_MODE, 0, ddc->fs_out, SQ_BENCH_AUDIO_FS) != 0) {
+            break;
+        }
+        squelch_t sq;
+        squelch_init(&sq, &cfgs[c], ddc->fs_out);
+
+        uint64_t t_idle = 0, t_burst = 0;
+        double open_s[3] = {0.0, 0.0, 0.0};
+        double pcm_samples = 0.0, gap_samples = 0.0, bytes = 0.0;
+        double chunk_s = (double)SQ_BENCH_CHUNK / fs;
+
+        for (size_t pos = 0; pos + SQ_BENCH_CHUNK <= n; pos += SQ_BENCH_CHUNK) {
+            int sec = (int)((double)pos / fs);
+            uint64_t t0 = bench_now_ns();
+            int n_chan = ddc_process_s8(ddc, &iq[2 * pos], SQ_BENCH_CHUNK, chan);
+            bool was_open = sq.open;
+            if (squelch_update(&sq, chan, (size_t)n_chan)) {
+                if (!was_open && cfgs[c].enabled) demod_reset(dm);
+                pcm_samples += demod_process(dm, chan, (size_t)n_chan, pcm);
+                open_s[sec] += chunk_s;
+            } else {
+                gap_samples += chunk_s * SQ_BENCH_AUDIO_FS;
+            }
+            uint64_t dt = bench_now_ns() - t0;
+            if (sec == 1) t_burst += dt;
+            else t_idle += dt;
+        }
+
+        // Encoded frames carry payload; skipped ones cost one marker per OPUS_TX_GAP_REPORT_FRAMES
+        bytes = floor(pcm_samples / frame_samples) * frame_bytes +
+                floor(gap_samples / frame_samples / OPUS_TX_GAP_REPORT_FRAMES) * SQ_BENCH_HDR_BYTES;
+
+        char params[64];
+        snprintf(params, sizeof(params), "squelch %s", names[c]);
+        bench_report("ddc+nfm idle", params, 2.0 * fs, t_idle);
+        printf("    idle: %.1f ms CPU per s of audio, open %.0f%% | burst: %.1f ms/s, open %.0f%% | "
+               "%.0f encoder frames/s, uplink %.0f B/s\n",
+               1e-6 * (double)t_idle / 2.0, 50.0 * (open_s[0] + open_s[2]),
+               1e-6 * (double)t_burst, 100.0 * open_s[1],
+               floor(pcm_samples / frame_samples) / SQ_BENCH_SECONDS, bytes / SQ_BENCH_SECONDS);
+
+        demod_free(dm);
+        ddc_free(ddc);
+    }
+
+    free(iq); free(chan); free(pcm); free(ddc); free(dm);
+}
@@ -0,0 +1,307 @@
+// bench/bench_transport.c
+#include "bench_common.h"
+#include "shm_ring.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+
+#define TR_BENCH_SHM_NAME     "/rf_bench_transport"
+#define TR_BENCH_SHM_BYTES    (256 * 1024)      // OPUS_TX_SHM_BYTES
+#define TR_BENCH_PAYLOAD      80                // 32 kb/s CBR at 20 ms
+#define TR_BENCH_HDR          16                // OPU0 header
+#define TR_BENCH_LAT_FRAMES   5000
+#define TR_BENCH_LAT_GAP_US   100
+#define TR_BENCH_TPUT_FRAMES  500000
+#define TR_BENCH_END_SEQ      0xFFFFFFFFu
+
+typedef struct {
+    uint32_t magic, seq, sample_rate;
+    uint16_t channels, payload_len;
+} __attribute__((packed)) tr_hdr_t;
+
+typedef struct {
+    int fd;                 // TCP: accepted socket
+    const char *sock_path;  // shm: where the eventfd is handed out
+    uint64_t *lat_ns;       // one slot per frame (latency run), NULL otherwise
+    size_t frames;
+    uint64_t bytes;
+    uint64_t t_last;
+    uint64_t producer_ns;   // time spent in the send loop (what the audio thread pays)
+} tr_consumer_t;
+
+static void fill_frame(uint8_t *f, uint32_t seq) {
+    tr_hdr_t h = { htonl(0x4F505530), htonl(seq), htonl(48000), htons(1), htons(TR_BENCH_PAYLOAD) };
+    memcpy(f, &h, sizeof(h));
+    memset(f + TR_BENCH_HDR, 0x5A, TR_BENCH_PAYLOAD);
+    uint64_t t = bench_now_ns();
+    memcpy(f + TR_BENCH_HDR, &t, sizeof(t));
+}
+
+/** Returns 0 for the end marker, 1 for a data frame */
+static int take_frame(tr_consumer_t *c, const uint8_t *f) {
+    tr_hdr_t h;
+    memcpy(&h, f, sizeof(h));
+    uint32_t seq = ntohl(h.seq);
+    if (seq == TR_BENCH_END_SEQ) return 0;
+
+    uint64_t t_send, now = bench_now_ns();
+    memcpy(&t_send, f + TR_BENCH_HDR, sizeof(t_send));
+    if (c->lat_ns && seq < TR_BENCH_LAT_FRAMES) c->lat_ns[seq] = now - t_send;
+    c->frames++;
+    c->bytes += TR_BENCH_HDR + ntohs(h.payload_len);
+    c->t_last = now;
+    return 1;
+}
+
+// ---------------------------------------------------------------- TCP (OPU0 stream)
+static void* tcp_consumer(void *arg) {
+    tr_consumer_t *c = (tr_consumer_t*)arg;
+    uint8_t buf[65536];
+    size_t have = 0;
+    const size_t flen = TR_BENCH_HDR + TR_BENCH_PAYLOAD;
+
+    for (;;) {
+        ssize_t r = recv(c->fd, buf + have, sizeof(buf) - have, 0);
+        if (r <= 0) break;
+        have += (size_t)r;
+        size_t off = 0;
+        while (have - off >= flen) {
+            if (!take_frame(c, buf + off)) return NULL;
+            off += flen;
+        }
+        memmove(buf, buf + off, have - off);
+        have -= off;
+    }
+    return NULL;
+}
+
+static int tcp_pair(int *tx_fd, int *rx_fd) {
+    int ls = socket(AF_INET, SOCK_STREAM, 0);
+    struct sockaddr_in a;
+    memset(&a, 0, sizeof(a));
+    a.sin_family = AF_INET;
+    a.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t alen = sizeof(a);
+    if (ls < 0 || bind(ls, (struct sockaddr*)&a, sizeof(a)) != 0 || listen(ls, 1) != 0 ||
+        getsockname(ls, (struct sockaddr*)&a, &alen) != 0) {
+        if (ls >= 0) close(ls);
+        return -1;
+    }
+    *tx_fd = socket(AF_INET, SOCK_STREAM, 0);
+    int one = 1;
+    setsockopt(*tx_fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));   // as opus_tx
+    if (connect(*tx_fd, (struct sockaddr*)&a, sizeof(a)) != 0) {
+        close(*tx_fd);
+        close(ls);
+        return -1;
+    }
+    *rx_fd = accept(ls, NULL, NULL);
+    close(ls);
+    return (*rx_fd >= 0) ? 0 : -1;
+}
+
+static int tcp_run(tr_consumer_t *c, size_t frames, int gap_us, uint64_t *elapsed) {
+    int tx_fd, rx_fd;
+    if (tcp_pair(&tx_fd, &rx_fd) != 0) return -1;
+    c->fd = rx_fd;
+
+    pthread_t th;
+    pthread_create(&th, NULL, tcp_consumer, c);
+
+    uint8_t f[TR_BENCH_HDR + TR_BENCH_PAYLOAD];
+    uint64_t t0 = bench_now_ns();
+    for (size_t i = 0; i < frames; i++) {
+        fill_frame(f, (uint32_t)i);
+        if (send(tx_fd, f, sizeof(f), MSG_NOSIGNAL) != (ssize_t)sizeof(f)) break;
+        if (gap_us) usleep((useconds_t)gap_us);
+    }
+    c->producer_ns = bench_now_ns() - t0;
+    fill_frame(f, TR_BENCH_END_SEQ);
+    send(tx_fd, f, sizeof(f), MSG_NOSIGNAL);
+    pthread_join(th, NULL);
+    *elapsed = c->t_last - t0;
+
+    close(tx_fd);
+    close(rx_fd);
+    return 0;
+}
+
+// ---------------------------------------------------------------- shm ring + eventfd
+// Same steps as shm_reader.py: map, fetch the eventfd, poll it, walk records, store tail.
+static void* shm_consumer(void *arg) {
+    tr_consumer_t *c = (tr_consumer_t*)arg;
+
+    int sfd = shm_open(TR_BENCH_SHM_NAME, O_RDWR, 0);
+    if (sfd < 0) return NULL;
+    struct stat st;
+    fstat(sfd, &st);
+    uint8_t *map = (uint8_t*)mmap(NULL, (size_t)st.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, sfd, 0);
+    close(sfd);
+    if (map == MAP_FAILED) return NULL;
+    shm_ring_hdr_t *hdr = (shm_ring_hdr_t*)map;
+    const uint8_t *data = map + hdr->data_offset;
+    const uint64_t mask = hdr->capacity - 1;
+
+    int us = socket(AF_UNIX, SOCK_STREAM, 0);
+    struct sockaddr_un ua;
+    memset(&ua, 0, sizeof(ua));
+    ua.sun_family = AF_UNIX;
+    snprintf(ua.sun_path, sizeof(ua.sun_path), "%s", c->sock_path);
+    int efd = -1;
+    if (connect(us, (struct sockaddr*)&ua, sizeof(ua)) == 0) {
+        char byte;
+        struct iovec iov = { .iov_base = &byte, .iov_len = 1 };
+        union { char buf[CMSG_SPACE(sizeof(int))]; struct cmsghdr align; } ctrl;
+        struct msghdr msg;
+        memset(&msg, 0, sizeof(msg));
+        msg.msg_iov = &iov;
+        msg.msg_iovlen = 1;
+        msg.msg_control = ctrl.buf;
+        msg.msg_controllen = sizeof(ctrl.buf);
+        if (recvmsg(us, &msg, 0) == 1) {
+            struct cmsghdr *cm = CMSG_FIRSTHDR(&msg);
+            if (cm && cm->cmsg_type == SCM_RIGHTS) memcpy(&efd, CMSG_DATA(cm), sizeof(int));
+        }
+    }
+
+    int running = (efd >= 0);
+    while (running) {
+        struct pollfd pfd = { .fd = efd, .events = POLLIN, .revents = 0 };
+        poll(&pfd, 1, 1000);
+        uint64_t cnt;
+        if (read(efd, &cnt, sizeof(cnt)) < 0 && errno != EAGAIN) break;
+
+        uint64_t tail = hdr->tail;
+        uint64_t head = __atomic_load_n(&hdr->head, __ATOMIC_ACQUIRE);
+        while (tail < head) {
+            const uint8_t *rec = &data[tail & mask];
+            uint32_t len;
+            memcpy(&len, rec, sizeof(len));
+            if (len == SHM_RING_WRAP) {
+                tail += (mask + 1) - (tail & mask);
+                continue;
+            }
+            if (!take_frame(c, rec + SHM_RING_REC_HDR)) running = 0;
+            tail += ((uint64_t)SHM_RING_REC_HDR + len + 7u) & ~(uint64_t)7u;
+        }
+        __atomic_store_n(&hdr->tail, tail, __ATOMIC_RELEASE);
+    }
+
+    if (efd >= 0) close(efd);
+    close(us);
+    munmap(map, (size_t)st.st_size);
+    return NULL;
+}
+
+static int shm_run(tr_consumer_t *c, size_t frames, int gap_us, uint64_t *elapsed, uint64_t *dropped) {
+    char sock_path[108];
+    snprintf(sock_path, sizeof(sock_path), "/tmp%s.sock", TR_BENCH_SHM_NAME);
+    c->sock_path = sock_path;
+
+    shm_ring_t *r = shm_ring_create(TR_BENCH_SHM_NAME, TR_BENCH_SHM_BYTES, sock_path);
+    if (!r) return -1;
+
+    pthread_t th;
+    pthread_create(&th, NULL, shm_consumer, c);
+
+    // Wait for the reader to pick up the eventfd (opus_tx does this from its send path)
+    shm_ring_stats_t ss = {0};
+    for (int i = 0; i < 2000 && !ss.reader; i++) {
+        shm_ring_poll(r);
+        shm_ring_get_stats(r, &ss);
+        if (!ss.reader) usleep(1000);
+    }
+
+    uint8_t f[TR_BENCH_HDR + TR_BENCH_PAYLOAD];
+    uint64_t t0 = bench_now_ns();
+    for (size_t i = 0; i < frames; i++) {
+        fill_frame(f, (uint32_t)i);
+        shm_ring_write(r, f, TR_BENCH_HDR, f + TR_BENCH_HDR, TR_BENCH_PAYLOAD);
+        if (gap_us) usleep((useconds_t)gap_us);
+    }
+    c->producer_ns = bench_now_ns() - t0;
+    fill_frame(f, TR_BENCH_END_SEQ);
+    while (shm_ring_write(r, f, TR_BENCH_HDR, f + TR_BENCH_HDR, TR_BENCH_PAYLOAD) != 0) usleep(100);
+    pthread_join(th, NULL);
+    *elapsed = c->t_last - t0;
+
+    shm_ring_get_stats(r, &ss);
+    *dropped = ss.dropped;
+    shm_ring_destroy(r);
+    return 0;
+}
+
+// ---------------------------------------------------------------- report
+static int cmp_u64(const void *a, const void *b) {
+    uint64_t x = *(const uint64_t*)a, y = *(const uint64_t*)b;
+    return (x > y) - (x < y);
+}
+
+static void report_latency(const char *name, uint64_t *lat, size_t n) {
+    size_t k = 0;
+    for (size_t i = 0; i < n; i++) if (lat[i]) lat[k++] = lat[i];
+    if (k == 0) {
+        printf("  %-22s no frames received\n", name);
+        return;
+    }
+    qsort(lat, k, sizeof(uint64_t), cmp_u64);
+    printf("  %-22s one-way latency p50 %6.1f us  p99 %6.1f us  max %7.1f us  (%zu frames)\n",
+           name, 1e-3 * (double)lat[k / 2], 1e-3 * (double)lat[k * 99 / 100], 1e-3 * (double)lat[k - 1], k);
+}
+
+/**
+ * @brief OPU0 frames (16 B header + 80 B payload) through loopback TCP with TCP_NODELAY
+ * (opus_tx default) and through the shm ring + eventfd, consumer on another thread.
+ * Latency: frames paced every TR_BENCH_LAT_GAP_US. Throughput: producer never sleeps
+ * (TCP blocks on a full socket buffer; the ring drops and counts instead, so on a
+ * single core "delivered" mostly measures how often the scheduler runs the reader).
+ */
+void bench_transport(void) {
+    printf("\n--- transport: OPU0 frames (%d B), loopback TCP vs shm ring + eventfd ---\n",
+           TR_BENCH_HDR + TR_BENCH_PAYLOAD);
+
+    uint64_t *lat = (uint64_t*)calloc(TR_BENCH_LAT_FRAMES, sizeof(uint64_t));
+    if (!lat) return;
+
+    for (int shm = 0; shm <= 1; shm++) {
+        const char *name = shm ? "shm ring + eventfd" : "tcp loopback";
+        tr_consumer_t c;
+        uint64_t elapsed = 0, dropped = 0;
+
+        memset(lat, 0, TR_BENCH_LAT_FRAMES * sizeof(uint64_t));
+        memset(&c, 0, sizeof(c));
+        c.lat_ns = lat;
+        int rc = shm ? shm_run(&c, TR_BENCH_LAT_FRAMES, TR_BENCH_LAT_GAP_US, &elapsed, &dropped)
+                     : tcp_run(&c, TR_BENCH_LAT_FRAMES, TR_BENCH_LAT_GAP_US, &elapsed);
+        if (rc != 0) {
+            printf("  %-22s setup failed: %s\n", name, strerror(errno));
+            continue;
+        }
+        report_latency(name, lat, TR_BENCH_LAT_FRAMES);
+
+        memset(&c, 0, sizeof(c));
+        if (shm) shm_run(&c, TR_BENCH_TPUT_FRAMES, 0, &elapsed, &dropped);
+        else tcp_run(&c, TR_BENCH_TPUT_FRAMES, 0, &elapsed);
+        double secs = (double)elapsed * 1e-9;
+        printf("  %-22s throughput %8.0f kframes/s  %7.1f MB/s  producer %6.0f ns/frame  "
+               "delivered %zu/%d  dropped %llu\n",
+               name, secs > 0 ? (double)c.frames / secs / 1e3 : 0.0,
+               secs > 0 ? (double)c.bytes / secs / 1e6 : 0.0,
+               (double)c.producer_ns / TR_BENCH_TPUT_FRAMES,
+               c.frames, TR_BENCH_TPUT_FRAMES, (unsigned long long)dropped);
+    }
+
+    free(lat);
+}
@@ -0,0 +1,73 @@
+// bench/rf_bench.c -- synthetic DSP benchmarks (no radio required)
+//
+// Usage:
+//   ./rf_bench            run every kernel
+//   ./rf_bench <kernel>   run one kernel (resampler, fm_radio, ddc, pfb, demod, stereo, squelch, transport,
+//                         jitter, pool, ring_buffer, psd, publish, opus_tx, golden)
+//   BENCH_JSON=<file>     also append every result line there as JSON (see bench_common.h)
+//   GOLDEN_UPDATE=1       golden: record the current outputs in GOLDEN_DIR (see bench_golden.c)
+//
+// Exits 1 when an accuracy check (golden) fails.
+#include <stdio.h>
+#include <string.h>
+#include "bench_common.h"
+
+void bench_resampler(void);
+void bench_fm_radio(void);
+void bench_ddc(void);
+void bench_pfb(void);
+void bench_demod(void);
+void bench_stereo(void);
+void bench_squelch(void);
+void bench_transport(void);
+void bench_jitter(void);
+void bench_pool(void);
+void bench_ringbuf(void);
+void bench_psd(void);
+void bench_publish(void);
+void bench_opus_tx(void);
+void bench_golden(void);
+
+typedef struct {
+    const char *name;
+    void (*fn)(void);
+} bench_entry_t;
+
+static const bench_entry_t benches[] = {
+    { "resampler", bench_resampler },
+    { "fm_radio",  bench_fm_radio  },
+    { "ddc",       bench_ddc       },
+    { "pfb",       bench_pfb       },
+    { "demod",     bench_demod     },
+    { "stereo",    bench_stereo    },
+    { "squelch",   bench_squelch   },
+    { "transport", bench_transport },
+    { "jitter",    bench_jitter    },
+    { "pool",      bench_pool      },
+    { "ring_buffer", bench_ringbuf },
+    { "psd",       bench_psd       },
+    { "publish",   bench_publish   },
+    { "opus_tx",   bench_opus_tx   },
+    { "golden",    bench_golden    },
+};
+
+int main(int argc, char **argv) {
+    const char *only = (argc > 1) ? argv[1] : NULL;
+    int ran = 0;
+
+    for (size_t i = 0; i < sizeof(benches) / sizeof(benches[0]); i++) {
+        if (only && strcmp(only, benches[i].name) != 0) continue;
+        benches[i].fn();
+        ran++;
+    }
+
+    if (ran == 0) {
+        fprintf(stderr, "[BENCH] Unknown kernel '%s'\n", only);
+        return 1;
+    }
+    if (bench_failures() > 0) {
+        fprintf(stderr, "[BENCH] %d accuracy check(s) failed\n", bench_failures());
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,513 @@
+// bench/rf_load.c -- end-to-end load generator for rf_engine
+//
+// Binds the PAIR endpoint rf_engine connects to (IPC_ADDR), replays a command sequence
+// at a fixed rate and times every config against the first valid PSD frame computed
+// with it. Each config carries a "seq" that the engine echoes in that frame.
+//
+// Usage:
+//   ./rf_load [options]
+//     --ipc ADDR            PAIR endpoint (ipc:///tmp/rf_engine)
+//     --mode MODE           fixed | scan | random | script (fixed)
+//     --script FILE         one JSON command per line, replayed in a loop (implies --mode script)
+//     --hz N                commands per second (2)
+//     --duration S          seconds of load (10)
+//     --device N            pipeline under test (0)
+//     --cf HZ --sr HZ --span HZ --rbw HZ    base config (105.7 MHz, 2 MS/s, 200 kHz, 10 kHz)
+//     --scan-step HZ --scan-steps N         scan: center steps (50 kHz x 20)
+//     --seed N              random: RBW / span draws
+//     --drain S             wait after the last command for its frame (6)
+//     --budget-p50 MS --budget-p99 MS --budget-max MS   latency budgets (0 = not checked)
+//     --max-miss PCT        commands left without a frame (superseded / invalid)
+//     --min-fps N           PSD frames per second
+//     --json FILE           append the summary as one JSON line (tagged with BENCH_REV)
+//
+// Exit status: 0 within budgets, 1 a budget was exceeded (or nothing was answered),
+// 2 setup error. The engine is run separately, usually with SDR_BACKEND=sim (load.sh).
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <math.h>
+#include <errno.h>
+#include <time.h>
+#include <getopt.h>
+#include <zmq.h>
+#include <cjson/cJSON.h>
+
+#define LOAD_RECV_BYTES    (4 * 1024 * 1024)   // largest PSD frame (PSD_JSON_BYTES of 150k bins)
+#define LOAD_SCRIPT_LINES  1024
+#define LOAD_FREQ_TOL_HZ   1.0                 // start/end vs the commanded center -+ span / 2
+
+typedef enum { MODE_FIXED, MODE_SCAN, MODE_RANDOM, MODE_SCRIPT } load_mode_t;
+
+typedef struct {
+    const char *ipc;
+    load_mode_t mode;
+    const char *mode_name;
+    const char *script;
+    double hz, duration_s, drain_s;
+    int device;
+    double cf, sr, span, rbw;
+    double scan_step;
+    int scan_steps;
+    uint32_t seed;
+    double budget_p50_ms, budget_p99_ms, budget_max_ms, max_miss_pct, min_fps;
+    const char *json_path;
+} load_opts_t;
+
+typedef struct {
+    uint64_t t_send_ns;
+    uint64_t t_frame_ns;    // first valid frame computed with this command, 0 = none
+    double lo_hz, hi_hz;    // expected frame range; lo > hi = not checked
+} load_cmd_t;
+
+typedef struct {
+    load_cmd_t *cmds;       // indexed by seq - 1
+    size_t cap, sent;
+    uint64_t send_failed;
+    uint64_t frames, frames_invalid, frames_unmatched, frames_late;
+    uint64_t last_answered;
+    uint64_t retunes;
+    double retune_valid_max_us;
+    uint64_t t_first_frame_ns, t_last_frame_ns;
+} load_state_t;
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static uint32_t rand_u32(uint32_t *s) {
+    *s ^= *s << 13;
+    *s ^= *s >> 17;
+    *s ^= *s << 5;
+    return *s;
+}
+
+// =========================================================
+// COMMANDS
+
+static char *script_lines[LOAD_SCRIPT_LINES];
+static int n_script_lines;
+
+static int load_script(const char *path) {
+    FILE *f = fopen(path, "r");
+    if (!f) {
+        fprintf(stderr, "[LOAD] Cannot open script %s\n", path);
+        return -1;
+    }
+    char line[8192];
+    while (fgets(line, sizeof(line), f) && n_script_lines < LOAD_SCRIPT_LINES) {
+        line[strcspn(line, "\r\n")] = '\0';
+        const char *p = line + strspn(line, " \t");
+        if (*p == '\0' || *p == '#') continue;
+        script_lines[n_script_lines++] = strdup(p);
+    }
+    fclose(f);
+    if (n_script_lines == 0) {
+        fprintf(stderr, "[LOAD] Script %s has no commands\n", path);
+        return -1;
+    }
+    return 0;
+}
+
+static cJSON* base_config(const load_opts_t *o, double cf, double span, double rbw) {
+    cJSON *root = cJSON_CreateObject();
+    cJSON_AddStringToObject(root, "rf_mode", "realtime");
+    cJSON_AddNumberToObject(root, "device", o->device);
+    cJSON_AddNumberToObject(root, "center_freq_hz", cf);
+    cJSON_AddNumberToObject(root, "sample_rate_hz", o->sr);
+    cJSON_AddNumberToObject(root, "rbw_hz", rbw);
+    cJSON_AddNumberToObject(root, "span", span);
+    cJSON_AddStringToObject(root, "window", "hann");
+    cJSON_AddNumberToObject(root, "overlap", 0.5);
+    return root;
+}
+
+/**
+ * @brief Command number i (0-based) of the sequence. Configs get "seq" = i + 1 and their
+ * expected frame range; commands ("cmd") are sent untimed.
+ */
+static cJSON* next_command(const load_opts_t *o, size_t i, uint32_t *seed, bool *timed) {
+    static const double rbws[] = { 1000, 3000, 10000, 30000, 100000 };
+    static const double span_div[] = { 10, 4, 2, 1 };
+    cJSON *root = NULL;
+
+    switch (o->mode) {
+    case MODE_FIXED:
+        root = base_config(o, o->cf, o->span, o->rbw);
+        break;
+    case MODE_SCAN:
+        root = base_config(o, o->cf + (double)(i % (size_t)o->scan_steps) * o->scan_step, o->span, o->rbw);
+        break;
+    case MODE_RANDOM: {
+        double rbw = rbws[rand_u32(seed) % (sizeof(rbws) / sizeof(rbws[0]))];
+        double span = o->sr / span_div[rand_u32(seed) % (sizeof(span_div) / sizeof(span_div[0]))];
+        root = base_config(o, o->cf, span, rbw);
+        break;
+    }
+    case MODE_SCRIPT:
+        root = cJSON_Parse(script_lines[i % (size_t)n_script_lines]);
+        if (!root) {
+            fprintf(stderr, "[LOAD] Script line %zu is not JSON\n", i % (size_t)n_script_lines + 1);
+            return NULL;
+        }
+        break;
+    }
+
+    *timed = !cJSON_GetObjectItemCaseSensitive(root, "cmd");
+    if (*timed) {
+        if (!cJSON_GetObjectItemCaseSensitive(root, "device")) cJSON_AddNumberToObject(root, "device", o->device);
+        cJSON_DeleteItemFromObjectCaseSensitive(root, "seq");
+    }
+    return root;
+}
+
+// =========================================================
+// ENGINE MESSAGES
+
+static void handle_frame(const load_opts_t *o, load_state_t *st, cJSON *root, uint64_t t) {
+    cJSON *dev = cJSON_GetObjectItemCaseSensitive(root, "device");
+    if (cJSON_IsNumber(dev) && dev->valueint != o->device) return;
+
+    st->frames++;
+    if (st->t_first_frame_ns == 0) st->t_first_frame_ns = t;
+    st->t_last_frame_ns = t;
+
+    cJSON *seq = cJSON_GetObjectItemCaseSensitive(root, "seq");
+    if (!cJSON_IsNumber(seq) || seq->valuedouble < 1 || (size_t)seq->valuedouble > st->sent) {
+        st->frames_unmatched++;
+        return;
+    }
+    uint64_t s = (uint64_t)seq->valuedouble;
+    load_cmd_t *c = &st->cmds[s - 1];
+    if (s < st->last_answered) st->frames_late++;
+
+    // Valid: every bin a finite number, band inside the commanded span
+    cJSON *pxx = cJSON_GetObjectItemCaseSensitive(root, "Pxx");
+    cJSON *start = cJSON_GetObjectItemCaseSensitive(root, "start_freq_hz");
+    cJSON *end = cJSON_GetObjectItemCaseSensitive(root, "end_freq_hz");
+    bool ok = cJSON_IsArray(pxx) && cJSON_GetArraySize(pxx) > 0 && cJSON_IsNumber(start) && cJSON_IsNumber(end) &&
+              start->valuedouble < end->valuedouble;
+    if (ok && c->lo_hz <= c->hi_hz) {
+        ok = start->valuedouble >= c->lo_hz - LOAD_FREQ_TOL_HZ && end->valuedouble <= c->hi_hz + LOAD_FREQ_TOL_HZ;
+    }
+    for (cJSON *it = ok ? pxx->child : NULL; it; it = it->next) {
+        if (!cJSON_IsNumber(it) || !isfinite(it->valuedouble)) {
+            ok = false;
+            break;
+        }
+    }
+    if (!ok) {
+        st->frames_invalid++;
+        return;
+    }
+    if (c->t_frame_ns == 0) c->t_frame_ns = t;
+    if (s > st->last_answered) st->last_answered = s;
+}
+
+static void handle_message(const load_opts_t *o, load_state_t *st, const char *msg, uint64_t t) {
+    cJSON *root = cJSON_Parse(msg);
+    if (!root) return;
+    if (cJSON_GetObjectItemCaseSensitive(root, "Pxx")) {
+        handle_frame(o, st, root, t);
+    } else {
+        cJSON *rt = cJSON_GetObjectItemCaseSensitive(root, "retune");
+        cJSON *dev = rt ? cJSON_GetObjectItemCaseSensitive(rt, "device") : NULL;
+        cJSON *valid = rt ? cJSON_GetObjectItemCaseSensitive(rt, "valid_us") : NULL;
+        if (cJSON_IsNumber(valid) && (!cJSON_IsNumber(dev) || dev->valueint == o->device)) {
+            st->retunes++;
+            if (valid->valuedouble > st->retune_valid_max_us) st->retune_valid_max_us = valid->valuedouble;
+        }
+    }
+    cJSON_Delete(root);
+}
+
+/** Receives until the socket is empty or deadline_ns passes */
+static void pump(void *sock, const load_opts_t *o, load_state_t *st, char *buf, uint64_t deadline_ns) {
+    for (;;) {
+        uint64_t t = now_ns();
+        long timeout_ms = t < deadline_ns ? (long)((deadline_ns - t + 999999) / 1000000) : 0;
+        zmq_pollitem_t item = { sock, 0, ZMQ_POLLIN, 0 };
+        if (zmq_poll(&item, 1, timeout_ms) <= 0) return;
+        int n = zmq_recv(sock, buf, LOAD_RECV_BYTES - 1, ZMQ_DONTWAIT);
+        if (n < 0) continue;
+        if (n >= LOAD_RECV_BYTES) {
+            st->frames++;
+            st->frames_invalid++;          // truncated: cannot be checked
+            continue;
+        }
+        buf[n] = '\0';
+        handle_message(o, st, buf, now_ns());
+    }
+}
+
+/** True once every command has been answered or superseded by a later answered one */
+static bool settled(const load_state_t *st) {
+    return st->sent == 0 || st->last_answered == st->sent;
+}
+
+// =========================================================
+// REPORT
+
+static int cmp_double(const void *a, const void *b) {
+    double x = *(const double*)a, y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+static double pct(const double *v, size_t n, double p) {
+    if (n == 0) return 0.0;
+    size_t i = (size_t)ceil(p / 100.0 * (double)n);
+    return v[i > 0 ? i - 1 : 0];
+}
+
+static bool check(const char *what, double value, double budget, bool upper) {
+    if (budget <= 0) return true;
+    bool pass = upper ? value <= budget : value >= budget;
+    printf("[LOAD] budget %-10s %9.2f %s %9.2f  %s\n", what, value, upper ? "<=" : ">=", budget,
+           pass ? "OK" : "FAIL");
+    return pass;
+}
+
+static int report(const load_opts_t *o, const load_state_t *st, double elapsed_s) {
+    // The first config also opens and starts the device: reported apart, not in the percentiles
+    double *lat = (double*)malloc((st->sent + 1) * sizeof(double));
+    if (!lat) return 2;
+    size_t n_lat = 0;
+    double cold_ms = -1.0;
+    for (size_t i = 0; i < st->sent; i++) {
+        const load_cmd_t *c = &st->cmds[i];
+        if (c->t_frame_ns == 0) continue;
+        double ms = (double)(c->t_frame_ns - c->t_send_ns) / 1e6;
+        if (i == 0) cold_ms = ms;
+        else lat[n_lat++] = ms;
+    }
+    qsort(lat, n_lat, sizeof(double), cmp_double);
+    size_t answered = n_lat + (cold_ms >= 0 ? 1 : 0);
+    size_t timed = st->sent;
+    double miss_pct = timed ? 100.0 * (double)(timed - answered) / (double)timed : 0.0;
+    double frame_span_s = (double)(st->t_last_frame_ns - st->t_first_frame_ns) / 1e9;
+    double fps = (st->frames > 1 && frame_span_s > 0) ? (double)(st->frames - 1) / frame_span_s : 0.0;
+    double p50 = pct(lat, n_lat, 50), p90 = pct(lat, n_lat, 90), p99 = pct(lat, n_lat, 99);
+    double max = n_lat ? lat[n_lat - 1] : 0.0;
+
+    printf("\n[LOAD] mode=%s hz=%.2f duration=%.1f s device=%d (%.1f s incl. drain)\n",
+           o->mode_name, o->hz, o->duration_s, o->device, elapsed_s);
+    printf("[LOAD] configs %zu sent, %zu answered, %zu without a frame (%.1f%%), %llu send failures\n",
+           timed, answered, timed - answered, miss_pct, (unsigned long long)st->send_failed);
+    printf("[LOAD] frames %llu (%llu invalid, %llu unmatched, %llu out of order), %.2f frames/s\n",
+           (unsigned long long)st->frames, (unsigned long long)st->frames_invalid,
+           (unsigned long long)st->frames_unmatched, (unsigned long long)st->frames_late, fps);
+    printf("[LOAD] config -> first valid frame: p50 %.1f ms, p90 %.1f ms, p99 %.1f ms, max %.1f ms (%zu samples)\n",
+           p50, p90, p99, max, n_lat);
+    if (cold_ms >= 0) printf("[LOAD] cold start (first config): %.1f ms\n", cold_ms);
+    if (st->retunes) {
+        printf("[LOAD] retunes %llu, settling max %.2f ms\n", (unsigned long long)st->retunes,
+               st->retune_valid_max_us / 1e3);
+    }
+
+    bool pass = answered > 0;
+    if (!pass) printf("[LOAD] no config was answered with a valid frame  FAIL\n");
+    pass &= check("p50 ms", p50, o->budget_p50_ms, true);
+    pass &= check("p99 ms", p99, o->budget_p99_ms, true);
+    pass &= check("max ms", max, o->budget_max_ms, true);
+    if (o->max_miss_pct > 0) pass &= check("miss %", miss_pct, o->max_miss_pct, true);
+    pass &= check("frames/s", fps, o->min_fps, false);
+    printf("[LOAD] %s\n", pass ? "PASS" : "FAIL");
+
+    if (o->json_path && o->json_path[0]) {
+        FILE *f = fopen(o->json_path, "a");
+        if (f) {
+            const char *rev = getenv("BENCH_REV");
+            fprintf(f, "{\"ts\":%lld,\"rev\":\"%s\",\"tool\":\"rf_load\",\"mode\":\"%s\",\"hz\":%g,"
+                       "\"duration_s\":%g,\"device\":%d,\"sent\":%zu,\"answered\":%zu,\"miss_pct\":%.3f,"
+                       "\"frames\":%llu,\"invalid\":%llu,\"unmatched\":%llu,\"fps\":%.3f,"
+                       "\"p50_ms\":%.3f,\"p90_ms\":%.3f,\"p99_ms\":%.3f,\"max_ms\":%.3f,\"cold_ms\":%.3f,"
+                       "\"retunes\":%llu,\"retune_valid_max_ms\":%.3f,\"pass\":%s}\n",
+                    (long long)time(NULL), rev ? rev : "", o->mode_name, o->hz, o->duration_s, o->device,
+                    timed, answered, miss_pct, (unsigned long long)st->frames,
+                    (unsigned long long)st->frames_invalid, (unsigned long long)st->frames_unmatched, fps,
+                    p50, p90, p99, max, cold_ms, (unsigned long long)st->retunes,
+                    st->retune_valid_max_us / 1e3, pass ? "true" : "false");
+            fclose(f);
+        } else {
+            fprintf(stderr, "[LOAD] Warning: cannot append to %s\n", o->json_path);
+        }
+    }
+    free(lat);
+    return pass ? 0 : 1;
+}
+
+// =========================================================
+// MAIN
+
+static int parse_args(int argc, char **argv, load_opts_t *o) {
+    enum { O_IPC = 256, O_MODE, O_SCRIPT, O_HZ, O_DURATION, O_DEVICE, O_CF, O_SR, O_SPAN, O_RBW,
+           O_SCAN_STEP, O_SCAN_STEPS, O_SEED, O_DRAIN, O_P50, O_P99, O_MAX, O_MISS, O_FPS, O_JSON };
+    static const struct option opts[] = {
+        { "ipc", required_argument, NULL, O_IPC },           { "mode", required_argument, NULL, O_MODE },
+        { "script", required_argument, NULL, O_SCRIPT },     { "hz", required_argument, NULL, O_HZ },
+        { "duration", required_argument, NULL, O_DURATION }, { "device", required_argument, NULL, O_DEVICE },
+        { "cf", required_argument, NULL, O_CF },             { "sr", required_argument, NULL, O_SR },
+        { "span", required_argument, NULL, O_SPAN },         { "rbw", required_argument, NULL, O_RBW },
+        { "scan-step", required_argument, NULL, O_SCAN_STEP },
+        { "scan-steps", required_argument, NULL, O_SCAN_STEPS },
+        { "seed", required_argument, NULL, O_SEED },         { "drain", required_argument, NULL, O_DRAIN },
+        { "budget-p50", required_argument, NULL, O_P50 },    { "budget-p99", required_argument, NULL, O_P99 },
+        { "budget-max", required_argument, NULL, O_MAX },    { "max-miss", required_argument, NULL, O_MISS },
+        { "min-fps", required_argument, NULL, O_FPS },       { "json", required_argument, NULL, O_JSON },
+        { NULL, 0, NULL, 0 },
+    };
+
+    *o = (load_opts_t){
+        .ipc = "ipc:///tmp/rf_engine", .mode = MODE_FIXED, .mode_name = "fixed",
+        .hz = 2.0, .duration_s = 10.0, .drain_s = 6.0,
+        .cf = 105.7e6, .sr = 2e6, .span = 200e3, .rbw = 10e3,
+        .scan_step = 50e3, .scan_steps = 20, .seed = 1,
+    };
+    int c;
+    while ((c = getopt_long(argc, argv, "", opts, NULL)) != -1) {
+        switch (c) {
+        case O_IPC:        o->ipc = optarg; break;
+        case O_MODE:       o->mode_name = optarg; break;
+        case O_SCRIPT:     o->script = optarg; o->mode_name = "script"; break;
+        case O_HZ:         o->hz = atof(optarg); break;
+        case O_DURATION:   o->duration_s = atof(optarg); break;
+        case O_DEVICE:     o->device = atoi(optarg); break;
+        case O_CF:         o->cf = atof(optarg); break;
+        case O_SR:         o->sr = atof(optarg); break;
+        case O_SPAN:       o->span = atof(optarg); break;
+        case O_RBW:        o->rbw = atof(optarg); break;
+        case O_SCAN_STEP:  o->scan_step = atof(optarg); break;
+        case O_SCAN_STEPS: o->scan_steps = atoi(optarg); break;
+        case O_SEED:       o->seed = (uint32_t)strtoul(optarg, NULL, 0); break;
+        case O_DRAIN:      o->drain_s = atof(optarg); break;
+        case O_P50:        o->budget_p50_ms = atof(optarg); break;
+        case O_P99:        o->budget_p99_ms = atof(optarg); break;
+        case O_MAX:        o->budget_max_ms = atof(optarg); break;
+        case O_MISS:       o->max_miss_pct = atof(optarg); break;
+        case O_FPS:        o->min_fps = atof(optarg); break;
+        case O_JSON:       o->json_path = optarg; break;
+        default:           return -1;
+        }
+    }
+
+    if (strcmp(o->mode_name, "fixed") == 0) o->mode = MODE_FIXED;
+    else if (strcmp(o->mode_name, "scan") == 0) o->mode = MODE_SCAN;
+    else if (strcmp(o->mode_name, "random") == 0) o->mode = MODE_RANDOM;
+    else if (strcmp(o->mode_name, "script") == 0) o->mode = MODE_SCRIPT;
+    else {
+        fprintf(stderr, "[LOAD] Unknown mode '%s' (fixed, scan, random, script)\n", o->mode_name);
+        return -1;
+    }
+    if (o->mode == MODE_SCRIPT && !o->script) {
+        fprintf(stderr, "[LOAD] --mode script needs --script FILE\n");
+        return -1;
+    }
+    if (o->hz <= 0 || o->duration_s <= 0 || o->scan_steps <= 0 || o->seed == 0) {
+        fprintf(stderr, "[LOAD] --hz, --duration, --scan-steps and --seed must be positive\n");
+        return -1;
+    }
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    load_opts_t o;
+    if (parse_args(argc, argv, &o) != 0) return 2;
+    if (o.mode == MODE_SCRIPT && load_script(o.script) != 0) return 2;
+
+    load_state_t st;
+    memset(&st, 0, sizeof(st));
+    st.cap = (size_t)ceil(o.hz * o.duration_s) + 1;
+    st.cmds = (load_cmd_t*)calloc(st.cap, sizeof(load_cmd_t));
+    char *buf = (char*)malloc(LOAD_RECV_BYTES);
+    if (!st.cmds || !buf) return 2;
+
+    // C connects (zpair_init), the load side binds, as sim_config_zmq.py does
+    void *ctx = zmq_ctx_new();
+    void *sock = ctx ? zmq_socket(ctx, ZMQ_PAIR) : NULL;
+    int linger = 0;
+    if (!sock || zmq_setsockopt(sock, ZMQ_LINGER, &linger, sizeof(linger)) != 0 || zmq_bind(sock, o.ipc) != 0) {
+        fprintf(stderr, "[LOAD] Cannot bind PAIR at %s: %s\n", o.ipc, zmq_strerror(zmq_errno()));
+        return 2;
+    }
+    printf("[LOAD] PAIR bound at %s, mode=%s, %.2f configs/s for %.1f s\n", o.ipc, o.mode_name, o.hz, o.duration_s);
+
+    // A PAIR send fails (EAGAIN) until the engine has connected: the first command waits for it
+    uint32_t seed = o.seed;
+    const uint64_t period_ns = (uint64_t)(1e9 / o.hz);
+    uint64_t t0 = 0, next_ns = 0, end_ns = 0;
+    const uint64_t connect_deadline = now_ns() + 30ULL * 1000000000ULL;
+    size_t i = 0;
+
+    for (;;) {
+        uint64_t t = now_ns();
+        if (t0 && t >= end_ns) break;
+        if (!t0 || t >= next_ns) {
+            bool timed = false;
+            cJSON *cmd = next_command(&o, i, &seed, &timed);
+            if (!cmd) return 2;
+            if (timed && st.sent >= st.cap) {
+                cJSON_Delete(cmd);
+                break;
+            }
+            if (timed) cJSON_AddNumberToObject(cmd, "seq", (double)(st.sent + 1));
+            char *txt = cJSON_PrintUnformatted(cmd);
+
+            int rc = txt ? zmq_send(sock, txt, strlen(txt), ZMQ_DONTWAIT) : -1;
+            uint64_t t_send = now_ns();
+            if (rc < 0 && !t0) {
+                // Not connected yet: retry the same command shortly
+                free(txt);
+                cJSON_Delete(cmd);
+                if (t_send > connect_deadline) {
+                    fprintf(stderr, "[LOAD] rf_engine did not connect to %s\n", o.ipc);
+                    return 2;
+                }
+                pump(sock, &o, &st, buf, t_send + 20000000ULL);
+                continue;
+            }
+            if (!t0) {
+                t0 = t_send;
+                next_ns = t0;
+                end_ns = t0 + (uint64_t)(o.duration_s * 1e9);
+                printf("[LOAD] rf_engine connected, sending\n");
+            }
+            if (rc < 0) {
+                st.send_failed++;
+            } else if (timed) {
+                load_cmd_t *c = &st.cmds[st.sent++];
+                c->t_send_ns = t_send;
+                cJSON *cf = cJSON_GetObjectItemCaseSensitive(cmd, "center_freq_hz");
+                cJSON *span = cJSON_GetObjectItemCaseSensitive(cmd, "span");
+                if (cJSON_IsNumber(cf) && cJSON_IsNumber(span)) {
+                    c->lo_hz = cf->valuedouble - span->valuedouble / 2.0;
+                    c->hi_hz = cf->valuedouble + span->valuedouble / 2.0;
+                } else {
+                    c->lo_hz = 1.0;
+                    c->hi_hz = 0.0;
+                }
+            }
+            free(txt);
+            cJSON_Delete(cmd);
+            i++;
+            next_ns += period_ns;
+        }
+        pump(sock, &o, &st, buf, next_ns < end_ns ? next_ns : end_ns);
+    }
+
+    // Drain: the last config's frame (or the acquisition timeout) can still be on its way
+    uint64_t drain_end = now_ns() + (uint64_t)(o.drain_s * 1e9);
+    while (!settled(&st) && now_ns() < drain_end) pump(sock, &o, &st, buf, now_ns() + 50000000ULL);
+
+    int rc = report(&o, &st, (double)(now_ns() - t0) / 1e9);
+
+    zmq_close(sock);
+    zmq_ctx_term(ctx);
+    free(buf);
+    free(st.cmds);
+    for (int k = 0; k < n_script_lines; k++) free(script_lines[k]);
+    return rc;
+}
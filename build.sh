@@ -37,8 +37,28 @@ SRCS=(
   "$LIBDIR/zmq_util.c"
   "$LIBDIR/utils.c"
   "$LIBDIR/fm_radio.c"
-  "$LIBDIR/sdr_HAL.c"
+  "$LIBDIR/resampler.c"   # CIC + polyphase FIR (IQ/audio rate conversion)
+  "$LIBDIR/ddc.c"         # NCO + channel filter for the demod channel
+  "$LIBDIR/demod.c"       # AM / NFM / WFM / USB / LSB behind one interface
+  "$LIBDIR/fm_stereo.c"   # WFM stereo: pilot PLL + L-R (FM_STEREO=1)
+  "$LIBDIR/squelch.c"     # channel power squelch (SQUELCH_DBFS)
+  "$LIBDIR/channelizer.c" # polyphase filter bank (many channels, one FFT)
+  "$LIBDIR/chan_bank.c"   # channel_attach/detach -> per-channel demod + Opus
+  "$LIBDIR/sdr_HAL.c"     # backend interface + HackRF (SDR_BACKEND)
+  "$LIBDIR/sdr_file.c"    # SDR_BACKEND=file: mmap'd IQ replay (int8 / cs16 / cf32)
+  "$LIBDIR/sdr_sim.c"     # SDR_BACKEND=sim: tones, FM, bursts, noise
   "$LIBDIR/opus_tx.c"     # <-- NUEVO: encoder Opus + framing TCP 'OPU0'
+  "$LIBDIR/latency.c"     # histogramas de latencia + línea de tiempo de captura (rx_callback)
+  "$LIBDIR/shm_ring.c"    # ring SPSC en /dev/shm + eventfd (AUDIO_TRANSPORT=shm, PSD_TRANSPORT=shm)
+  "$LIBDIR/iq_recorder.c" # record_start/record_stop: IQ crudo a SigMF con O_DIRECT
+  "$LIBDIR/consumer.c"    # ring + callback servido por un hilo propio o del scheduler
+  "$LIBDIR/dataflow.c"    # grafo de bloques tipados desde JSON (graph_start / RF_GRAPH)
+  "$LIBDIR/df_blocks.c"   # bloques: tap, sdr, ddc, demod, psd, encoder, sink
+  "$LIBDIR/rt_policy.c"   # RT_POLICY: afinidad, SCHED_FIFO, nice por hilo + mlockall
+  "$LIBDIR/work_pool.c"   # pool work-stealing compartido (Welch, canales) con prioridades
+  "$LIBDIR/arena.c"       # arena por configuración (buffers del lazo PSD sin malloc por frame)
+  "$LIBDIR/metrics.c"     # registro de métricas (contadores por hilo, gauges, histogramas) -> topic stats
+  "$LIBDIR/trace.c"       # spans por hilo (trace_start / trace_dump) -> JSON Chrome / Perfetto
 )
 
 # =========================================================
@@ -54,6 +74,7 @@ LIBS=(
   -lpthread
   -lm
   -lfftw3
+  -lfftw3f             # channelizer (single precision)
 )
 
 # =========================================================
@@ -0,0 +1,45 @@
+// libs/arena.c
+#include "arena.h"
+#include <stdlib.h>
+#include <string.h>
+
+void arena_init(arena_t *a) {
+    memset(a, 0, sizeof(*a));
+}
+
+int arena_reserve(arena_t *a, size_t bytes) {
+    bytes = ARENA_SIZE(bytes);
+    a->used = 0;
+    if (a->base && bytes <= a->cap && bytes >= a->cap / 4) return 0;
+
+    free(a->base);
+    a->base = NULL;
+    a->cap = 0;
+    if (bytes == 0) return 0;
+    void *p = NULL;
+    if (posix_memalign(&p, ARENA_ALIGN, bytes) != 0) return -1;
+    a->base = (uint8_t*)p;
+    a->cap = bytes;
+    a->resizes++;
+    return 0;
+}
+
+void* arena_alloc(arena_t *a, size_t bytes) {
+    size_t need = ARENA_SIZE(bytes);
+    if (!a->base || need > a->cap - a->used) return NULL;
+    void *p = a->base + a->used;
+    a->used += need;
+    if (a->used > a->peak) a->peak = a->used;
+    return p;
+}
+
+void arena_reset(arena_t *a) {
+    a->used = 0;
+}
+
+void arena_free(arena_t *a) {
+    free(a->base);
+    a->base = NULL;
+    a->cap = 0;
+    a->used = 0;
+}
@@ -0,0 +1,45 @@
+// libs/arena.h
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// --- Bump arena for buffers that live exactly as long as one configuration ---
+//
+// Sized once (arena_reserve) when the configuration changes; every buffer of the
+// frame is then carved out with arena_alloc and dropped all at once by the next
+// reserve. Allocations are ARENA_ALIGN aligned (FFTW SIMD buffers included).
+
+#define ARENA_ALIGN 64
+#define ARENA_SIZE(bytes) (((size_t)(bytes) + ARENA_ALIGN - 1) & ~(size_t)(ARENA_ALIGN - 1))
+
+typedef struct {
+    uint8_t *base;
+    size_t cap;
+    size_t used;
+    size_t peak;                // largest 'used' since arena_init
+    unsigned resizes;           // times the backing block was (re)allocated
+} arena_t;
+
+void arena_init(arena_t *a);
+
+/**
+ * @brief Empties the arena and makes room for 'bytes'. Keeps the current block when it is
+ * big enough and not more than 4x too big; otherwise replaces it.
+ * @return 0 on success, -1 if the block could not be allocated (the arena is then empty).
+ */
+int arena_reserve(arena_t *a, size_t bytes);
+
+/**
+ * @brief Next ARENA_ALIGN aligned slice of 'bytes'. Never falls back to the heap.
+ * @return NULL if the reservation is exhausted.
+ */
+void* arena_alloc(arena_t *a, size_t bytes);
+
+/** Drops every allocation, keeps the block. */
+void arena_reset(arena_t *a);
+
+void arena_free(arena_t *a);
+
+#endif
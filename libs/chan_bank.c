@@ -0,0 +1,396 @@
+// libs/chan_bank.c
+#include "chan_bank.h"
+#include "ddc.h"
+#include "demod.h"
+#include "rt_policy.h"
+#include "work_pool.h"
+#include "latency.h"
+#include "trace.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <math.h>
+#include <time.h>
+
+#define CHAN_RETRY_MS 1000
+
+struct pfb_chan {
+    chan_spec_t spec;
+    int bin;                // -1 while outside the capture
+    ddc_t ddc;              // residual offset + channel filter at the bin rate
+    demod_t demod;
+    bool dsp_ready;
+    squelch_t sq;
+    double gap_samples;     // squelched audio not yet reported to the gateway
+
+    opus_tx_t *tx;
+    uint64_t next_retry_ms;
+
+    float *iq;              // ddc output
+    int16_t *pcm;
+    int16_t *accum;
+    int accum_len;
+};
+
+static uint64_t mono_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000ULL + (uint64_t)ts.tv_nsec / 1000000ULL;
+}
+
+static int frame_samples_of(const chan_bank_t *bank) {
+    return (int)lrint(bank->opus.sample_rate * bank->frame_ms / 1000.0);
+}
+
+static void chan_destroy(pfb_chan_t *ch) {
+    if (!ch) return;
+    if (ch->tx) opus_tx_destroy(ch->tx);
+    ddc_free(&ch->ddc);
+    demod_free(&ch->demod);
+    free(ch->iq);
+    free(ch->pcm);
+    free(ch->accum);
+    free(ch);
+}
+
+static pfb_chan_t* chan_create(const chan_bank_t *bank, const chan_spec_t *spec) {
+    pfb_chan_t *ch = (pfb_chan_t*)calloc(1, sizeof(pfb_chan_t));
+    if (!ch) return NULL;
+
+    ch->spec = *spec;
+    ch->bin = -1;
+    // Bin rate output never exceeds one sample per D inputs; size for a whole chunk
+    ch->iq    = (float*)malloc(((size_t)CHAN_BANK_CHUNK + 64) * 2 * sizeof(float));
+    ch->pcm   = (int16_t*)malloc(((size_t)CHAN_BANK_CHUNK + 64) * sizeof(int16_t));
+    ch->accum = (int16_t*)malloc((size_t)frame_samples_of(bank) * sizeof(int16_t));
+    if (!ch->iq || !ch->pcm || !ch->accum) {
+        chan_destroy(ch);
+        return NULL;
+    }
+    return ch;
+}
+
+/**
+ * @brief Maps the channel onto a PFB bin and (re)builds its DSP for the residual offset.
+ * center_freq is bank_sync's snapshot (bank->center_freq belongs to bank->lock).
+ */
+static void chan_place(chan_bank_t *bank, pfb_chan_t *ch, double center_freq) {
+    ch->bin = -1;
+    if (!bank->pfb_ready) return;
+
+    const demod_ops_t *ops = demod_ops_for(ch->spec.mode, 0);
+    double offset = ch->spec.freq_hz - center_freq;
+    double bw = (ch->spec.bw_hz > 0) ? ch->spec.bw_hz : ops->default_bw_hz;
+    if (fabs(offset) + 0.5 * bw > 0.5 * bank->pfb.fs_in) {
+        fprintf(stderr, "[CHAN %d] WARN: %.0f Hz outside capture. Channel idle.\n", ch->spec.id, ch->spec.freq_hz);
+        return;
+    }
+
+    double residual = 0.0;
+    // Bin chosen around the band actually demodulated (SSB: the sideband)
+    int bin = channelizer_bin_for(&bank->pfb, offset + ops->if_shift_hz, &residual);
+    if (fabs(residual) + 0.5 * bw > PFB_PASS_FRAC * bank->pfb.spacing_hz) {
+        fprintf(stderr, "[CHAN %d] WARN: residual %+.0f Hz + bw/2 exceeds bin passband; audio may degrade.\n",
+                ch->spec.id, residual);
+    }
+
+    ddc_free(&ch->ddc);
+    demod_free(&ch->demod);
+    ch->dsp_ready = (demod_front_end_init(&ch->ddc, ch->spec.mode, 0, bank->pfb.fs_chan,
+                                          residual - ops->if_shift_hz, bw) == 0) &&
+                    (demod_init(&ch->demod, ch->spec.mode, 0, ch->ddc.fs_out, bank->opus.sample_rate) == 0);
+    if (!ch->dsp_ready) {
+        fprintf(stderr, "[CHAN %d] ERROR: DSP init failed.\n", ch->spec.id);
+        return;
+    }
+
+    ch->bin = bin;
+    ch->accum_len = 0;
+    ch->gap_samples = 0.0;
+    squelch_init(&ch->sq, &bank->squelch, ch->ddc.fs_out);
+    printf("[CHAN %d] %s %.0f Hz -> bin %d (residual %+.0f Hz) -> %s:%d\n",
+           ch->spec.id, ops->name, ch->spec.freq_hz, bin, residual, ch->spec.host, ch->spec.port);
+}
+
+/**
+ * @brief Applies requested specs / tuner changes (bank thread only).
+ */
+static void bank_sync(chan_bank_t *bank) {
+    chan_spec_t specs[CHAN_BANK_MAX];
+    bool used[CHAN_BANK_MAX];
+
+    pthread_mutex_lock(&bank->lock);
+    memcpy(specs, bank->specs, sizeof(specs));
+    memcpy(used, bank->spec_used, sizeof(used));
+    double fs = bank->fs;
+    double center_freq = bank->center_freq;
+    bank->dirty = false;
+    pthread_mutex_unlock(&bank->lock);
+
+    bool rebuild = (fs > 0.0) && (!bank->pfb_ready || fabs(fs - bank->pfb_fs) > 1e-6);
+    if (rebuild) {
+        channelizer_free(&bank->pfb);
+        bank->pfb_ready = (channelizer_init(&bank->pfb, fs, bank->spacing_hz) == 0);
+        bank->pfb_fs = fs;
+        rb_reset(&bank->rb);
+    }
+
+    int n_used = 0;
+    for (int i = 0; i < CHAN_BANK_MAX; i++) {
+        pfb_chan_t *ch = bank->chans[i];
+
+        if (!used[i]) {
+            if (ch) {
+                printf("[CHAN %d] Detached.\n", ch->spec.id);
+                chan_destroy(ch);
+                bank->chans[i] = NULL;
+            }
+            continue;
+        }
+        n_used++;
+
+        bool respec = ch && memcmp(&ch->spec, &specs[i], sizeof(chan_spec_t)) != 0;
+        if (respec && (strcmp(ch->spec.host, specs[i].host) != 0 || ch->spec.port != specs[i].port)) {
+            // New destination: drop the old stream
+            chan_destroy(ch);
+            bank->chans[i] = ch = NULL;
+        }
+        if (!ch) {
+            ch = chan_create(bank, &specs[i]);
+            if (!ch) {
+                fprintf(stderr, "[CHAN %d] ERROR: alloc failed.\n", specs[i].id);
+                continue;
+            }
+            bank->chans[i] = ch;
+        }
+        ch->spec = specs[i];
+        chan_place(bank, ch, center_freq);   // tuner center or rate may have moved the bin
+    }
+
+    bank->enabled = (n_used > 0);
+    if (!bank->enabled) rb_reset(&bank->rb);
+}
+
+/**
+ * @brief PCM -> exact Opus frames -> opus_tx queue. Sends never block and the
+ * connection is retried inside opus_tx, so one slow or unreachable gateway never
+ * stalls the other channels.
+ */
+static void chan_emit(chan_bank_t *bank, pfb_chan_t *ch, int n_pcm) {
+    const int frame_samples = frame_samples_of(bank);
+
+    if (!ch->tx) {
+        uint64_t now = mono_ms();
+        if (now < ch->next_retry_ms) return;
+        // Fixed SSRC (RTP_SSRC) stays unique per channel when several share a group
+        opus_tx_cfg_t cfg = bank->opus;
+        if (cfg.rtp_ssrc) cfg.rtp_ssrc += (uint32_t)(ch->spec.id + 1);
+        ch->tx = opus_tx_create(ch->spec.host, ch->spec.port, &cfg);
+        if (!ch->tx) {
+            fprintf(stderr, "[CHAN %d] WARN: Opus encoder init failed. Will retry.\n", ch->spec.id);
+            ch->next_retry_ms = now + CHAN_RETRY_MS;
+            return;
+        }
+        ch->accum_len = 0;
+        ch->gap_samples = 0.0;
+    }
+
+    int idx = 0;
+    while (idx < n_pcm) {
+        int take = frame_samples - ch->accum_len;
+        if (take > n_pcm - idx) take = n_pcm - idx;
+        memcpy(&ch->accum[ch->accum_len], &ch->pcm[idx], (size_t)take * sizeof(int16_t));
+        ch->accum_len += take;
+        idx += take;
+
+        if (ch->accum_len == frame_samples) {
+            ch->accum_len = 0;
+            if (opus_tx_send_frame(ch->tx, ch->accum, frame_samples) != 0) {
+                fprintf(stderr, "[CHAN %d] WARN: opus_encode failed, frame dropped.\n", ch->spec.id);
+            }
+        }
+    }
+}
+
+/**
+ * @brief Squelch closed for n_iq channel samples: no demod, no encoder, only seq advances.
+ */
+static void chan_gap(chan_bank_t *bank, pfb_chan_t *ch, int n_iq) {
+    const int frame_samples = frame_samples_of(bank);
+
+    ch->gap_samples += (double)n_iq * (double)bank->opus.sample_rate / ch->ddc.fs_out + (double)ch->accum_len;
+    ch->accum_len = 0;
+    if (!ch->tx || ch->gap_samples < (double)frame_samples) return;
+
+    int frames = (int)(ch->gap_samples / (double)frame_samples);
+    ch->gap_samples -= (double)frames * (double)frame_samples;
+    opus_tx_send_gap(ch->tx, frames);
+}
+
+// One channel's share of a bank pass, run as a pool task
+typedef struct {
+    chan_bank_t *bank;
+    pfb_chan_t *ch;
+    const float *bin_iq;
+    int n_bin;
+} chan_job_t;
+
+/** Channel chain after the PFB: DDC -> squelch -> demod -> Opus. Touches only ch. */
+static void chan_job(void *arg) {
+    chan_job_t *j = (chan_job_t*)arg;
+    pfb_chan_t *ch = j->ch;
+    int n_iq = ddc_process_cf32(&ch->ddc, j->bin_iq, (size_t)j->n_bin, ch->iq);
+
+    bool was_open = ch->sq.open;
+    if (!squelch_update(&ch->sq, ch->iq, (size_t)n_iq)) {
+        chan_gap(j->bank, ch, n_iq);
+        return;
+    }
+    if (!was_open && j->bank->squelch.enabled) demod_reset(&ch->demod);
+
+    int n_pcm = demod_process(&ch->demod, ch->iq, (size_t)n_iq, ch->pcm);
+    if (n_pcm > 0) chan_emit(j->bank, ch, n_pcm);
+}
+
+static void* bank_thread_fn(void *arg) {
+    chan_bank_t *bank = (chan_bank_t*)arg;
+    rt_policy_apply("chan", NULL);
+    // Pool workers would run the chains below the chan thread's RT class: keep them here
+    bool inline_chains = rt_policy_role_is_rt("chan") && !rt_policy_role_is_rt("pool");
+    if (inline_chains) printf("[CHAN] \"chan\" is real-time and \"pool\" is not: channel chains run inline\n");
+
+    int8_t *raw = (int8_t*)malloc((size_t)CHAN_BANK_CHUNK * 2);
+    // One output stream per bin, at most CHAN_BANK_CHUNK / D + 1 samples each
+    size_t stride = ((size_t)CHAN_BANK_CHUNK + 64) * 2;
+    float *bin_out = (float*)malloc(stride * CHAN_BANK_MAX * sizeof(float));
+    if (!raw || !bin_out) {
+        fprintf(stderr, "[CHAN] FATAL: malloc failed\n");
+        free(raw);
+        free(bin_out);
+        return NULL;
+    }
+
+    int bins[CHAN_BANK_MAX];
+    pfb_chan_t *active[CHAN_BANK_MAX];
+    chan_job_t jobs[CHAN_BANK_MAX];
+    wp_group_t group;
+    wp_group_init(&group);
+
+    while (bank->running) {
+        if (bank->dirty) bank_sync(bank);
+
+        if (!bank->enabled || !bank->pfb_ready) {
+            usleep(2000);
+            continue;
+        }
+        if (rb_available(&bank->rb) < (size_t)CHAN_BANK_CHUNK * 2) {
+            usleep(1000);
+            continue;
+        }
+        rb_read(&bank->rb, raw, (size_t)CHAN_BANK_CHUNK * 2);
+        uint64_t t_pass = lat_now_ns();
+        trace_begin("chan_pass");
+
+        int n_active = 0;
+        for (int i = 0; i < CHAN_BANK_MAX; i++) {
+            pfb_chan_t *ch = bank->chans[i];
+            if (!ch || ch->bin < 0 || !ch->dsp_ready) continue;
+            bins[n_active] = ch->bin;
+            active[n_active++] = ch;
+        }
+
+        // One filter bank pass serves every channel; keep only the bins in use
+        int n_bin = channelizer_process_s8(&bank->pfb, raw, CHAN_BANK_CHUNK, bins, n_active, bin_out, stride);
+
+        // Channels are independent: fan them out on the shared pool at audio priority
+        // (inline when there is no pool, a single channel, or the pool is not RT like chan)
+        for (int b = 0; b < n_active; b++) {
+            jobs[b] = (chan_job_t){ bank, active[b], &bin_out[(size_t)b * stride], n_bin };
+            if (n_active == 1 || inline_chains) chan_job(&jobs[b]);
+            else work_pool_submit(&group, WP_PRIO_HIGH, chan_job, &jobs[b]);
+        }
+        wp_group_wait(&group);
+        trace_end("chan_pass");
+        metrics_observe_ns(bank->m_pass_ns, lat_now_ns() - t_pass);
+        metrics_add(bank->m_passes, 1);
+    }
+    wp_group_destroy(&group);
+
+    for (int i = 0; i < CHAN_BANK_MAX; i++) {
+        chan_destroy(bank->chans[i]);
+        bank->chans[i] = NULL;
+    }
+    channelizer_free(&bank->pfb);
+    free(raw);
+    free(bin_out);
+    return NULL;
+}
+
+int chan_bank_start(chan_bank_t *bank, const opus_tx_cfg_t *opus, const squelch_cfg_t *squelch,
+                    double frame_ms, double spacing_hz) {
+    if (!bank || !opus || frame_ms <= 0) return -1;
+
+    memset(bank, 0, sizeof(*bank));
+    bank->opus = *opus;
+    if (squelch) bank->squelch = *squelch;
+    bank->frame_ms = frame_ms;
+    bank->spacing_hz = (spacing_hz > 0) ? spacing_hz : CHAN_BANK_SPACING_HZ;
+    bank->m_passes = -1;
+    bank->m_pass_ns = -1;
+    pthread_mutex_init(&bank->lock, NULL);
+    rb_init(&bank->rb, CHAN_BANK_RB_SIZE);
+
+    bank->running = true;
+    if (pthread_create(&bank->thread, NULL, bank_thread_fn, bank) != 0) {
+        bank->running = false;
+        rb_free(&bank->rb);
+        return -1;
+    }
+    return 0;
+}
+
+void chan_bank_stop(chan_bank_t *bank) {
+    if (!bank || !bank->running) return;
+    bank->running = false;
+    pthread_join(bank->thread, NULL);
+    rb_free(&bank->rb);
+    pthread_mutex_destroy(&bank->lock);
+}
+
+void chan_bank_set_tuner(chan_bank_t *bank, double fs, double center_freq) {
+    if (!bank) return;
+    pthread_mutex_lock(&bank->lock);
+    if (bank->fs != fs || bank->center_freq != center_freq) {
+        bank->fs = fs;
+        bank->center_freq = center_freq;
+        bank->dirty = true;
+    }
+    pthread_mutex_unlock(&bank->lock);
+}
+
+int chan_bank_attach(chan_bank_t *bank, const chan_spec_t *spec) {
+    if (!bank || !spec || spec->id < 0 || spec->id >= CHAN_BANK_MAX) return -1;
+    pthread_mutex_lock(&bank->lock);
+    bank->specs[spec->id] = *spec;
+    bank->spec_used[spec->id] = true;
+    bank->dirty = true;
+    pthread_mutex_unlock(&bank->lock);
+    return 0;
+}
+
+int chan_bank_detach(chan_bank_t *bank, int id) {
+    if (!bank || id < 0 || id >= CHAN_BANK_MAX) return -1;
+    pthread_mutex_lock(&bank->lock);
+    int rc = bank->spec_used[id] ? 0 : -1;
+    bank->spec_used[id] = false;
+    bank->dirty = true;
+    pthread_mutex_unlock(&bank->lock);
+    return rc;
+}
+
+size_t chan_bank_push(chan_bank_t *bank, const uint8_t *data, size_t len) {
+    if (!bank->enabled) return 0;
+    return len - rb_write(&bank->rb, data, len);
+}
@@ -0,0 +1,98 @@
+// libs/chan_bank.h
+#ifndef CHAN_BANK_H
+#define CHAN_BANK_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <pthread.h>
+
+#include "ring_buffer.h"
+#include "channelizer.h"
+#include "opus_tx.h"
+#include "squelch.h"
+#include "datatypes.h"
+#include "metrics.h"
+
+#define CHAN_BANK_MAX           16
+#define CHAN_BANK_CHUNK         16384                 // IQ samples per bank pass
+#define CHAN_BANK_RB_SIZE       (CHAN_BANK_CHUNK * 2 * 16)
+#define CHAN_BANK_SPACING_HZ    200000.0              // default PFB bin spacing
+
+// --- One monitored channel (as requested over JSON) ---
+typedef struct {
+    int id;
+    double freq_hz;         // absolute channel center
+    double bw_hz;           // <= 0 -> demodulator default
+    rf_mode_t mode;         // demodulator (FM_MODE = WFM)
+    char host[64];          // Opus TCP destination
+    int port;
+} chan_spec_t;
+
+typedef struct pfb_chan pfb_chan_t;
+
+// --- Channel bank: one PFB over the capture feeding N demod + Opus chains ---
+typedef struct {
+    ring_buffer_t rb;               // fed by rx_callback while a channel is attached
+    volatile bool enabled;
+
+    pthread_t thread;
+    volatile bool running;
+
+    // Requested state (command / main threads), guarded by lock
+    pthread_mutex_t lock;
+    chan_spec_t specs[CHAN_BANK_MAX];
+    bool spec_used[CHAN_BANK_MAX];
+    double fs;
+    double center_freq;
+    volatile bool dirty;
+
+    // Applied state (bank thread only)
+    channelizer_t pfb;
+    bool pfb_ready;
+    double pfb_fs;
+    double spacing_hz;
+    pfb_chan_t *chans[CHAN_BANK_MAX];
+
+    opus_tx_cfg_t opus;
+    squelch_cfg_t squelch;          // per-channel gate, same settings for every channel
+    double frame_ms;
+
+    metric_id_t m_passes;           // metrics registry ids, -1 = not recorded (set by the owner)
+    metric_id_t m_pass_ns;
+} chan_bank_t;
+
+/**
+ * @brief Starts the (idle) bank thread. Channels are added with chan_bank_attach.
+ * @param squelch NULL or disabled = every channel always demodulates and encodes.
+ * @param spacing_hz PFB bin spacing (<= 0 -> CHAN_BANK_SPACING_HZ).
+ * @return 0 on success, -1 on error.
+ */
+int chan_bank_start(chan_bank_t *bank, const opus_tx_cfg_t *opus, const squelch_cfg_t *squelch,
+                    double frame_ms, double spacing_hz);
+
+void chan_bank_stop(chan_bank_t *bank);
+
+/**
+ * @brief Tuner state changed (sample rate rebuilds the PFB, center moves bins).
+ */
+void chan_bank_set_tuner(chan_bank_t *bank, double fs, double center_freq);
+
+/**
+ * @brief Adds or replaces channel spec->id.
+ * @return 0 on success, -1 if the id is invalid or the bank is full.
+ */
+int chan_bank_attach(chan_bank_t *bank, const chan_spec_t *spec);
+
+/**
+ * @return 0 on success, -1 if the id is not attached.
+ */
+int chan_bank_detach(chan_bank_t *bank, int id);
+
+/**
+ * @brief Copies raw IQ into the bank ring (cheap no-op while no channel is attached).
+ * @return Bytes dropped because the ring was full (0 while idle).
+ */
+size_t chan_bank_push(chan_bank_t *bank, const uint8_t *data, size_t len);
+
+#endif
@@ -0,0 +1,171 @@
+// libs/channelizer.c
+#include "channelizer.h"
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <math.h>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+#define PFB_MIN_TAPS 4
+
+static double bessel_i0(double x) {
+    double sum = 1.0, term = 1.0;
+    double q = x * x / 4.0;
+    for (int k = 1; k < 50; k++) {
+        term *= q / ((double)k * (double)k);
+        sum += term;
+        if (term < 1e-12 * sum) break;
+    }
+    return sum;
+}
+
+int channelizer_init(channelizer_t *c, double fs_in, double spacing_hz) {
+    if (!c || fs_in <= 0.0 || spacing_hz <= 0.0) return -1;
+    memset(c, 0, sizeof(*c));
+
+    int M = 2 * (int)lround(fs_in / (2.0 * spacing_hz));
+    if (M < 2) M = 2;
+
+    c->fs_in = fs_in;
+    c->M = M;
+    c->D = M / 2;
+    c->spacing_hz = fs_in / (double)M;
+    c->fs_chan = fs_in / (double)c->D;
+
+    // Passband +/- PFB_PASS_FRAC * spacing; stop edge placed so that what folds at
+    // fs_chan = 2 * spacing lands outside the passband of the same bin
+    double fp  = PFB_PASS_FRAC * c->spacing_hz;
+    double fsb = 2.0 * c->spacing_hz - fp;
+    double n_est = (PFB_ATTEN_DB - 8.0) * fs_in / (2.285 * 2.0 * M_PI * (fsb - fp));
+    c->P = (int)ceil(n_est / (double)M);
+    if (c->P < PFB_MIN_TAPS) c->P = PFB_MIN_TAPS;
+
+    int N = M * c->P;
+    c->taps = (float*)calloc((size_t)N, sizeof(float));
+    c->hist = (float complex*)calloc(2 * (size_t)N, sizeof(float complex));
+    c->fft_buf = fftwf_alloc_complex((size_t)M);
+    double *proto = (double*)malloc((size_t)N * sizeof(double));
+    if (!c->taps || !c->hist || !c->fft_buf || !proto) {
+        free(proto);
+        channelizer_free(c);
+        return -1;
+    }
+
+    // Kaiser-windowed sinc, cutoff halfway through the transition (= spacing)
+    double fc = 0.5 * (fp + fsb) / fs_in;
+    double beta = 0.1102 * (PFB_ATTEN_DB - 8.7);
+    double i0_beta = bessel_i0(beta);
+    double center = 0.5 * (double)(N - 1);
+    double sum = 0.0;
+    for (int n = 0; n < N; n++) {
+        double t = (double)n - center;
+        double x = 2.0 * fc * t;
+        double sinc = (fabs(x) < 1e-12) ? 1.0 : sin(M_PI * x) / (M_PI * x);
+        double r = t / center;
+        proto[n] = sinc * bessel_i0(beta * sqrt(fmax(0.0, 1.0 - r * r))) / i0_beta;
+        sum += proto[n];
+    }
+    for (int p = 0; p < M; p++) {
+        for (int l = 0; l < c->P; l++) {
+            c->taps[p * c->P + l] = (float)(proto[p + l * M] / sum);
+        }
+    }
+    free(proto);
+
+    c->plan = fftwf_plan_dft_1d(M, c->fft_buf, c->fft_buf, FFTW_BACKWARD, FFTW_ESTIMATE);
+    if (!c->plan) {
+        channelizer_free(c);
+        return -1;
+    }
+
+    printf("[PFB] fs=%.0f Hz | M=%d bins x %.0f Hz | taps/branch=%d | bin rate %.0f Hz\n",
+           fs_in, M, c->spacing_hz, c->P, c->fs_chan);
+    return 0;
+}
+
+void channelizer_free(channelizer_t *c) {
+    if (!c) return;
+    if (c->plan) {
+        fftwf_destroy_plan(c->plan);
+        c->plan = NULL;
+    }
+    if (c->fft_buf) {
+        fftwf_free(c->fft_buf);
+        c->fft_buf = NULL;
+    }
+    if (c->taps) {
+        free(c->taps);
+        c->taps = NULL;
+    }
+    if (c->hist) {
+        free(c->hist);
+        c->hist = NULL;
+    }
+}
+
+int channelizer_bin_for(const channelizer_t *c, double offset_hz, double *residual_hz) {
+    long b = lround(offset_hz / c->spacing_hz);
+    if (residual_hz) *residual_hz = offset_hz - (double)b * c->spacing_hz;
+    return (int)(((b % c->M) + c->M) % c->M);
+}
+
+int channelizer_max_output(const channelizer_t *c, size_t n_in) {
+    if (!c || c->D <= 0) return 0;
+    return (int)(n_in / (size_t)c->D) + 1;
+}
+
+int channelizer_process_s8(channelizer_t *c, const int8_t *iq, size_t n,
+                           const int *bins, int n_bins, float *out, size_t out_stride) {
+    if (!c || !c->plan || !iq) return 0;
+
+    const int M = c->M;
+    const int P = c->P;
+    const int W = M * P;
+    const float scale = 1.0f / 128.0f;
+    int n_out = 0;
+
+    for (size_t i = 0; i < n; i++) {
+        // 1) commutator: newest sample first in the mirrored delay line
+        c->hist_pos = (c->hist_pos == 0) ? (W - 1) : (c->hist_pos - 1);
+        float complex x = ((float)iq[2*i] * scale) + ((float)iq[2*i + 1] * scale) * I;
+        c->hist[c->hist_pos] = x;
+        c->hist[c->hist_pos + W] = x;
+
+        if (++c->fill < c->D) continue;
+        c->fill = 0;
+
+        // 2) polyphase branches: v[p] = sum_l h[p + lM] * x[nD - p - lM]
+        const float complex *h = &c->hist[c->hist_pos];
+        for (int p = 0; p < M; p++) {
+            const float *tp = &c->taps[p * P];
+            float acc_re = 0.0f, acc_im = 0.0f;
+            for (int l = 0; l < P; l++) {
+                float complex v = h[p + l * M];
+                acc_re += tp[l] * crealf(v);
+                acc_im += tp[l] * cimagf(v);
+            }
+            c->fft_buf[p] = acc_re + acc_im * I;
+        }
+
+        // 3) M-point IFFT -> one sample per bin; (-1)^(k*n) from the M/2 decimation
+        fftwf_execute(c->plan);
+
+        int odd = (int)(c->step & 1);
+        for (int b = 0; b < n_bins; b++) {
+            int k = bins[b];
+            float complex y = c->fft_buf[k];
+            if (odd && (k & 1)) y = -y;
+            if (out) {
+                out[(size_t)b * out_stride + 2 * (size_t)n_out]     = crealf(y);
+                out[(size_t)b * out_stride + 2 * (size_t)n_out + 1] = cimagf(y);
+            }
+        }
+        c->step++;
+        n_out++;
+    }
+
+    return n_out;
+}
@@ -0,0 +1,62 @@
+// libs/channelizer.h
+#ifndef CHANNELIZER_H
+#define CHANNELIZER_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <complex.h>
+#include <fftw3.h>
+
+#define PFB_PASS_FRAC   0.75    // clean passband per bin: +/- 0.75 * spacing
+#define PFB_ATTEN_DB    70.0
+
+// --- 2x oversampled polyphase filter bank (M uniform channels, decimation M/2) ---
+typedef struct {
+    double fs_in;
+    double spacing_hz;      // fs_in / M
+    double fs_chan;         // 2 * spacing_hz
+
+    int M;                  // number of bins (even)
+    int D;                  // decimation = M / 2
+    int P;                  // taps per polyphase branch
+
+    float *taps;            // [M][P], branch p holds h[p + l*M]
+    float complex *hist;    // mirrored delay line, 2 * M * P, newest first
+    int hist_pos;
+    int fill;               // new samples gathered for the current step
+    uint64_t step;          // output index n (sign (-1)^(k*n) of the oversampled bank)
+
+    float complex *fft_buf; // in-place M-point IFFT
+    fftwf_plan plan;
+} channelizer_t;
+
+/**
+ * @brief Builds an M-channel bank (M = fs_in / spacing_hz rounded to an even number).
+ * @return 0 on success, -1 on error.
+ */
+int channelizer_init(channelizer_t *c, double fs_in, double spacing_hz);
+
+void channelizer_free(channelizer_t *c);
+
+/**
+ * @brief Nearest bin for a channel at offset_hz from the tuner center.
+ * @param residual_hz Remaining offset from the bin center (|r| <= spacing / 2).
+ * @return Bin index 0..M-1.
+ */
+int channelizer_bin_for(const channelizer_t *c, double offset_hz, double *residual_hz);
+
+/**
+ * @brief Upper bound of samples per bin produced for n_in input samples.
+ */
+int channelizer_max_output(const channelizer_t *c, size_t n_in);
+
+/**
+ * @brief Runs the bank over interleaved int8 IQ and keeps only the requested bins.
+ * @param bins Bin indexes to extract. @param out Bin b is written as interleaved
+ * float I/Q starting at out[b * out_stride] (out_stride in floats).
+ * @return Samples produced per bin.
+ */
+int channelizer_process_s8(channelizer_t *c, const int8_t *iq, size_t n,
+                           const int *bins, int n_bins, float *out, size_t out_stride);
+
+#endif
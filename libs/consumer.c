@@ -6,58 +6,174 @@
 #include <stdlib.h>
 #include <unistd.h>
 #include <string.h>
+#include <time.h>
+
+static uint64_t mono_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+void consumer_wake_init(consumer_wake_t *w) {
+    pthread_condattr_t attr;
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_cond_init(&w->cond, &attr);
+    pthread_condattr_destroy(&attr);
+    pthread_mutex_init(&w->lock, NULL);
+    w->seq = 0;
+}
+
+void consumer_wake_destroy(consumer_wake_t *w) {
+    pthread_cond_destroy(&w->cond);
+    pthread_mutex_destroy(&w->lock);
+}
+
+void consumer_notify(consumer_wake_t *w) {
+    pthread_mutex_lock(&w->lock);
+    w->seq++;
+    pthread_cond_broadcast(&w->cond);
+    pthread_mutex_unlock(&w->lock);
+}
+
+void consumer_wait(consumer_wake_t *w, uint64_t seen_seq, int timeout_us) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    ts.tv_nsec += (long)timeout_us * 1000L;
+    ts.tv_sec += ts.tv_nsec / 1000000000L;
+    ts.tv_nsec %= 1000000000L;
+
+    pthread_mutex_lock(&w->lock);
+    if (w->seq == seen_seq) pthread_cond_timedwait(&w->cond, &w->lock, &ts);
+    pthread_mutex_unlock(&w->lock);
+}
+
+uint64_t consumer_wake_seq(consumer_wake_t *w) {
+    pthread_mutex_lock(&w->lock);
+    uint64_t s = w->seq;
+    pthread_mutex_unlock(&w->lock);
+    return s;
+}
+
+int consumer_poll(Consumer_t *c) {
+    size_t available = rb_available(&c->rb);
+    if (available > c->depth_max) c->depth_max = available;
+
+    // Only process if we have enough data (or a minimum threshold)
+    if (available < c->chunk_process_size) return 0;
+
+    if (!c->temp_buf) {
+        c->temp_buf = malloc(c->chunk_process_size);
+        if (!c->temp_buf) return 0;
+    }
+    size_t read = rb_read(&c->rb, c->temp_buf, c->chunk_process_size);
+    consumer_notify(c->wake);   // space for a blocked producer
+
+    if (read > 0 && c->logic_cb) {
+        // Execute the registered logic
+        uint64_t t0 = mono_ns();
+        c->logic_cb(c->temp_buf, read, c->ctx);
+        c->busy_ns += mono_ns() - t0;
+        c->chunks++;
+    }
+    return 1;
+}
 
 static void* consumer_worker(void* arg) {
     Consumer_t *c = (Consumer_t*)arg;
-    uint8_t *temp_buf = malloc(c->chunk_process_size);
-    
+
     printf("[%s] Thread Started\n", c->name);
 
     while (c->running) {
-        size_t available = rb_available(&c->rb);
-        
-        // Only process if we have enough data (or a minimum threshold)
-        if (available >= c->chunk_process_size) {
-            size_t read = rb_read(&c->rb, temp_buf, c->chunk_process_size);
-            if (read > 0 && c->logic_cb) {
-                // Execute the registered logic
-                c->logic_cb(temp_buf, read, c->ctx);
-            }
-        } else {
-            // Prevent CPU spin
-            usleep(1000); 
-        }
+        uint64_t seen = consumer_wake_seq(c->wake);
+        // Sleep until the producer pushes instead of spinning
+        if (!consumer_poll(c)) consumer_wait(c->wake, seen, 1000);
     }
-    
-    free(temp_buf);
+
     printf("[%s] Thread Stopped\n", c->name);
     return NULL;
 }
 
 void consumer_init(Consumer_t *c, const char *name, size_t buf_size, consumer_logic_fn cb, void *ctx) {
+    memset(c, 0, sizeof(*c));
     strncpy(c->name, name, 31);
     rb_init(&c->rb, buf_size);
     c->logic_cb = cb;
     c->ctx = ctx;
     c->running = 0;
     c->chunk_process_size = 4096; // Default processing block
+    c->policy = CONSUMER_DROP;
+    consumer_wake_init(&c->own_wake);
+    c->wake = &c->own_wake;
 }
 
 void consumer_start(Consumer_t *c) {
     if (c->running) return;
     c->running = 1;
-    pthread_create(&c->thread, NULL, consumer_worker, c);
+    if (pthread_create(&c->thread, NULL, consumer_worker, c) != 0) {
+        c->running = 0;
+        return;
+    }
+    c->own_thread = 1;
 }
 
 void consumer_stop(Consumer_t *c) {
     c->running = 0;
-    pthread_join(c->thread, NULL);
+    consumer_notify(c->wake);   // releases a worker or a blocked producer
+    if (c->own_thread) {
+        pthread_join(c->thread, NULL);
+        c->own_thread = 0;
+    }
     rb_free(&c->rb);
+    free(c->temp_buf);
+    c->temp_buf = NULL;
+    consumer_wake_destroy(&c->own_wake);
 }
 
 void consumer_push_chunk(Consumer_t *c, const uint8_t *data, size_t len) {
     if (!c->running) return;
-    // Push data into the consumer's private ring buffer
-    // If buffer is full, this drops data (real-time behavior)
-    rb_write(&c->rb, data, len); 
-}
\ No newline at end of file
+
+    if (c->policy == CONSUMER_DROP) {
+        // All or nothing: a partial chunk would misalign every item after it
+        if (rb_space(&c->rb) < len) {
+            c->bytes_dropped += len;
+            return;
+        }
+        rb_write(&c->rb, data, len);
+        c->bytes_in += len;
+        consumer_notify(c->wake);
+        return;
+    }
+
+    // CONSUMER_BLOCK: wait for room, in pieces no larger than the ring
+    size_t off = 0;
+    while (off < len && c->running) {
+        size_t piece = len - off;
+        if (piece > c->rb.size) piece = c->rb.size;
+
+        uint64_t seen = consumer_wake_seq(c->wake);
+        if (rb_space(&c->rb) < piece) {
+            uint64_t t0 = mono_ns();
+            consumer_wait(c->wake, seen, 1000);
+            c->block_ns += mono_ns() - t0;
+            continue;
+        }
+        rb_write(&c->rb, data + off, piece);
+        c->bytes_in += piece;
+        off += piece;
+        consumer_notify(c->wake);
+    }
+}
+
+void consumer_get_stats(Consumer_t *c, consumer_stats_t *out) {
+    memset(out, 0, sizeof(*out));
+    if (!c) return;
+    out->bytes_in = c->bytes_in;
+    out->bytes_dropped = c->bytes_dropped;
+    out->chunks = c->chunks;
+    out->busy_ns = c->busy_ns;
+    out->block_ns = c->block_ns;
+    out->depth = rb_available(&c->rb);
+    out->depth_max = c->depth_max;
+    out->capacity = c->rb.size;
+}
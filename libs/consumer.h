@@ -12,16 +12,54 @@
 // Function pointer for the specific logic (FM, CSV, etc.)
 typedef void (*consumer_logic_fn)(const uint8_t *data, size_t len, void *ctx);
 
+// What consumer_push_chunk does when the ring cannot take the whole chunk
+typedef enum {
+    CONSUMER_DROP = 0,          // drop the chunk (real-time behavior, never stalls the producer)
+    CONSUMER_BLOCK              // wait for space (back-pressure up the chain)
+} consumer_policy_t;
+
+// Wakeup shared by everything one thread serves (its own by default)
+typedef struct {
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    uint64_t seq;               // bumped on every push / read
+} consumer_wake_t;
+
+typedef struct {
+    uint64_t bytes_in;          // accepted into the ring
+    uint64_t bytes_dropped;     // CONSUMER_DROP: chunks that did not fit
+    uint64_t chunks;            // logic_cb calls
+    uint64_t busy_ns;           // time inside logic_cb
+    uint64_t block_ns;          // CONSUMER_BLOCK: producer time spent waiting for space
+    size_t depth;               // bytes queued now
+    size_t depth_max;
+    size_t capacity;
+} consumer_stats_t;
+
 typedef struct {
     char name[32];
     ring_buffer_t rb;
     pthread_t thread;
+    int own_thread;             // consumer_start created thread (not a scheduler)
     volatile int running;
-    
+
     consumer_logic_fn logic_cb; // The callback
     void *ctx;                  // User data (File handle, PortAudio stream, etc.)
-    
+
     size_t chunk_process_size;  // How many bytes to pull per loop
+    consumer_policy_t policy;
+
+    consumer_wake_t own_wake;
+    consumer_wake_t *wake;      // &own_wake unless a scheduler thread serves several consumers
+    uint8_t *temp_buf;
+
+    // Counters (written by the producer / worker, read by consumer_get_stats)
+    volatile uint64_t bytes_in;
+    volatile uint64_t bytes_dropped;
+    volatile uint64_t chunks;
+    volatile uint64_t busy_ns;
+    volatile uint64_t block_ns;
+    volatile size_t depth_max;
 } Consumer_t;
 
 void consumer_init(Consumer_t *c, const char *name, size_t buf_size, consumer_logic_fn cb, void *ctx);
@@ -29,4 +67,23 @@ void consumer_start(Consumer_t *c);
 void consumer_stop(Consumer_t *c);
 void consumer_push_chunk(Consumer_t *c, const uint8_t *data, size_t len);
 
-#endif
\ No newline at end of file
+/**
+ * @brief Runs logic_cb on one chunk if a full chunk_process_size is queued. For threads that
+ * serve several consumers (set c->wake to a shared consumer_wake_t and running before polling).
+ * @return 1 if a chunk was processed, 0 if there was nothing to do.
+ */
+int consumer_poll(Consumer_t *c);
+
+/**
+ * @brief Sleeps until something is pushed to or read from a consumer using w, or timeout_us passes.
+ */
+void consumer_wait(consumer_wake_t *w, uint64_t seen_seq, int timeout_us);
+
+void consumer_wake_init(consumer_wake_t *w);
+void consumer_wake_destroy(consumer_wake_t *w);
+void consumer_notify(consumer_wake_t *w);
+uint64_t consumer_wake_seq(consumer_wake_t *w);     // read before polling, pass to consumer_wait
+
+void consumer_get_stats(Consumer_t *c, consumer_stats_t *out);
+
+#endif
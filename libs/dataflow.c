@@ -0,0 +1,447 @@
+// libs/dataflow.c
+#include "dataflow.h"
+#include "utils.h"
+#include "rt_policy.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+
+typedef struct {
+    char name[DF_NAME_LEN];
+    df_graph_t *graph;
+    pthread_t thread;
+    bool created;
+    volatile int running;
+    consumer_wake_t wake;       // shared by every member ring
+    df_block_t *members[DF_MAX_BLOCKS];
+    int n_members;
+    cpu_set_t cpus;
+    bool pinned;
+    volatile uint64_t rounds;   // scheduler passes
+} df_thread_t;
+
+struct df_graph {
+    df_block_t *blocks[DF_MAX_BLOCKS];
+    int n_blocks;
+    df_thread_t threads[DF_MAX_THREADS];
+    int n_threads;
+    df_format_t tap;
+    bool has_tap;
+    bool started;
+    df_publish_fn publish;
+    void *publish_ctx;
+    uint64_t stats_ns;          // start of the current stats window
+};
+
+static uint64_t mono_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+const char* df_type_name(df_type_t t) {
+    switch (t) {
+    case DF_IQ_S8:   return "iq_s8";
+    case DF_IQ_F32:  return "iq_f32";
+    case DF_PCM_S16: return "pcm_s16";
+    case DF_PSD_F64: return "psd_f64";
+    case DF_NONE:    return "none";
+    default:         return "any";
+    }
+}
+
+size_t df_item_bytes(const df_format_t *f) {
+    switch (f->type) {
+    case DF_IQ_S8:   return 2;
+    case DF_IQ_F32:  return 2 * sizeof(float);
+    case DF_PCM_S16: return (size_t)(f->channels > 0 ? f->channels : 1) * sizeof(int16_t);
+    case DF_PSD_F64: return (size_t)f->bins * sizeof(double);
+    default:         return 1;
+    }
+}
+
+// =========================================================
+// DATA PATH
+void df_emit(df_block_t *b, const void *data, size_t len) {
+    if (!b || !data || len == 0) return;
+    for (int i = 0; i < b->n_outs; i++) consumer_push_chunk(&b->outs[i]->in, (const uint8_t*)data, len);
+    b->bytes_out += len;
+}
+
+void df_publish(df_block_t *b, const char *json) {
+    df_graph_t *g = b->graph;
+    if (g->publish && json) g->publish(b->name, json, g->publish_ctx);
+}
+
+void df_graph_push(df_graph_t *g, const uint8_t *data, size_t len) {
+    if (!g || !g->started) return;
+    for (int i = 0; i < g->n_blocks; i++) {
+        df_block_t *b = g->blocks[i];
+        if (strcmp(b->ops->kind, "tap") == 0) df_emit(b, data, len);
+    }
+}
+
+static void block_logic(const uint8_t *data, size_t len, void *ctx) {
+    df_block_t *b = (df_block_t*)ctx;
+    b->ops->process(b, data, len);
+}
+
+/** Scheduler: one pass polls every member once; sleeps only when a whole pass found nothing. */
+static void* df_thread_fn(void *arg) {
+    df_thread_t *t = (df_thread_t*)arg;
+
+    if (t->pinned && pthread_setaffinity_np(pthread_self(), sizeof(t->cpus), &t->cpus) != 0) {
+        fprintf(stderr, "[DF] Warning: thread '%s' could not be pinned\n", t->name);
+    }
+    char tname[16] = "df:";      // kernel limit: 15 characters
+    size_t n = strlen(t->name);
+    if (n > sizeof(tname) - 4) n = sizeof(tname) - 4;
+    memcpy(tname + 3, t->name, n);
+    tname[3 + n] = '\0';
+    pthread_setname_np(pthread_self(), tname);
+    rt_policy_apply("graph", tname);     // an RT_POLICY entry wins over the graph's "cpus"
+
+    while (t->running) {
+        uint64_t seen = consumer_wake_seq(&t->wake);
+        int worked = 0;
+        for (int i = 0; i < t->n_members; i++) worked |= consumer_poll(&t->members[i]->in);
+        t->rounds++;
+        if (!worked) consumer_wait(&t->wake, seen, 1000);
+    }
+    return NULL;
+}
+
+// =========================================================
+// CONSTRUCTION
+static df_thread_t* thread_named(df_graph_t *g, const char *name) {
+    for (int i = 0; i < g->n_threads; i++) {
+        if (strcmp(g->threads[i].name, name) == 0) return &g->threads[i];
+    }
+    if (g->n_threads >= DF_MAX_THREADS) return NULL;
+    df_thread_t *t = &g->threads[g->n_threads++];
+    snprintf(t->name, sizeof(t->name), "%s", name);
+    t->graph = g;
+    consumer_wake_init(&t->wake);
+    return t;
+}
+
+static df_block_t* block_named(df_graph_t *g, const char *name) {
+    for (int i = 0; i < g->n_blocks; i++) {
+        if (strcmp(g->blocks[i]->name, name) == 0) return g->blocks[i];
+    }
+    return NULL;
+}
+
+static const char* json_str(const cJSON *o, const char *key) {
+    const cJSON *v = cJSON_GetObjectItemCaseSensitive(o, key);
+    return (cJSON_IsString(v) && v->valuestring) ? v->valuestring : NULL;
+}
+
+static int add_block(df_graph_t *g, const cJSON *spec, char *err, size_t err_len) {
+    const char *name = json_str(spec, "name");
+    const char *kind = json_str(spec, "type");
+    if (!name || !*name || strlen(name) >= DF_NAME_LEN) {
+        snprintf(err, err_len, "block %d: missing or long \"name\"", g->n_blocks);
+        return -1;
+    }
+    if (block_named(g, name)) {
+        snprintf(err, err_len, "%s: duplicate name", name);
+        return -1;
+    }
+    const df_ops_t *ops = kind ? df_ops_for(kind) : NULL;
+    if (!ops) {
+        snprintf(err, err_len, "%s: unknown type '%s'", name, kind ? kind : "");
+        return -1;
+    }
+
+    df_block_t *up = NULL;
+    df_format_t in_fmt = {0};
+    const char *input = json_str(spec, "input");
+    if (ops->source) {
+        if (input) {
+            snprintf(err, err_len, "%s: a %s source takes no input", name, kind);
+            return -1;
+        }
+        if (strcmp(kind, "tap") == 0) {
+            if (!g->has_tap) {
+                snprintf(err, err_len, "%s: no device stream to tap here", name);
+                return -1;
+            }
+            in_fmt = g->tap;
+        }
+    } else {
+        up = input ? block_named(g, input) : NULL;
+        if (!up) {
+            snprintf(err, err_len, "%s: input '%s' is not an earlier block", name, input ? input : "");
+            return -1;
+        }
+        if (up->out_fmt.type == DF_NONE || up->n_outs >= DF_MAX_OUTPUTS) {
+            snprintf(err, err_len, "%s: '%s' has no output to spare", name, input);
+            return -1;
+        }
+        if (ops->in != DF_ANY && ops->in != up->out_fmt.type) {
+            snprintf(err, err_len, "%s: takes %s, '%s' produces %s", name, df_type_name(ops->in),
+                     input, df_type_name(up->out_fmt.type));
+            return -1;
+        }
+        in_fmt = up->out_fmt;
+    }
+
+    // Ring policy and scheduler thread (non-sources), checked before anything is built
+    const char *policy = json_str(spec, "policy");
+    bool blocking = policy && strcmp(policy, "block") == 0;
+    if (policy && !blocking && strcmp(policy, "drop") != 0) {
+        snprintf(err, err_len, "%s: policy is \"drop\" or \"block\"", name);
+        return -1;
+    }
+    df_thread_t *t = NULL;
+    if (!ops->source) {
+        const char *tname = json_str(spec, "thread");
+        t = thread_named(g, tname ? tname : name);
+        if (!t || t->n_members >= DF_MAX_BLOCKS) {
+            snprintf(err, err_len, "%s: too many threads", name);
+            return -1;
+        }
+        // A source pushes from the engine's rx_callback (libusb thread, graph_lock held) or
+        // its own producer: waiting there would stall acquisition for every consumer
+        if (blocking && up->ops->source) {
+            snprintf(err, err_len, "%s: \"block\" is not allowed on a block fed by source '%s' (use \"drop\")",
+                     name, up->name);
+            return -1;
+        }
+        // A blocking push into a ring served by the pushing thread itself never drains
+        if (blocking && up->thread >= 0 && &g->threads[up->thread] == t) {
+            snprintf(err, err_len, "%s: \"block\" needs a thread other than its input's ('%s')", name, t->name);
+            return -1;
+        }
+    }
+
+    df_block_t *b = (df_block_t*)calloc(1, sizeof(df_block_t));
+    if (!b) return -1;
+    snprintf(b->name, sizeof(b->name), "%s", name);
+    b->ops = ops;
+    b->graph = g;
+    b->in_fmt = in_fmt;
+    b->thread = -1;
+
+    char berr[160] = {0};
+    if (ops->init(b, spec, &in_fmt, &b->out_fmt, berr, sizeof(berr)) != 0) {
+        snprintf(err, err_len, "%s: %s", name, berr[0] ? berr : "init failed");
+        free(b);
+        return -1;
+    }
+
+    if (!ops->source) {
+        size_t item = df_item_bytes(&in_fmt);
+        if (b->chunk == 0) b->chunk = item * 4096;
+        b->chunk -= b->chunk % item;
+        if (b->chunk == 0) b->chunk = item;
+
+        const cJSON *qb = cJSON_GetObjectItemCaseSensitive(spec, "queue_bytes");
+        size_t queue = cJSON_IsNumber(qb) && qb->valuedouble > 0 ? (size_t)qb->valuedouble : DF_QUEUE_DEFAULT;
+        if (queue < DF_QUEUE_CHUNKS_MIN * b->chunk) queue = DF_QUEUE_CHUNKS_MIN * b->chunk;
+
+        consumer_init(&b->in, name, queue, block_logic, b);
+        b->in.chunk_process_size = b->chunk;
+        b->in.policy = blocking ? CONSUMER_BLOCK : CONSUMER_DROP;
+        b->in.wake = &t->wake;
+        b->thread = (int)(t - g->threads);
+        t->members[t->n_members++] = b;
+        up->outs[up->n_outs++] = b;
+    }
+    g->blocks[g->n_blocks++] = b;
+    return 0;
+}
+
+df_graph_t* df_graph_from_json(const cJSON *spec, const df_format_t *tap, char *err, size_t err_len) {
+    const cJSON *blocks = spec ? cJSON_GetObjectItemCaseSensitive(spec, "blocks") : NULL;
+    if (!cJSON_IsArray(blocks) || cJSON_GetArraySize(blocks) == 0) {
+        snprintf(err, err_len, "\"blocks\" must be a non-empty array");
+        return NULL;
+    }
+    if (cJSON_GetArraySize(blocks) > DF_MAX_BLOCKS) {
+        snprintf(err, err_len, "more than %d blocks", DF_MAX_BLOCKS);
+        return NULL;
+    }
+
+    df_graph_t *g = (df_graph_t*)calloc(1, sizeof(df_graph_t));
+    if (!g) return NULL;
+    if (tap) {
+        g->tap = *tap;
+        g->has_tap = true;
+    }
+
+    const cJSON *bs;
+    cJSON_ArrayForEach(bs, blocks) {
+        if (add_block(g, bs, err, err_len) != 0) {
+            df_graph_destroy(g);
+            return NULL;
+        }
+    }
+
+    // "threads": {"dsp": {"cpus": "2-3"}}
+    const cJSON *threads = cJSON_GetObjectItemCaseSensitive(spec, "threads");
+    const cJSON *ts;
+    cJSON_ArrayForEach(ts, threads) {
+        df_thread_t *t = NULL;
+        for (int i = 0; i < g->n_threads; i++) {
+            if (strcmp(g->threads[i].name, ts->string) == 0) t = &g->threads[i];
+        }
+        const char *cpus = json_str(ts, "cpus");
+        if (!t || !cpus) {
+            snprintf(err, err_len, "threads.%s: %s", ts->string, !t ? "no block runs on it" : "missing \"cpus\"");
+            df_graph_destroy(g);
+            return NULL;
+        }
+        if (parse_cpu_list(cpus, &t->cpus) <= 0) {
+            snprintf(err, err_len, "threads.%s: bad cpu list '%s'", ts->string, cpus);
+            df_graph_destroy(g);
+            return NULL;
+        }
+        t->pinned = true;
+    }
+    return g;
+}
+
+void df_graph_set_publish(df_graph_t *g, df_publish_fn fn, void *ctx) {
+    if (!g) return;
+    g->publish = fn;
+    g->publish_ctx = ctx;
+}
+
+// =========================================================
+// LIFECYCLE
+static void stop_all(df_graph_t *g) {
+    // Sources first, then release every ring (unblocks CONSUMER_BLOCK pushers), then the threads
+    for (int i = 0; i < g->n_blocks; i++) {
+        df_block_t *b = g->blocks[i];
+        if (b->ops->source && b->ops->stop) b->ops->stop(b);
+    }
+    g->started = false;
+    for (int i = 0; i < g->n_blocks; i++) {
+        df_block_t *b = g->blocks[i];
+        if (b->ops->source) continue;
+        b->in.running = 0;
+        consumer_notify(b->in.wake);
+    }
+    for (int i = 0; i < g->n_threads; i++) {
+        df_thread_t *t = &g->threads[i];
+        t->running = 0;
+        consumer_notify(&t->wake);
+        if (t->created) pthread_join(t->thread, NULL);
+        t->created = false;
+    }
+}
+
+int df_graph_start(df_graph_t *g) {
+    if (!g || g->started) return -1;
+
+    for (int i = 0; i < g->n_blocks; i++) {
+        if (!g->blocks[i]->ops->source) g->blocks[i]->in.running = 1;
+    }
+    for (int i = 0; i < g->n_threads; i++) {
+        df_thread_t *t = &g->threads[i];
+        t->running = 1;
+        if (pthread_create(&t->thread, NULL, df_thread_fn, t) != 0) {
+            fprintf(stderr, "[DF] Error: cannot start thread '%s'\n", t->name);
+            stop_all(g);
+            return -1;
+        }
+        t->created = true;
+    }
+
+    g->started = true;
+    g->stats_ns = mono_ns();
+    for (int i = 0; i < g->n_blocks; i++) {
+        df_block_t *b = g->blocks[i];
+        if (b->ops->source && b->ops->start && b->ops->start(b) != 0) {
+            fprintf(stderr, "[DF] Error: source '%s' did not start\n", b->name);
+            stop_all(g);
+            return -1;
+        }
+    }
+
+    printf("[DF] Graph started: %d blocks on %d threads\n", g->n_blocks, g->n_threads);
+    for (int i = 0; i < g->n_blocks; i++) {
+        df_block_t *b = g->blocks[i];
+        printf("[DF]   %-12s %-8s %-8s -> %-8s", b->name, b->ops->kind,
+               b->ops->source ? "-" : df_type_name(b->in_fmt.type), df_type_name(b->out_fmt.type));
+        if (b->ops->source) printf(" (source)\n");
+        else printf(" thread %-10s ring %zu KiB, %s\n", g->threads[b->thread].name, b->in.rb.size / 1024,
+                    b->in.policy == CONSUMER_BLOCK ? "block" : "drop");
+    }
+    return 0;
+}
+
+void df_graph_destroy(df_graph_t *g) {
+    if (!g) return;
+    stop_all(g);
+    for (int i = 0; i < g->n_blocks; i++) {
+        df_block_t *b = g->blocks[i];
+        if (!b->ops->source) consumer_stop(&b->in);
+        if (b->ops->release) b->ops->release(b);
+        free(b);
+    }
+    for (int i = 0; i < g->n_threads; i++) consumer_wake_destroy(&g->threads[i].wake);
+    free(g);
+}
+
+// =========================================================
+// STATS
+cJSON* df_graph_stats_json(df_graph_t *g) {
+    if (!g) return NULL;
+    uint64_t now = mono_ns();
+    double window_s = (double)(now - g->stats_ns) * 1e-9;
+    if (window_s <= 0.0) window_s = 1e-9;
+    g->stats_ns = now;
+
+    cJSON *root = cJSON_CreateObject();
+    cJSON_AddNumberToObject(root, "window_s", window_s);
+    cJSON *arr = cJSON_AddArrayToObject(root, "blocks");
+
+    for (int i = 0; i < g->n_blocks; i++) {
+        df_block_t *b = g->blocks[i];
+        cJSON *o = cJSON_CreateObject();
+        cJSON_AddStringToObject(o, "name", b->name);
+        cJSON_AddStringToObject(o, "type", b->ops->kind);
+        cJSON_AddStringToObject(o, "out", df_type_name(b->out_fmt.type));
+
+        uint64_t out = b->bytes_out;
+        double out_item = (double)df_item_bytes(&b->out_fmt);
+        cJSON_AddNumberToObject(o, "out_items_s", (double)(out - b->prev_out) / out_item / window_s);
+        b->prev_out = out;
+
+        if (!b->ops->source) {
+            consumer_stats_t cs;
+            consumer_get_stats(&b->in, &cs);
+            double in_item = (double)df_item_bytes(&b->in_fmt);
+            cJSON_AddStringToObject(o, "thread", g->threads[b->thread].name);
+            cJSON_AddNumberToObject(o, "in_items_s", (double)(cs.bytes_in - b->prev_in) / in_item / window_s);
+            cJSON_AddNumberToObject(o, "busy_pct", 100.0 * 1e-9 * (double)(cs.busy_ns - b->prev_busy_ns) / window_s);
+            cJSON_AddNumberToObject(o, "queue_bytes", (double)cs.depth);
+            cJSON_AddNumberToObject(o, "queue_max", (double)cs.depth_max);
+            cJSON_AddNumberToObject(o, "queue_fill_pct", cs.capacity ? 100.0 * (double)cs.depth / (double)cs.capacity : 0.0);
+            cJSON_AddStringToObject(o, "policy", b->in.policy == CONSUMER_BLOCK ? "block" : "drop");
+            cJSON_AddNumberToObject(o, "dropped_bytes", (double)cs.bytes_dropped);
+            cJSON_AddNumberToObject(o, "blocked_ms", 1e-6 * (double)(cs.block_ns - b->prev_block_ns));
+            b->prev_in = cs.bytes_in;
+            b->prev_busy_ns = cs.busy_ns;
+            b->prev_block_ns = cs.block_ns;
+        }
+        cJSON_AddItemToArray(arr, o);
+    }
+
+    cJSON *tarr = cJSON_AddArrayToObject(root, "threads");
+    for (int i = 0; i < g->n_threads; i++) {
+        df_thread_t *t = &g->threads[i];
+        cJSON *o = cJSON_CreateObject();
+        cJSON_AddStringToObject(o, "name", t->name);
+        cJSON_AddBoolToObject(o, "pinned", t->pinned);
+        cJSON *m = cJSON_AddArrayToObject(o, "blocks");
+        for (int k = 0; k < t->n_members; k++) cJSON_AddItemToArray(m, cJSON_CreateString(t->members[k]->name));
+        cJSON_AddItemToArray(tarr, o);
+    }
+    return root;
+}
@@ -0,0 +1,144 @@
+// libs/dataflow.h
+#ifndef DATAFLOW_H
+#define DATAFLOW_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <sched.h>
+#include <cjson/cJSON.h>
+#include "consumer.h"
+
+// --- Dataflow graph: typed blocks joined by Consumer_t rings, served by scheduler threads ---
+//
+// {"blocks":[
+//    {"name":"src", "type":"tap"},                                   // IQ from the engine's device
+//    {"name":"ch",  "type":"ddc",   "input":"src", "offset_hz":-250000, "mode":"nfm"},
+//    {"name":"dem", "type":"demod", "input":"ch",  "mode":"nfm", "thread":"dsp"},
+//    {"name":"enc", "type":"encoder", "input":"dem", "port":9100, "policy":"block"},
+//    {"name":"psd", "type":"psd",   "input":"src", "rbw_hz":1000, "thread":"dsp"},
+//    {"name":"out", "type":"sink",  "input":"psd", "to":"publish"}],
+//  "threads":{"dsp":{"cpus":"2-3"}}}
+//
+// Every block but a source owns an input ring ("queue_bytes", "policy": "drop" | "block").
+// "block" is rejected on blocks fed directly by a source: sources must never wait.
+// Blocks naming the same "thread" share one scheduler thread; the rest get one each.
+// A block's input must be declared before it, so the list is already in topological order.
+
+#define DF_MAX_BLOCKS       32
+#define DF_MAX_OUTPUTS      8
+#define DF_MAX_THREADS      DF_MAX_BLOCKS
+#define DF_NAME_LEN         32
+#define DF_QUEUE_DEFAULT    (4 * 1024 * 1024)
+#define DF_QUEUE_CHUNKS_MIN 2           // a ring holds at least this many input chunks
+
+typedef enum {
+    DF_ANY = 0,                 // sinks that take whatever arrives
+    DF_IQ_S8,                   // interleaved int8 I/Q (HackRF wire format)
+    DF_IQ_F32,                  // interleaved float I/Q, unit full scale
+    DF_PCM_S16,                 // interleaved int16 PCM
+    DF_PSD_F64,                 // one frame = bins doubles, fftshifted (lowest frequency first)
+    DF_NONE                     // terminal blocks produce nothing
+} df_type_t;
+
+typedef struct {
+    df_type_t type;
+    double fs;                  // items per second: IQ pairs, PCM frames, PSD frames
+    double center_hz;           // IQ: absolute frequency of the stream center
+    double start_hz;            // PSD: absolute frequency of the first bin
+    double bin_hz;              // PSD: bin spacing
+    int channels;               // PCM channels
+    int bins;                   // PSD bins per frame
+} df_format_t;
+
+typedef struct df_block df_block_t;
+typedef struct df_graph df_graph_t;
+
+typedef struct {
+    const char *kind;           // JSON "type"
+    df_type_t in;               // accepted input (ignored for sources)
+    bool source;
+    /**
+     * Builds the block from its JSON entry. Sets out and b->chunk (bytes per process call).
+     * @return 0 on success, -1 with a message in err.
+     */
+    int  (*init)(df_block_t *b, const cJSON *spec, const df_format_t *in, df_format_t *out, char *err, size_t err_len);
+    void (*process)(df_block_t *b, const uint8_t *data, size_t len);
+    int  (*start)(df_block_t *b);       // optional: sources that run their own producer
+    void (*stop)(df_block_t *b);
+    void (*release)(df_block_t *b);
+} df_ops_t;
+
+struct df_block {
+    char name[DF_NAME_LEN];
+    const df_ops_t *ops;
+    df_graph_t *graph;
+    df_format_t in_fmt;
+    df_format_t out_fmt;
+
+    Consumer_t in;              // input ring (unused by sources)
+    size_t chunk;               // bytes handed to process at once
+    int thread;                 // scheduler thread index (-1 for sources)
+
+    df_block_t *outs[DF_MAX_OUTPUTS];
+    int n_outs;
+
+    void *state;                // owned by the block ops
+
+    volatile uint64_t bytes_out;
+    uint64_t prev_in, prev_out, prev_busy_ns, prev_block_ns;    // last stats window
+};
+
+/**
+ * @brief Hands len bytes (whole items of b->out_fmt) to every downstream block, applying
+ * each one's policy. Called from process or a source's producer thread.
+ */
+void df_emit(df_block_t *b, const void *data, size_t len);
+
+/**
+ * @brief Sends a JSON message through the graph's publish hook (no-op without one).
+ */
+void df_publish(df_block_t *b, const char *json);
+
+/**
+ * @brief Block implementation for a JSON "type" (df_blocks.c). NULL if unknown.
+ */
+const df_ops_t* df_ops_for(const char *kind);
+
+const char* df_type_name(df_type_t t);
+size_t df_item_bytes(const df_format_t *f);
+
+typedef void (*df_publish_fn)(const char *block, const char *json, void *ctx);
+
+/**
+ * @brief Builds (does not start) a graph. tap is the format df_graph_push delivers to
+ * "tap" sources (NULL = graph without taps).
+ * @return NULL with a message in err on a bad spec.
+ */
+df_graph_t* df_graph_from_json(const cJSON *spec, const df_format_t *tap, char *err, size_t err_len);
+
+void df_graph_set_publish(df_graph_t *g, df_publish_fn fn, void *ctx);
+
+/**
+ * @brief Starts the scheduler threads, then the sources.
+ * @return 0 on success, -1 on error (graph left stopped).
+ */
+int df_graph_start(df_graph_t *g);
+
+/**
+ * @brief Feeds int8 IQ to every "tap" source (the engine's rx_callback).
+ */
+void df_graph_push(df_graph_t *g, const uint8_t *data, size_t len);
+
+/**
+ * @brief Per-block throughput, queue depth and busy share since the previous call, per-thread
+ * membership. Caller owns the result.
+ */
+cJSON* df_graph_stats_json(df_graph_t *g);
+
+/**
+ * @brief Stops sources, then threads, and frees everything.
+ */
+void df_graph_destroy(df_graph_t *g);
+
+#endif
@@ -42,8 +42,11 @@ typedef struct {
 typedef enum {
     REALTIME_MODE,
     CAMPAIGN_MODE,
-    FM_MODE,
-    AM_MODE
+    FM_MODE,        // broadcast (wide) FM
+    AM_MODE,
+    NFM_MODE,       // narrowband FM (voice, 12.5 kHz channels)
+    USB_MODE,
+    LSB_MODE
 } rf_mode_t;
 
 // --- Demodulation Config ---
@@ -70,6 +73,7 @@ typedef struct {
     PsdWindowType_t window_type;
     char *scale;    // Will be stored in lowercase
     int ppm_error;
+    uint64_t seq;   // optional "seq": echoed in the PSD frame computed with this config (0 = none)
 } DesiredCfg_t;
 
 // --- Buffer Configuration ---
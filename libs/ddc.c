@@ -0,0 +1,154 @@
+// libs/ddc.c
+#include "ddc.h"
+#include <string.h>
+#include <stdio.h>
+#include <math.h>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+static uint32_t offset_to_phase_inc(double fs, double offset_hz) {
+    // Negative rotation brings +offset down to 0 Hz
+    double turns = -offset_hz / fs;
+    turns -= floor(turns);
+    return (uint32_t)llround(turns * 4294967296.0);
+}
+
+/**
+ * @brief Common part of both constructors: clears state, fills the NCO table, sets the offset.
+ */
+static void ddc_setup_nco(ddc_t *ddc, double fs_in, double offset_hz, double bw_hz) {
+    memset(ddc, 0, sizeof(*ddc));
+    ddc->fs_in = fs_in;
+    ddc->bw_hz = bw_hz;
+
+    for (int i = 0; i < DDC_NCO_SIZE; i++) {
+        double ph = 2.0 * M_PI * (double)i / (double)DDC_NCO_SIZE;
+        ddc->nco_cos[i] = (float)cos(ph);
+        ddc->nco_sin[i] = (float)sin(ph);
+    }
+    ddc_retune(ddc, offset_hz);
+}
+
+int ddc_init(ddc_t *ddc, double fs_in, double offset_hz, double bw_hz) {
+    if (!ddc || fs_in <= 0.0) return -1;
+
+    if (bw_hz <= 0.0) bw_hz = DDC_DEFAULT_BW_HZ;
+    if (bw_hz > fs_in) bw_hz = fs_in;
+    ddc_setup_nco(ddc, fs_in, offset_hz, bw_hz);
+
+    ddc->decim = (int)floor(fs_in / (DDC_OVERSAMPLE * bw_hz));
+    if (ddc->decim < 1) ddc->decim = 1;
+    ddc->fs_out = fs_in / (double)ddc->decim;
+
+    if (resampler_init(&ddc->rs, fs_in, ddc->fs_out, 2, 0.5 * bw_hz) != 0) return -1;
+
+    printf("[DDC] fs=%.0f Hz | offset=%.0f Hz | bw=%.0f Hz | D=%d -> %.0f Hz\n",
+           fs_in, ddc->offset_hz, bw_hz, ddc->decim, ddc->fs_out);
+    return 0;
+}
+
+int ddc_init_rate(ddc_t *ddc, double fs_in, double offset_hz, double bw_hz, double fs_out) {
+    if (!ddc || fs_in <= 0.0 || fs_out <= 0.0 || fs_out > fs_in) return -1;
+
+    if (bw_hz <= 0.0) bw_hz = DDC_DEFAULT_BW_HZ;
+    if (bw_hz > fs_out) bw_hz = fs_out;
+    ddc_setup_nco(ddc, fs_in, offset_hz, bw_hz);
+
+    if (resampler_init(&ddc->rs, fs_in, fs_out, 2, 0.5 * bw_hz) != 0) return -1;
+    ddc->fs_out = ddc->rs.fs_out;
+    ddc->decim = (int)lround(fs_in / ddc->fs_out);
+
+    printf("[DDC] fs=%.0f Hz | offset=%.0f Hz | bw=%.0f Hz | rational -> %.0f Hz\n",
+           fs_in, ddc->offset_hz, bw_hz, ddc->fs_out);
+    return 0;
+}
+
+void ddc_retune(ddc_t *ddc, double offset_hz) {
+    if (!ddc) return;
+    ddc->offset_hz = offset_hz;
+    ddc->phase_inc = offset_to_phase_inc(ddc->fs_in, offset_hz);
+}
+
+void ddc_free(ddc_t *ddc) {
+    if (!ddc) return;
+    resampler_free(&ddc->rs);
+}
+
+int ddc_max_output(const ddc_t *ddc, size_t n_in) {
+    if (!ddc) return 0;
+    int out = 0;
+    // process() works in DDC_BLOCK pieces; bound each piece separately
+    while (n_in > 0) {
+        size_t n = (n_in > DDC_BLOCK) ? DDC_BLOCK : n_in;
+        out += resampler_max_output(&ddc->rs, (int)n);
+        n_in -= n;
+    }
+    return out;
+}
+
+int ddc_process_s8(ddc_t *ddc, const int8_t *iq, size_t n, float *out) {
+    if (!ddc || !iq || !out) return 0;
+
+    const float scale = 1.0f / 128.0f;
+    const int shift = 32 - DDC_NCO_BITS;
+    int n_out = 0;
+    size_t pos = 0;
+
+    while (pos < n) {
+        size_t blk = n - pos;
+        if (blk > DDC_BLOCK) blk = DDC_BLOCK;
+
+        // 1) NCO mix (table lookup, phase wraps naturally in uint32)
+        uint32_t phase = ddc->phase;
+        const int8_t *src = &iq[2 * pos];
+        for (size_t i = 0; i < blk; i++) {
+            uint32_t idx = phase >> shift;
+            float c = ddc->nco_cos[idx];
+            float s = ddc->nco_sin[idx];
+            float re = (float)src[2*i] * scale;
+            float im = (float)src[2*i + 1] * scale;
+            ddc->mix_buf[2*i]     = re * c - im * s;
+            ddc->mix_buf[2*i + 1] = re * s + im * c;
+            phase += ddc->phase_inc;
+        }
+        ddc->phase = phase;
+        pos += blk;
+
+        // 2) channel filter + decimation
+        n_out += resampler_process(&ddc->rs, ddc->mix_buf, (int)blk, &out[2 * n_out]);
+    }
+
+    return n_out;
+}
+
+int ddc_process_cf32(ddc_t *ddc, const float *iq, size_t n, float *out) {
+    if (!ddc || !iq || !out) return 0;
+
+    const int shift = 32 - DDC_NCO_BITS;
+    int n_out = 0;
+    size_t pos = 0;
+
+    while (pos < n) {
+        size_t blk = n - pos;
+        if (blk > DDC_BLOCK) blk = DDC_BLOCK;
+
+        uint32_t phase = ddc->phase;
+        const float *src = &iq[2 * pos];
+        for (size_t i = 0; i < blk; i++) {
+            uint32_t idx = phase >> shift;
+            float c = ddc->nco_cos[idx];
+            float s = ddc->nco_sin[idx];
+            ddc->mix_buf[2*i]     = src[2*i] * c - src[2*i + 1] * s;
+            ddc->mix_buf[2*i + 1] = src[2*i] * s + src[2*i + 1] * c;
+            phase += ddc->phase_inc;
+        }
+        ddc->phase = phase;
+        pos += blk;
+
+        n_out += resampler_process(&ddc->rs, ddc->mix_buf, (int)blk, &out[2 * n_out]);
+    }
+
+    return n_out;
+}
@@ -0,0 +1,70 @@
+// libs/ddc.h
+#ifndef DDC_H
+#define DDC_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "resampler.h"
+
+#define DDC_NCO_BITS      12
+#define DDC_NCO_SIZE      (1 << DDC_NCO_BITS)
+#define DDC_BLOCK         4096
+#define DDC_OVERSAMPLE    1.25      // fs_out >= 1.25 * channel bandwidth
+#define DDC_DEFAULT_BW_HZ 200000.0  // broadcast FM channel
+
+// --- Digital down-converter: NCO mix -> CIC + FIR channel filter -> fs_in / D ---
+typedef struct {
+    double fs_in;
+    double fs_out;
+    double offset_hz;       // channel center relative to the tuner center
+    double bw_hz;
+    int decim;              // nominal fs_in / fs_out
+
+    uint32_t phase;         // NCO phase accumulator (full 32-bit turn)
+    uint32_t phase_inc;
+
+    resampler_t rs;         // 2 channels (I/Q)
+    float nco_cos[DDC_NCO_SIZE];
+    float nco_sin[DDC_NCO_SIZE];
+    float mix_buf[2 * DDC_BLOCK];
+} ddc_t;
+
+/**
+ * @brief Builds the DDC for a channel at offset_hz with bandwidth bw_hz (<= 0 -> 200 kHz).
+ * The output rate is fs_in / D with D = floor(fs_in / (DDC_OVERSAMPLE * bw_hz)).
+ * @return 0 on success, -1 on error.
+ */
+int ddc_init(ddc_t *ddc, double fs_in, double offset_hz, double bw_hz);
+
+/**
+ * @brief Same as ddc_init with an explicit output rate (rational resampling), so
+ * narrowband modes land on a rate that divides the audio rate.
+ * @return 0 on success, -1 on error.
+ */
+int ddc_init_rate(ddc_t *ddc, double fs_in, double offset_hz, double bw_hz, double fs_out);
+
+/**
+ * @brief Moves the NCO to a new offset without touching filters or phase continuity.
+ */
+void ddc_retune(ddc_t *ddc, double offset_hz);
+
+void ddc_free(ddc_t *ddc);
+
+/**
+ * @brief Upper bound of IQ pairs produced for n_in input pairs.
+ */
+int ddc_max_output(const ddc_t *ddc, size_t n_in);
+
+/**
+ * @brief Mixes, filters and decimates interleaved int8 IQ.
+ * @param out Interleaved float I/Q at fs_out, unit full scale (int8 / 128).
+ * @return Number of IQ pairs written.
+ */
+int ddc_process_s8(ddc_t *ddc, const int8_t *iq, size_t n, float *out);
+
+/**
+ * @brief Same as ddc_process_s8 for interleaved float IQ (e.g. a channelizer output).
+ */
+int ddc_process_cf32(ddc_t *ddc, const float *iq, size_t n, float *out);
+
+#endif
@@ -0,0 +1,278 @@
+// libs/demod.c
+#include "demod.h"
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+
+#define NFM_DEVIATION_HZ   5000.0
+#define WFM_DEVIATION_HZ   75000.0
+#define AM_DEPTH_PCM       16000.0f    // PCM level for 100% modulation
+#define SSB_PEAK_PCM       20000.0f    // PCM level the SSB AGC holds peaks at
+#define AGC_ATTACK_S       0.005
+#define AGC_DECAY_S        0.300
+#define AM_CARRIER_TAU_S   0.100       // carrier tracker, well below the voice band
+#define DC_BLOCK_R         0.996f
+
+// =========================================================
+// Shared helpers
+// =========================================================
+
+static float tau_coef(double tau_s, int fs) {
+    return (float)(1.0 - exp(-1.0 / (tau_s * (double)fs)));
+}
+
+static void agc_init(demod_agc_t *agc, int audio_fs, double attack_s, double decay_s, float floor_level) {
+    agc->attack = tau_coef(attack_s, audio_fs);
+    agc->decay  = tau_coef(decay_s, audio_fs);
+    agc->floor  = floor_level;
+    agc->level  = floor_level;
+}
+
+static inline float agc_track(demod_agc_t *agc, float x) {
+    float coef = (x > agc->level) ? agc->attack : agc->decay;
+    agc->level += coef * (x - agc->level);
+    return (agc->level > agc->floor) ? agc->level : agc->floor;
+}
+
+static inline int16_t to_pcm(float v) {
+    if (v >  32767.0f) v =  32767.0f;
+    if (v < -32768.0f) v = -32768.0f;
+    return (int16_t)v;
+}
+
+/**
+ * @brief Resampler + block size so one pass never overruns audio_buf.
+ */
+static int rs_setup(demod_t *d, int channels, double passband_hz) {
+    if (resampler_init(&d->rs, d->fs, (double)d->audio_fs, channels, passband_hz) != 0) return -1;
+    d->block_in = DEMOD_BLOCK;
+    while (d->block_in > 1 &&
+           resampler_max_output(&d->rs, d->block_in) * channels > 2 * DEMOD_BLOCK) {
+        d->block_in /= 2;
+    }
+    return 0;
+}
+
+static void rs_release(demod_t *d) {
+    resampler_free(&d->rs);
+}
+
+// =========================================================
+// WFM / NFM (fm_radio chain)
+// =========================================================
+
+static int wfm_init(demod_t *d, double fs, int audio_fs) {
+    return fm_radio_init(&d->fm, fs, audio_fs, 75);
+}
+
+static int nfm_init(demod_t *d, double fs, int audio_fs) {
+    // No de-emphasis; voice band low-pass; same PCM level per % deviation as WFM
+    if (fm_radio_init(&d->fm, fs, audio_fs, 0) != 0) return -1;
+    d->fm.gain *= (float)(WFM_DEVIATION_HZ / NFM_DEVIATION_HZ);
+    fm_radio_set_audio_lpf(&d->fm, audio_fs, 3400.0f);
+    return 0;
+}
+
+static int fm_process(demod_t *d, const float *iq, size_t n, int16_t *pcm_out) {
+    return fm_radio_cf32_to_pcm(&d->fm, iq, n, pcm_out);
+}
+
+static void fm_reset(demod_t *d) {
+    d->fm.prev_iq[0] = 1.0f;
+    d->fm.prev_iq[1] = 0.0f;
+    d->fm.deemph_acc = 0.0f;
+    d->fm.dc_x1 = d->fm.dc_y1 = 0.0f;
+    d->fm.z1 = d->fm.z2 = 0.0f;
+    resampler_reset(&d->fm.rs);
+}
+
+static void fm_release(demod_t *d) {
+    fm_radio_free(&d->fm);
+}
+
+static int wfm_stereo_init(demod_t *d, double fs, int audio_fs) {
+    return fm_stereo_init(&d->st, fs, audio_fs, 75);
+}
+
+static int wfm_stereo_process(demod_t *d, const float *iq, size_t n, int16_t *pcm_out) {
+    return fm_stereo_cf32_to_pcm(&d->st, iq, n, pcm_out);
+}
+
+static void wfm_stereo_reset(demod_t *d) {
+    fm_stereo_reset(&d->st);
+}
+
+static void wfm_stereo_release(demod_t *d) {
+    fm_stereo_free(&d->st);
+}
+
+// =========================================================
+// AM: envelope -> audio_fs -> carrier-referenced AGC
+// =========================================================
+
+static int am_init(demod_t *d, double fs, int audio_fs) {
+    if (rs_setup(d, 1, 0.0) != 0) return -1;
+    // Carrier level doubles as the AGC reference: audio = (env - carrier) / carrier.
+    // Symmetric time constant: a faster attack would ride the modulation peaks
+    agc_init(&d->agc, audio_fs, AM_CARRIER_TAU_S, AM_CARRIER_TAU_S, 1e-4f);
+    (void)fs;
+    return 0;
+}
+
+static int am_process(demod_t *d, const float *iq, size_t n, int16_t *pcm_out) {
+    int out = 0;
+    size_t pos = 0;
+
+    while (pos < n) {
+        size_t m = n - pos;
+        if (m > (size_t)d->block_in) m = (size_t)d->block_in;
+
+        const float *x = &iq[2 * pos];
+        for (size_t i = 0; i < m; i++) {
+            d->work_buf[i] = sqrtf(x[2*i] * x[2*i] + x[2*i + 1] * x[2*i + 1]);
+        }
+        pos += m;
+
+        int n_a = resampler_process(&d->rs, d->work_buf, (int)m, d->audio_buf);
+        for (int k = 0; k < n_a; k++) {
+            float env = d->audio_buf[k];
+            float carrier = agc_track(&d->agc, env);
+            pcm_out[out++] = to_pcm((env - carrier) / carrier * AM_DEPTH_PCM);
+        }
+    }
+    return out;
+}
+
+static void am_reset(demod_t *d) {
+    resampler_reset(&d->rs);
+    d->agc.level = d->agc.floor;
+}
+
+// =========================================================
+// USB / LSB: IQ -> audio_fs, shift the sideband to [0, bw], real part, peak AGC
+// =========================================================
+
+static int ssb_init(demod_t *d, double fs, int audio_fs) {
+    double half = 0.5 * d->ops->default_bw_hz;
+    if (rs_setup(d, 2, half) != 0) return -1;
+    // DDC sits at carrier + if_shift; rotating by +if_shift puts the carrier back at 0 Hz
+    d->bfo_inc = 2.0 * M_PI * d->ops->if_shift_hz / (double)audio_fs;
+    d->bfo_phase = 0.0;
+    agc_init(&d->agc, audio_fs, AGC_ATTACK_S, AGC_DECAY_S, 1e-4f);
+    (void)fs;
+    return 0;
+}
+
+static int ssb_process(demod_t *d, const float *iq, size_t n, int16_t *pcm_out) {
+    int out = 0;
+    size_t pos = 0;
+
+    while (pos < n) {
+        size_t m = n - pos;
+        if (m > (size_t)d->block_in) m = (size_t)d->block_in;
+
+        int n_a = resampler_process(&d->rs, &iq[2 * pos], (int)m, d->audio_buf);
+        pos += m;
+
+        for (int k = 0; k < n_a; k++) {
+            float c = (float)cos(d->bfo_phase);
+            float s = (float)sin(d->bfo_phase);
+            d->bfo_phase += d->bfo_inc;
+            if (d->bfo_phase > M_PI) d->bfo_phase -= 2.0 * M_PI;
+            if (d->bfo_phase < -M_PI) d->bfo_phase += 2.0 * M_PI;
+
+            float y = d->audio_buf[2*k] * c - d->audio_buf[2*k + 1] * s;
+
+            // DC blocker: a carrier left at 0 Hz would otherwise pin the AGC
+            float dc = y - d->dc_x1 + DC_BLOCK_R * d->dc_y1;
+            d->dc_x1 = y;
+            d->dc_y1 = dc;
+
+            float level = agc_track(&d->agc, fabsf(dc));
+            pcm_out[out++] = to_pcm(dc / level * SSB_PEAK_PCM);
+        }
+    }
+    return out;
+}
+
+static void ssb_reset(demod_t *d) {
+    resampler_reset(&d->rs);
+    d->agc.level = d->agc.floor;
+    d->dc_x1 = d->dc_y1 = 0.0f;
+    d->bfo_phase = 0.0;
+}
+
+// =========================================================
+// Tables
+// =========================================================
+
+// Narrowband rates divide 48 kHz so the audio resampler stays a small L/M.
+// Stereo keeps the whole 2 x 128 kHz Carson band (L-R sits at 23..53 kHz of the MPX).
+static const demod_ops_t demod_wfm_ops = { "wfm", 200000.0,     0.0,     0.0, 1, wfm_init, fm_process,  fm_reset,  fm_release };
+static const demod_ops_t demod_wfs_ops = { "wfm_stereo", 256000.0, 0.0,  0.0, 2, wfm_stereo_init, wfm_stereo_process, wfm_stereo_reset, wfm_stereo_release };
+static const demod_ops_t demod_nfm_ops = { "nfm",  12500.0,     0.0, 24000.0, 1, nfm_init, fm_process,  fm_reset,  fm_release };
+static const demod_ops_t demod_am_ops  = { "am",   10000.0,     0.0, 24000.0, 1, am_init,  am_process,  am_reset,  rs_release };
+static const demod_ops_t demod_usb_ops = { "usb",   3000.0,  1500.0, 12000.0, 1, ssb_init, ssb_process, ssb_reset, rs_release };
+static const demod_ops_t demod_lsb_ops = { "lsb",   3000.0, -1500.0, 12000.0, 1, ssb_init, ssb_process, ssb_reset, rs_release };
+
+const demod_ops_t* demod_ops_for(rf_mode_t mode, int stereo) {
+    switch (mode) {
+        case NFM_MODE: return &demod_nfm_ops;
+        case AM_MODE:  return &demod_am_ops;
+        case USB_MODE: return &demod_usb_ops;
+        case LSB_MODE: return &demod_lsb_ops;
+        default:       return stereo ? &demod_wfs_ops : &demod_wfm_ops;
+    }
+}
+
+// =========================================================
+// Public API
+// =========================================================
+
+int demod_front_end_init(ddc_t *ddc, rf_mode_t mode, int stereo, double fs_in, double offset_hz, double bw_hz) {
+    const demod_ops_t *ops = demod_ops_for(mode, stereo);
+    if (bw_hz <= 0.0) bw_hz = ops->default_bw_hz;
+
+    double center = offset_hz + ops->if_shift_hz;
+    if (ops->channel_fs > 0.0 && ops->channel_fs < fs_in) {
+        return ddc_init_rate(ddc, fs_in, center, bw_hz, ops->channel_fs);
+    }
+    return ddc_init(ddc, fs_in, center, bw_hz);
+}
+
+void demod_front_end_retune(ddc_t *ddc, rf_mode_t mode, double offset_hz) {
+    ddc_retune(ddc, offset_hz + demod_ops_for(mode, 0)->if_shift_hz);
+}
+
+int demod_init(demod_t *d, rf_mode_t mode, int stereo, double fs, int audio_fs) {
+    if (!d || fs <= 0.0 || audio_fs <= 0) return -1;
+
+    memset(d, 0, sizeof(*d));
+    d->ops = demod_ops_for(mode, stereo);
+    d->mode = mode;
+    d->fs = fs;
+    d->audio_fs = audio_fs;
+
+    if (d->ops->init(d, fs, audio_fs) != 0) {
+        d->ops->release(d);
+        return -1;
+    }
+
+    printf("[DEMOD] %s @ %.0f Hz -> %d Hz\n", d->ops->name, fs, audio_fs);
+    return 0;
+}
+
+int demod_process(demod_t *d, const float *iq, size_t n, int16_t *pcm_out) {
+    if (!d || !d->ops || !iq || !pcm_out || n == 0) return 0;
+    return d->ops->process(d, iq, n, pcm_out);
+}
+
+void demod_reset(demod_t *d) {
+    if (!d || !d->ops) return;
+    d->ops->reset(d);
+}
+
+void demod_free(demod_t *d) {
+    if (!d || !d->ops) return;
+    d->ops->release(d);
+}
@@ -0,0 +1,96 @@
+// libs/demod.h
+#ifndef DEMOD_H
+#define DEMOD_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "datatypes.h"
+#include "resampler.h"
+#include "fm_radio.h"
+#include "fm_stereo.h"
+#include "ddc.h"
+
+#define DEMOD_BLOCK 4096    // channel-rate samples handled per resampler pass
+
+typedef struct demod demod_t;
+
+// --- Demodulator interface: every mode takes DDC output (interleaved float IQ) ---
+typedef struct {
+    const char *name;
+    double default_bw_hz;   // channel width handed to the DDC front end
+    double if_shift_hz;     // DDC center relative to the carrier (SSB: middle of the sideband)
+    double channel_fs;      // DDC output rate; 0 = integer decimation from the channel width
+    int channels;           // PCM channels produced (interleaved when 2)
+    int  (*init)(demod_t *d, double fs, int audio_fs);
+    int  (*process)(demod_t *d, const float *iq, size_t n, int16_t *pcm_out);
+    void (*reset)(demod_t *d);
+    void (*release)(demod_t *d);
+} demod_ops_t;
+
+// --- Envelope AGC (AM carrier / SSB peak) ---
+typedef struct {
+    float level;
+    float attack;           // per-sample smoothing when the level rises
+    float decay;            // per-sample smoothing when it falls
+    float floor;            // minimum level (caps the gain on silence)
+} demod_agc_t;
+
+struct demod {
+    const demod_ops_t *ops;
+    rf_mode_t mode;
+    double fs;              // channel rate (DDC output)
+    int audio_fs;
+
+    fm_radio_t fm;          // WFM / NFM
+    fm_stereo_t st;         // WFM stereo
+
+    resampler_t rs;         // AM: envelope, SSB: IQ -> audio_fs
+    int block_in;
+    demod_agc_t agc;
+    float dc_x1, dc_y1;
+    double bfo_phase;       // SSB: moves the sideband center back to its audio offset
+    double bfo_inc;
+
+    float work_buf[2 * DEMOD_BLOCK];
+    float audio_buf[2 * DEMOD_BLOCK];
+};
+
+/**
+ * @brief Interface for rf_mode; modes without audio (realtime/campaign) map to WFM.
+ * @param stereo Non-zero selects the stereo decoder for WFM (ignored by other modes).
+ */
+const demod_ops_t* demod_ops_for(rf_mode_t mode, int stereo);
+
+/**
+ * @brief Shared front end: DDC for a carrier at offset_hz from the tuner center, with the
+ * mode's sideband shift, default width (bw_hz <= 0) and channel rate.
+ * @return 0 on success, -1 on error.
+ */
+int demod_front_end_init(ddc_t *ddc, rf_mode_t mode, int stereo, double fs_in, double offset_hz, double bw_hz);
+
+/**
+ * @brief Moves an existing front end to a new carrier offset (NCO only).
+ */
+void demod_front_end_retune(ddc_t *ddc, rf_mode_t mode, double offset_hz);
+
+/**
+ * @brief Builds the demodulator for mode at channel rate fs.
+ * @return 0 on success, -1 on error.
+ */
+int demod_init(demod_t *d, rf_mode_t mode, int stereo, double fs, int audio_fs);
+
+/**
+ * @brief Demodulates n IQ pairs. pcm_out must hold resampled output for n inputs
+ * (channels * (n * audio_fs / fs + a few samples)).
+ * @return Number of PCM frames written (samples per channel).
+ */
+int demod_process(demod_t *d, const float *iq, size_t n, int16_t *pcm_out);
+
+/**
+ * @brief Clears filter/AGC state (same mode and rate).
+ */
+void demod_reset(demod_t *d);
+
+void demod_free(demod_t *d);
+
+#endif
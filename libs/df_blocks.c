@@ -0,0 +1,508 @@
+// libs/df_blocks.c
+// Block kinds for dataflow graphs: thin wrappers over the existing DSP, HAL and Opus code.
+#include "dataflow.h"
+#include "sdr_HAL.h"
+#include "ddc.h"
+#include "demod.h"
+#include "psd.h"
+#include "opus_tx.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#define DF_AUDIO_FS        48000
+#define DF_CHUNK_PAIRS     8192     // IQ pairs per process call (ddc / demod)
+
+static double num_or(const cJSON *o, const char *key, double def) {
+    const cJSON *v = cJSON_GetObjectItemCaseSensitive(o, key);
+    return cJSON_IsNumber(v) ? v->valuedouble : def;
+}
+
+static const char* str_or(const cJSON *o, const char *key, const char *def) {
+    const cJSON *v = cJSON_GetObjectItemCaseSensitive(o, key);
+    return (cJSON_IsString(v) && v->valuestring) ? v->valuestring : def;
+}
+
+static int mode_of(const cJSON *spec, rf_mode_t *mode, char *err, size_t err_len) {
+    const char *m = str_or(spec, "mode", "fm");
+    if (rf_mode_from_string(m, mode) != 0) {
+        snprintf(err, err_len, "unknown mode '%s'", m);
+        return -1;
+    }
+    return 0;
+}
+
+// =========================================================
+// tap: the engine's device stream (df_graph_push)
+static int tap_init(df_block_t *b, const cJSON *spec, const df_format_t *in, df_format_t *out,
+                    char *err, size_t err_len) {
+    (void)b; (void)spec; (void)err; (void)err_len;
+    *out = *in;
+    return 0;
+}
+
+// =========================================================
+// sdr: a source of its own through sdr_HAL (sim / file / hackrf)
+static int sdr_block_cb(const uint8_t *buf, size_t len, void *ctx) {
+    df_emit((df_block_t*)ctx, buf, len);
+    return 0;
+}
+
+static int sdr_block_init(df_block_t *b, const cJSON *spec, const df_format_t *in, df_format_t *out,
+                          char *err, size_t err_len) {
+    (void)in;
+    sdr_open_cfg_t src;
+    memset(&src, 0, sizeof(src));
+
+    int be = sdr_backend_parse(str_or(spec, "backend", "sim"));
+    if (be < 0) {
+        snprintf(err, err_len, "backend is hackrf, file or sim");
+        return -1;
+    }
+    src.backend = (sdr_backend_t)be;
+    const cJSON *rt = cJSON_GetObjectItemCaseSensitive(spec, "realtime");
+    src.realtime = !cJSON_IsFalse(rt);
+    src.serial = str_or(spec, "serial", NULL);
+    src.path = str_or(spec, "path", NULL);
+    src.format = sdr_iq_format_parse(str_or(spec, "format", NULL), src.path);
+    src.loop = cJSON_IsTrue(cJSON_GetObjectItemCaseSensitive(spec, "loop"));
+    src.seed = (uint32_t)num_or(spec, "seed", 0);
+    const char *sig = str_or(spec, "signals", NULL);
+    if (sig) {
+        src.n_sim = sdr_sim_parse(sig, src.sim, SDR_SIM_MAX_SIGNALS);
+        if (src.n_sim < 0) {
+            snprintf(err, err_len, "bad signals '%s'", sig);
+            return -1;
+        }
+    }
+
+    SDR_cfg_t cfg = {
+        .sample_rate = num_or(spec, "sample_rate_hz", 2e6),
+        .center_freq = (uint64_t)num_or(spec, "center_freq_hz", 100e6),
+        .amp_enabled = cJSON_IsTrue(cJSON_GetObjectItemCaseSensitive(spec, "antenna_amp")),
+        .lna_gain = (int)num_or(spec, "lna_gain", SDR_LNA_GAIN_DEFAULT),
+        .vga_gain = (int)num_or(spec, "vga_gain", SDR_VGA_GAIN_DEFAULT),
+        .ppm_error = (int)num_or(spec, "ppm_error", 0),
+    };
+
+    sdr_dev_t *dev = sdr_open(&src);
+    if (!dev) {
+        snprintf(err, err_len, "%s source did not open", sdr_backend_name(src.backend));
+        return -1;
+    }
+    if (sdr_apply_cfg(dev, &cfg) < 0) {
+        snprintf(err, err_len, "config rejected by the %s source", sdr_backend_name(src.backend));
+        sdr_close(dev);
+        return -1;
+    }
+    b->state = dev;
+
+    memset(out, 0, sizeof(*out));
+    out->type = DF_IQ_S8;
+    out->fs = cfg.sample_rate;
+    out->center_hz = (double)cfg.center_freq;
+    return 0;
+}
+
+static int sdr_block_start(df_block_t *b) {
+    return sdr_start((sdr_dev_t*)b->state, sdr_block_cb, b);
+}
+
+static void sdr_block_stop(df_block_t *b) {
+    sdr_stop((sdr_dev_t*)b->state);
+}
+
+static void sdr_block_release(df_block_t *b) {
+    sdr_close((sdr_dev_t*)b->state);
+}
+
+// =========================================================
+// ddc: channel at offset_hz (or absolute freq_hz) -> float IQ at the channel rate.
+// With "mode" the front end is the demodulator's (sideband shift, width, channel rate).
+typedef struct {
+    ddc_t ddc;
+    float *out;
+} ddc_block_t;
+
+static int ddc_block_init(df_block_t *b, const cJSON *spec, const df_format_t *in, df_format_t *out,
+                          char *err, size_t err_len) {
+    if (in->type != DF_IQ_S8 && in->type != DF_IQ_F32) {
+        snprintf(err, err_len, "takes iq_s8 or iq_f32, not %s", df_type_name(in->type));
+        return -1;
+    }
+    double offset = num_or(spec, "offset_hz", 0.0);
+    const cJSON *fa = cJSON_GetObjectItemCaseSensitive(spec, "freq_hz");
+    if (cJSON_IsNumber(fa)) offset = fa->valuedouble - in->center_hz;
+    if (fabs(offset) >= in->fs / 2.0) {
+        snprintf(err, err_len, "channel %+.0f Hz is outside +-%.0f Hz", offset, in->fs / 2.0);
+        return -1;
+    }
+    double bw = num_or(spec, "bw_hz", 0.0);
+
+    ddc_block_t *s = (ddc_block_t*)calloc(1, sizeof(ddc_block_t));
+    if (!s) return -1;
+    int rc;
+    if (cJSON_GetObjectItemCaseSensitive(spec, "mode")) {
+        rf_mode_t mode;
+        if (mode_of(spec, &mode, err, err_len) != 0) {
+            free(s);
+            return -1;
+        }
+        int stereo = cJSON_IsTrue(cJSON_GetObjectItemCaseSensitive(spec, "stereo"));
+        rc = demod_front_end_init(&s->ddc, mode, stereo, in->fs, offset, bw);
+    } else {
+        rc = ddc_init(&s->ddc, in->fs, offset, bw);
+    }
+    if (rc != 0) {
+        snprintf(err, err_len, "DDC rejected %.0f Hz / %+.0f Hz / %.0f Hz", in->fs, offset, bw);
+        free(s);
+        return -1;
+    }
+    s->out = (float*)malloc((size_t)ddc_max_output(&s->ddc, DF_CHUNK_PAIRS) * 2 * sizeof(float));
+    if (!s->out) {
+        ddc_free(&s->ddc);
+        free(s);
+        return -1;
+    }
+    b->state = s;
+    b->chunk = DF_CHUNK_PAIRS * df_item_bytes(in);
+
+    memset(out, 0, sizeof(*out));
+    out->type = DF_IQ_F32;
+    out->fs = s->ddc.fs_out;
+    out->center_hz = in->center_hz + offset;
+    return 0;
+}
+
+static void ddc_block_process(df_block_t *b, const uint8_t *data, size_t len) {
+    ddc_block_t *s = (ddc_block_t*)b->state;
+    size_t n = len / df_item_bytes(&b->in_fmt);
+    int n_out = (b->in_fmt.type == DF_IQ_S8)
+        ? ddc_process_s8(&s->ddc, (const int8_t*)data, n, s->out)
+        : ddc_process_cf32(&s->ddc, (const float*)data, n, s->out);
+    if (n_out > 0) df_emit(b, s->out, (size_t)n_out * 2 * sizeof(float));
+}
+
+static void ddc_block_release(df_block_t *b) {
+    ddc_block_t *s = (ddc_block_t*)b->state;
+    if (!s) return;
+    ddc_free(&s->ddc);
+    free(s->out);
+    free(s);
+}
+
+// =========================================================
+// demod: float IQ at the channel rate -> PCM at 48 kHz
+typedef struct {
+    demod_t dm;
+    int16_t *pcm;
+} demod_block_t;
+
+static int demod_block_init(df_block_t *b, const cJSON *spec, const df_format_t *in, df_format_t *out,
+                            char *err, size_t err_len) {
+    rf_mode_t mode;
+    if (mode_of(spec, &mode, err, err_len) != 0) return -1;
+    int stereo = cJSON_IsTrue(cJSON_GetObjectItemCaseSensitive(spec, "stereo"));
+
+    demod_block_t *s = (demod_block_t*)calloc(1, sizeof(demod_block_t));
+    if (!s) return -1;
+    if (demod_init(&s->dm, mode, stereo, in->fs, DF_AUDIO_FS) != 0) {
+        snprintf(err, err_len, "cannot demodulate %s at %.0f Hz", str_or(spec, "mode", "fm"), in->fs);
+        free(s);
+        return -1;
+    }
+    int ch = s->dm.ops->channels;
+    size_t frames = (size_t)ceil((double)DF_CHUNK_PAIRS * DF_AUDIO_FS / in->fs) + 256;
+    s->pcm = (int16_t*)malloc(frames * (size_t)ch * sizeof(int16_t));
+    if (!s->pcm) {
+        demod_free(&s->dm);
+        free(s);
+        return -1;
+    }
+    b->state = s;
+    b->chunk = DF_CHUNK_PAIRS * df_item_bytes(in);
+
+    memset(out, 0, sizeof(*out));
+    out->type = DF_PCM_S16;
+    out->fs = DF_AUDIO_FS;
+    out->channels = ch;
+    return 0;
+}
+
+static void demod_block_process(df_block_t *b, const uint8_t *data, size_t len) {
+    demod_block_t *s = (demod_block_t*)b->state;
+    size_t n = len / df_item_bytes(&b->in_fmt);
+    int frames = demod_process(&s->dm, (const float*)data, n, s->pcm);
+    if (frames > 0) df_emit(b, s->pcm, (size_t)frames * df_item_bytes(&b->out_fmt));
+}
+
+static void demod_block_release(df_block_t *b) {
+    demod_block_t *s = (demod_block_t*)b->state;
+    if (!s) return;
+    demod_free(&s->dm);
+    free(s->pcm);
+    free(s);
+}
+
+// =========================================================
+// psd: Welch over capture_s of int8 IQ (default: what find_params_psd asks for, ~1 s),
+// same keys as the engine config (rbw_hz, window, overlap, scale, span), cropped to span.
+typedef struct {
+    PsdConfig_t cfg;
+    char *scale;
+    arena_t arena;                  // everything below, sized for one chunk
+    psd_workspace_t ws;
+    signal_iq_t sig;
+    double *f;
+    double *p;
+    int first, bins;
+} psd_block_t;
+
+static void psd_block_release(df_block_t *b);
+
+static int psd_block_init(df_block_t *b, const cJSON *spec, const df_format_t *in, df_format_t *out,
+                          char *err, size_t err_len) {
+    cJSON *req = cJSON_Duplicate(spec, 1);
+    if (!req) return -1;
+    cJSON_DeleteItemFromObjectCaseSensitive(req, "sample_rate_hz");
+    cJSON_DeleteItemFromObjectCaseSensitive(req, "center_freq_hz");
+    cJSON_AddNumberToObject(req, "sample_rate_hz", in->fs);
+    cJSON_AddNumberToObject(req, "center_freq_hz", in->center_hz);
+    char *txt = cJSON_PrintUnformatted(req);
+    cJSON_Delete(req);
+
+    DesiredCfg_t desired;
+    int rc = txt ? parse_config_rf(txt, &desired) : -1;
+    free(txt);
+    if (rc != 0) {
+        snprintf(err, err_len, "bad PSD parameters");
+        return -1;
+    }
+
+    psd_block_t *s = (psd_block_t*)calloc(1, sizeof(psd_block_t));
+    if (!s) {
+        free_desired_psd(&desired);
+        return -1;
+    }
+    RB_cfg_t rb;
+    find_params_psd(desired, NULL, &s->cfg, &rb);
+    s->scale = desired.scale;       // taken over from desired
+
+    double capture_s = num_or(spec, "capture_s", 0.0);
+    size_t capture = capture_s > 0.0 ? (size_t)(capture_s * in->fs) * 2 : rb.total_bytes;
+    if (capture < (size_t)s->cfg.nperseg * 2) capture = (size_t)s->cfg.nperseg * 2;
+    b->chunk = capture & ~(size_t)1;
+
+    // Bins inside +-span/2 of the axis execute_welch_psd produces (-fs/2 + i * fs / n)
+    int n = s->cfg.nperseg;
+    double df = in->fs / n;
+    double half = desired.span > 0.0 ? desired.span / 2.0 : in->fs / 2.0;
+    int last = n - 1;
+    s->first = 0;
+    for (int i = 0; i < n; i++) {
+        if (-in->fs / 2.0 + i * df >= -half) { s->first = i; break; }
+    }
+    for (int i = s->first; i < n; i++) {
+        if (-in->fs / 2.0 + i * df > half) { last = i - 1; break; }
+        last = i;
+    }
+    s->bins = last - s->first + 1;
+
+    b->state = s;
+    if (s->bins <= 0) {
+        snprintf(err, err_len, "span leaves no bins");
+        psd_block_release(b);
+        return -1;
+    }
+    size_t n_samples = b->chunk / 2;
+    size_t bytes = ARENA_SIZE(n_samples * sizeof(double complex)) + 2 * ARENA_SIZE((size_t)n * sizeof(double))
+                 + psd_workspace_bytes(&s->cfg);
+    if (arena_reserve(&s->arena, bytes) == 0) {
+        s->sig.signal_iq = (double complex*)arena_alloc(&s->arena, n_samples * sizeof(double complex));
+        s->f = (double*)arena_alloc(&s->arena, (size_t)n * sizeof(double));
+        s->p = (double*)arena_alloc(&s->arena, (size_t)n * sizeof(double));
+    }
+    if (!s->sig.signal_iq || !s->f || !s->p || psd_workspace_init(&s->ws, &s->cfg, &s->arena) != 0) {
+        snprintf(err, err_len, "cannot allocate PSD buffers");
+        psd_block_release(b);
+        return -1;
+    }
+
+    memset(out, 0, sizeof(*out));
+    out->type = DF_PSD_F64;
+    out->fs = in->fs / ((double)b->chunk / 2.0);
+    out->center_hz = in->center_hz;
+    out->start_hz = in->center_hz - in->fs / 2.0 + s->first * df;
+    out->bin_hz = df;
+    out->bins = s->bins;
+    return 0;
+}
+
+static void psd_block_process(df_block_t *b, const uint8_t *data, size_t len) {
+    psd_block_t *s = (psd_block_t*)b->state;
+    if (load_iq_into(&s->sig, b->chunk / 2, (const int8_t*)data, len) != 0) return;
+    execute_welch_psd_ws(&s->ws, &s->sig, s->f, s->p);
+    scale_psd(s->p, s->cfg.nperseg, s->scale);
+    df_emit(b, &s->p[s->first], (size_t)s->bins * sizeof(double));
+}
+
+static void psd_block_release(df_block_t *b) {
+    psd_block_t *s = (psd_block_t*)b->state;
+    if (!s) return;
+    free(s->scale);
+    psd_workspace_release(&s->ws);
+    arena_free(&s->arena);
+    free(s);
+}
+
+// =========================================================
+// encoder: PCM -> Opus over OPU0/TCP (host, port), RTP/UDP (host, port) or shm (shm_name),
+// one frame per process call
+typedef struct {
+    opus_tx_t *tx;
+    int frame_samples;
+} enc_block_t;
+
+static int enc_block_init(df_block_t *b, const cJSON *spec, const df_format_t *in, df_format_t *out,
+                          char *err, size_t err_len) {
+    const char *tr = str_or(spec, "transport", "tcp");
+    opus_tx_cfg_t cfg;
+    memset(&cfg, 0, sizeof(cfg));
+    cfg.sample_rate = (int)in->fs;
+    cfg.channels = in->channels;
+    cfg.bitrate = (int)num_or(spec, "bitrate", 32000);
+    cfg.complexity = (int)num_or(spec, "complexity", 5);
+    cfg.vbr = 1;
+    cfg.frame_ms = opus_tx_snap_frame_ms(num_or(spec, "frame_ms", 20));
+    if (strcmp(tr, "rtp") == 0) cfg.transport = OPUS_TX_RTP_UDP;
+    else if (strcmp(tr, "shm") == 0) cfg.transport = OPUS_TX_SHM;
+    else if (strcmp(tr, "tcp") == 0) cfg.transport = OPUS_TX_OPU0_TCP;
+    else {
+        snprintf(err, err_len, "transport is tcp, rtp or shm");
+        return -1;
+    }
+
+    const char *host = str_or(spec, cfg.transport == OPUS_TX_SHM ? "shm_name" : "host",
+                              cfg.transport == OPUS_TX_SHM ? "/rf_df_audio" : "127.0.0.1");
+    int port = (int)num_or(spec, "port", cfg.transport == OPUS_TX_RTP_UDP ? 5004 : 9000);
+
+    enc_block_t *s = (enc_block_t*)calloc(1, sizeof(enc_block_t));
+    if (!s) return -1;
+    s->frame_samples = (int)lround(cfg.frame_ms * in->fs / 1000.0);
+    s->tx = opus_tx_create(host, port, &cfg);
+    if (!s->tx) {
+        snprintf(err, err_len, "Opus encoder not created (%d Hz x %d)", cfg.sample_rate, cfg.channels);
+        free(s);
+        return -1;
+    }
+    b->state = s;
+    b->chunk = (size_t)s->frame_samples * df_item_bytes(in);
+
+    memset(out, 0, sizeof(*out));
+    out->type = DF_NONE;
+    return 0;
+}
+
+static void enc_block_process(df_block_t *b, const uint8_t *data, size_t len) {
+    enc_block_t *s = (enc_block_t*)b->state;
+    (void)len;
+    opus_tx_send_frame(s->tx, (const int16_t*)data, s->frame_samples);
+}
+
+static void enc_block_release(df_block_t *b) {
+    enc_block_t *s = (enc_block_t*)b->state;
+    if (!s) return;
+    opus_tx_destroy(s->tx);
+    free(s);
+}
+
+// =========================================================
+// sink: "null" (count only), "file" (raw bytes to path), "publish" (PSD frames as
+// {"start_freq_hz","end_freq_hz","Pxx"} through the graph's publish hook)
+typedef enum { SINK_NULL, SINK_FILE, SINK_PUBLISH } sink_kind_t;
+
+typedef struct {
+    sink_kind_t kind;
+    FILE *fp;
+} sink_block_t;
+
+static int sink_block_init(df_block_t *b, const cJSON *spec, const df_format_t *in, df_format_t *out,
+                           char *err, size_t err_len) {
+    const char *to = str_or(spec, "to", "null");
+    sink_block_t *s = (sink_block_t*)calloc(1, sizeof(sink_block_t));
+    if (!s) return -1;
+
+    if (strcmp(to, "null") == 0) {
+        s->kind = SINK_NULL;
+    } else if (strcmp(to, "file") == 0) {
+        const char *path = str_or(spec, "path", NULL);
+        s->kind = SINK_FILE;
+        s->fp = path ? fopen(path, "wb") : NULL;
+        if (!s->fp) {
+            snprintf(err, err_len, "cannot write '%s'", path ? path : "(no path)");
+            free(s);
+            return -1;
+        }
+    } else if (strcmp(to, "publish") == 0) {
+        if (in->type != DF_PSD_F64) {
+            snprintf(err, err_len, "publish takes psd_f64, not %s", df_type_name(in->type));
+            free(s);
+            return -1;
+        }
+        s->kind = SINK_PUBLISH;
+    } else {
+        snprintf(err, err_len, "to is null, file or publish");
+        free(s);
+        return -1;
+    }
+    b->state = s;
+    // Whole PSD frames; stream types in 64 KiB pieces
+    b->chunk = in->type == DF_PSD_F64 ? df_item_bytes(in) : 65536;
+
+    memset(out, 0, sizeof(*out));
+    out->type = DF_NONE;
+    return 0;
+}
+
+static void sink_block_process(df_block_t *b, const uint8_t *data, size_t len) {
+    sink_block_t *s = (sink_block_t*)b->state;
+    if (s->kind == SINK_FILE) {
+        fwrite(data, 1, len, s->fp);
+    } else if (s->kind == SINK_PUBLISH) {
+        const df_format_t *f = &b->in_fmt;
+        cJSON *root = cJSON_CreateObject();
+        cJSON_AddNumberToObject(root, "start_freq_hz", f->start_hz);
+        cJSON_AddNumberToObject(root, "end_freq_hz", f->start_hz + (f->bins - 1) * f->bin_hz);
+        cJSON_AddItemToObject(root, "Pxx", cJSON_CreateDoubleArray((const double*)data, f->bins));
+        char *json = cJSON_PrintUnformatted(root);
+        df_publish(b, json);
+        free(json);
+        cJSON_Delete(root);
+    }
+}
+
+static void sink_block_release(df_block_t *b) {
+    sink_block_t *s = (sink_block_t*)b->state;
+    if (!s) return;
+    if (s->fp) fclose(s->fp);
+    free(s);
+}
+
+// =========================================================
+static const df_ops_t block_kinds[] = {
+    { "tap",     DF_ANY,     true,  tap_init,         NULL,                NULL,            NULL,           NULL },
+    { "sdr",     DF_ANY,     true,  sdr_block_init,   NULL,                sdr_block_start, sdr_block_stop, sdr_block_release },
+    { "ddc",     DF_ANY,     false, ddc_block_init,   ddc_block_process,   NULL,            NULL,           ddc_block_release },
+    { "demod",   DF_IQ_F32,  false, demod_block_init, demod_block_process, NULL,            NULL,           demod_block_release },
+    { "psd",     DF_IQ_S8,   false, psd_block_init,   psd_block_process,   NULL,            NULL,           psd_block_release },
+    { "encoder", DF_PCM_S16, false, enc_block_init,   enc_block_process,   NULL,            NULL,           enc_block_release },
+    { "sink",    DF_ANY,     false, sink_block_init,  sink_block_process,  NULL,            NULL,           sink_block_release },
+};
+
+const df_ops_t* df_ops_for(const char *kind) {
+    for (size_t i = 0; i < sizeof(block_kinds) / sizeof(block_kinds[0]); i++) {
+        if (strcmp(block_kinds[i].kind, kind) == 0) return &block_kinds[i];
+    }
+    return NULL;
+}
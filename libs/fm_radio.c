@@ -5,16 +5,24 @@
 static void  biquad_lowpass(fm_radio_t *r, float fs, float fc, float Q);
 static inline float biquad_process(fm_radio_t *r, float x);
 static inline float dc_block_process(fm_radio_t *r, float x);
+static int audio_tail(fm_radio_t *radio, int n_disc, int16_t *pcm_out);
 
-void fm_radio_init(fm_radio_t *radio, double fs, int audio_fs, int deemph_us) {
+int fm_radio_init(fm_radio_t *radio, double fs, int audio_fs, int deemph_us) {
     radio->prev_sample = 1.0 + 0.0*I;
-    radio->audio_acc = 0;
-    radio->samples_in_acc = 0;
+    radio->prev_iq[0] = 1.0f;
+    radio->prev_iq[1] = 0.0f;
     radio->deemph_acc = 0;
-    radio->gain = 60000.0;
+    // Discriminator output is rad/sample: scale with fs so the PCM level per Hz of
+    // deviation matches the original 2 MS/s tuning (60000 @ 2 MS/s ~ 0.19 LSB/Hz)
+    radio->gain = (float)(60000.0 * fs / 2e6);
 
-    radio->decim_factor = (int)llround(fs / (double)audio_fs);
-    if (radio->decim_factor < 1) radio->decim_factor = 1;
+    // Exact fs -> audio_fs (replaces llround(fs / audio_fs) boxcar decimation)
+    if (resampler_init(&radio->rs, fs, (double)audio_fs, 1, 0.0) != 0) return -1;
+
+    radio->block_in = FM_RADIO_BLOCK;
+    while (radio->block_in > 1 && resampler_max_output(&radio->rs, radio->block_in) > FM_RADIO_BLOCK) {
+        radio->block_in /= 2;
+    }
 
     float tau = (float)deemph_us * 1e-6f;
     float dt  = 1.0f / (float)audio_fs;
@@ -33,6 +41,19 @@ void fm_radio_init(fm_radio_t *radio, double fs, int audio_fs, int deemph_us) {
     // - Voice:  4–6 kHz
     // - WBFM:  12–15 kHz (use 12 kHz as conservative default)
     biquad_lowpass(radio, (float)audio_fs, 12000.0f, 0.707f);
+    return 0;
+}
+
+void fm_radio_free(fm_radio_t *radio) {
+    if (!radio) return;
+    resampler_free(&radio->rs);
+}
+
+void fm_radio_set_audio_lpf(fm_radio_t *radio, int audio_fs, float fc_hz) {
+    if (!radio || audio_fs <= 0) return;
+    biquad_lowpass(radio, (float)audio_fs, fc_hz, 0.707f);
+    radio->z1 = 0.0f;
+    radio->z2 = 0.0f;
 }
 
 static void biquad_lowpass(fm_radio_t *r, float fs, float fc, float Q) {
@@ -78,47 +99,182 @@ static inline float dc_block_process(fm_radio_t *r, float x) {
     return y;
 }
 
+/**
+ * @brief Branch-free atan2 (octant reduction + odd minimax polynomial on [0,1]).
+ *
+ * Octant fix-ups are written as copysignf offsets instead of selects so the
+ * batch loops below if-convert and vectorize at -O2 (fmaxf/fminf would not:
+ * their NaN semantics keep them as calls).
+ */
+static inline float fast_atan2f(float y, float x) {
+    float ax = fabsf(x);
+    float ay = fabsf(y);
+    float mx = (ax > ay) ? ax : ay;   // MAX_EXPR / MIN_EXPR, not branches
+    float mn = (ax > ay) ? ay : ax;
+    float a = mn / (mx + 1e-30f);
+    float s = a * a;
+
+    float r = -0.01172120f;
+    r = r * s + 0.05265332f;
+    r = r * s - 0.11643287f;
+    r = r * s + 0.19354346f;
+    r = r * s - 0.33262347f;
+    r = r * s + 0.99997726f;
+    r *= a;
+
+    // ay > ax: pi/2 - r, else r
+    r = (0.78539819f - copysignf(0.78539819f, ax - ay)) + copysignf(r, ax - ay);
+    // x < 0: pi - r, else r
+    r = (1.57079637f - copysignf(1.57079637f, x)) + copysignf(r, x);
+    return copysignf(r, y);
+}
+
+// cur[k] * conj(prv[k]) over one batch; prv is cur shifted back one sample
+static inline void disc_batch_f32(const float *restrict cur, const float *restrict prv, float *restrict out) {
+    for (int j = 0; j < FM_DISC_BATCH; j++) {
+        float i1 = cur[2*j], q1 = cur[2*j + 1];
+        float i0 = prv[2*j], q0 = prv[2*j + 1];
+        out[j] = fast_atan2f(q1 * i0 - i1 * q0, i1 * i0 + q1 * q0);
+    }
+}
+
+static inline void disc_batch_s8(const int8_t *restrict cur, const int8_t *restrict prv, float *restrict out) {
+    for (int j = 0; j < FM_DISC_BATCH; j++) {
+        // int8 products are exact in int32
+        int32_t i1 = cur[2*j], q1 = cur[2*j + 1];
+        int32_t i0 = prv[2*j], q0 = prv[2*j + 1];
+        out[j] = fast_atan2f((float)(q1 * i0 - i1 * q0), (float)(i1 * i0 + q1 * q0));
+    }
+}
+
+void fm_discriminate_f32(const float *iq, size_t n, float prev_iq[2], float *out) {
+    if (n == 0) return;
+
+    // First sample pairs with the carried-over one; afterwards pairs are contiguous
+    out[0] = fast_atan2f(iq[1] * prev_iq[0] - iq[0] * prev_iq[1],
+                         iq[0] * prev_iq[0] + iq[1] * prev_iq[1]);
+
+    size_t k = 1;
+    for (; k + FM_DISC_BATCH <= n; k += FM_DISC_BATCH) {
+        disc_batch_f32(&iq[2*k], &iq[2*(k - 1)], &out[k]);
+    }
+    for (; k < n; k++) {
+        out[k] = fast_atan2f(iq[2*k + 1] * iq[2*k - 2] - iq[2*k] * iq[2*k - 1],
+                             iq[2*k] * iq[2*k - 2] + iq[2*k + 1] * iq[2*k - 1]);
+    }
+
+    prev_iq[0] = iq[2*(n - 1)];
+    prev_iq[1] = iq[2*(n - 1) + 1];
+}
+
+void fm_discriminate_s8(const int8_t *iq, size_t n, float prev_iq[2], float *out) {
+    if (n == 0) return;
+
+    out[0] = fast_atan2f((float)iq[1] * prev_iq[0] - (float)iq[0] * prev_iq[1],
+                         (float)iq[0] * prev_iq[0] + (float)iq[1] * prev_iq[1]);
+
+    size_t k = 1;
+    for (; k + FM_DISC_BATCH <= n; k += FM_DISC_BATCH) {
+        disc_batch_s8(&iq[2*k], &iq[2*(k - 1)], &out[k]);
+    }
+    for (; k < n; k++) {
+        int32_t i1 = iq[2*k], q1 = iq[2*k + 1];
+        int32_t i0 = iq[2*k - 2], q0 = iq[2*k - 1];
+        out[k] = fast_atan2f((float)(q1 * i0 - i1 * q0), (float)(i1 * i0 + q1 * q0));
+    }
+
+    prev_iq[0] = (float)iq[2*(n - 1)];
+    prev_iq[1] = (float)iq[2*(n - 1) + 1];
+}
+
+/**
+ * @brief Resamples radio->disc_buf[0..n_disc) to audio_fs and runs the audio chain.
+ */
+static int audio_tail(fm_radio_t *radio, int n_disc, int16_t *pcm_out) {
+    int n_audio = resampler_process(&radio->rs, radio->disc_buf, n_disc, radio->audio_buf);
+
+    for (int k = 0; k < n_audio; k++) {
+        float val = radio->audio_buf[k];
+
+        // 3) de-emphasis
+        radio->deemph_acc += radio->deemph_alpha * (val - radio->deemph_acc);
+        float a = radio->deemph_acc;
+
+        // 3b) DC blocker
+        if (radio->enable_dc_block) {
+            a = dc_block_process(radio, a);
+        }
+
+        // 3c) audio low-pass
+        if (radio->enable_lpf) {
+            a = biquad_process(radio, a);
+        }
+
+        // 4) gain + clip (NOTE: use 'a', not deemph_acc)
+        double pcm = (double)a * (double)radio->gain;
+        if (pcm >  32767.0) pcm =  32767.0;
+        if (pcm < -32768.0) pcm = -32768.0;
+
+        pcm_out[k] = (int16_t)pcm;
+    }
+
+    return n_audio;
+}
+
 int fm_radio_iq_to_pcm(fm_radio_t *radio, signal_iq_t *sig, int16_t *pcm_out) {
     int out_idx = 0;
+    size_t pos = 0;
+
+    while (pos < sig->n_signal) {
+        size_t n = sig->n_signal - pos;
+        if (n > (size_t)radio->block_in) n = (size_t)radio->block_in;
 
-    for (size_t i = 0; i < sig->n_signal; i++) {
         // 1) FM demod: phase difference
-        double complex diff = sig->signal_iq[i] * conj(radio->prev_sample);
-        double angle = atan2(cimag(diff), creal(diff));
-        radio->prev_sample = sig->signal_iq[i];
-
-        // 2) crude decimation: accumulate then average
-        radio->audio_acc += angle;
-        radio->samples_in_acc++;
-
-        if (radio->samples_in_acc >= radio->decim_factor) {
-            float val = (float)(radio->audio_acc / (double)radio->samples_in_acc);
-            radio->audio_acc = 0;
-            radio->samples_in_acc = 0;
-
-            // 3) de-emphasis
-            radio->deemph_acc += radio->deemph_alpha * (val - radio->deemph_acc);
-            float a = radio->deemph_acc;
-
-            // 3b) DC blocker
-            if (radio->enable_dc_block) {
-                a = dc_block_process(radio, a);
-            }
-
-            // 3c) audio low-pass
-            if (radio->enable_lpf) {
-                a = biquad_process(radio, a);
-            }
-
-            // 4) gain + clip (NOTE: use 'a', not deemph_acc)
-            double pcm = (double)a * (double)radio->gain;
-            if (pcm >  32767.0) pcm =  32767.0;
-            if (pcm < -32768.0) pcm = -32768.0;
-
-            pcm_out[out_idx++] = (int16_t)pcm;
+        for (size_t i = 0; i < n; i++) {
+            double complex x = sig->signal_iq[pos + i];
+            double complex diff = x * conj(radio->prev_sample);
+            radio->disc_buf[i] = (float)atan2(cimag(diff), creal(diff));
+            radio->prev_sample = x;
         }
+        pos += n;
+
+        // 2) anti-aliased rational resampling to audio_fs + audio chain
+        out_idx += audio_tail(radio, (int)n, &pcm_out[out_idx]);
+    }
+
+    return out_idx;
+}
+
+int fm_radio_iq8_to_pcm(fm_radio_t *radio, const int8_t *iq, size_t n_samples, int16_t *pcm_out) {
+    int out_idx = 0;
+    size_t pos = 0;
+
+    while (pos < n_samples) {
+        size_t n = n_samples - pos;
+        if (n > (size_t)radio->block_in) n = (size_t)radio->block_in;
+
+        fm_discriminate_s8(&iq[2*pos], n, radio->prev_iq, radio->disc_buf);
+        pos += n;
+
+        out_idx += audio_tail(radio, (int)n, &pcm_out[out_idx]);
     }
 
     return out_idx;
 }
 
+int fm_radio_cf32_to_pcm(fm_radio_t *radio, const float *iq, size_t n_samples, int16_t *pcm_out) {
+    int out_idx = 0;
+    size_t pos = 0;
+
+    while (pos < n_samples) {
+        size_t n = n_samples - pos;
+        if (n > (size_t)radio->block_in) n = (size_t)radio->block_in;
+
+        fm_discriminate_f32(&iq[2*pos], n, radio->prev_iq, radio->disc_buf);
+        pos += n;
+
+        out_idx += audio_tail(radio, (int)n, &pcm_out[out_idx]);
+    }
+
+    return out_idx;
+}
@@ -2,15 +2,22 @@
 #define FM_RADIO_H
 
 #include "datatypes.h"
+#include "resampler.h"
 #include <stdint.h>
 #include <complex.h>
 
+#define FM_RADIO_BLOCK 4096   // discriminator samples handled per resampler pass
+#define FM_DISC_BATCH  16     // constant trip count so the kernel vectorizes at -O2
+
 typedef struct {
-    double complex prev_sample;
+    double complex prev_sample;     // reference (double atan2) path
+    float prev_iq[2];               // float/int8 discriminator path
 
-    double audio_acc;
-    int samples_in_acc;
-    int decim_factor;
+    // Discriminator rate -> exactly audio_fs
+    resampler_t rs;
+    int block_in;                   // input samples per pass (keeps audio_buf in bounds)
+    float disc_buf[FM_RADIO_BLOCK];
+    float audio_buf[FM_RADIO_BLOCK];
 
     float deemph_acc;
     float deemph_alpha;
@@ -35,13 +42,51 @@ typedef struct {
 /**
  * @brief Setup the radio state.
  * @param fs Input rate (e.g., 2e6), @param audio_fs Output rate (e.g., 48000), @param deemph_us (75)
+ * @return 0 on success, -1 if the resampler could not be built.
+ */
+int fm_radio_init(fm_radio_t *radio, double fs, int audio_fs, int deemph_us);
+
+/**
+ * @brief Releases the resampler buffers owned by the radio.
  */
-void fm_radio_init(fm_radio_t *radio, double fs, int audio_fs, int deemph_us);
+void fm_radio_free(fm_radio_t *radio);
+
+/**
+ * @brief Moves the audio low-pass corner (12 kHz by default; ~3 kHz for voice).
+ */
+void fm_radio_set_audio_lpf(fm_radio_t *radio, int audio_fs, float fc_hz);
 
 /**
  * @brief Processes an IQ block and fills a PCM16 buffer. 
+ * pcm_out must hold at least sig->n_signal samples when fs >= audio_fs.
  * @return Number of audio samples generated.
  */
 int fm_radio_iq_to_pcm(fm_radio_t *radio, signal_iq_t *sig, int16_t *pcm_out);
 
+/**
+ * @brief Same chain as fm_radio_iq_to_pcm, fed straight from interleaved int8 IQ
+ * with the float discriminator (no double complex conversion, no libm atan2).
+ * @param n_samples Number of IQ pairs in iq.
+ * @return Number of audio samples generated.
+ */
+int fm_radio_iq8_to_pcm(fm_radio_t *radio, const int8_t *iq, size_t n_samples, int16_t *pcm_out);
+
+/**
+ * @brief Same chain fed with interleaved float IQ (e.g. DDC output at the channel rate).
+ * @return Number of audio samples generated.
+ */
+int fm_radio_cf32_to_pcm(fm_radio_t *radio, const float *iq, size_t n_samples, int16_t *pcm_out);
+
+/**
+ * @brief Float FM discriminator: out[k] = arg(x[k] * conj(x[k-1])), polynomial atan2
+ * (max error 1.95e-6 rad, as measured by rf_bench fm_radio), processed in FM_DISC_BATCH blocks.
+ * @param iq Interleaved I/Q (n pairs). @param prev_iq Last sample of the previous block (updated).
+ */
+void fm_discriminate_f32(const float *iq, size_t n, float prev_iq[2], float *out);
+
+/**
+ * @brief int8 variant of fm_discriminate_f32 (HackRF native format, scale-free).
+ */
+void fm_discriminate_s8(const int8_t *iq, size_t n, float prev_iq[2], float *out);
+
 #endif
@@ -0,0 +1,211 @@
+// libs/fm_stereo.c
+#include "fm_stereo.h"
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+
+#define PLL_LOOP_HZ       30.0      // loop natural frequency
+#define PLL_DAMPING       0.707
+#define PLL_ARM_HZ        200.0     // I/Q arm low-pass
+#define PILOT_MIN_DEV_HZ  2000.0    // below this the pilot is treated as absent
+#define BLEND_TAU_S       0.050
+
+static void stereo_lowpass(fm_stereo_t *st, float fs, float fc, float Q) {
+    if (fc > 0.49f * fs) fc = 0.49f * fs;
+    const float w0 = 2.0f * (float)M_PI * (fc / fs);
+    const float c  = cosf(w0);
+    const float alpha = sinf(w0) / (2.0f * Q);
+    const float a0 = 1.0f + alpha;
+
+    st->b0 = (1.0f - c) * 0.5f / a0;
+    st->b1 = (1.0f - c) / a0;
+    st->b2 = (1.0f - c) * 0.5f / a0;
+    st->a1 = (-2.0f * c) / a0;
+    st->a2 = (1.0f - alpha) / a0;
+}
+
+/**
+ * @brief De-emphasis + DC blocker + 15 kHz biquad + gain for one channel.
+ */
+static inline int16_t stereo_tail(fm_stereo_t *st, int ch, float x) {
+    st->deemph[ch] += st->deemph_alpha * (x - st->deemph[ch]);
+    float a = st->deemph[ch];
+
+    float dc = a - st->dc_x1[ch] + st->dc_r * st->dc_y1[ch];
+    st->dc_x1[ch] = a;
+    st->dc_y1[ch] = dc;
+
+    float y = st->b0 * dc + st->z1[ch];
+    st->z1[ch] = st->b1 * dc - st->a1 * y + st->z2[ch];
+    st->z2[ch] = st->b2 * dc - st->a2 * y;
+
+    float pcm = y * st->gain;
+    if (pcm >  32767.0f) pcm =  32767.0f;
+    if (pcm < -32768.0f) pcm = -32768.0f;
+    return (int16_t)pcm;
+}
+
+static int is_prime(int n) {
+    if (n < 2) return 0;
+    for (int d = 2; d * d <= n; d++) {
+        if (n % d == 0) return 0;
+    }
+    return 1;
+}
+
+int fm_stereo_init(fm_stereo_t *st, double fs, int audio_fs, int deemph_us) {
+    if (!st || fs < FM_STEREO_MPX_MIN_FS || audio_fs <= 0) return -1;
+
+    memset(st, 0, sizeof(*st));
+    st->fs = fs;
+    st->audio_fs = audio_fs;
+
+    // Pilot and L-R stages run after an integer decimation of the discriminator output
+    // A prime factor keeps the resampler off its CIC front end: sinc^4 droop at
+    // 23-53 kHz would shrink L-R against L+R and cost tens of dB of separation.
+    int mpx_decim = (int)floor(fs / FM_STEREO_MPX_MIN_FS);
+    if (mpx_decim < 1) mpx_decim = 1;
+    while (mpx_decim > 3 && !is_prime(mpx_decim)) mpx_decim--;
+    st->fs_mpx = fs / (double)mpx_decim;
+
+    if (resampler_init(&st->mpx_rs, fs, st->fs_mpx, 1, 53000.0) != 0) return -1;
+    if (resampler_init(&st->audio_rs, st->fs_mpx, (double)audio_fs, 2, FM_STEREO_AUDIO_HZ) != 0) {
+        fm_stereo_free(st);
+        return -1;
+    }
+
+    st->block_in = FM_RADIO_BLOCK;
+    while (st->block_in > 1 &&
+           (resampler_max_output(&st->mpx_rs, st->block_in) > FM_RADIO_BLOCK ||
+            resampler_max_output(&st->audio_rs, resampler_max_output(&st->mpx_rs, st->block_in)) > FM_RADIO_BLOCK)) {
+        st->block_in /= 2;
+    }
+
+    for (int i = 0; i < FM_STEREO_NCO_SIZE; i++) {
+        st->nco_sin[i] = (float)sin(2.0 * M_PI * (double)i / (double)FM_STEREO_NCO_SIZE);
+    }
+
+    // Second-order loop: PI filter on a unit-gain phase detector
+    double T  = 1.0 / st->fs_mpx;
+    double wn = 2.0 * M_PI * PLL_LOOP_HZ * T;
+    st->w0 = (float)(2.0 * M_PI * FM_STEREO_PILOT_HZ * T);
+    st->kp = (float)(2.0 * PLL_DAMPING * wn);
+    st->ki = (float)(wn * wn);
+    st->arm_coef   = (float)(1.0 - exp(-2.0 * M_PI * PLL_ARM_HZ * T));
+    st->blend_coef = (float)(1.0 - exp(-T / BLEND_TAU_S));
+    // arm_i settles to half the pilot amplitude (rad/sample of the discriminator)
+    st->lock_thr = (float)(M_PI * PILOT_MIN_DEV_HZ / fs);
+
+    float tau = (float)deemph_us * 1e-6f;
+    float dt  = 1.0f / (float)audio_fs;
+    st->deemph_alpha = dt / (tau + dt);
+    st->dc_r = 0.996f;
+    stereo_lowpass(st, (float)audio_fs, (float)FM_STEREO_AUDIO_HZ, 0.707f);
+
+    // Same PCM level per Hz of deviation as fm_radio (mono)
+    st->gain = (float)(60000.0 * fs / 2e6);
+    st->prev_iq[0] = 1.0f;
+
+    printf("[STEREO] fs=%.0f Hz -> MPX %.0f Hz (D=%d) -> %d Hz | PLL %.0f Hz\n",
+           fs, st->fs_mpx, mpx_decim, audio_fs, PLL_LOOP_HZ);
+    return 0;
+}
+
+void fm_stereo_free(fm_stereo_t *st) {
+    if (!st) return;
+    resampler_free(&st->mpx_rs);
+    resampler_free(&st->audio_rs);
+}
+
+void fm_stereo_reset(fm_stereo_t *st) {
+    if (!st) return;
+    resampler_reset(&st->mpx_rs);
+    resampler_reset(&st->audio_rs);
+    st->prev_iq[0] = 1.0f;
+    st->prev_iq[1] = 0.0f;
+    st->phase = 0;
+    st->freq = 0.0f;
+    st->arm_i = st->arm_q = 0.0f;
+    st->blend = 0.0f;
+    memset(st->deemph, 0, sizeof(st->deemph));
+    memset(st->dc_x1, 0, sizeof(st->dc_x1));
+    memset(st->dc_y1, 0, sizeof(st->dc_y1));
+    memset(st->z1, 0, sizeof(st->z1));
+    memset(st->z2, 0, sizeof(st->z2));
+}
+
+int fm_stereo_locked(const fm_stereo_t *st) {
+    return st && st->blend > 0.9f;
+}
+
+/**
+ * @brief Pilot PLL, pilot cancellation and 38 kHz product over mpx_buf -> sd_buf (sum, diff).
+ */
+static void stereo_mpx(fm_stereo_t *st, int n) {
+    const uint32_t shift = 32 - FM_STEREO_NCO_BITS;
+    const uint32_t quarter = FM_STEREO_NCO_SIZE / 4;
+    const uint32_t mask = FM_STEREO_NCO_SIZE - 1;
+    const float rad_to_phase = 4294967296.0f / (2.0f * (float)M_PI);
+
+    uint32_t phase = st->phase;
+    float arm_i = st->arm_i, arm_q = st->arm_q;
+    float freq = st->freq, blend = st->blend;
+
+    for (int i = 0; i < n; i++) {
+        uint32_t idx = phase >> shift;
+        float s = st->nco_sin[idx];
+        float c = st->nco_sin[(idx + quarter) & mask];
+        float x = st->mpx_buf[i];
+
+        // Pilot ~ A sin(theta + e): arm_i -> (A/2) cos e, arm_q -> (A/2) sin e
+        arm_i += st->arm_coef * (x * s - arm_i);
+        arm_q += st->arm_coef * (x * c - arm_q);
+        float err = arm_q / (fabsf(arm_i) + fabsf(arm_q) + 1e-9f);
+
+        freq += st->ki * err;
+        float step = st->w0 + freq + st->kp * err;
+
+        // Remove the pilot itself, then L-R = 2 * x * sin(2 theta)
+        float clean = x - 2.0f * arm_i * s;
+        float s2 = st->nco_sin[(phase << 1) >> shift];
+        phase += (uint32_t)(int32_t)(step * rad_to_phase);
+
+        bool locked = arm_i > st->lock_thr && fabsf(arm_q) < 0.3f * arm_i;
+        blend += st->blend_coef * ((locked ? 1.0f : 0.0f) - blend);
+
+        st->sd_buf[2*i]     = clean;
+        st->sd_buf[2*i + 1] = 2.0f * clean * s2 * blend;
+    }
+
+    st->phase = phase;
+    st->arm_i = arm_i;
+    st->arm_q = arm_q;
+    st->freq = freq;
+    st->blend = blend;
+}
+
+int fm_stereo_cf32_to_pcm(fm_stereo_t *st, const float *iq, size_t n_samples, int16_t *pcm_out) {
+    int out = 0;
+    size_t pos = 0;
+
+    while (pos < n_samples) {
+        size_t n = n_samples - pos;
+        if (n > (size_t)st->block_in) n = (size_t)st->block_in;
+
+        fm_discriminate_f32(&iq[2*pos], n, st->prev_iq, st->disc_buf);
+        pos += n;
+
+        int n_mpx = resampler_process(&st->mpx_rs, st->disc_buf, (int)n, st->mpx_buf);
+        stereo_mpx(st, n_mpx);
+
+        int n_a = resampler_process(&st->audio_rs, st->sd_buf, n_mpx, st->audio_buf);
+        for (int k = 0; k < n_a; k++) {
+            float sum  = st->audio_buf[2*k];
+            float diff = st->audio_buf[2*k + 1];
+            pcm_out[2*out]     = stereo_tail(st, 0, sum + diff);
+            pcm_out[2*out + 1] = stereo_tail(st, 1, sum - diff);
+            out++;
+        }
+    }
+    return out;
+}
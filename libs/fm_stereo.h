@@ -0,0 +1,78 @@
+// libs/fm_stereo.h
+#ifndef FM_STEREO_H
+#define FM_STEREO_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "resampler.h"
+#include "fm_radio.h"
+
+#define FM_STEREO_PILOT_HZ   19000.0
+#define FM_STEREO_MPX_MIN_FS 120000.0   // MPX rate floor: L-R reaches 53 kHz
+#define FM_STEREO_NCO_BITS   12
+#define FM_STEREO_NCO_SIZE   (1 << FM_STEREO_NCO_BITS)
+#define FM_STEREO_AUDIO_HZ   15000.0
+
+// --- Broadcast FM stereo: discriminator -> MPX decimation -> pilot PLL -> L+R / L-R ---
+typedef struct {
+    double fs;              // discriminator (channel) rate
+    double fs_mpx;          // after integer decimation, >= FM_STEREO_MPX_MIN_FS
+    int audio_fs;
+
+    float prev_iq[2];
+    resampler_t mpx_rs;     // fs -> fs_mpx, 1 channel
+    resampler_t audio_rs;   // fs_mpx -> audio_fs, 2 channels (sum, diff)
+    int block_in;
+
+    // Pilot PLL (32-bit phase, table NCO)
+    uint32_t phase;
+    float w0;               // nominal pilot step, rad/sample at fs_mpx
+    float freq;             // integrator of the loop filter, rad/sample
+    float kp, ki;
+    float arm_coef;         // I/Q arm low-pass
+    float arm_i, arm_q;     // arm_i ~ pilot amplitude / 2 when locked
+    float lock_thr;
+    float blend;            // 0 = mono .. 1 = full separation
+    float blend_coef;
+    float nco_sin[FM_STEREO_NCO_SIZE];
+
+    // Audio tail, per channel (L, R)
+    float deemph_alpha;
+    float deemph[2];
+    float dc_r, dc_x1[2], dc_y1[2];
+    float b0, b1, b2, a1, a2;
+    float z1[2], z2[2];
+    float gain;
+
+    float disc_buf[FM_RADIO_BLOCK];
+    float mpx_buf[FM_RADIO_BLOCK];
+    float sd_buf[2 * FM_RADIO_BLOCK];
+    float audio_buf[2 * FM_RADIO_BLOCK];
+} fm_stereo_t;
+
+/**
+ * @brief Setup the stereo decoder at channel rate fs (>= 2 * FM_STEREO_MPX_MIN_FS is best).
+ * @return 0 on success, -1 on error.
+ */
+int fm_stereo_init(fm_stereo_t *st, double fs, int audio_fs, int deemph_us);
+
+void fm_stereo_free(fm_stereo_t *st);
+
+/**
+ * @brief Clears PLL, filters and resampler state.
+ */
+void fm_stereo_reset(fm_stereo_t *st);
+
+/**
+ * @brief Demodulates interleaved float IQ at fs into interleaved L/R PCM16.
+ * Falls back to mono (L = R) while the pilot is absent.
+ * @return Number of stereo frames written (2 int16 each).
+ */
+int fm_stereo_cf32_to_pcm(fm_stereo_t *st, const float *iq, size_t n_samples, int16_t *pcm_out);
+
+/**
+ * @brief 1 once the pilot PLL is locked and separation is fully blended in.
+ */
+int fm_stereo_locked(const fm_stereo_t *st);
+
+#endif
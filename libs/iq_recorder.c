@@ -0,0 +1,522 @@
+// libs/iq_recorder.c
+#include "iq_recorder.h"
+#include "rt_policy.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <time.h>
+#include <pthread.h>
+#include <semaphore.h>
+#include <cjson/cJSON.h>
+
+#define QLEN 32     // power of two >= IQ_REC_NBUFS + 2 (all buffers + end marker)
+#define Q_END (-1)  // after the last buffer of a recording
+
+_Static_assert(QLEN >= IQ_REC_NBUFS + 2 && (QLEN & (QLEN - 1)) == 0, "QLEN too small");
+
+// Single producer / single consumer queue of buffer indices
+typedef struct {
+    int slot[QLEN];
+    volatile unsigned head;
+    volatile unsigned tail;
+} idx_q_t;
+
+typedef enum { NOTE_CAPTURE, NOTE_DROP, NOTE_WRITE_ERROR } note_kind_t;
+
+typedef struct {
+    note_kind_t kind;
+    uint64_t sample;            // file position (samples) where it applies
+    uint64_t count;             // NOTE_DROP / NOTE_WRITE_ERROR: samples that never reached the file
+    SDR_cfg_t cfg;              // NOTE_CAPTURE
+    char datetime[32];
+} iq_note_t;
+
+struct iq_rec {
+    pthread_mutex_t lock;       // producer vs start/stop/set_tuner
+    volatile bool active;
+
+    uint8_t *buf[IQ_REC_NBUFS];
+    size_t fill[IQ_REC_NBUFS];
+    idx_q_t free_q;             // writer -> producer
+    idx_q_t full_q;             // producer -> writer
+    sem_t full_sem;
+    int cur;                    // buffer being filled, -1 = none
+
+    pthread_t writer;
+    bool writer_alive;
+    int fd;
+    volatile bool direct;
+
+    SDR_cfg_t tuner;
+    bool tuner_valid;
+    iq_rec_req_t req;
+    double fs;                  // the recording's sample rate
+    uint64_t limit_bytes;       // 0 = none
+    uint64_t accepted;
+    uint64_t dropped;
+    volatile uint64_t written;
+    volatile int write_errno;   // set by the writer; the next push ends the recording
+    double write_mb_s;
+    bool drop_open;             // last push dropped: extend the same annotation
+
+    iq_note_t notes[IQ_REC_MAX_NOTES];
+    int n_notes;
+    uint64_t notes_lost;
+};
+
+static bool q_push(idx_q_t *q, int v) {
+    unsigned h = q->head;
+    if (h - __atomic_load_n(&q->tail, __ATOMIC_ACQUIRE) >= QLEN) return false;
+    q->slot[h % QLEN] = v;
+    __atomic_store_n(&q->head, h + 1, __ATOMIC_RELEASE);
+    return true;
+}
+
+static bool q_pop(idx_q_t *q, int *v) {
+    unsigned t = q->tail;
+    if (t == __atomic_load_n(&q->head, __ATOMIC_ACQUIRE)) return false;
+    *v = q->slot[t % QLEN];
+    __atomic_store_n(&q->tail, t + 1, __ATOMIC_RELEASE);
+    return true;
+}
+
+static void iso8601_now(char *out, size_t n) {
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    struct tm tm;
+    gmtime_r(&ts.tv_sec, &tm);
+    char base[24];
+    strftime(base, sizeof(base), "%Y-%m-%dT%H:%M:%S", &tm);
+    snprintf(out, n, "%s.%03dZ", base, (int)(ts.tv_nsec / 1000000L));
+}
+
+static iq_note_t* add_note(iq_rec_t *rec, note_kind_t kind) {
+    if (rec->n_notes >= IQ_REC_MAX_NOTES) {
+        rec->notes_lost++;
+        return NULL;
+    }
+    iq_note_t *n = &rec->notes[rec->n_notes++];
+    memset(n, 0, sizeof(*n));
+    n->kind = kind;
+    n->sample = rec->accepted / 2;
+    iso8601_now(n->datetime, sizeof(n->datetime));
+    return n;
+}
+
+// =========================================================
+// Writer thread
+static int write_all(iq_rec_t *rec, const uint8_t *p, size_t n) {
+    while (n > 0) {
+        ssize_t w = write(rec->fd, p, n);
+        if (w < 0) {
+            if (errno == EINTR) continue;
+            if (errno == EINVAL && rec->direct) {
+                // Accepted at open, refused on write: fall back to the page cache
+                fprintf(stderr, "[REC] O_DIRECT write refused, using buffered I/O\n");
+                fcntl(rec->fd, F_SETFL, fcntl(rec->fd, F_GETFL) & ~O_DIRECT);
+                rec->direct = false;
+                continue;
+            }
+            __atomic_store_n(&rec->write_errno, errno, __ATOMIC_RELEASE);
+            fprintf(stderr, "[REC] write failed: %s\n", strerror(errno));
+            return -1;
+        }
+        p += w;
+        n -= (size_t)w;
+        __atomic_add_fetch(&rec->written, (uint64_t)w, __ATOMIC_RELAXED);
+    }
+    return 0;
+}
+
+static int write_buffer(iq_rec_t *rec, int idx) {
+    const uint8_t *p = rec->buf[idx];
+    size_t n = rec->fill[idx];
+    if (n == 0) return 0;
+
+    struct timespec t0, t1;
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+
+    int rc;
+    if (rec->direct && (n % IQ_REC_ALIGN) != 0) {
+        // Only the last buffer is partial: aligned prefix direct, the tail through the cache
+        size_t head = n - (n % IQ_REC_ALIGN);
+        rc = write_all(rec, p, head);
+        if (rc == 0) {
+            fcntl(rec->fd, F_SETFL, fcntl(rec->fd, F_GETFL) & ~O_DIRECT);
+            rc = write_all(rec, p + head, n - head);
+        }
+    } else {
+        rc = write_all(rec, p, n);
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    double dt = (double)(t1.tv_sec - t0.tv_sec) + (double)(t1.tv_nsec - t0.tv_nsec) * 1e-9;
+    if (dt > 0.0) {
+        double mb_s = (double)n / dt / 1e6;
+        rec->write_mb_s = (rec->write_mb_s > 0.0) ? 0.8 * rec->write_mb_s + 0.2 * mb_s : mb_s;
+    }
+    return rc;
+}
+
+static void add_capture_json(cJSON *arr, const iq_note_t *n) {
+    cJSON *c = cJSON_CreateObject();
+    cJSON_AddNumberToObject(c, "core:sample_start", (double)n->sample);
+    cJSON_AddNumberToObject(c, "core:frequency", (double)n->cfg.center_freq);
+    cJSON_AddStringToObject(c, "core:datetime", n->datetime);
+    cJSON_AddBoolToObject(c, "rf_engine:amp_enabled", n->cfg.amp_enabled);
+    cJSON_AddNumberToObject(c, "rf_engine:lna_gain_db", n->cfg.lna_gain);
+    cJSON_AddNumberToObject(c, "rf_engine:vga_gain_db", n->cfg.vga_gain);
+    cJSON_AddNumberToObject(c, "rf_engine:ppm_error", n->cfg.ppm_error);
+    cJSON_AddItemToArray(arr, c);
+}
+
+static int write_meta(iq_rec_t *rec) {
+    cJSON *root = cJSON_CreateObject();
+    cJSON *global = cJSON_CreateObject();
+    cJSON_AddStringToObject(global, "core:datatype", "ci8");
+    cJSON_AddNumberToObject(global, "core:sample_rate", rec->fs);
+    cJSON_AddStringToObject(global, "core:version", "1.0.0");
+    cJSON_AddStringToObject(global, "core:recorder", "rf_engine");
+    if (rec->req.hw[0]) cJSON_AddStringToObject(global, "core:hw", rec->req.hw);
+    if (rec->req.description[0]) cJSON_AddStringToObject(global, "core:description", rec->req.description);
+    cJSON_AddNumberToObject(global, "rf_engine:dropped_bytes", (double)rec->dropped);
+    cJSON_AddItemToObject(root, "global", global);
+
+    cJSON *captures = cJSON_CreateArray();
+    cJSON *annotations = cJSON_CreateArray();
+    int segment = 0;
+    for (int i = 0; i < rec->n_notes; i++) {
+        const iq_note_t *n = &rec->notes[i];
+        cJSON *a = NULL;
+        char comment[96];
+        if (n->kind == NOTE_CAPTURE) {
+            add_capture_json(captures, n);
+            if (segment++ == 0) continue;
+            a = cJSON_CreateObject();
+            snprintf(comment, sizeof(comment), "retune to %lu Hz", n->cfg.center_freq);
+        } else {
+            a = cJSON_CreateObject();
+            cJSON_AddNumberToObject(a, "core:sample_count", (double)n->count);
+            if (n->kind == NOTE_DROP) snprintf(comment, sizeof(comment), "%lu samples dropped (writer behind)", n->count);
+            else snprintf(comment, sizeof(comment), "%lu samples lost (write error: %s)", n->count,
+                          strerror(rec->write_errno));
+        }
+        cJSON_AddNumberToObject(a, "core:sample_start", (double)n->sample);
+        cJSON_AddStringToObject(a, "core:comment", comment);
+        cJSON_AddItemToArray(annotations, a);
+    }
+    cJSON_AddItemToObject(root, "captures", captures);
+    cJSON_AddItemToObject(root, "annotations", annotations);
+
+    char path[300];
+    snprintf(path, sizeof(path), "%s.sigmf-meta", rec->req.base);
+    char *txt = cJSON_Print(root);
+    cJSON_Delete(root);
+    if (!txt) return -1;
+
+    FILE *f = fopen(path, "w");
+    int rc = -1;
+    if (f) {
+        rc = (fputs(txt, f) >= 0 && fputc('\n', f) != EOF) ? 0 : -1;
+        if (fclose(f) != 0) rc = -1;
+    }
+    if (rc != 0) fprintf(stderr, "[REC] cannot write %s\n", path);
+    free(txt);
+    return rc;
+}
+
+/**
+ * @brief After a write error: bytes accepted past the end of the data file become
+ * dropped, and notes beyond that end fold into one NOTE_WRITE_ERROR there.
+ */
+static void settle_unwritten_locked(iq_rec_t *rec) {
+    uint64_t on_disk = __atomic_load_n(&rec->written, __ATOMIC_RELAXED) & ~1ULL;
+    if (rec->accepted <= on_disk) return;
+
+    uint64_t lost = (rec->accepted - on_disk) / 2;
+    rec->dropped += rec->accepted - on_disk;
+    rec->accepted = on_disk;
+
+    int kept = 1;   // the first capture is at sample 0
+    for (int i = 1; i < rec->n_notes; i++) {
+        const iq_note_t *n = &rec->notes[i];
+        if (n->sample < on_disk / 2) rec->notes[kept++] = *n;
+        else if (n->kind != NOTE_CAPTURE) lost += n->count;
+    }
+    rec->n_notes = kept;
+    iq_note_t *n = add_note(rec, NOTE_WRITE_ERROR);
+    if (n) n->count = lost;
+}
+
+static void* writer_fn(void *arg) {
+    iq_rec_t *rec = (iq_rec_t*)arg;
+    bool failed = false;
+    rt_policy_apply("rec", NULL);
+
+    for (;;) {
+        int idx;
+        while (!q_pop(&rec->full_q, &idx)) {
+            while (sem_wait(&rec->full_sem) != 0 && errno == EINTR) { }
+        }
+        if (idx == Q_END) break;
+
+        // After a failed write only recycle: the next push ends the recording
+        if (!failed && write_buffer(rec, idx) != 0) failed = true;
+        rec->fill[idx] = 0;
+        q_push(&rec->free_q, idx);
+    }
+
+    fsync(rec->fd);
+    close(rec->fd);
+    rec->fd = -1;
+
+    pthread_mutex_lock(&rec->lock);   // notes are final, the lock orders their stores
+    if (failed) settle_unwritten_locked(rec);
+    write_meta(rec);
+    int segments = 0;
+    for (int i = 0; i < rec->n_notes; i++) segments += (rec->notes[i].kind == NOTE_CAPTURE);
+    printf("[REC] %s: %.1f MB written, %lu bytes dropped, %d capture segment(s)%s%s\n",
+           rec->req.base, (double)rec->written / 1e6, rec->dropped, segments,
+           failed ? ", write error: " : "", failed ? strerror(rec->write_errno) : "");
+    pthread_mutex_unlock(&rec->lock);
+    return NULL;
+}
+
+// =========================================================
+// Producer / control (lock held)
+static void hand_over_locked(iq_rec_t *rec) {
+    if (rec->cur < 0) return;
+    q_push(&rec->full_q, rec->cur);
+    sem_post(&rec->full_sem);
+    rec->cur = -1;
+}
+
+static void end_locked(iq_rec_t *rec, const char *why) {
+    if (!rec->active) return;
+    __atomic_store_n(&rec->active, false, __ATOMIC_RELEASE);
+    hand_over_locked(rec);
+    q_push(&rec->full_q, Q_END);
+    sem_post(&rec->full_sem);
+    printf("[REC] %s: stopping (%s)\n", rec->req.base, why);
+}
+
+void iq_rec_push(iq_rec_t *rec, const uint8_t *data, size_t len) {
+    if (!rec || !__atomic_load_n(&rec->active, __ATOMIC_ACQUIRE)) return;
+
+    pthread_mutex_lock(&rec->lock);
+    if (!rec->active) {
+        pthread_mutex_unlock(&rec->lock);
+        return;
+    }
+    if (__atomic_load_n(&rec->write_errno, __ATOMIC_ACQUIRE) != 0) {
+        end_locked(rec, "write error");
+        pthread_mutex_unlock(&rec->lock);
+        return;
+    }
+
+    size_t n = len;
+    if (rec->limit_bytes && rec->accepted + rec->dropped + n > rec->limit_bytes) {
+        n = (size_t)(rec->limit_bytes - rec->accepted - rec->dropped);
+    }
+
+    size_t off = 0;
+    while (off < n) {
+        if (rec->cur < 0 && !q_pop(&rec->free_q, &rec->cur)) {
+            rec->cur = -1;
+            break;
+        }
+        size_t room = IQ_REC_BUF_BYTES - rec->fill[rec->cur];
+        size_t k = (n - off < room) ? n - off : room;
+        memcpy(rec->buf[rec->cur] + rec->fill[rec->cur], data + off, k);
+        rec->fill[rec->cur] += k;
+        off += k;
+        if (rec->fill[rec->cur] == IQ_REC_BUF_BYTES) hand_over_locked(rec);
+    }
+    rec->accepted += off;
+
+    if (off < n) {
+        uint64_t lost = n - off;
+        rec->dropped += lost;
+        if (rec->drop_open && rec->n_notes > 0 && rec->notes[rec->n_notes - 1].kind == NOTE_DROP) {
+            rec->notes[rec->n_notes - 1].count += lost / 2;
+        } else {
+            iq_note_t *note = add_note(rec, NOTE_DROP);
+            if (note) note->count = lost / 2;
+        }
+        rec->drop_open = true;
+    } else {
+        rec->drop_open = false;
+    }
+
+    // Limits count the stream, dropped or not: a 10 s recording covers 10 s of air
+    if (rec->limit_bytes && rec->accepted + rec->dropped >= rec->limit_bytes) end_locked(rec, "limit reached");
+    pthread_mutex_unlock(&rec->lock);
+}
+
+void iq_rec_set_tuner(iq_rec_t *rec, const SDR_cfg_t *cfg) {
+    if (!rec || !cfg) return;
+    pthread_mutex_lock(&rec->lock);
+    rec->tuner = *cfg;
+    rec->tuner_valid = true;
+
+    if (rec->active) {
+        if (cfg->sample_rate != rec->fs) {
+            // SigMF has one core:sample_rate per recording
+            end_locked(rec, "sample rate changed");
+        } else {
+            // Two retunes with no sample in between share one segment (sample_start is unique)
+            iq_note_t *n = (rec->n_notes > 0) ? &rec->notes[rec->n_notes - 1] : NULL;
+            if (!n || n->kind != NOTE_CAPTURE || n->sample != rec->accepted / 2) n = add_note(rec, NOTE_CAPTURE);
+            if (n) n->cfg = *cfg;
+        }
+    }
+    pthread_mutex_unlock(&rec->lock);
+}
+
+// =========================================================
+// Lifecycle
+iq_rec_t* iq_rec_create(void) {
+    iq_rec_t *rec = (iq_rec_t*)calloc(1, sizeof(iq_rec_t));
+    if (!rec) return NULL;
+    pthread_mutex_init(&rec->lock, NULL);
+    sem_init(&rec->full_sem, 0, 0);
+    rec->cur = -1;
+    rec->fd = -1;
+    return rec;
+}
+
+static void reap_writer(iq_rec_t *rec) {
+    if (!rec->writer_alive) return;
+    pthread_join(rec->writer, NULL);
+    rec->writer_alive = false;
+}
+
+int iq_rec_start(iq_rec_t *rec, const iq_rec_req_t *req) {
+    if (!rec || !req || !req->base[0]) return -1;
+
+    pthread_mutex_lock(&rec->lock);
+    if (rec->active) {
+        pthread_mutex_unlock(&rec->lock);
+        fprintf(stderr, "[REC] already recording %s\n", rec->req.base);
+        return -1;
+    }
+    if (!rec->tuner_valid || rec->tuner.sample_rate <= 0.0) {
+        pthread_mutex_unlock(&rec->lock);
+        fprintf(stderr, "[REC] no tuner configuration yet\n");
+        return -1;
+    }
+    pthread_mutex_unlock(&rec->lock);
+
+    reap_writer(rec);   // previous recording that hit its limit
+
+    for (int i = 0; i < IQ_REC_NBUFS; i++) {
+        if (rec->buf[i]) continue;
+        if (posix_memalign((void**)&rec->buf[i], IQ_REC_ALIGN, IQ_REC_BUF_BYTES) != 0) {
+            rec->buf[i] = NULL;
+            fprintf(stderr, "[REC] cannot allocate %d MB of buffers\n", IQ_REC_NBUFS * (IQ_REC_BUF_BYTES >> 20));
+            return -1;
+        }
+        // Touch every page now: a first-touch fault inside rx_callback costs more than the copy
+        memset(rec->buf[i], 0, IQ_REC_BUF_BYTES);
+    }
+
+    char path[300];
+    snprintf(path, sizeof(path), "%s.sigmf-data", req->base);
+    bool direct = true;
+    int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC | O_DIRECT, 0644);
+    if (fd < 0 && errno == EINVAL) {
+        direct = false;
+        fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    }
+    if (fd < 0) {
+        fprintf(stderr, "[REC] cannot create %s: %s\n", path, strerror(errno));
+        return -1;
+    }
+
+    pthread_mutex_lock(&rec->lock);
+    rec->req = *req;
+    rec->fd = fd;
+    rec->direct = direct;
+    rec->fs = rec->tuner.sample_rate;
+    rec->accepted = rec->dropped = 0;
+    rec->written = 0;
+    rec->write_errno = 0;
+    rec->write_mb_s = 0.0;
+    rec->drop_open = false;
+    rec->n_notes = 0;
+    rec->notes_lost = 0;
+
+    uint64_t lim_s = (req->max_seconds > 0.0) ? (uint64_t)(req->max_seconds * rec->fs) * 2 : 0;
+    rec->limit_bytes = req->max_bytes & ~1ULL;
+    if (lim_s && (!rec->limit_bytes || lim_s < rec->limit_bytes)) rec->limit_bytes = lim_s;
+
+    memset(&rec->free_q, 0, sizeof(rec->free_q));
+    memset(&rec->full_q, 0, sizeof(rec->full_q));
+    while (sem_trywait(&rec->full_sem) == 0) { }
+    for (int i = 0; i < IQ_REC_NBUFS; i++) {
+        rec->fill[i] = 0;
+        q_push(&rec->free_q, i);
+    }
+    rec->cur = -1;
+
+    iq_note_t *n = add_note(rec, NOTE_CAPTURE);
+    if (n) n->cfg = rec->tuner;
+
+    if (pthread_create(&rec->writer, NULL, writer_fn, rec) != 0) {
+        pthread_mutex_unlock(&rec->lock);
+        close(fd);
+        rec->fd = -1;
+        return -1;
+    }
+    rec->writer_alive = true;
+    __atomic_store_n(&rec->active, true, __ATOMIC_RELEASE);
+    pthread_mutex_unlock(&rec->lock);
+
+    printf("[REC] %s.sigmf-data: %.0f Hz at %lu Hz, %s I/O, limit %s\n", req->base, rec->fs,
+           rec->tuner.center_freq, direct ? "O_DIRECT" : "buffered",
+           rec->limit_bytes ? "set" : "none");
+    return 0;
+}
+
+int iq_rec_stop(iq_rec_t *rec) {
+    if (!rec) return -1;
+    pthread_mutex_lock(&rec->lock);
+    bool had = rec->active || rec->writer_alive;
+    end_locked(rec, "stop command");
+    pthread_mutex_unlock(&rec->lock);
+    reap_writer(rec);
+    return had ? 0 : -1;
+}
+
+void iq_rec_get_stats(iq_rec_t *rec, iq_rec_stats_t *out) {
+    if (!out) return;
+    memset(out, 0, sizeof(*out));
+    if (!rec) return;
+    pthread_mutex_lock(&rec->lock);
+    out->active = rec->active;
+    out->direct = rec->direct;
+    snprintf(out->base, sizeof(out->base), "%s", rec->req.base);
+    out->bytes_written = __atomic_load_n(&rec->written, __ATOMIC_RELAXED);
+    out->bytes_accepted = rec->accepted;
+    out->bytes_dropped = rec->dropped;
+    out->seconds = (rec->fs > 0.0) ? (double)rec->accepted / 2.0 / rec->fs : 0.0;
+    out->write_mb_s = rec->write_mb_s;
+    out->write_errno = __atomic_load_n(&rec->write_errno, __ATOMIC_ACQUIRE);
+    for (int i = 1; i < rec->n_notes; i++) {
+        if (rec->notes[i].kind == NOTE_CAPTURE) out->retunes++;
+    }
+    pthread_mutex_unlock(&rec->lock);
+}
+
+void iq_rec_destroy(iq_rec_t *rec) {
+    if (!rec) return;
+    iq_rec_stop(rec);
+    for (int i = 0; i < IQ_REC_NBUFS; i++) free(rec->buf[i]);
+    sem_destroy(&rec->full_sem);
+    pthread_mutex_destroy(&rec->lock);
+    free(rec);
+}
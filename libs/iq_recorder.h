@@ -0,0 +1,74 @@
+// libs/iq_recorder.h
+#ifndef IQ_RECORDER_H
+#define IQ_RECORDER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "sdr_HAL.h"
+
+// --- Raw IQ to SigMF (<base>.sigmf-data + <base>.sigmf-meta, datatype ci8) ---
+// rx_callback copies into a pool of large page-aligned buffers and never waits:
+// with no free buffer the bytes are counted as dropped and annotated. A writer
+// thread issues one O_DIRECT write per full buffer (buffered I/O where the
+// filesystem refuses O_DIRECT, e.g. tmpfs). A write error (ENOSPC, ...) ends the
+// recording; what never reached the file is counted as dropped.
+#define IQ_REC_BUF_BYTES    (4 * 1024 * 1024)   // one write; multiple of any sector size
+#define IQ_REC_NBUFS        16                  // 64 MB in flight: 1.6 s at 20 MS/s
+#define IQ_REC_ALIGN        4096
+#define IQ_REC_MAX_NOTES    1024                // captures + annotations kept for the meta file
+
+typedef struct {
+    char base[256];             // output path without extension
+    uint64_t max_bytes;         // 0 = no limit
+    double max_seconds;         // 0 = no limit
+    char description[128];
+    char hw[64];                // core:hw
+} iq_rec_req_t;
+
+typedef struct {
+    bool active;                // accepting samples
+    bool direct;                // O_DIRECT in use
+    char base[256];
+    uint64_t bytes_written;     // on disk
+    uint64_t bytes_accepted;    // handed to the writer (written + queued)
+    uint64_t bytes_dropped;     // writer behind: never reached the file
+    double seconds;             // bytes_accepted at the recording's sample rate
+    double write_mb_s;          // disk throughput of the last buffer writes
+    int write_errno;            // 0, or the write error that ended the recording
+    int retunes;
+} iq_rec_stats_t;
+
+typedef struct iq_rec iq_rec_t;
+
+iq_rec_t* iq_rec_create(void);
+void iq_rec_destroy(iq_rec_t *rec);
+
+/**
+ * @brief Opens <base>.sigmf-data and starts accepting samples from iq_rec_push.
+ * Needs a tuner state from iq_rec_set_tuner (the first capture segment).
+ * @return 0 on success, -1 if already recording, no tuner yet, or the file cannot be created.
+ */
+int iq_rec_start(iq_rec_t *rec, const iq_rec_req_t *req);
+
+/**
+ * @brief Stops accepting, drains the queue, writes the tail and the meta file.
+ * Also reaps a recording that already ended on its own (limit reached).
+ */
+int iq_rec_stop(iq_rec_t *rec);
+
+/**
+ * @brief Producer side (rx_callback). Cheap no-op while idle.
+ */
+void iq_rec_push(iq_rec_t *rec, const uint8_t *data, size_t len);
+
+/**
+ * @brief Tuner applied. While recording a frequency/gain change opens a new capture
+ * segment at the current sample; a sample rate change ends the recording.
+ */
+void iq_rec_set_tuner(iq_rec_t *rec, const SDR_cfg_t *cfg);
+
+void iq_rec_get_stats(iq_rec_t *rec, iq_rec_stats_t *out);
+
+#endif
@@ -0,0 +1,88 @@
+// libs/latency.c
+#include "latency.h"
+
+#include <string.h>
+#include <time.h>
+
+uint64_t lat_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+uint64_t lat_mono_to_unix_ns(uint64_t mono_ns) {
+    struct timespec rt;
+    clock_gettime(CLOCK_REALTIME, &rt);
+    uint64_t rt_ns = (uint64_t)rt.tv_sec * 1000000000ULL + (uint64_t)rt.tv_nsec;
+    uint64_t now = lat_now_ns();
+    return rt_ns - (now - mono_ns);
+}
+
+void lat_hist_reset(lat_hist_t *h) {
+    if (h) memset(h, 0, sizeof(*h));
+}
+
+int lat_hist_bucket(uint64_t ns) {
+    if (ns < (1ULL << LAT_HIST_MIN_SHIFT)) return 0;
+    int l = 63 - __builtin_clzll(ns);
+    int sub = (int)((ns >> (l - LAT_HIST_SUB_BITS)) & ((1u << LAT_HIST_SUB_BITS) - 1));
+    int b = 1 + ((l - LAT_HIST_MIN_SHIFT) << LAT_HIST_SUB_BITS) + sub;
+    return (b < LAT_HIST_BUCKETS) ? b : LAT_HIST_BUCKETS - 1;
+}
+
+uint64_t lat_hist_bucket_upper_ns(int b) {
+    if (b <= 0) return 1ULL << LAT_HIST_MIN_SHIFT;
+    int l = LAT_HIST_MIN_SHIFT + ((b - 1) >> LAT_HIST_SUB_BITS);
+    uint64_t sub = (uint64_t)((b - 1) & ((1 << LAT_HIST_SUB_BITS) - 1));
+    return (1ULL << l) + ((sub + 1) << (l - LAT_HIST_SUB_BITS));
+}
+
+void lat_hist_add(lat_hist_t *h, uint64_t ns) {
+    h->count[lat_hist_bucket(ns)]++;
+    h->n++;
+    h->sum_ns += ns;
+    if (ns > h->max_ns) h->max_ns = ns;
+}
+
+uint64_t lat_hist_quantile_ns(const lat_hist_t *h, double q) {
+    if (!h || h->n == 0) return 0;
+    uint64_t want = (uint64_t)(q * (double)h->n);
+    if (want >= h->n) want = h->n - 1;
+
+    uint64_t seen = 0;
+    for (int b = 0; b < LAT_HIST_BUCKETS; b++) {
+        seen += h->count[b];
+        if (seen > want) {
+            uint64_t up = lat_hist_bucket_upper_ns(b);
+            return (up < h->max_ns) ? up : h->max_ns;
+        }
+    }
+    return h->max_ns;
+}
+
+void lat_timeline_mark(lat_timeline_t *tl, uint64_t pos_end, uint64_t t_ns) {
+    uint64_t c = tl->count;
+    lat_mark_t *m = &tl->mark[c % LAT_TIMELINE_MARKS];
+    m->pos = pos_end;
+    m->t_ns = t_ns;
+    __atomic_store_n(&tl->count, c + 1, __ATOMIC_RELEASE);
+}
+
+uint64_t lat_timeline_lookup(const lat_timeline_t *tl, uint64_t pos, double bytes_per_s) {
+    uint64_t c = __atomic_load_n(&tl->count, __ATOMIC_ACQUIRE);
+    if (c == 0 || bytes_per_s <= 0.0) return 0;
+
+    // Newest to oldest: the transfer holding pos is the oldest mark with pos_end >= pos.
+    // Half the marks are kept as margin against the writer lapping the scan.
+    uint64_t lo = (c > LAT_TIMELINE_MARKS / 2) ? c - LAT_TIMELINE_MARKS / 2 : 0;
+    lat_mark_t hit = {0, 0};
+    for (uint64_t i = c; i > lo; i--) {
+        lat_mark_t m = tl->mark[(i - 1) % LAT_TIMELINE_MARKS];
+        if (m.pos < pos) break;
+        hit = m;
+    }
+    if (hit.t_ns == 0) return 0;
+
+    uint64_t ahead_ns = (uint64_t)((double)(hit.pos - pos) * 1e9 / bytes_per_s);
+    return (hit.t_ns > ahead_ns) ? hit.t_ns - ahead_ns : 0;
+}
@@ -0,0 +1,74 @@
+// libs/latency.h
+#ifndef LATENCY_H
+#define LATENCY_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// --- Log-scale histogram: four buckets per octave (<= 19% wide) from 1 us to ~68 s ---
+#define LAT_HIST_MIN_SHIFT  10          // bucket 0 holds everything below 2^10 ns
+#define LAT_HIST_SUB_BITS   2           // 2^2 buckets per octave
+#define LAT_HIST_BUCKETS    (1 + (26 << LAT_HIST_SUB_BITS))
+
+typedef struct {
+    uint32_t count[LAT_HIST_BUCKETS];
+    uint64_t n;
+    uint64_t sum_ns;
+    uint64_t max_ns;
+} lat_hist_t;
+
+// --- Capture timeline: byte position in a stream -> CLOCK_MONOTONIC time ---
+// rx_callback marks the end of every transfer it writes; the reader interpolates
+// inside a transfer with the sample rate. Single writer, single reader, no lock.
+#define LAT_TIMELINE_MARKS  256
+
+typedef struct {
+    uint64_t pos;       // stream bytes written up to the end of the transfer
+    uint64_t t_ns;      // when the transfer reached the host
+} lat_mark_t;
+
+typedef struct {
+    lat_mark_t mark[LAT_TIMELINE_MARKS];
+    volatile uint64_t count;    // marks written so far
+} lat_timeline_t;
+
+/**
+ * @brief CLOCK_MONOTONIC in ns (the clock every stage stamp uses).
+ */
+uint64_t lat_now_ns(void);
+
+/**
+ * @brief Converts a CLOCK_MONOTONIC stamp to Unix time (ns) for other hosts.
+ */
+uint64_t lat_mono_to_unix_ns(uint64_t mono_ns);
+
+void lat_hist_reset(lat_hist_t *h);
+void lat_hist_add(lat_hist_t *h, uint64_t ns);
+
+/**
+ * @brief Bucket index of a value (lat_hist_add without the counters, for callers keeping their own).
+ */
+int lat_hist_bucket(uint64_t ns);
+
+/**
+ * @brief Upper edge of bucket b in ns.
+ */
+uint64_t lat_hist_bucket_upper_ns(int b);
+
+/**
+ * @brief Upper edge of the bucket holding quantile q (0..1), capped at max_ns. 0 if empty.
+ */
+uint64_t lat_hist_quantile_ns(const lat_hist_t *h, double q);
+
+/**
+ * @brief Producer side: pos_end bytes have been written, the last one arrived at t_ns.
+ */
+void lat_timeline_mark(lat_timeline_t *tl, uint64_t pos_end, uint64_t t_ns);
+
+/**
+ * @brief Capture time of the byte at pos, or 0 if it is older than the kept marks.
+ * @param bytes_per_s Stream rate (2 bytes per int8 IQ sample).
+ */
+uint64_t lat_timeline_lookup(const lat_timeline_t *tl, uint64_t pos, double bytes_per_s);
+
+#endif
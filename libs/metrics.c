@@ -0,0 +1,287 @@
+// libs/metrics.c
+#include "metrics.h"
+#include "latency.h"
+#include "rt_policy.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <stdbool.h>
+#include <pthread.h>
+#include <unistd.h>
+
+// One per thread that ever updated a counter or histogram; only its owner writes it.
+// A thread's shard is handed to the next new thread when it exits (totals are sums,
+// so what it counted stays counted).
+typedef struct metrics_shard {
+    struct metrics_shard *next;
+    int in_use;
+    uint64_t counter[METRICS_MAX_COUNTERS];
+    lat_hist_t hist[METRICS_MAX_HISTS];
+} metrics_shard_t;
+
+typedef struct {
+    char name[METRICS_NAME_LEN];
+    uint64_t bits;                  // double, stored atomically
+    metrics_read_fn fn;
+    void *ctx;
+} gauge_t;
+
+static pthread_mutex_t reg_lock = PTHREAD_MUTEX_INITIALIZER;
+static char counter_name[METRICS_MAX_COUNTERS][METRICS_NAME_LEN];
+static char hist_name[METRICS_MAX_HISTS][METRICS_NAME_LEN];
+static gauge_t gauges[METRICS_MAX_GAUGES];
+static int n_counters, n_hists, n_gauges;
+
+static metrics_shard_t *shards;
+static __thread metrics_shard_t *my_shard;
+static pthread_key_t shard_key;
+static pthread_once_t shard_once = PTHREAD_ONCE_INIT;
+
+static uint64_t t_start_ns;
+
+static void shard_release(void *p) {
+    __atomic_store_n(&((metrics_shard_t*)p)->in_use, 0, __ATOMIC_RELEASE);
+}
+
+static void shard_key_init(void) {
+    pthread_key_create(&shard_key, shard_release);
+}
+
+static metrics_shard_t* get_shard(void) {
+    if (my_shard) return my_shard;
+    pthread_once(&shard_once, shard_key_init);
+
+    metrics_shard_t *s = NULL;
+    for (metrics_shard_t *it = __atomic_load_n(&shards, __ATOMIC_ACQUIRE); it; it = it->next) {
+        int free_slot = 0;
+        if (__atomic_compare_exchange_n(&it->in_use, &free_slot, 1, false, __ATOMIC_ACQ_REL, __ATOMIC_RELAXED)) {
+            s = it;
+            break;
+        }
+    }
+    if (!s) {
+        s = (metrics_shard_t*)calloc(1, sizeof(metrics_shard_t));
+        if (!s) return NULL;
+        s->in_use = 1;
+        s->next = __atomic_load_n(&shards, __ATOMIC_RELAXED);
+        while (!__atomic_compare_exchange_n(&shards, &s->next, s, true, __ATOMIC_RELEASE, __ATOMIC_RELAXED)) {}
+    }
+    pthread_setspecific(shard_key, s);
+    my_shard = s;
+    return s;
+}
+
+/** Finds or appends name in a table of n fixed-size names; -1 when full */
+static int reg_name(char (*names)[METRICS_NAME_LEN], int *n, int max, const char *name) {
+    for (int i = 0; i < *n; i++) if (strcmp(names[i], name) == 0) return i;
+    if (*n >= max) {
+        fprintf(stderr, "[METRICS] Warning: registry full, '%s' not recorded\n", name);
+        return -1;
+    }
+    snprintf(names[*n], METRICS_NAME_LEN, "%s", name);
+    __atomic_store_n(n, *n + 1, __ATOMIC_RELEASE);
+    return *n - 1;
+}
+
+metric_id_t metrics_counter(const char *fmt, ...) {
+    char name[METRICS_NAME_LEN];
+    va_list ap;
+    va_start(ap, fmt);
+    vsnprintf(name, sizeof(name), fmt, ap);
+    va_end(ap);
+    pthread_mutex_lock(&reg_lock);
+    if (!t_start_ns) t_start_ns = lat_now_ns();
+    int id = reg_name(counter_name, &n_counters, METRICS_MAX_COUNTERS, name);
+    pthread_mutex_unlock(&reg_lock);
+    return id;
+}
+
+metric_id_t metrics_histogram(const char *fmt, ...) {
+    char name[METRICS_NAME_LEN];
+    va_list ap;
+    va_start(ap, fmt);
+    vsnprintf(name, sizeof(name), fmt, ap);
+    va_end(ap);
+    pthread_mutex_lock(&reg_lock);
+    if (!t_start_ns) t_start_ns = lat_now_ns();
+    int id = reg_name(hist_name, &n_hists, METRICS_MAX_HISTS, name);
+    pthread_mutex_unlock(&reg_lock);
+    return id;
+}
+
+static metric_id_t reg_gauge(metrics_read_fn fn, void *ctx, const char *name) {
+    pthread_mutex_lock(&reg_lock);
+    if (!t_start_ns) t_start_ns = lat_now_ns();
+    int id = -1;
+    for (int i = 0; i < n_gauges; i++) if (strcmp(gauges[i].name, name) == 0) id = i;
+    if (id < 0 && n_gauges < METRICS_MAX_GAUGES) {
+        id = n_gauges;
+        snprintf(gauges[id].name, METRICS_NAME_LEN, "%s", name);
+        __atomic_store_n(&n_gauges, n_gauges + 1, __ATOMIC_RELEASE);
+    } else if (id < 0) {
+        fprintf(stderr, "[METRICS] Warning: registry full, '%s' not recorded\n", name);
+    }
+    if (id >= 0 && fn) {
+        gauges[id].ctx = ctx;
+        __atomic_store_n(&gauges[id].fn, fn, __ATOMIC_RELEASE);
+    }
+    pthread_mutex_unlock(&reg_lock);
+    return id;
+}
+
+metric_id_t metrics_gauge(const char *fmt, ...) {
+    char name[METRICS_NAME_LEN];
+    va_list ap;
+    va_start(ap, fmt);
+    vsnprintf(name, sizeof(name), fmt, ap);
+    va_end(ap);
+    return reg_gauge(NULL, NULL, name);
+}
+
+metric_id_t metrics_gauge_fn(metrics_read_fn fn, void *ctx, const char *fmt, ...) {
+    char name[METRICS_NAME_LEN];
+    va_list ap;
+    va_start(ap, fmt);
+    vsnprintf(name, sizeof(name), fmt, ap);
+    va_end(ap);
+    return reg_gauge(fn, ctx, name);
+}
+
+void metrics_add(metric_id_t id, uint64_t v) {
+    if (id < 0 || id >= METRICS_MAX_COUNTERS) return;
+    metrics_shard_t *s = get_shard();
+    if (!s) return;
+    __atomic_store_n(&s->counter[id], s->counter[id] + v, __ATOMIC_RELAXED);
+}
+
+void metrics_set(metric_id_t id, double v) {
+    if (id < 0 || id >= METRICS_MAX_GAUGES) return;
+    uint64_t bits;
+    memcpy(&bits, &v, sizeof(bits));
+    __atomic_store_n(&gauges[id].bits, bits, __ATOMIC_RELAXED);
+}
+
+void metrics_observe_ns(metric_id_t id, uint64_t ns) {
+    if (id < 0 || id >= METRICS_MAX_HISTS) return;
+    metrics_shard_t *s = get_shard();
+    if (!s) return;
+    lat_hist_t *h = &s->hist[id];
+    int b = lat_hist_bucket(ns);
+    __atomic_store_n(&h->count[b], h->count[b] + 1, __ATOMIC_RELAXED);
+    __atomic_store_n(&h->sum_ns, h->sum_ns + ns, __ATOMIC_RELAXED);
+    if (ns > h->max_ns) __atomic_store_n(&h->max_ns, ns, __ATOMIC_RELAXED);
+    __atomic_store_n(&h->n, h->n + 1, __ATOMIC_RELAXED);
+}
+
+// --- Per-thread CPU time (utime + stime of /proc/self/task/<tid>/stat) ---
+static double thread_cpu_s(pid_t tid) {
+    char path[64], buf[512];
+    snprintf(path, sizeof(path), "/proc/self/task/%d/stat", (int)tid);
+    FILE *f = fopen(path, "r");
+    if (!f) return -1.0;        // thread gone
+    size_t n = fread(buf, 1, sizeof(buf) - 1, f);
+    fclose(f);
+    buf[n] = '\0';
+    const char *p = strrchr(buf, ')');      // comm may contain spaces
+    unsigned long ut, st;
+    if (!p || sscanf(p + 1, " %*c %*d %*d %*d %*d %*d %*u %*u %*u %*u %*u %lu %lu", &ut, &st) != 2) return -1.0;
+    long hz = sysconf(_SC_CLK_TCK);
+    return (double)(ut + st) / (double)(hz > 0 ? hz : 100);
+}
+
+static pthread_mutex_t cpu_lock = PTHREAD_MUTEX_INITIALIZER;
+static struct { pid_t tid; double cpu_s; } cpu_prev[RT_MAX_THREADS];
+static int n_cpu_prev;
+static uint64_t cpu_prev_ns;
+
+static void add_threads(cJSON *root) {
+    rt_placement_t th[RT_MAX_THREADS];
+    int n = rt_policy_threads(th, RT_MAX_THREADS);
+    cJSON *arr = cJSON_AddArrayToObject(root, "threads");
+
+    pthread_mutex_lock(&cpu_lock);
+    uint64_t now = lat_now_ns();
+    double wall_s = cpu_prev_ns ? 1e-9 * (double)(now - cpu_prev_ns) : 0.0;
+    int n_next = 0;
+    for (int i = 0; i < n; i++) {
+        double cpu = thread_cpu_s(th[i].tid);
+        if (cpu < 0.0) continue;
+        cJSON *o = cJSON_CreateObject();
+        cJSON_AddStringToObject(o, "label", th[i].label);
+        cJSON_AddNumberToObject(o, "tid", th[i].tid);
+        cJSON_AddNumberToObject(o, "cpu_s", cpu);
+        for (int k = 0; k < n_cpu_prev && wall_s > 0.0; k++) {
+            if (cpu_prev[k].tid != th[i].tid) continue;
+            cJSON_AddNumberToObject(o, "cpu_pct", 100.0 * (cpu - cpu_prev[k].cpu_s) / wall_s);
+            break;
+        }
+        cJSON_AddItemToArray(arr, o);
+        cpu_prev[n_next].tid = th[i].tid;
+        cpu_prev[n_next].cpu_s = cpu;
+        n_next++;
+    }
+    n_cpu_prev = n_next;
+    cpu_prev_ns = now;
+    pthread_mutex_unlock(&cpu_lock);
+}
+
+cJSON* metrics_snapshot_json(void) {
+    cJSON *root = cJSON_CreateObject();
+    cJSON_AddNumberToObject(root, "uptime_s", t_start_ns ? 1e-9 * (double)(lat_now_ns() - t_start_ns) : 0.0);
+
+    metrics_shard_t *head = __atomic_load_n(&shards, __ATOMIC_ACQUIRE);
+
+    cJSON *co = cJSON_AddObjectToObject(root, "counters");
+    int nc = __atomic_load_n(&n_counters, __ATOMIC_ACQUIRE);
+    for (int i = 0; i < nc; i++) {
+        uint64_t v = 0;
+        for (metrics_shard_t *s = head; s; s = s->next) v += __atomic_load_n(&s->counter[i], __ATOMIC_RELAXED);
+        cJSON_AddNumberToObject(co, counter_name[i], (double)v);
+    }
+
+    cJSON *go = cJSON_AddObjectToObject(root, "gauges");
+    int ng = __atomic_load_n(&n_gauges, __ATOMIC_ACQUIRE);
+    for (int i = 0; i < ng; i++) {
+        metrics_read_fn fn = __atomic_load_n(&gauges[i].fn, __ATOMIC_ACQUIRE);
+        double v;
+        if (fn) {
+            v = fn(gauges[i].ctx);
+        } else {
+            uint64_t bits = __atomic_load_n(&gauges[i].bits, __ATOMIC_RELAXED);
+            memcpy(&v, &bits, sizeof(v));
+        }
+        cJSON_AddNumberToObject(go, gauges[i].name, v);
+    }
+
+    cJSON *ho = cJSON_AddObjectToObject(root, "histograms");
+    int nh = __atomic_load_n(&n_hists, __ATOMIC_ACQUIRE);
+    lat_hist_t sum;
+    for (int i = 0; i < nh; i++) {
+        lat_hist_reset(&sum);
+        for (metrics_shard_t *s = head; s; s = s->next) {
+            const lat_hist_t *h = &s->hist[i];
+            for (int b = 0; b < LAT_HIST_BUCKETS; b++) sum.count[b] += __atomic_load_n(&h->count[b], __ATOMIC_RELAXED);
+            sum.n += __atomic_load_n(&h->n, __ATOMIC_RELAXED);
+            sum.sum_ns += __atomic_load_n(&h->sum_ns, __ATOMIC_RELAXED);
+            uint64_t mx = __atomic_load_n(&h->max_ns, __ATOMIC_RELAXED);
+            if (mx > sum.max_ns) sum.max_ns = mx;
+        }
+        // n is read apart from the buckets: keep the quantile walk consistent with them
+        uint64_t in_buckets = 0;
+        for (int b = 0; b < LAT_HIST_BUCKETS; b++) in_buckets += sum.count[b];
+        sum.n = in_buckets;
+
+        cJSON *o = cJSON_AddObjectToObject(ho, hist_name[i]);
+        cJSON_AddNumberToObject(o, "n", (double)sum.n);
+        cJSON_AddNumberToObject(o, "mean_ms", sum.n ? 1e-6 * (double)sum.sum_ns / (double)sum.n : 0.0);
+        cJSON_AddNumberToObject(o, "p50_ms", 1e-6 * (double)lat_hist_quantile_ns(&sum, 0.50));
+        cJSON_AddNumberToObject(o, "p90_ms", 1e-6 * (double)lat_hist_quantile_ns(&sum, 0.90));
+        cJSON_AddNumberToObject(o, "p99_ms", 1e-6 * (double)lat_hist_quantile_ns(&sum, 0.99));
+        cJSON_AddNumberToObject(o, "max_ms", 1e-6 * (double)sum.max_ns);
+    }
+
+    add_threads(root);
+    return root;
+}
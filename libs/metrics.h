@@ -0,0 +1,60 @@
+// libs/metrics.h
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <cjson/cJSON.h>
+
+// --- Process-wide metrics registry: counters, gauges, histograms ---
+//
+// Registration (by name, at setup) takes a lock and returns an id; the same name gives
+// the same id. Updates are lock-free: every thread writes only its own shard (counters
+// and histograms, created on first use) and readers add the shards up. Gauges are
+// single values (set, or a callback evaluated at read time). An id < 0 (registry
+// full) turns every update into a no-op.
+//
+// Names are "<scope>/<metric>", e.g. "dev0/rx_bytes", "dev0/audio_rb/fill_pct".
+// Counters and histograms are cumulative since start; readers take differences.
+
+#define METRICS_MAX_COUNTERS    192
+#define METRICS_MAX_GAUGES      96
+#define METRICS_MAX_HISTS       48
+#define METRICS_NAME_LEN        48
+
+typedef int metric_id_t;
+
+typedef double (*metrics_read_fn)(void *ctx);
+
+/**
+ * @brief Registers (or finds) a counter; name is printf-style.
+ * @return id, -1 if the registry is full.
+ */
+metric_id_t metrics_counter(const char *fmt, ...) __attribute__((format(printf, 1, 2)));
+
+/** Latency / duration histogram in ns (latency.h buckets: 4 per octave, 1 us .. 68 s). */
+metric_id_t metrics_histogram(const char *fmt, ...) __attribute__((format(printf, 1, 2)));
+
+/** Gauge written with metrics_set. */
+metric_id_t metrics_gauge(const char *fmt, ...) __attribute__((format(printf, 1, 2)));
+
+/**
+ * @brief Gauge computed by fn(ctx) when a snapshot is taken (ring fill levels etc.).
+ * ctx must outlive the process's last snapshot.
+ */
+metric_id_t metrics_gauge_fn(metrics_read_fn fn, void *ctx, const char *fmt, ...)
+    __attribute__((format(printf, 3, 4)));
+
+void metrics_add(metric_id_t id, uint64_t v);
+void metrics_set(metric_id_t id, double v);
+void metrics_observe_ns(metric_id_t id, uint64_t ns);
+
+/**
+ * @brief Current totals: {"uptime_s":..,"counters":{..},"gauges":{..},
+ * "histograms":{name:{"n","mean_ms","p50_ms","p90_ms","p99_ms","max_ms"}},
+ * "threads":[{"label","tid","cpu_s","cpu_pct"}]} (threads = rt_policy's table; cpu_pct
+ * since the previous snapshot).
+ */
+cJSON* metrics_snapshot_json(void);
+
+#endif
@@ -1,11 +1,26 @@
 #include "opus_tx.h"
+#include "shm_ring.h"
+#include "latency.h"
 #include <opus/opus.h>
 
+#include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <errno.h>
+#include <time.h>
 #include <unistd.h>
+#include <poll.h>
 #include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
 #include <sys/socket.h>
+#include <sys/uio.h>
+#include <sys/random.h>
+#include <endian.h>
+#include <math.h>
+
+#define OPUS_TX_MAX_PAYLOAD 1500
+#define OPUS_TX_IOV_MAX     64      // frames por sendmsg
 
 #pragma pack(push, 1)
 typedef struct {
@@ -17,41 +32,365 @@ typedef struct {
 } OpusFrameHeader;
 #pragma pack(pop)
 
+// cfg.ts_ext: magic 'OPU1' y estos 16 bytes entre header y payload (big endian)
+#pragma pack(push, 1)
+typedef struct {
+    uint64_t capture_unix_ns;   // primera muestra IQ del frame (0 = desconocida / marcador)
+    uint64_t encode_unix_ns;    // salida del encoder
+} OpusTsExt;
+#pragma pack(pop)
+
+#define OPUS_TX_HDR_MAX (sizeof(OpusFrameHeader) + sizeof(OpusTsExt))
+
+// RFC 3550 fixed header (sin CSRC ni extensiones)
+#pragma pack(push, 1)
+typedef struct {
+    uint8_t  vpxcc;       // V=2, P=0, X=0, CC=0
+    uint8_t  mpt;         // M | PT
+    uint16_t seq;
+    uint32_t ts;
+    uint32_t ssrc;
+} RtpHeader;
+#pragma pack(pop)
+
+// Un frame listo para el cable: header + payload contiguos
+typedef struct {
+    uint16_t len;
+    uint64_t capture_ns;    // CLOCK_MONOTONIC, para el histograma "sent"
+    uint8_t data[OPUS_TX_HDR_MAX + OPUS_TX_MAX_PAYLOAD];
+} tx_slot_t;
+
 struct opus_tx {
-    int sock_fd;
+    int sock_fd;            // -1 sin conexión
+    int connecting;         // connect() no bloqueante en curso
+    int warned;             // el fallo de conexión ya se reportó
+    int ever_connected;
+    char host[64];
+    int port;
+    uint64_t next_retry_ms;
+
     uint32_t seq;
     OpusEncoder *enc;
     opus_tx_cfg_t cfg;
+    int gap_pending;        // frames omitidos aún sin marcador
+
+    // Cola circular de frames; q[q_head] puede estar a medio escribir (head_off)
+    tx_slot_t *q;
+    int q_cap;
+    int q_head;
+    int q_count;
+    size_t head_off;
+
+    shm_ring_t *shm;        // transport == OPUS_TX_SHM
+
+    // RTP (transport == OPUS_TX_RTP_UDP)
+    uint16_t rtp_seq;
+    uint32_t rtp_ts;        // próximo timestamp, reloj de 48 kHz
+    uint32_t rtp_ssrc;
+    int rtp_marker;         // 1 en el primer paquete tras un hueco
+
+    opus_tx_stats_t stats;
+
+    // Latencia desde la captura hasta la salida del encoder / el socket (ventana actual)
+    lat_hist_t lat_encoded;
+    lat_hist_t lat_sent;
 };
 
-static int send_all(int fd, const void *buf, size_t n) {
-    const uint8_t *p = (const uint8_t*)buf;
-    while (n > 0) {
-        ssize_t w = send(fd, p, n, 0);
-        if (w <= 0) return -1;
-        p += (size_t)w;
-        n -= (size_t)w;
+static uint64_t mono_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000ULL + (uint64_t)ts.tv_nsec / 1000000ULL;
+}
+
+static void drop_head(opus_tx_t *tx) {
+    tx->q_head = (tx->q_head + 1) % tx->q_cap;
+    tx->q_count--;
+    tx->head_off = 0;
+    tx->stats.frames_dropped++;
+}
+
+static void close_sock(opus_tx_t *tx, const char *why) {
+    if (tx->sock_fd >= 0) close(tx->sock_fd);
+    tx->sock_fd = -1;
+    tx->connecting = 0;
+    tx->stats.connected = 0;
+    tx->next_retry_ms = mono_ms() + OPUS_TX_RETRY_MS;
+
+    // Un frame cortado no se puede retomar en el stream nuevo
+    if (tx->head_off > 0) drop_head(tx);
+
+    if (!tx->warned) {
+        fprintf(stderr, "[OPUS_TX] WARN: %s:%d %s. Retrying every %d ms (queue keeps the newest %d frames).\n",
+                tx->host, tx->port, why, OPUS_TX_RETRY_MS, tx->q_cap);
+        tx->warned = 1;
     }
-    return 0;
 }
 
-static int connect_tcp(const char *host, int port) {
-    int fd = socket(AF_INET, SOCK_STREAM, 0);
-    if (fd < 0) return -1;
+static void start_connect(opus_tx_t *tx) {
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons((uint16_t)tx->port);
+    if (inet_pton(AF_INET, tx->host, &addr.sin_addr) != 1) {
+        close_sock(tx, "is not an IPv4 address");
+        return;
+    }
+
+    int fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        close_sock(tx, "socket() failed");
+        return;
+    }
+
+    // Frames chicos y periódicos: sin Nagle
+    int one = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+    tx->sock_fd = fd;
+    if (connect(fd, (struct sockaddr*)&addr, sizeof(addr)) == 0) {
+        tx->connecting = 0;
+    } else if (errno == EINPROGRESS) {
+        tx->connecting = 1;
+    } else {
+        close_sock(tx, strerror(errno));
+        return;
+    }
+}
+
+/**
+ * @brief 1 cuando el socket quedó listo para escribir.
+ */
+static int connection_ready(opus_tx_t *tx) {
+    if (tx->sock_fd < 0) {
+        if (mono_ms() < tx->next_retry_ms) return 0;
+        start_connect(tx);
+        if (tx->sock_fd < 0) return 0;
+    }
+
+    if (tx->connecting) {
+        struct pollfd pfd = { .fd = tx->sock_fd, .events = POLLOUT, .revents = 0 };
+        if (poll(&pfd, 1, 0) <= 0) return 0;
+
+        int err = 0;
+        socklen_t len = sizeof(err);
+        if (getsockopt(tx->sock_fd, SOL_SOCKET, SO_ERROR, &err, &len) != 0 || err != 0) {
+            close_sock(tx, err ? strerror(err) : "connect failed");
+            return 0;
+        }
+        tx->connecting = 0;
+    }
+
+    if (!tx->stats.connected) {
+        tx->stats.connected = 1;
+        if (tx->ever_connected) tx->stats.reconnects++;
+        tx->ever_connected = 1;
+        tx->warned = 0;
+        fprintf(stderr, "[OPUS_TX] Connected to %s:%d (sr=%d ch=%d, %d frames queued)\n",
+                tx->host, tx->port, tx->cfg.sample_rate, tx->cfg.channels, tx->q_count);
+    }
+    return 1;
+}
+
+/**
+ * @brief Header OPU0 (u 'OPU1' + extensión de tiempos) en dst; devuelve sus bytes.
+ */
+static size_t fill_header(const opus_tx_t *tx, uint8_t *dst, uint32_t seq, int n, uint64_t capture_ns) {
+    OpusFrameHeader h;
+    h.magic      = htonl(tx->cfg.ts_ext ? OPUS_TX_MAGIC_TS : OPUS_TX_MAGIC);
+    h.seq        = htonl(seq);
+    h.sample_rate= htonl((uint32_t)tx->cfg.sample_rate);
+    h.channels   = htons((uint16_t)tx->cfg.channels);
+    h.payload_len= htons((uint16_t)n);
+    memcpy(dst, &h, sizeof(h));
+    if (!tx->cfg.ts_ext) return sizeof(h);
+
+    OpusTsExt e;
+    e.capture_unix_ns = htobe64(capture_ns ? lat_mono_to_unix_ns(capture_ns) : 0);
+    e.encode_unix_ns  = htobe64(lat_mono_to_unix_ns(lat_now_ns()));
+    memcpy(dst + sizeof(h), &e, sizeof(e));
+    return sizeof(h) + sizeof(e);
+}
+
+static void enqueue(opus_tx_t *tx, uint32_t seq, const uint8_t *payload, int n, uint64_t capture_ns) {
+    // Memoria compartida: el mismo framing OPU0, un registro por frame, sin cola propia
+    if (tx->shm) {
+        uint8_t h[OPUS_TX_HDR_MAX];
+        size_t hl = fill_header(tx, h, seq, n, capture_ns);
+        if (shm_ring_write(tx->shm, h, hl, payload, (size_t)n) == 0) {
+            tx->stats.frames_sent++;
+            tx->stats.bytes_sent += hl + (uint64_t)n;
+            if (capture_ns) lat_hist_add(&tx->lat_sent, lat_now_ns() - capture_ns);
+        } else {
+            tx->stats.frames_dropped++;
+        }
+        return;
+    }
+
+    // Cola llena: se pierde el frame más viejo que todavía no tocó el socket
+    if (tx->q_count == tx->q_cap) {
+        if (tx->head_off > 0) {
+            int next = (tx->q_head + 1) % tx->q_cap;
+            memcpy(&tx->q[next], &tx->q[tx->q_head], sizeof(tx_slot_t));
+            tx->q_head = next;
+            tx->q_count--;
+            tx->stats.frames_dropped++;
+        } else {
+            drop_head(tx);
+        }
+    }
 
+    tx_slot_t *slot = &tx->q[(tx->q_head + tx->q_count) % tx->q_cap];
+    size_t hl = fill_header(tx, slot->data, seq, n, capture_ns);
+    if (n > 0) memcpy(slot->data + hl, payload, (size_t)n);
+    slot->len = (uint16_t)(hl + (size_t)n);
+    slot->capture_ns = capture_ns;
+    tx->q_count++;
+    if (tx->q_count > tx->stats.queue_max) tx->stats.queue_max = tx->q_count;
+}
+
+void opus_tx_flush(opus_tx_t *tx) {
+    if (!tx || tx->cfg.transport == OPUS_TX_RTP_UDP) return;
+    if (tx->shm) {
+        shm_ring_poll(tx->shm);
+        shm_ring_stats_t ss;
+        shm_ring_get_stats(tx->shm, &ss);
+        tx->stats.connected = ss.reader;
+        return;
+    }
+
+    while (tx->q_count > 0) {
+        if (!connection_ready(tx)) return;
+
+        // Varios frames (header+payload contiguos) por syscall
+        struct iovec iov[OPUS_TX_IOV_MAX];
+        int n_iov = 0;
+        size_t want = 0;
+        for (int i = 0; i < tx->q_count && n_iov < OPUS_TX_IOV_MAX; i++) {
+            tx_slot_t *s = &tx->q[(tx->q_head + i) % tx->q_cap];
+            size_t off = (i == 0) ? tx->head_off : 0;
+            iov[n_iov].iov_base = s->data + off;
+            iov[n_iov].iov_len = s->len - off;
+            want += iov[n_iov].iov_len;
+            n_iov++;
+        }
+
+        struct msghdr msg;
+        memset(&msg, 0, sizeof(msg));
+        msg.msg_iov = iov;
+        msg.msg_iovlen = (size_t)n_iov;
+
+        ssize_t w = sendmsg(tx->sock_fd, &msg, MSG_NOSIGNAL | MSG_DONTWAIT);
+        if (w < 0) {
+            if (errno == EINTR) continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK) return;   // gateway lento: queda en cola
+            close_sock(tx, strerror(errno));
+            return;
+        }
+        tx->stats.bytes_sent += (uint64_t)w;
+
+        size_t left = (size_t)w;
+        while (left > 0 && tx->q_count > 0) {
+            tx_slot_t *s = &tx->q[tx->q_head];
+            size_t rem = s->len - tx->head_off;
+            if (left < rem) {
+                tx->head_off += left;
+                break;
+            }
+            left -= rem;
+            if (s->capture_ns) lat_hist_add(&tx->lat_sent, lat_now_ns() - s->capture_ns);
+            tx->q_head = (tx->q_head + 1) % tx->q_cap;
+            tx->q_count--;
+            tx->head_off = 0;
+            tx->stats.frames_sent++;
+        }
+        if ((size_t)w < want) return;   // buffer del socket lleno
+    }
+}
+
+static uint32_t random_u32(void) {
+    uint32_t v = 0;
+    if (getrandom(&v, sizeof(v), GRND_NONBLOCK) != (ssize_t)sizeof(v)) {
+        struct timespec ts;
+        clock_gettime(CLOCK_REALTIME, &ts);
+        v = (uint32_t)ts.tv_nsec ^ ((uint32_t)getpid() << 16);
+    }
+    return v;
+}
+
+/**
+ * @brief UDP socket "conectado" al destino; multicast (224/4) con TTL y loopback.
+ */
+static int rtp_open(opus_tx_t *tx) {
     struct sockaddr_in addr;
     memset(&addr, 0, sizeof(addr));
     addr.sin_family = AF_INET;
-    addr.sin_port = htons((uint16_t)port);
-    if (inet_pton(AF_INET, host, &addr.sin_addr) != 1) {
-        close(fd);
+    addr.sin_port = htons((uint16_t)tx->port);
+    if (inet_pton(AF_INET, tx->host, &addr.sin_addr) != 1) {
+        fprintf(stderr, "[OPUS_TX] ERROR: %s is not an IPv4 address\n", tx->host);
         return -1;
     }
+
+    int fd = socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0) return -1;
+
+    if (IN_MULTICAST(ntohl(addr.sin_addr.s_addr))) {
+        unsigned char ttl = (unsigned char)((tx->cfg.rtp_ttl > 0) ? tx->cfg.rtp_ttl : 1);
+        unsigned char loop = 1;
+        setsockopt(fd, IPPROTO_IP, IP_MULTICAST_TTL, &ttl, sizeof(ttl));
+        setsockopt(fd, IPPROTO_IP, IP_MULTICAST_LOOP, &loop, sizeof(loop));
+    }
     if (connect(fd, (struct sockaddr*)&addr, sizeof(addr)) != 0) {
+        fprintf(stderr, "[OPUS_TX] ERROR: RTP connect %s:%d: %s\n", tx->host, tx->port, strerror(errno));
         close(fd);
         return -1;
     }
-    return fd;
+
+    tx->sock_fd = fd;
+    tx->stats.connected = 1;
+    tx->rtp_ssrc = tx->cfg.rtp_ssrc ? tx->cfg.rtp_ssrc : random_u32();
+    tx->rtp_seq = (uint16_t)random_u32();
+    tx->rtp_ts = random_u32();
+    tx->rtp_marker = 1;
+    fprintf(stderr, "[OPUS_TX] RTP to %s:%d (PT=%d SSRC=0x%08X%s)\n", tx->host, tx->port,
+            tx->cfg.rtp_pt, tx->rtp_ssrc, IN_MULTICAST(ntohl(addr.sin_addr.s_addr)) ? ", multicast" : "");
+    return 0;
+}
+
+/**
+ * @brief Un paquete RTP por frame; UDP no tiene backpressure útil, así que lo que
+ * el socket rechaza se cuenta como descartado en vez de encolarse.
+ */
+static void rtp_send(opus_tx_t *tx, const uint8_t *payload, int n, int frame_samples, uint64_t capture_ns) {
+    RtpHeader h;
+    h.vpxcc = 0x80;
+    h.mpt   = (uint8_t)((tx->rtp_marker ? 0x80 : 0x00) | (tx->cfg.rtp_pt & 0x7F));
+    h.seq   = htons(tx->rtp_seq);
+    h.ts    = htonl(tx->rtp_ts);
+    h.ssrc  = htonl(tx->rtp_ssrc);
+
+    struct iovec iov[2] = {
+        { .iov_base = &h, .iov_len = sizeof(h) },
+        { .iov_base = (void*)payload, .iov_len = (size_t)n },
+    };
+    struct msghdr msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = iov;
+    msg.msg_iovlen = 2;
+
+    // seq y timestamp avanzan aunque el envío falle: el receptor ve la pérdida
+    tx->rtp_seq++;
+    tx->rtp_ts += (uint32_t)((int64_t)frame_samples * OPUS_TX_RTP_CLOCK / tx->cfg.sample_rate);
+
+    ssize_t w = sendmsg(tx->sock_fd, &msg, MSG_NOSIGNAL | MSG_DONTWAIT);
+    if (w < 0) {
+        // EAGAIN, o ECONNREFUSED por un ICMP de un envío anterior (nadie escucha)
+        tx->stats.frames_dropped++;
+        return;
+    }
+    tx->rtp_marker = 0;
+    tx->stats.frames_sent++;
+    tx->stats.bytes_sent += (uint64_t)w;
+    if (capture_ns) lat_hist_add(&tx->lat_sent, lat_now_ns() - capture_ns);
 }
 
 opus_tx_t* opus_tx_create(const char *host, int port, const opus_tx_cfg_t *cfg) {
@@ -61,8 +400,16 @@ opus_tx_t* opus_tx_create(const char *host, int port, const opus_tx_cfg_t *cfg)
     if (!tx) return NULL;
 
     tx->cfg = *cfg;
-    tx->sock_fd = connect_tcp(host, port);
-    if (tx->sock_fd < 0) {
+    tx->sock_fd = -1;
+    snprintf(tx->host, sizeof(tx->host), "%s", host);
+    tx->port = port;
+
+    tx->q_cap = (cfg->queue_frames > 0) ? cfg->queue_frames : OPUS_TX_QUEUE_DEFAULT;
+    // Mínimo 2: con la cola llena y la cabeza a medio enviar se descarta el siguiente,
+    // nunca la cabeza (cortarla rompería el framing TCP)
+    if (tx->q_cap < 2) tx->q_cap = 2;
+    tx->q = (tx_slot_t*)malloc((size_t)tx->q_cap * sizeof(tx_slot_t));
+    if (!tx->q) {
         free(tx);
         return NULL;
     }
@@ -70,7 +417,7 @@ opus_tx_t* opus_tx_create(const char *host, int port, const opus_tx_cfg_t *cfg)
     int err = 0;
     tx->enc = opus_encoder_create(cfg->sample_rate, cfg->channels, OPUS_APPLICATION_AUDIO, &err);
     if (!tx->enc || err != OPUS_OK) {
-        close(tx->sock_fd);
+        free(tx->q);
         free(tx);
         return NULL;
     }
@@ -78,37 +425,120 @@ opus_tx_t* opus_tx_create(const char *host, int port, const opus_tx_cfg_t *cfg)
     opus_encoder_ctl(tx->enc, OPUS_SET_BITRATE(cfg->bitrate));
     opus_encoder_ctl(tx->enc, OPUS_SET_COMPLEXITY(cfg->complexity));
     opus_encoder_ctl(tx->enc, OPUS_SET_VBR(cfg->vbr));
+    opus_encoder_ctl(tx->enc, OPUS_SET_DTX(cfg->dtx ? 1 : 0));
+
+    if (tx->cfg.frame_ms <= 0) tx->cfg.frame_ms = 20;
+    tx->cfg.frame_ms = opus_tx_snap_frame_ms(tx->cfg.frame_ms);
+    if (tx->cfg.rtp_pt <= 0 || tx->cfg.rtp_pt > 127) tx->cfg.rtp_pt = OPUS_TX_RTP_PT_DEFAULT;
 
     tx->seq = 0;
+    if (tx->cfg.transport == OPUS_TX_RTP_UDP) {
+        if (rtp_open(tx) != 0) {
+            opus_tx_destroy(tx);
+            return NULL;
+        }
+    } else if (tx->cfg.transport == OPUS_TX_SHM) {
+        tx->shm = shm_ring_create(tx->host, OPUS_TX_SHM_BYTES, NULL);
+        if (!tx->shm) {
+            opus_tx_destroy(tx);
+            return NULL;
+        }
+    } else {
+        start_connect(tx);
+    }
     return tx;
 }
 
 int opus_tx_send_frame(opus_tx_t *tx, const int16_t *pcm, int frame_samples) {
+    return opus_tx_send_frame_at(tx, pcm, frame_samples, 0);
+}
+
+int opus_tx_send_frame_at(opus_tx_t *tx, const int16_t *pcm, int frame_samples, uint64_t capture_ns) {
     if (!tx || !pcm) return -1;
 
-    uint8_t opus_out[1500];
+    uint8_t opus_out[OPUS_TX_MAX_PAYLOAD];
     int n = opus_encode(tx->enc, pcm, frame_samples, opus_out, (opus_int32)sizeof(opus_out));
     if (n < 0) return -1;
+    if (capture_ns) lat_hist_add(&tx->lat_encoded, lat_now_ns() - capture_ns);
 
-    OpusFrameHeader h;
-    h.magic      = htonl(0x4F505530);
-    h.seq        = htonl(tx->seq++);
-    h.sample_rate= htonl((uint32_t)tx->cfg.sample_rate);
-    h.channels   = htons((uint16_t)tx->cfg.channels);
-    h.payload_len= htons((uint16_t)n);
+    // DTX: el encoder indica que este frame no hace falta transmitirlo
+    if (tx->cfg.dtx && n <= 2) return opus_tx_send_gap(tx, 1);
+
+    if (tx->cfg.transport == OPUS_TX_RTP_UDP) {
+        rtp_send(tx, opus_out, n, frame_samples, capture_ns);
+        return 0;
+    }
+
+    tx->gap_pending = 0;
+    enqueue(tx, tx->seq++, opus_out, n, capture_ns);
+    opus_tx_flush(tx);
+    return 0;
+}
 
-    if (send_all(tx->sock_fd, &h, sizeof(h)) != 0) return -1;
-    if (send_all(tx->sock_fd, opus_out, (size_t)n) != 0) return -1;
+int opus_tx_send_gap(opus_tx_t *tx, int frames) {
+    if (!tx || frames < 0) return -1;
+
+    if (tx->cfg.transport == OPUS_TX_RTP_UDP) {
+        // RTP: sólo salta el timestamp; el marker señala el inicio del siguiente tramo
+        uint32_t step = (uint32_t)(tx->cfg.frame_ms * (OPUS_TX_RTP_CLOCK / 1000) + 0.5);
+        tx->rtp_ts += (uint32_t)frames * step;
+        tx->stats.frames_skipped += (uint64_t)frames;
+        if (frames > 0) tx->rtp_marker = 1;
+        return 0;
+    }
+
+    tx->seq += (uint32_t)frames;
+    tx->gap_pending += frames;
+    tx->stats.frames_skipped += (uint64_t)frames;
+
+    if (tx->gap_pending >= OPUS_TX_GAP_REPORT_FRAMES) {
+        tx->gap_pending = 0;
+        enqueue(tx, tx->seq - 1, NULL, 0, 0);
+    }
+    opus_tx_flush(tx);
     return 0;
 }
 
+void opus_tx_get_stats(const opus_tx_t *tx, opus_tx_stats_t *out) {
+    if (!out) return;
+    if (!tx) {
+        memset(out, 0, sizeof(*out));
+        return;
+    }
+    *out = tx->stats;
+    out->queue_depth = tx->q_count;
+}
+
+double opus_tx_snap_frame_ms(double ms) {
+    static const double valid[] = { 2.5, 5.0, 10.0, 20.0, 40.0, 60.0 };
+    double best = valid[0];
+    for (size_t i = 1; i < sizeof(valid) / sizeof(valid[0]); i++) {
+        if (fabs(valid[i] - ms) < fabs(best - ms)) best = valid[i];
+    }
+    return best;
+}
+
+void opus_tx_take_latency(opus_tx_t *tx, lat_hist_t *encoded, lat_hist_t *sent) {
+    if (!tx) {
+        lat_hist_reset(encoded);
+        lat_hist_reset(sent);
+        return;
+    }
+    if (encoded) *encoded = tx->lat_encoded;
+    if (sent) *sent = tx->lat_sent;
+    lat_hist_reset(&tx->lat_encoded);
+    lat_hist_reset(&tx->lat_sent);
+}
+
 void opus_tx_destroy(opus_tx_t *tx) {
     if (!tx) return;
     if (tx->sock_fd >= 0) close(tx->sock_fd);
+    if (tx->shm) shm_ring_destroy(tx->shm);
     if (tx->enc) opus_encoder_destroy(tx->enc);
+    free(tx->q);
     free(tx);
 }
 
 int opus_tx_fd(const opus_tx_t *tx) {
-    return tx ? tx->sock_fd : -1;
+    return (tx && !tx->connecting) ? tx->sock_fd : -1;
 }
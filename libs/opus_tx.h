@@ -1,6 +1,7 @@
 #pragma once
 #include <stdint.h>
 #include <stddef.h>
+#include "latency.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -8,24 +9,91 @@ extern "C" {
 
 typedef struct opus_tx opus_tx_t;
 
+// Transporte de salida
+#define OPUS_TX_OPU0_TCP   0        // header 'OPU0' + payload sobre TCP (gateway Python)
+#define OPUS_TX_RTP_UDP    1        // RTP RFC 7587 sobre UDP (udpsrc / cualquier receptor RTP)
+#define OPUS_TX_SHM        2        // registros OPU0 en un ring de memoria compartida (host = nombre shm)
+
+#define OPUS_TX_SHM_BYTES  (256 * 1024)  // ~5 s de frames a 32 kb/s
+
+#define OPUS_TX_MAGIC      0x4F505530u  // 'OPU0': header !IIIHH + payload
+#define OPUS_TX_MAGIC_TS   0x4F505531u  // 'OPU1': header + !QQ (captura, encoder; ns Unix) + payload
+
+#define OPUS_TX_RTP_PT_DEFAULT  96  // dinámico, igual que el rtpopuspay del gateway
+#define OPUS_TX_RTP_CLOCK       48000   // RFC 7587: el reloj RTP de Opus siempre es 48 kHz
+
 typedef struct {
     int sample_rate;
     int channels;
     int bitrate;
     int complexity;
     int vbr;
+    int dtx;            // 1 = OPUS_SET_DTX; frames de <= 2 bytes no se envían (hueco)
+    int queue_frames;   // cola de envío (0 = OPUS_TX_QUEUE_DEFAULT, mínimo 2); llena => se descarta el más viejo
+    double frame_ms;    // duración de un frame (0 = 20; 2.5..60): paso de timestamp en huecos
+    int ts_ext;         // 1 = headers 'OPU1' con los tiempos de captura y encoder (TCP y shm)
+
+    int transport;      // OPUS_TX_OPU0_TCP | OPUS_TX_RTP_UDP
+    uint32_t rtp_ssrc;  // 0 = aleatorio
+    int rtp_pt;         // 0 = OPUS_TX_RTP_PT_DEFAULT
+    int rtp_ttl;        // TTL multicast (0 = 1); destino 224.0.0.0/4 => multicast con loopback
 } opus_tx_cfg_t;
 
-// Crea encoder + conecta TCP
+// Contadores desde opus_tx_create (sobreviven a las reconexiones)
+typedef struct {
+    uint64_t frames_sent;       // escritos completos en el socket
+    uint64_t frames_skipped;    // squelch cerrado o DTX
+    uint64_t frames_dropped;    // cola llena (drop-oldest) o frame cortado por una desconexión
+    uint64_t bytes_sent;        // header + payload
+    uint64_t reconnects;
+    int queue_depth;            // frames esperando socket
+    int queue_max;              // pico de queue_depth
+    int connected;
+} opus_tx_stats_t;
+
+// Cada cuántos frames omitidos se manda un marcador de hueco (payload_len = 0)
+#define OPUS_TX_GAP_REPORT_FRAMES 25
+#define OPUS_TX_QUEUE_DEFAULT     50      // 1 s a 20 ms
+#define OPUS_TX_RETRY_MS          1000
+
+// Crea el encoder y arranca la conexión TCP (no bloqueante). Sólo falla si el
+// encoder no se puede crear: sin gateway los frames se encolan y se descartan
+// por antigüedad, y se reintenta la conexión cada OPUS_TX_RETRY_MS.
+// Con OPUS_TX_RTP_UDP cada frame sale como un paquete RTP (sin cola: UDP no espera
+// al receptor); seq RTP cuenta paquetes y el timestamp cuenta muestras a 48 kHz,
+// así un hueco de squelch/DTX es un salto de timestamp con marker en el siguiente.
+// Con OPUS_TX_SHM, host es el nombre POSIX del ring ("/rf_audio") y port se ignora;
+// el lector (shm_reader.py) toma el eventfd por /tmp<nombre>.sock.
 opus_tx_t* opus_tx_create(const char *host, int port, const opus_tx_cfg_t *cfg);
 
-// Encode + envía 1 frame PCM (por ejemplo 20ms a 48k => 960 samples)
+// Encode + encola 1 frame PCM (por ejemplo 20ms a 48k => 960 samples) y vacía
+// la cola lo que el socket acepte sin bloquear. -1 sólo si falla el encoder.
 int  opus_tx_send_frame(opus_tx_t *tx, const int16_t *pcm, int frame_samples);
 
+// Igual, con el instante de captura (CLOCK_MONOTONIC) de la primera muestra del
+// frame: alimenta los histogramas encoded/sent y la extensión 'OPU1'. 0 = desconocido.
+int  opus_tx_send_frame_at(opus_tx_t *tx, const int16_t *pcm, int frame_samples, uint64_t capture_ns);
+
+// Marca frames de silencio sin codificarlos: seq avanza igual que si se hubieran
+// enviado, y cada OPUS_TX_GAP_REPORT_FRAMES sale un header con payload_len = 0
+// (seq = último frame omitido) para que el gateway mantenga el reloj.
+int  opus_tx_send_gap(opus_tx_t *tx, int frames);
+
+// Reintenta conexión / escribe lo pendiente sin encolar nada nuevo.
+void opus_tx_flush(opus_tx_t *tx);
+
+void opus_tx_get_stats(const opus_tx_t *tx, opus_tx_stats_t *out);
+
+// Duración válida para Opus más cercana a ms: 2.5, 5, 10, 20, 40 o 60
+double opus_tx_snap_frame_ms(double ms);
+
+// Copia y reinicia los histogramas captura->encoder y captura->socket (ventana móvil)
+void opus_tx_take_latency(opus_tx_t *tx, lat_hist_t *encoded, lat_hist_t *sent);
+
 // Cierra socket y destruye encoder
 void opus_tx_destroy(opus_tx_t *tx);
 
-// Opcional: acceso a FD o estado
+// Opcional: acceso a FD o estado (-1 mientras no hay conexión)
 int  opus_tx_fd(const opus_tx_t *tx);
 
 #ifdef __cplusplus
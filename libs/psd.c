@@ -7,6 +7,8 @@
 #include <complex.h>
 #include <ctype.h>
 #include <stdio.h>
+#include <strings.h>
+#include <pthread.h>
 
 // =========================================================
 // Static Helper: Robust String Lowercasing
@@ -59,6 +61,17 @@ signal_iq_t* load_iq_from_buffer(const int8_t* buffer, size_t buffer_size) {
     return signal_data;
 }
 
+int load_iq_into(signal_iq_t* signal_data, size_t capacity, const int8_t* buffer, size_t buffer_size) {
+    if (!signal_data || !signal_data->signal_iq || !buffer || buffer_size / 2 > capacity) return -1;
+
+    size_t n_samples = buffer_size / 2;
+    signal_data->n_signal = n_samples;
+    for (size_t i = 0; i < n_samples; i++) {
+        signal_data->signal_iq[i] = (double)buffer[2 * i] + (double)buffer[2 * i + 1] * I;
+    }
+    return 0;
+}
+
 void free_signal_iq(signal_iq_t* signal) {
     if (signal) {
         if (signal->signal_iq) {
@@ -73,6 +86,24 @@ void free_signal_iq(signal_iq_t* signal) {
 // Configuration & Parsing
 // =========================================================
 
+int rf_mode_from_string(const char *mode_str, rf_mode_t *mode) {
+    char *clean_mode = strdup_lowercase(mode_str);
+    if (!clean_mode) return -1;
+
+    int rc = 0;
+    if(strcmp(clean_mode, "realtime") == 0) *mode = REALTIME_MODE;
+    else if(strcmp(clean_mode, "campaign") == 0) *mode = CAMPAIGN_MODE;
+    else if(strcmp(clean_mode, "fm") == 0 || strcmp(clean_mode, "wfm") == 0) *mode = FM_MODE;
+    else if(strcmp(clean_mode, "nfm") == 0) *mode = NFM_MODE;
+    else if(strcmp(clean_mode, "am") == 0) *mode = AM_MODE;
+    else if(strcmp(clean_mode, "usb") == 0) *mode = USB_MODE;
+    else if(strcmp(clean_mode, "lsb") == 0) *mode = LSB_MODE;
+    else rc = -1;
+
+    free(clean_mode);
+    return rc;
+}
+
 /**
  * @brief Helper to map normalized strings to Enum
  */
@@ -109,14 +140,7 @@ int parse_config_rf(const char *json_string, DesiredCfg_t *target) {
     // 1. RF Mode (Strict Lowercase Parsing)
     cJSON *rf_mode = cJSON_GetObjectItemCaseSensitive(root, "rf_mode");
     if (cJSON_IsString(rf_mode) && rf_mode->valuestring) {
-        char *clean_mode = strdup_lowercase(rf_mode->valuestring);
-        if (clean_mode) {
-            if(strcmp(clean_mode, "realtime") == 0) target->rf_mode = REALTIME_MODE;
-            else if(strcmp(clean_mode, "campaign") == 0) target->rf_mode = CAMPAIGN_MODE;
-            else if(strcmp(clean_mode, "fm") == 0) target->rf_mode = FM_MODE;
-            else if(strcmp(clean_mode, "am") == 0) target->rf_mode = AM_MODE;
-            free(clean_mode);
-        }
+        rf_mode_from_string(rf_mode->valuestring, &target->rf_mode);
     }
 
     // 2. Numeric params
@@ -135,6 +159,9 @@ int parse_config_rf(const char *json_string, DesiredCfg_t *target) {
     cJSON *ov = cJSON_GetObjectItemCaseSensitive(root, "overlap");
     if (cJSON_IsNumber(ov)) target->overlap = ov->valuedouble;
 
+    cJSON *seq = cJSON_GetObjectItemCaseSensitive(root, "seq");
+    if (cJSON_IsNumber(seq) && seq->valuedouble > 0) target->seq = (uint64_t)seq->valuedouble;
+
     // 3. Window (Strict Lowercase Parsing)
     cJSON *win = cJSON_GetObjectItemCaseSensitive(root, "window");
     if (cJSON_IsString(win) && win->valuestring) {
@@ -157,10 +184,10 @@ int parse_config_rf(const char *json_string, DesiredCfg_t *target) {
 
     // 5. Gains
     cJSON *lna = cJSON_GetObjectItemCaseSensitive(root, "lna_gain");
-    if (cJSON_IsNumber(lna)) target->lna_gain = (int)lna->valuedouble;
+    target->lna_gain = cJSON_IsNumber(lna) ? (int)lna->valuedouble : SDR_LNA_GAIN_DEFAULT;
 
     cJSON *vga = cJSON_GetObjectItemCaseSensitive(root, "vga_gain");
-    if (cJSON_IsNumber(vga)) target->vga_gain = (int)vga->valuedouble;
+    target->vga_gain = cJSON_IsNumber(vga) ? (int)vga->valuedouble : SDR_VGA_GAIN_DEFAULT;
 
     // 6. Antenna
     cJSON *amp = cJSON_GetObjectItemCaseSensitive(root, "antenna_amp");
@@ -171,6 +198,13 @@ int parse_config_rf(const char *json_string, DesiredCfg_t *target) {
 
     cJSON *ppm = cJSON_GetObjectItemCaseSensitive(root, "ppm_error");
     if (cJSON_IsNumber(ppm)) target->ppm_error = (int)ppm->valuedouble;
+
+    // 7. Demodulated channel (absolute frequency; 0 = tuner center)
+    cJSON *dcf = cJSON_GetObjectItemCaseSensitive(root, "demod_center_freq_hz");
+    if (cJSON_IsNumber(dcf)) target->demode_config.center_freq = dcf->valuedouble;
+
+    cJSON *dbw = cJSON_GetObjectItemCaseSensitive(root, "demod_bw_hz");
+    if (cJSON_IsNumber(dbw)) target->demode_config.bw_hz = dbw->valuedouble;
     
     // Validation
     if (target->center_freq == 0 && target->sample_rate == 0) {
@@ -247,9 +281,57 @@ void print_config_summary(DesiredCfg_t *des, SDR_cfg_t *hw, PsdConfig_t *psd, RB
     printf("FFT Size    : %d bins\n", psd->nperseg);
     printf("Overlap     : %d bins\n", psd->noverlap);
     printf("Scale Unit  : %s\n", des->scale ? des->scale : "dbm");
+
+    printf("\n--- DEMOD CHANNEL (DDC) ---\n");
+    if (des->demode_config.center_freq > 0) {
+        printf("Channel     : %.0f Hz (offset %+.0f Hz)\n", des->demode_config.center_freq,
+               des->demode_config.center_freq - (double)hw->center_freq);
+    } else {
+        printf("Channel     : tuner center\n");
+    }
+    printf("Channel BW  : %.0f Hz\n", des->demode_config.bw_hz);
     printf("===========================================================\n\n");
 }
 
+// =========================================================
+// Result message
+// =========================================================
+
+/** Appends v the way cJSON prints numbers (15 digits if they round-trip, else 17; null for NaN/inf) */
+static size_t json_put_number(char *out, double v) {
+    if (isnan(v) || isinf(v)) {
+        memcpy(out, "null", 4);
+        return 4;
+    }
+    int n = snprintf(out, 32, "%1.15g", v);
+    double back;
+    if (sscanf(out, "%lg", &back) != 1 || back != v) n = snprintf(out, 32, "%1.17g", v);
+    return (size_t)n;
+}
+
+size_t psd_json_write(char *out, size_t cap, int device, uint64_t seq, double start_hz, double end_hz,
+                      const double *pxx, int n) {
+    if (!out || !pxx || n <= 0 || cap < PSD_JSON_BYTES(n)) return 0;
+
+    size_t len = seq ? (size_t)snprintf(out, PSD_JSON_HEAD_BYTES, "{\"device\":%d,\"seq\":%llu,\"start_freq_hz\":",
+                                        device, (unsigned long long)seq)
+                     : (size_t)snprintf(out, PSD_JSON_HEAD_BYTES, "{\"device\":%d,\"start_freq_hz\":", device);
+    len += json_put_number(out + len, start_hz);
+    memcpy(out + len, ",\"end_freq_hz\":", 15);
+    len += 15;
+    len += json_put_number(out + len, end_hz);
+    memcpy(out + len, ",\"Pxx\":[", 8);
+    len += 8;
+    for (int i = 0; i < n; i++) {
+        if (i > 0) out[len++] = ',';
+        len += json_put_number(out + len, pxx[i]);
+    }
+    out[len++] = ']';
+    out[len++] = '}';
+    out[len] = '\0';
+    return len;
+}
+
 // =========================================================
 // DSP Logic
 // =========================================================
@@ -261,17 +343,15 @@ int scale_psd(double* psd, int nperseg, const char* scale_str) {
     typedef enum { UNIT_DBM, UNIT_DBUV, UNIT_DBMV, UNIT_WATTS, UNIT_VOLTS } Unit_t;
     Unit_t unit = UNIT_DBM; // Default
     
-    // STRICT LOWERCASE LOGIC as requested
-    char *temp_scale = strdup_lowercase(scale_str); // NULL safe
-    if (temp_scale) {
-        if (strcmp(temp_scale, "dbuv") == 0) unit = UNIT_DBUV;
-        else if (strcmp(temp_scale, "dbmv") == 0) unit = UNIT_DBMV;
-        else if (strcmp(temp_scale, "w") == 0)    unit = UNIT_WATTS;
-        else if (strcmp(temp_scale, "watts") == 0) unit = UNIT_WATTS;
-        else if (strcmp(temp_scale, "v") == 0)    unit = UNIT_VOLTS;
-        else if (strcmp(temp_scale, "volts") == 0) unit = UNIT_VOLTS;
+    // Case-insensitive compare in place (runs every frame: no lowercase copy)
+    if (scale_str) {
+        if (strcasecmp(scale_str, "dbuv") == 0) unit = UNIT_DBUV;
+        else if (strcasecmp(scale_str, "dbmv") == 0) unit = UNIT_DBMV;
+        else if (strcasecmp(scale_str, "w") == 0)    unit = UNIT_WATTS;
+        else if (strcasecmp(scale_str, "watts") == 0) unit = UNIT_WATTS;
+        else if (strcasecmp(scale_str, "v") == 0)    unit = UNIT_VOLTS;
+        else if (strcasecmp(scale_str, "volts") == 0) unit = UNIT_VOLTS;
         // else defaults to UNIT_DBM
-        free(temp_scale);
     }
 
     // Apply scaling
@@ -348,27 +428,115 @@ static void generate_window(PsdWindowType_t window_type, double* window_buffer,
     }
 }
 
-static void fftshift(double* data, int n) {
+static void fftshift(double* data, int n, double* temp) {
     int half = n / 2;
-    // Use malloc instead of alloca for large FFTs to avoid stack overflow
-    double* temp = (double*)malloc(half * sizeof(double));
-    if (!temp) return; // Fail silently or handle error
-
     memcpy(temp, data, half * sizeof(double));
     memcpy(data, &data[half], (n - half) * sizeof(double));
     memcpy(&data[n - half], temp, half * sizeof(double));
-    
-    free(temp);
 }
 
-void execute_welch_psd(signal_iq_t* signal_data, const PsdConfig_t* config, double* f_out, double* p_out) {
-    if (!signal_data || !config || !f_out || !p_out) return;
+// Segments per pool task: below this a task costs more to hand over than to compute
+#define WELCH_MIN_SEGS_PER_TASK 8
+
+// FFTW's planner is not thread-safe (pipelines and graph blocks plan concurrently)
+static pthread_mutex_t plan_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static int welch_max_slices(void) {
+    int n = work_pool_size() + 1;
+    return n > PSD_WS_MAX_SLICES ? PSD_WS_MAX_SLICES : n;
+}
+
+size_t psd_workspace_bytes(const PsdConfig_t *config) {
+    size_t n = (size_t)config->nperseg;
+    size_t slices = (size_t)welch_max_slices();
+    return ARENA_SIZE(n * sizeof(double))                                   // window
+         + ARENA_SIZE(n / 2 * sizeof(double))                               // fftshift temp
+         + slices * 2 * ARENA_SIZE(n * sizeof(double complex))              // FFT in / out
+         + (slices - 1) * ARENA_SIZE(n * sizeof(double));                   // partial sums
+}
+
+int psd_workspace_init(psd_workspace_t *ws, const PsdConfig_t *config, arena_t *arena) {
+    memset(ws, 0, sizeof(*ws));
+    if (!config || config->nperseg <= 0) return -1;
+    int n = config->nperseg;
+    ws->cfg = *config;
+    ws->n_slices = welch_max_slices();
+    ws->window = (double*)arena_alloc(arena, (size_t)n * sizeof(double));
+    ws->shift_tmp = (double*)arena_alloc(arena, (size_t)(n / 2) * sizeof(double));
+    if (!ws->window || !ws->shift_tmp) return -1;
+    for (int t = 0; t < ws->n_slices; t++) {
+        ws->fft_in[t] = (double complex*)arena_alloc(arena, (size_t)n * sizeof(double complex));
+        ws->fft_out[t] = (double complex*)arena_alloc(arena, (size_t)n * sizeof(double complex));
+        if (!ws->fft_in[t] || !ws->fft_out[t]) return -1;
+        if (t > 0 && !(ws->acc[t] = (double*)arena_alloc(arena, (size_t)n * sizeof(double)))) return -1;
+    }
+
+    generate_window(config->window_type, ws->window, n);
 
-    double complex* signal = signal_data->signal_iq;
+    // Calculate window power (S2)
+    double u_norm = 0.0;
+    for (int i = 0; i < n; i++) u_norm += ws->window[i] * ws->window[i];
+    ws->u_norm = u_norm / n;
+
+    // One plan per configuration; every slice executes it on its own (equally aligned) arrays
+    pthread_mutex_lock(&plan_lock);
+    ws->plan = fftw_plan_dft_1d(n, ws->fft_in[0], ws->fft_out[0], FFTW_FORWARD, FFTW_ESTIMATE);
+    pthread_mutex_unlock(&plan_lock);
+    return ws->plan ? 0 : -1;
+}
+
+void psd_workspace_release(psd_workspace_t *ws) {
+    if (ws->plan) {
+        pthread_mutex_lock(&plan_lock);
+        fftw_destroy_plan(ws->plan);
+        pthread_mutex_unlock(&plan_lock);
+    }
+    ws->plan = NULL;
+}
+
+// One slice of the Welch average: segments [k0, k1) accumulated into acc
+typedef struct {
+    const double complex *signal;
+    size_t n_signal;
+    const double *window;
+    int nperseg, step, k0, k1;
+    fftw_plan plan;                 // shared; fftw_execute_dft is safe on distinct arrays
+    double complex *fft_in, *fft_out;
+    double *acc;
+} welch_slice_t;
+
+static void welch_slice(void *arg) {
+    welch_slice_t *w = (welch_slice_t*)arg;
+    for (int k = w->k0; k < w->k1; k++) {
+        size_t start = (size_t)k * w->step;
+
+        for (int i = 0; i < w->nperseg; i++) {
+            if ((start + i) < w->n_signal) {
+                w->fft_in[i] = w->signal[start + i] * w->window[i];
+            } else {
+                w->fft_in[i] = 0;
+            }
+        }
+
+        fftw_execute_dft(w->plan, w->fft_in, w->fft_out);
+
+        // Accumulate Magnitude Squared
+        for (int i = 0; i < w->nperseg; i++) {
+            double mag = cabs(w->fft_out[i]);
+            w->acc[i] += (mag * mag);
+        }
+    }
+}
+
+void execute_welch_psd_ws(psd_workspace_t *ws, const signal_iq_t* signal_data, double* f_out, double* p_out) {
+    if (!ws || !ws->plan || !signal_data || !f_out || !p_out) return;
+
+    const double complex* signal = signal_data->signal_iq;
     size_t n_signal = signal_data->n_signal;
-    int nperseg = config->nperseg;
-    int noverlap = config->noverlap;
-    double fs = config->sample_rate;
+    int nperseg = ws->cfg.nperseg;
+    int noverlap = ws->cfg.noverlap;
+    double fs = ws->cfg.sample_rate;
+    double u_norm = ws->u_norm;
     
     int nfft = nperseg;
     int step = nperseg - noverlap;
@@ -380,49 +548,44 @@ void execute_welch_psd(signal_iq_t* signal_data, const PsdConfig_t* config, doub
         k_segments = (int)((n_signal - nperseg) / step) + 1;
     }
 
-    double* window = (double*)malloc(nperseg * sizeof(double));
-    if (!window) return; 
-    
-    generate_window(config->window_type, window, nperseg);
-
-    // Calculate window power (S2)
-    double u_norm = 0.0;
-    for (int i = 0; i < nperseg; i++) u_norm += window[i] * window[i];
-    u_norm /= nperseg;
-
-    // Allocate FFTW arrays
-    double complex* fft_in = fftw_alloc_complex(nfft);
-    double complex* fft_out = fftw_alloc_complex(nfft);
-    if (!fft_in || !fft_out) {
-        free(window);
-        if(fft_in) fftw_free(fft_in);
-        if(fft_out) fftw_free(fft_out);
-        return;
-    }
-
-    fftw_plan plan = fftw_plan_dft_1d(nfft, fft_in, fft_out, FFTW_FORWARD, FFTW_ESTIMATE);
-
     // Reset Output
     memset(p_out, 0, nfft * sizeof(double));
 
-    // Welch Averaging Loop
-    for (int k = 0; k < k_segments; k++) {
-        size_t start = k * step;
-        
-        for (int i = 0; i < nperseg; i++) {
-            if ((start + i) < n_signal) {
-                fft_in[i] = signal[start + i] * window[i];
-            } else {
-                fft_in[i] = 0;
-            }
-        }
-
-        fftw_execute(plan);
+    // Welch Averaging Loop: split into slices on the shared pool (NORMAL priority, so
+    // channel audio goes first). Slice 0 accumulates into p_out; the partial sums are
+    // added in slice order, so the result does not depend on scheduling.
+    int n_slices = ws->n_slices;
+    if (n_slices > k_segments / WELCH_MIN_SEGS_PER_TASK) n_slices = k_segments / WELCH_MIN_SEGS_PER_TASK;
+    if (n_slices < 1) n_slices = 1;
+
+    welch_slice_t slices[PSD_WS_MAX_SLICES];
+    for (int t = 0; t < n_slices; t++) {
+        welch_slice_t *w = &slices[t];
+        w->signal = signal;
+        w->n_signal = n_signal;
+        w->window = ws->window;
+        w->nperseg = nperseg;
+        w->step = step;
+        w->k0 = (int)((long)k_segments * t / n_slices);
+        w->k1 = (int)((long)k_segments * (t + 1) / n_slices);
+        w->plan = ws->plan;
+        w->fft_in = ws->fft_in[t];
+        w->fft_out = ws->fft_out[t];
+        w->acc = t == 0 ? p_out : ws->acc[t];
+        if (t > 0) memset(w->acc, 0, nfft * sizeof(double));
+    }
 
-        // Accumulate Magnitude Squared
-        for (int i = 0; i < nfft; i++) {
-            double mag = cabs(fft_out[i]);
-            p_out[i] += (mag * mag);
+    if (n_slices == 1) {
+        welch_slice(&slices[0]);
+    } else {
+        // wp_group_t lives on the stack: no allocation per frame
+        wp_group_t group;
+        wp_group_init(&group);
+        for (int t = 0; t < n_slices; t++) work_pool_submit(&group, WP_PRIO_NORMAL, welch_slice, &slices[t]);
+        wp_group_wait(&group);
+        wp_group_destroy(&group);
+        for (int t = 1; t < n_slices; t++) {
+            for (int i = 0; i < nfft; i++) p_out[i] += slices[t].acc[i];
         }
     }
 
@@ -436,7 +599,7 @@ void execute_welch_psd(signal_iq_t* signal_data, const PsdConfig_t* config, doub
     }
 
     // Shift zero frequency to center
-    fftshift(p_out, nfft);
+    fftshift(p_out, nfft, ws->shift_tmp);
 
     // --- DC SPIKE REMOVAL (Dynamic 0.5%) ---
     int c = nfft / 2; 
@@ -462,10 +625,20 @@ void execute_welch_psd(signal_iq_t* signal_data, const PsdConfig_t* config, doub
     for (int i = 0; i < nfft; i++) {
         f_out[i] = -fs / 2.0 + i * df;
     }
+}
 
-    // Cleanup
-    free(window);
-    fftw_destroy_plan(plan);
-    fftw_free(fft_in);
-    fftw_free(fft_out);
-}
\ No newline at end of file
+void execute_welch_psd(signal_iq_t* signal_data, const PsdConfig_t* config, double* f_out, double* p_out) {
+    if (!signal_data || !config || !f_out || !p_out) return;
+
+    // One-shot workspace; loops that run every frame keep theirs (psd_workspace_init)
+    arena_t arena;
+    psd_workspace_t ws;
+    memset(&ws, 0, sizeof(ws));
+    arena_init(&arena);
+    if (arena_reserve(&arena, psd_workspace_bytes(config)) == 0 &&
+        psd_workspace_init(&ws, config, &arena) == 0) {
+        execute_welch_psd_ws(&ws, signal_data, f_out, p_out);
+    }
+    psd_workspace_release(&ws);
+    arena_free(&arena);
+}
@@ -4,6 +4,9 @@
 
 #include "datatypes.h"
 #include "sdr_HAL.h"
+#include "arena.h"
+#include "work_pool.h"
+#include <fftw3.h>
 #include <cjson/cJSON.h>
 #include <inttypes.h>
 
@@ -11,6 +14,12 @@
 signal_iq_t* load_iq_from_buffer(const int8_t* buffer, size_t buffer_size);
 void free_signal_iq(signal_iq_t* signal);
 
+/**
+ * @brief load_iq_from_buffer into a caller-owned signal (signal_iq holds capacity samples).
+ * @return 0 on success, -1 if the buffer does not fit.
+ */
+int load_iq_into(signal_iq_t* signal_data, size_t capacity, const int8_t* buffer, size_t buffer_size);
+
 // --- PSD Computation ---
 
 /**
@@ -22,6 +31,55 @@ void free_signal_iq(signal_iq_t* signal);
  */
 void execute_welch_psd(signal_iq_t* signal_data, const PsdConfig_t* config, double* f_out, double* p_out);
 
+// --- Per-configuration Welch state: window, FFTW plan and buffers, built once ---
+#define PSD_WS_MAX_SLICES WP_MAX_WORKERS
+
+typedef struct {
+    PsdConfig_t cfg;
+    double *window;
+    double u_norm;
+    double *shift_tmp;
+    fftw_plan plan;
+    int n_slices;                                   // pool workers + 1 at init
+    double complex *fft_in[PSD_WS_MAX_SLICES];
+    double complex *fft_out[PSD_WS_MAX_SLICES];
+    double *acc[PSD_WS_MAX_SLICES];                 // partial sums (slice 0 uses p_out)
+} psd_workspace_t;
+
+/**
+ * @brief Arena bytes psd_workspace_init takes for config.
+ */
+size_t psd_workspace_bytes(const PsdConfig_t* config);
+
+/**
+ * @brief Carves the workspace out of arena and plans the FFT (the only FFTW allocation).
+ * @return 0 on success, -1 if the arena is too small or planning failed.
+ */
+int psd_workspace_init(psd_workspace_t* ws, const PsdConfig_t* config, arena_t* arena);
+
+/** Destroys the plan; the buffers belong to the arena. */
+void psd_workspace_release(psd_workspace_t* ws);
+
+/**
+ * @brief execute_welch_psd on a prepared workspace: no heap allocation.
+ */
+void execute_welch_psd_ws(psd_workspace_t* ws, const signal_iq_t* signal_data, double* f_out, double* p_out);
+
+// --- Result message ---
+#define PSD_JSON_HEAD_BYTES   160   // {"device":..,"seq":..,"start_freq_hz":..,"end_freq_hz":..,"Pxx":[ ... ]}
+#define PSD_JSON_NUM_BYTES    26    // "%1.17g" worst case + ','
+#define PSD_JSON_BYTES(bins)  (PSD_JSON_HEAD_BYTES + (size_t)(bins) * PSD_JSON_NUM_BYTES)
+
+/**
+ * @brief Writes {"device":..,"start_freq_hz":..,"end_freq_hz":..,"Pxx":[..]} into out, numbers
+ * printed the way cJSON prints them, without building a cJSON tree.
+ * @param seq The config's "seq", written after "device" when non-zero.
+ * @param cap Bytes at out; PSD_JSON_BYTES(n) always fits.
+ * @return Length written (NUL-terminated), 0 if cap is too small.
+ */
+size_t psd_json_write(char *out, size_t cap, int device, uint64_t seq, double start_hz, double end_hz,
+                      const double *pxx, int n);
+
 // --- Processing Helpers ---
 double get_window_enbw_factor(PsdWindowType_t type); 
 
@@ -43,6 +101,12 @@ int scale_psd(double* psd, int nperseg, const char* scale_str);
  */
 int parse_config_rf(const char *json_string, DesiredCfg_t *target);
 
+/**
+ * @brief Maps "realtime", "campaign", "fm"/"wfm", "nfm", "am", "usb", "lsb" (any case) to rf_mode_t.
+ * @return 0 on success, -1 if the name is unknown (mode left untouched).
+ */
+int rf_mode_from_string(const char *mode_str, rf_mode_t *mode);
+
 /**
  * @brief Frees allocated strings inside DesiredCfg_t (specifically 'scale').
  */
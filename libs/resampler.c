@@ -0,0 +1,272 @@
+// libs/resampler.c
+#include "resampler.h"
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <math.h>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+#define RS_MAX_L             512
+#define RS_MAX_M             10000000L
+#define RS_MIN_TAPS          8
+#define RS_MAX_TAPS          512
+#define RS_ATTEN_DB          70.0
+#define CIC_MAX_R            512          // 4 stages * 9 bits + 2^20 scale stays inside 64-bit wrap
+#define CIC_MIN_OVERSAMPLE   2.0          // CIC output must stay >= 2x fs_out
+#define CIC_FIXED_SCALE      1048576.0f   // 2^20: float -> fixed point for the integrators
+
+// =========================================================
+// Static Helpers
+// =========================================================
+
+/**
+ * @brief Best rational approximation num/den of x with num <= max_num (continued fractions).
+ */
+static void rational_approx(double x, long max_num, long *num, long *den) {
+    long h_prev = 1, h_prev2 = 0;
+    long k_prev = 0, k_prev2 = 1;
+    double r = x;
+
+    *num = 1;
+    *den = 1;
+
+    for (int it = 0; it < 64; it++) {
+        double a_d = floor(r);
+        long a = (long)a_d;
+        long h = a * h_prev + h_prev2;
+        long k = a * k_prev + k_prev2;
+        if (h > max_num || k > RS_MAX_M) break;
+
+        *num = h;
+        *den = k;
+        if (fabs(x - (double)h / (double)k) <= 1e-12 * x) break;
+
+        double frac = r - a_d;
+        if (frac < 1e-12) break;
+        r = 1.0 / frac;
+
+        h_prev2 = h_prev; h_prev = h;
+        k_prev2 = k_prev; k_prev = k;
+    }
+}
+
+static double bessel_i0(double x) {
+    double sum = 1.0, term = 1.0;
+    double q = x * x / 4.0;
+    for (int k = 1; k < 50; k++) {
+        term *= q / ((double)k * (double)k);
+        sum += term;
+        if (term < 1e-12 * sum) break;
+    }
+    return sum;
+}
+
+/**
+ * @brief Largest divisor of M (<= CIC_MAX_R) that keeps fs_in / R >= CIC_MIN_OVERSAMPLE * fs_out.
+ */
+static int pick_cic_ratio(long M, double fs_in, double fs_out) {
+    int best = 1;
+    for (int r = 2; r <= CIC_MAX_R; r++) {
+        if (M % r != 0) continue;
+        if (fs_in / (double)r < CIC_MIN_OVERSAMPLE * fs_out) break;
+        best = r;
+    }
+    return best;
+}
+
+static void cic_init(cic_decim_t *c, int R, int channels) {
+    memset(c, 0, sizeof(*c));
+    c->R = R;
+    c->channels = channels;
+    c->out_scale = (float)(1.0 / (pow((double)R, CIC_STAGES) * (double)CIC_FIXED_SCALE));
+}
+
+/**
+ * @brief Pushes one frame through the integrators.
+ * @return 1 when a decimated frame was written to y.
+ */
+static inline int cic_push(cic_decim_t *c, const float *x, float *y) {
+    for (int ch = 0; ch < c->channels; ch++) {
+        uint64_t v = (uint64_t)(int64_t)(x[ch] * CIC_FIXED_SCALE);
+        uint64_t *acc = c->integ[ch];
+        for (int s = 0; s < CIC_STAGES; s++) {
+            acc[s] += v;
+            v = acc[s];
+        }
+    }
+
+    if (++c->count < c->R) return 0;
+    c->count = 0;
+
+    for (int ch = 0; ch < c->channels; ch++) {
+        uint64_t v = c->integ[ch][CIC_STAGES - 1];
+        uint64_t *dly = c->comb[ch];
+        for (int s = 0; s < CIC_STAGES; s++) {
+            uint64_t t = v - dly[s];
+            dly[s] = v;
+            v = t;
+        }
+        y[ch] = (float)(int64_t)v * c->out_scale;
+    }
+    return 1;
+}
+
+// =========================================================
+// Public API
+// =========================================================
+
+int resampler_init(resampler_t *rs, double fs_in, double fs_out, int channels, double passband_hz) {
+    if (!rs || fs_in <= 0.0 || fs_out <= 0.0) return -1;
+    if (channels < 1 || channels > RESAMPLER_MAX_CH) return -1;
+
+    memset(rs, 0, sizeof(*rs));
+    rs->channels = channels;
+    rs->fs_in = fs_in;
+
+    long L = 1, M = 1;
+    rational_approx(fs_out / fs_in, RS_MAX_L, &L, &M);
+
+    int R = pick_cic_ratio(M, fs_in, fs_out);
+    cic_init(&rs->cic, R, channels);
+
+    rs->L = (int)L;
+    rs->M = (int)(M / R);
+    rs->fs_out = fs_in * (double)L / (double)M;
+
+    // Polyphase prototype runs at fs_mid * L
+    double fs_mid = fs_in / (double)R;
+    double f_lim  = (fs_mid < rs->fs_out) ? fs_mid : rs->fs_out;
+
+    double fp = (passband_hz > 0.0) ? passband_hz : 0.3 * f_lim;
+    if (fp > 0.45 * f_lim) fp = 0.45 * f_lim;
+    // Stop edge chosen so that anything folding back lands above the passband
+    double fsb = f_lim - fp;
+    double tw  = fsb - fp;
+    if (tw < 0.02 * f_lim) tw = 0.02 * f_lim;
+
+    // Kaiser estimate, expressed in taps per polyphase branch
+    double k_est = (RS_ATTEN_DB - 8.0) * fs_mid / (2.285 * 2.0 * M_PI * tw);
+    int K = (int)ceil(k_est);
+    if (K < RS_MIN_TAPS) K = RS_MIN_TAPS;
+    if (K > RS_MAX_TAPS) K = RS_MAX_TAPS;
+    rs->taps_per_phase = K;
+
+    int N = K * rs->L;
+    rs->taps = (float*)calloc((size_t)N, sizeof(float));
+    rs->hist = (float*)calloc((size_t)channels * 2 * (size_t)K, sizeof(float));
+    if (!rs->taps || !rs->hist) {
+        resampler_free(rs);
+        return -1;
+    }
+
+    // Kaiser-windowed sinc, cutoff in the middle of the transition band
+    double fc = 0.5 * (fp + fp + tw) / (fs_mid * (double)rs->L);
+    double beta = 0.1102 * (RS_ATTEN_DB - 8.7);
+    double i0_beta = bessel_i0(beta);
+    double center = 0.5 * (double)(N - 1);
+    double *proto = (double*)malloc((size_t)N * sizeof(double));
+    if (!proto) {
+        resampler_free(rs);
+        return -1;
+    }
+
+    double sum = 0.0;
+    for (int n = 0; n < N; n++) {
+        double t = (double)n - center;
+        double x = 2.0 * fc * t;
+        double sinc = (fabs(x) < 1e-12) ? 1.0 : sin(M_PI * x) / (M_PI * x);
+        double r = (N > 1) ? (t / center) : 0.0;
+        double w = bessel_i0(beta * sqrt(fmax(0.0, 1.0 - r * r))) / i0_beta;
+        proto[n] = 2.0 * fc * sinc * w;
+        sum += proto[n];
+    }
+
+    // DC gain L (interpolation), split into branches h[p + k*L]
+    double norm = (sum != 0.0) ? (double)rs->L / sum : 1.0;
+    for (int p = 0; p < rs->L; p++) {
+        for (int k = 0; k < K; k++) {
+            rs->taps[p * K + k] = (float)(proto[p + k * rs->L] * norm);
+        }
+    }
+    free(proto);
+
+    printf("[RESAMP] %.0f Hz -> %.3f Hz | CIC R=%d | FIR L=%d M=%d taps/phase=%d\n",
+           fs_in, rs->fs_out, R, rs->L, rs->M, K);
+    return 0;
+}
+
+void resampler_free(resampler_t *rs) {
+    if (!rs) return;
+    if (rs->taps) {
+        free(rs->taps);
+        rs->taps = NULL;
+    }
+    if (rs->hist) {
+        free(rs->hist);
+        rs->hist = NULL;
+    }
+}
+
+void resampler_reset(resampler_t *rs) {
+    if (!rs) return;
+    cic_init(&rs->cic, rs->cic.R, rs->channels);
+    if (rs->hist) {
+        memset(rs->hist, 0, (size_t)rs->channels * 2 * (size_t)rs->taps_per_phase * sizeof(float));
+    }
+    rs->hist_idx = 0;
+    rs->phase = 0;
+}
+
+int resampler_max_output(const resampler_t *rs, int n_in) {
+    if (!rs || rs->M <= 0 || n_in <= 0) return 0;
+    int64_t n_mid = (int64_t)n_in / rs->cic.R + 1;
+    return (int)((n_mid * rs->L + rs->M - 1) / rs->M) + 1;
+}
+
+int resampler_process(resampler_t *rs, const float *in, int n_in, float *out) {
+    if (!rs || !rs->taps || !in || !out) return 0;
+
+    const int C = rs->channels;
+    const int K = rs->taps_per_phase;
+    const int L = rs->L;
+    const int M = rs->M;
+    int n_out = 0;
+    float mid[RESAMPLER_MAX_CH];
+
+    for (int i = 0; i < n_in; i++) {
+        const float *x = &in[i * C];
+
+        // 1) CIC front end (only every R-th frame reaches the FIR)
+        if (rs->cic.R > 1) {
+            if (!cic_push(&rs->cic, x, mid)) continue;
+            x = mid;
+        }
+
+        // 2) push into the mirrored delay line (newest first in memory)
+        rs->hist_idx = (rs->hist_idx == 0) ? (K - 1) : (rs->hist_idx - 1);
+        for (int ch = 0; ch < C; ch++) {
+            float *h = &rs->hist[ch * 2 * K];
+            h[rs->hist_idx] = x[ch];
+            h[rs->hist_idx + K] = x[ch];
+        }
+
+        // 3) emit every output whose phase falls on this input
+        while (rs->phase < L) {
+            const float *taps = &rs->taps[rs->phase * K];
+            for (int ch = 0; ch < C; ch++) {
+                const float *h = &rs->hist[ch * 2 * K + rs->hist_idx];
+                float acc = 0.0f;
+                for (int k = 0; k < K; k++) acc += taps[k] * h[k];
+                out[n_out * C + ch] = acc;
+            }
+            n_out++;
+            rs->phase += M;
+        }
+        rs->phase -= L;
+    }
+
+    return n_out;
+}
@@ -0,0 +1,68 @@
+// libs/resampler.h
+#ifndef RESAMPLER_H
+#define RESAMPLER_H
+
+#include <stdint.h>
+
+#define CIC_STAGES        4
+#define RESAMPLER_MAX_CH  2     // 1 = real audio, 2 = interleaved I/Q
+
+// --- CIC decimator (integer front end for large ratios) ---
+typedef struct {
+    int R;                                      // decimation ratio (1 = bypass)
+    int channels;
+    int count;
+    uint64_t integ[RESAMPLER_MAX_CH][CIC_STAGES]; // wrap-around arithmetic is intended
+    uint64_t comb[RESAMPLER_MAX_CH][CIC_STAGES];
+    float out_scale;                            // 1 / (R^N * fixed-point scale)
+} cic_decim_t;
+
+// --- Rational resampler: CIC (optional) + polyphase FIR L/M ---
+typedef struct {
+    double fs_in;
+    double fs_out;          // exact: fs_in * L / (R * M)
+    int channels;
+
+    cic_decim_t cic;
+
+    int L;                  // polyphase interpolation factor
+    int M;                  // polyphase decimation factor (after CIC)
+    int taps_per_phase;
+    float *taps;            // [L][taps_per_phase], newest-sample-first
+    float *hist;            // [channels][2 * taps_per_phase] mirrored delay line
+    int hist_idx;
+    int phase;
+} resampler_t;
+
+/**
+ * @brief Builds a resampler producing exactly fs_out from fs_in.
+ * The ratio is reduced to L/M; when M has a suitable divisor a CIC stage takes it
+ * first so the polyphase FIR runs at a few times fs_out.
+ * @param channels 1 (real) or 2 (interleaved I/Q).
+ * @param passband_hz Edge of the flat band; <= 0 picks 0.3 * min(fs_mid, fs_out).
+ * @return 0 on success, -1 on error.
+ */
+int resampler_init(resampler_t *rs, double fs_in, double fs_out, int channels, double passband_hz);
+
+/**
+ * @brief Releases the tap and history buffers.
+ */
+void resampler_free(resampler_t *rs);
+
+/**
+ * @brief Clears filter state (keeps taps).
+ */
+void resampler_reset(resampler_t *rs);
+
+/**
+ * @brief Upper bound of output frames produced for n_in input frames.
+ */
+int resampler_max_output(const resampler_t *rs, int n_in);
+
+/**
+ * @brief Resamples n_in frames (interleaved when channels == 2).
+ * @return Number of output frames written to out.
+ */
+int resampler_process(resampler_t *rs, const float *in, int n_in, float *out);
+
+#endif
@@ -36,6 +36,15 @@ void rb_reset(ring_buffer_t *rb) {
     pthread_mutex_unlock(&rb->lock);
 }
 
+// Drops unread bytes without clearing memory (stale samples after a retune)
+size_t rb_discard(ring_buffer_t *rb) {
+    pthread_mutex_lock(&rb->lock);
+    size_t dropped = rb->head - rb->tail;
+    rb->tail = rb->head;
+    pthread_mutex_unlock(&rb->lock);
+    return dropped;
+}
+
 size_t rb_write(ring_buffer_t *rb, const void *data, size_t len) {
     pthread_mutex_lock(&rb->lock);
     
@@ -90,4 +99,12 @@ size_t rb_available(ring_buffer_t *rb) {
     size_t val = rb->head - rb->tail;
     pthread_mutex_unlock(&rb->lock);
     return val;
-}
\ No newline at end of file
+}
+
+// Free bytes; with a single producer a write of up to this many bytes cannot be cut short
+size_t rb_space(ring_buffer_t *rb) {
+    pthread_mutex_lock(&rb->lock);
+    size_t val = rb->size - (rb->head - rb->tail);
+    pthread_mutex_unlock(&rb->lock);
+    return val;
+}
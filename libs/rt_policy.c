@@ -0,0 +1,305 @@
+// libs/rt_policy.c
+#include "rt_policy.h"
+#include "utils.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <errno.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+
+#define RT_MAX_ENTRIES 32
+
+typedef struct {
+    char key[RT_LABEL_LEN];     // role or label
+    rt_thread_cfg_t cfg;
+} rt_entry_t;
+
+static rt_entry_t entries[RT_MAX_ENTRIES];
+static int n_entries = 0;
+static bool want_mlock = false;
+static int mlock_state = 0;     // 0 = not requested, 1 = locked, -1 = failed
+
+static rt_placement_t placed[RT_MAX_THREADS];
+static int n_placed = 0;
+static pthread_mutex_t placed_lock = PTHREAD_MUTEX_INITIALIZER;
+
+const char* rt_sched_name(int sched) {
+    switch (sched) {
+    case SCHED_FIFO:  return "fifo";
+    case SCHED_RR:    return "rr";
+    case SCHED_OTHER: return "other";
+#ifdef SCHED_BATCH
+    case SCHED_BATCH: return "batch";
+#endif
+#ifdef SCHED_IDLE
+    case SCHED_IDLE:  return "idle";
+#endif
+    default:          return "?";
+    }
+}
+
+static char* read_file(const char *path) {
+    FILE *f = fopen(path, "rb");
+    if (!f) return NULL;
+    char *txt = NULL;
+    long sz = -1;
+    if (fseek(f, 0, SEEK_END) == 0 && (sz = ftell(f)) > 0 && fseek(f, 0, SEEK_SET) == 0) {
+        txt = (char*)calloc(1, (size_t)sz + 1);
+        if (txt && fread(txt, 1, (size_t)sz, f) != (size_t)sz) {
+            free(txt);
+            txt = NULL;
+        }
+    }
+    fclose(f);
+    return txt;
+}
+
+static int parse_entry(const char *key, const cJSON *o, rt_thread_cfg_t *cfg, char *err, size_t err_len) {
+    memset(cfg, 0, sizeof(*cfg));
+    cfg->sched = SCHED_OTHER;
+
+    const cJSON *cpus = cJSON_GetObjectItemCaseSensitive(o, "cpus");
+    if (cJSON_IsString(cpus) && cpus->valuestring) {
+        if (parse_cpu_list(cpus->valuestring, &cfg->cpus) <= 0) {
+            snprintf(err, err_len, "%s: bad cpu list '%s'", key, cpus->valuestring);
+            return -1;
+        }
+        cfg->has_cpus = true;
+    }
+
+    const cJSON *sched = cJSON_GetObjectItemCaseSensitive(o, "sched");
+    if (cJSON_IsString(sched) && sched->valuestring) {
+        const char *s = sched->valuestring;
+        if (strcasecmp(s, "fifo") == 0) cfg->sched = SCHED_FIFO;
+        else if (strcasecmp(s, "rr") == 0) cfg->sched = SCHED_RR;
+        else if (strcasecmp(s, "other") == 0) cfg->sched = SCHED_OTHER;
+        else {
+            snprintf(err, err_len, "%s: sched is fifo, rr or other", key);
+            return -1;
+        }
+        cfg->has_sched = true;
+    }
+    const cJSON *prio = cJSON_GetObjectItemCaseSensitive(o, "priority");
+    if (cfg->sched != SCHED_OTHER) {
+        int lo = sched_get_priority_min(cfg->sched), hi = sched_get_priority_max(cfg->sched);
+        cfg->priority = cJSON_IsNumber(prio) ? prio->valueint : lo;
+        if (cfg->priority < lo || cfg->priority > hi) {
+            snprintf(err, err_len, "%s: priority %d outside %d..%d", key, cfg->priority, lo, hi);
+            return -1;
+        }
+    }
+
+    const cJSON *nice = cJSON_GetObjectItemCaseSensitive(o, "nice");
+    if (cJSON_IsNumber(nice)) {
+        cfg->nice = nice->valueint;
+        if (cfg->nice < -20 || cfg->nice > 19) {
+            snprintf(err, err_len, "%s: nice %d outside -20..19", key, cfg->nice);
+            return -1;
+        }
+        cfg->has_nice = true;
+    }
+    return 0;
+}
+
+int rt_policy_load(const char *spec, char *err, size_t err_len) {
+    n_entries = 0;
+    want_mlock = false;
+    if (!spec || !spec[0]) return 0;
+
+    char *txt = (spec[0] == '{') ? strdup(spec) : read_file(spec);
+    if (!txt) {
+        snprintf(err, err_len, "cannot read %s", spec);
+        return -1;
+    }
+    cJSON *root = cJSON_Parse(txt);
+    free(txt);
+    if (!cJSON_IsObject(root)) {
+        snprintf(err, err_len, "not a JSON object");
+        cJSON_Delete(root);
+        return -1;
+    }
+
+    want_mlock = cJSON_IsTrue(cJSON_GetObjectItemCaseSensitive(root, "mlockall"));
+    const cJSON *threads = cJSON_GetObjectItemCaseSensitive(root, "threads");
+    const cJSON *t;
+    cJSON_ArrayForEach(t, threads) {
+        if (n_entries >= RT_MAX_ENTRIES || !t->string || strlen(t->string) >= RT_LABEL_LEN) {
+            snprintf(err, err_len, "threads: too many entries or a long key");
+            cJSON_Delete(root);
+            return -1;
+        }
+        rt_entry_t *e = &entries[n_entries];
+        snprintf(e->key, sizeof(e->key), "%s", t->string);
+        if (parse_entry(e->key, t, &e->cfg, err, err_len) != 0) {
+            cJSON_Delete(root);
+            return -1;
+        }
+        n_entries++;
+    }
+    cJSON_Delete(root);
+    printf("[RT] Policy: %d thread entr%s%s\n", n_entries, n_entries == 1 ? "y" : "ies", want_mlock ? ", mlockall" : "");
+    return 0;
+}
+
+int rt_policy_lock_memory(void) {
+    if (!want_mlock) return 0;
+    if (mlockall(MCL_CURRENT | MCL_FUTURE) != 0) {
+        struct rlimit rl;
+        getrlimit(RLIMIT_MEMLOCK, &rl);
+        fprintf(stderr, "[RT] Warning: mlockall failed: %s (RLIMIT_MEMLOCK %lu KiB; needs CAP_IPC_LOCK or ulimit -l)\n",
+                strerror(errno), rl.rlim_cur == RLIM_INFINITY ? 0UL : (unsigned long)(rl.rlim_cur / 1024));
+        mlock_state = -1;
+        return -1;
+    }
+    printf("[RT] Memory locked (current and future pages)\n");
+    mlock_state = 1;
+    return 0;
+}
+
+int rt_thread_apply(const rt_thread_cfg_t *cfg) {
+    int rc = 0;
+    if (cfg->has_cpus && pthread_setaffinity_np(pthread_self(), sizeof(cfg->cpus), &cfg->cpus) != 0) {
+        fprintf(stderr, "[RT] Warning: affinity not applied (CPUs offline or outside the cgroup)\n");
+        rc = -1;
+    }
+    if (cfg->has_sched) {
+        struct sched_param sp = { .sched_priority = cfg->sched == SCHED_OTHER ? 0 : cfg->priority };
+        int e = pthread_setschedparam(pthread_self(), cfg->sched, &sp);
+        if (e != 0) {
+            fprintf(stderr, "[RT] Warning: %s %d not applied: %s%s\n", rt_sched_name(cfg->sched), sp.sched_priority,
+                    strerror(e), e == EPERM ? " (needs CAP_SYS_NICE or an rtprio limit)" : "");
+            rc = -1;
+        }
+    }
+    // nice is per thread on Linux: setpriority on the tid
+    if (cfg->has_nice && setpriority(PRIO_PROCESS, (id_t)syscall(SYS_gettid), cfg->nice) != 0) {
+        fprintf(stderr, "[RT] Warning: nice %d not applied: %s\n", cfg->nice, strerror(errno));
+        rc = -1;
+    }
+    return rc;
+}
+
+static const rt_entry_t* entry_for(const char *role, const char *label) {
+    for (int i = 0; label && i < n_entries; i++) if (strcmp(entries[i].key, label) == 0) return &entries[i];
+    for (int i = 0; i < n_entries; i++) if (strcmp(entries[i].key, role) == 0) return &entries[i];
+    return NULL;
+}
+
+bool rt_policy_role_is_rt(const char *role) {
+    const rt_entry_t *e = entry_for(role, NULL);
+    return e && e->cfg.has_sched && e->cfg.sched != SCHED_OTHER;
+}
+
+static void cpus_str(const cpu_set_t *set, char *out, size_t len) {
+    size_t used = 0;
+    out[0] = '\0';
+    for (int c = 0; c < CPU_SETSIZE && used + 12 < len; c++) {
+        if (!CPU_ISSET(c, set)) continue;
+        int last = c;
+        while (last + 1 < CPU_SETSIZE && CPU_ISSET(last + 1, set)) last++;
+        if (last > c) used += (size_t)snprintf(out + used, len - used, "%s%d-%d", used ? "," : "", c, last);
+        else used += (size_t)snprintf(out + used, len - used, "%s%d", used ? "," : "", c);
+        c = last;
+    }
+}
+
+void rt_policy_apply(const char *role, const char *label) {
+    const rt_entry_t *e = entry_for(role, label);
+    rt_placement_t p;
+    memset(&p, 0, sizeof(p));
+    snprintf(p.label, sizeof(p.label), "%s", label ? label : role);
+    snprintf(p.role, sizeof(p.role), "%s", role);
+    p.tid = (pid_t)syscall(SYS_gettid);
+    p.configured = (e != NULL);
+    if (e) p.failed = (rt_thread_apply(&e->cfg) != 0);
+
+    // Effective values, whatever their origin (entry, inheritance, defaults)
+    struct sched_param sp;
+    pthread_getaffinity_np(pthread_self(), sizeof(p.cpus), &p.cpus);
+    pthread_getschedparam(pthread_self(), &p.sched, &sp);
+    p.priority = sp.sched_priority;
+    errno = 0;
+    p.nice = getpriority(PRIO_PROCESS, (id_t)p.tid);
+
+    char cpus[96];
+    cpus_str(&p.cpus, cpus, sizeof(cpus));
+    printf("[RT] %-14s tid %-6d CPUs %-10s %s %d, nice %d%s\n", p.label, (int)p.tid, cpus,
+           rt_sched_name(p.sched), p.priority, p.nice, !e ? " (inherited)" : (p.failed ? " (partly applied)" : ""));
+
+    pthread_mutex_lock(&placed_lock);
+    int slot = -1;
+    for (int i = 0; i < n_placed; i++) if (strcmp(placed[i].label, p.label) == 0) slot = i;   // restarted thread
+    if (slot < 0 && n_placed < RT_MAX_THREADS) slot = n_placed++;
+    if (slot >= 0) placed[slot] = p;
+    pthread_mutex_unlock(&placed_lock);
+}
+
+static long locked_kb(void) {
+    FILE *f = fopen("/proc/self/status", "r");
+    if (!f) return -1;
+    char line[128];
+    long kb = -1;
+    while (fgets(line, sizeof(line), f)) {
+        if (sscanf(line, "VmLck: %ld kB", &kb) == 1) break;
+    }
+    fclose(f);
+    return kb;
+}
+
+void rt_policy_report(void) {
+    pthread_mutex_lock(&placed_lock);
+    printf("\n================ [ THREAD PLACEMENT ] ================\n");
+    printf("%-14s %-6s %-7s %-12s %-6s %4s %5s\n", "thread", "role", "tid", "cpus", "sched", "prio", "nice");
+    for (int i = 0; i < n_placed; i++) {
+        const rt_placement_t *p = &placed[i];
+        char cpus[96];
+        cpus_str(&p->cpus, cpus, sizeof(cpus));
+        printf("%-14s %-6s %-7d %-12s %-6s %4d %5d%s\n", p->label, p->role, (int)p->tid, cpus,
+               rt_sched_name(p->sched), p->priority, p->nice,
+               !p->configured ? "  inherited" : (p->failed ? "  PARTLY APPLIED" : ""));
+    }
+    pthread_mutex_unlock(&placed_lock);
+    printf("Memory lock : %s, VmLck %ld kB\n",
+           mlock_state == 1 ? "mlockall" : (mlock_state < 0 ? "mlockall FAILED" : "off"), locked_kb());
+    printf("======================================================\n\n");
+}
+
+cJSON* rt_policy_report_json(void) {
+    cJSON *root = cJSON_CreateObject();
+    cJSON_AddStringToObject(root, "mlockall", mlock_state == 1 ? "locked" : (mlock_state < 0 ? "failed" : "off"));
+    cJSON_AddNumberToObject(root, "locked_kb", (double)locked_kb());
+    cJSON *arr = cJSON_AddArrayToObject(root, "threads");
+
+    pthread_mutex_lock(&placed_lock);
+    for (int i = 0; i < n_placed; i++) {
+        const rt_placement_t *p = &placed[i];
+        char cpus[96];
+        cpus_str(&p->cpus, cpus, sizeof(cpus));
+        cJSON *o = cJSON_CreateObject();
+        cJSON_AddStringToObject(o, "label", p->label);
+        cJSON_AddStringToObject(o, "role", p->role);
+        cJSON_AddNumberToObject(o, "tid", p->tid);
+        cJSON_AddStringToObject(o, "cpus", cpus);
+        cJSON_AddStringToObject(o, "sched", rt_sched_name(p->sched));
+        cJSON_AddNumberToObject(o, "priority", p->priority);
+        cJSON_AddNumberToObject(o, "nice", p->nice);
+        cJSON_AddBoolToObject(o, "configured", p->configured);
+        cJSON_AddBoolToObject(o, "failed", p->failed);
+        cJSON_AddItemToArray(arr, o);
+    }
+    pthread_mutex_unlock(&placed_lock);
+    return root;
+}
+
+int rt_policy_threads(rt_placement_t *out, int max) {
+    pthread_mutex_lock(&placed_lock);
+    int n = n_placed < max ? n_placed : max;
+    memcpy(out, placed, (size_t)n * sizeof(rt_placement_t));
+    pthread_mutex_unlock(&placed_lock);
+    return n;
+}
@@ -0,0 +1,102 @@
+// libs/rt_policy.h
+#ifndef RT_POLICY_H
+#define RT_POLICY_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <sched.h>
+#include <sys/types.h>
+#include <cjson/cJSON.h>
+
+// --- Per-thread CPU placement and scheduling, by role ---
+//
+// RT_POLICY (.env) = inline JSON or the path of a JSON file:
+// {"mlockall": true,
+//  "threads": {
+//     "rx":    {"cpus": "3",   "sched": "fifo", "priority": 80},   // SDR sample delivery (libusb / file / sim)
+//     "audio": {"cpus": "2",   "sched": "fifo", "priority": 70},
+//     "psd":   {"cpus": "0-1", "nice": 5},                        // pipeline thread (acquisition + PSD)
+//     "dev1/psd": {"cpus": "1"},                                 // a label overrides its role
+//     "zmq":   {"cpus": "0-1"}, "chan": {...}, "rec": {...}, "graph": {...}, "pool": {...}}}
+//
+// Every key is optional. A thread whose role has no entry keeps what it inherited from
+// its creator (RF_DEVICE_CPUS, the creator's policy); it is still listed in the report.
+//
+// With several channels attached, the channel chains (DDC -> demod -> Opus) run as "pool"
+// tasks, so "pool" must carry the audio-grade policy. If "chan" is FIFO/RR and "pool" is
+// not, the chan thread runs the chains inline instead.
+
+#define RT_MAX_THREADS  64
+#define RT_LABEL_LEN    32
+
+typedef struct {
+    bool has_cpus;
+    cpu_set_t cpus;
+    bool has_sched;
+    int sched;                  // SCHED_OTHER | SCHED_FIFO | SCHED_RR
+    int priority;               // FIFO/RR: 1..99
+    bool has_nice;
+    int nice;                   // -20..19 (SCHED_OTHER)
+} rt_thread_cfg_t;
+
+// What one thread ended up with (read back right after applying)
+typedef struct {
+    char label[RT_LABEL_LEN];
+    char role[16];
+    pid_t tid;
+    cpu_set_t cpus;
+    int sched;
+    int priority;
+    int nice;
+    bool configured;            // an entry matched
+    bool failed;                // part of the entry could not be applied (see the log)
+} rt_placement_t;
+
+/**
+ * @brief Parses a policy (inline JSON or file path). NULL/empty = no policy.
+ * @return 0 on success, -1 with a message in err.
+ */
+int rt_policy_load(const char *spec, char *err, size_t err_len);
+
+/**
+ * @brief mlockall(MCL_CURRENT | MCL_FUTURE) if the policy asks for it.
+ * @return 0 if not requested or locked, -1 if it failed (logged; the engine keeps running).
+ */
+int rt_policy_lock_memory(void);
+
+/**
+ * @brief Applies the entry for label, else for role, to the calling thread and records the
+ * effective placement. label NULL = role. Never fails the caller: errors are logged.
+ */
+void rt_policy_apply(const char *role, const char *label);
+
+/**
+ * @brief Same as rt_policy_apply with an explicit entry (bench / tests).
+ * @return 0 if every part was applied, -1 otherwise.
+ */
+int rt_thread_apply(const rt_thread_cfg_t *cfg);
+
+/**
+ * @brief True if the entry for role asks for SCHED_FIFO or SCHED_RR.
+ */
+bool rt_policy_role_is_rt(const char *role);
+
+/**
+ * @brief Prints every recorded thread plus the memory lock state.
+ */
+void rt_policy_report(void);
+
+/**
+ * @brief {"mlockall":..,"locked_kb":..,"threads":[{"label","role","tid","cpus","sched","priority","nice",..}]}
+ */
+cJSON* rt_policy_report_json(void);
+
+/**
+ * @brief Copies up to max recorded threads (every thread that called rt_policy_apply).
+ * @return Number copied.
+ */
+int rt_policy_threads(rt_placement_t *out, int max);
+
+const char* rt_sched_name(int sched);
+
+#endif
@@ -1,6 +1,18 @@
 //libs/sdr_HAL.c
 #include "sdr_HAL.h"
+#include "sdr_backend.h"
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <time.h>
+#include <errno.h>
+
+static uint64_t mono_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
 
 static void tune_freq_with_ppm(hackrf_device* dev, uint64_t target_freq, int ppm_error) {
     double correction = 1.0 + ((double)ppm_error / 1000000.0);
@@ -12,13 +24,390 @@ static void tune_freq_with_ppm(hackrf_device* dev, uint64_t target_freq, int ppm
     hackrf_set_freq(dev, corrected_freq);
 }
 
+// MAX2837 steps: LNA 0..40 dB in 8 dB, VGA 0..62 dB in 2 dB (libhackrf rejects other values)
+static uint32_t lna_steps(int db) {
+    if (db < 0) db = 0;
+    if (db > 40) db = 40;
+    return (uint32_t)(db & ~7);
+}
+
+static uint32_t vga_steps(int db) {
+    if (db < 0) db = 0;
+    if (db > 62) db = 62;
+    return (uint32_t)(db & ~1);
+}
+
+/**
+ * @brief Issues the libhackrf calls selected by changed (SDR_CHG_*).
+ * @return 0 if every call succeeded.
+ */
+static int hackrf_apply_changed(hackrf_device* dev, SDR_cfg_t *cfg, unsigned changed) {
+    int rc = HACKRF_SUCCESS;
+    if (changed & SDR_CHG_AMP) rc |= hackrf_set_amp_enable(dev, cfg->amp_enabled ? 1 : 0);
+    if (changed & SDR_CHG_LNA) rc |= hackrf_set_lna_gain(dev, lna_steps(cfg->lna_gain));
+    if (changed & SDR_CHG_VGA) rc |= hackrf_set_vga_gain(dev, vga_steps(cfg->vga_gain));
+    if (changed & SDR_CHG_RATE) rc |= hackrf_set_sample_rate(dev, cfg->sample_rate);
+    if (changed == SDR_CHG_ALL) rc |= hackrf_set_hw_sync_mode(dev, 0);
+    if (changed & SDR_CHG_FREQ) tune_freq_with_ppm(dev, cfg->center_freq, cfg->ppm_error);
+    return (rc == HACKRF_SUCCESS) ? 0 : -1;
+}
+
 void hackrf_apply_cfg(hackrf_device* dev, SDR_cfg_t *cfg) {
     if (!dev || !cfg) return;
+    hackrf_apply_changed(dev, cfg, SDR_CHG_ALL);
+}
+
+// =========================================================
+// HackRF backend
+static bool hackrf_lib_ready = false;
+static pthread_mutex_t hackrf_lib_lock = PTHREAD_MUTEX_INITIALIZER;  // pipelines open boards concurrently
+
+static int deliver(sdr_dev_t *dev, const uint8_t *buf, size_t len, uint64_t t_ns, uint64_t pos);
+
+static int hackrf_rx(hackrf_transfer *transfer) {
+    sdr_dev_t *dev = (sdr_dev_t*)transfer->rx_ctx;
+    return deliver(dev, transfer->buffer, (size_t)transfer->valid_length, mono_ns(), 0);
+}
+
+static int hackrf_be_apply(void *impl, SDR_cfg_t *cfg, unsigned changed) {
+    return hackrf_apply_changed((hackrf_device*)impl, cfg, changed);
+}
+
+static int hackrf_be_start(void *impl, sdr_dev_t *dev) {
+    return (hackrf_start_rx((hackrf_device*)impl, hackrf_rx, dev) == HACKRF_SUCCESS) ? 0 : -1;
+}
+
+static int hackrf_be_stop(void *impl) {
+    return (hackrf_stop_rx((hackrf_device*)impl) == HACKRF_SUCCESS) ? 0 : -1;
+}
+
+static void hackrf_be_close(void *impl) {
+    hackrf_close((hackrf_device*)impl);
+}
+
+static const sdr_ops_t hackrf_ops = {
+    .apply = hackrf_be_apply,
+    .start = hackrf_be_start,
+    .stop  = hackrf_be_stop,
+    .fill  = NULL,
+    .close = hackrf_be_close,
+};
+
+static int hackrf_lib_init(void) {
+    if (hackrf_lib_ready) return 0;
+    if (hackrf_init() != HACKRF_SUCCESS) {
+        fprintf(stderr, "[HAL] hackrf_init failed\n");
+        return -1;
+    }
+    hackrf_lib_ready = true;
+    return 0;
+}
+
+static void* hackrf_be_open(const sdr_open_cfg_t *cfg, const sdr_ops_t **ops) {
+    hackrf_device *h = NULL;
+    int rc = HACKRF_ERROR_OTHER;
+
+    pthread_mutex_lock(&hackrf_lib_lock);
+    if (hackrf_lib_init() == 0) {
+        rc = (cfg->serial && cfg->serial[0]) ? hackrf_open_by_serial(cfg->serial, &h) : hackrf_open(&h);
+    }
+    pthread_mutex_unlock(&hackrf_lib_lock);
+
+    if (rc != HACKRF_SUCCESS) return NULL;
+    *ops = &hackrf_ops;
+    return h;
+}
+
+int sdr_hackrf_list(char serials[][SDR_SERIAL_LEN], int max) {
+    pthread_mutex_lock(&hackrf_lib_lock);
+    if (hackrf_lib_init() != 0) {
+        pthread_mutex_unlock(&hackrf_lib_lock);
+        return -1;
+    }
+    hackrf_device_list_t *list = hackrf_device_list();
+    int n = 0;
+    if (list) {
+        for (int i = 0; i < list->devicecount && n < max; i++) {
+            if (!list->serial_numbers[i]) continue;     // board without a readable serial (in use)
+            snprintf(serials[n++], SDR_SERIAL_LEN, "%s", list->serial_numbers[i]);
+        }
+        hackrf_device_list_free(list);
+    }
+    pthread_mutex_unlock(&hackrf_lib_lock);
+    return n;
+}
+
+// =========================================================
+// Settling: every block passes here on its way to the callback. A hardware block ends
+// at its arrival time, so its samples are dated backwards with the sample rate and
+// those older than valid_t_ns are cut. A software block is dated by stream position:
+// everything filled after the apply is already valid.
+static int deliver(sdr_dev_t *dev, const uint8_t *buf, size_t len, uint64_t t_ns, uint64_t pos) {
+    size_t skip = 0;
+
+    pthread_mutex_lock(&dev->settle_lock);
+    if (dev->pend_active) {
+        if (!dev->ops->fill) {
+            uint64_t span_ns = (uint64_t)((double)(len / 2) * 1e9 / dev->pend_fs);
+            uint64_t first_ns = t_ns - span_ns;
+            if (t_ns <= dev->valid_t_ns) {
+                skip = len;
+            } else if (first_ns < dev->valid_t_ns) {
+                skip = 2 * (size_t)((double)(dev->valid_t_ns - first_ns) * dev->pend_fs / 1e9);
+                if (skip > len) skip = len;
+            }
+        } else if (pos < dev->valid_pos) {
+            skip = (dev->valid_pos - pos < len) ? (size_t)(dev->valid_pos - pos) : len;
+        }
+        dev->pend.discarded_samples += skip / 2;
+
+        if (skip < len) {
+            dev->pend.valid_us = (double)(t_ns - dev->pend_t0_ns) / 1e3;
+            dev->pend.seq = dev->last.seq + 1;
+            dev->last = dev->pend;
+            dev->pend_active = false;
+        }
+    }
+    pthread_mutex_unlock(&dev->settle_lock);
+
+    if (skip >= len) return 0;
+    return dev->cb(buf + skip, len - skip, dev->cb_ctx);
+}
+
+static unsigned cfg_diff(const SDR_cfg_t *a, const SDR_cfg_t *b) {
+    unsigned m = 0;
+    if (a->center_freq != b->center_freq || a->ppm_error != b->ppm_error) m |= SDR_CHG_FREQ;
+    if (a->sample_rate != b->sample_rate) m |= SDR_CHG_RATE;
+    if (a->amp_enabled != b->amp_enabled) m |= SDR_CHG_AMP;
+    if (a->lna_gain != b->lna_gain) m |= SDR_CHG_LNA;
+    if (a->vga_gain != b->vga_gain) m |= SDR_CHG_VGA;
+    return m;
+}
+
+static uint64_t settle_ns_of(unsigned changed) {
+    uint64_t us = 0;
+    if ((changed & (SDR_CHG_AMP | SDR_CHG_LNA | SDR_CHG_VGA)) && us < SDR_SETTLE_GAIN_US) us = SDR_SETTLE_GAIN_US;
+    if ((changed & SDR_CHG_FREQ) && us < SDR_SETTLE_FREQ_US) us = SDR_SETTLE_FREQ_US;
+    if ((changed & SDR_CHG_RATE) && us < SDR_SETTLE_RATE_US) us = SDR_SETTLE_RATE_US;
+    return us * 1000ULL;
+}
 
-    hackrf_set_amp_enable(dev, cfg->amp_enabled ? 1 : 0);
-    hackrf_set_lna_gain(dev, 28);
-    hackrf_set_vga_gain(dev, 32);
-    hackrf_set_sample_rate(dev, cfg->sample_rate);
-    hackrf_set_hw_sync_mode(dev, 0);
-    tune_freq_with_ppm(dev, cfg->center_freq, cfg->ppm_error);
-}
\ No newline at end of file
+// =========================================================
+// Software sources: one thread fills SDR_BLOCK_BYTES and hands it to the callback,
+// sleeping until the block's last sample is "due" when paced (like a USB transfer
+// completing), or back to back when not.
+
+static void sleep_until_ns(uint64_t t_ns) {
+    struct timespec ts = { .tv_sec = (time_t)(t_ns / 1000000000ULL), .tv_nsec = (long)(t_ns % 1000000000ULL) };
+    // Absolute deadline: a signal only interrupts it, any other error would spin forever
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR) { }
+}
+
+static void* soft_thread_fn(void *arg) {
+    sdr_dev_t *dev = (sdr_dev_t*)arg;
+    uint64_t t_due = mono_ns();
+    uint64_t late_blocks = 0;
+
+    while (dev->streaming) {
+        pthread_mutex_lock(&dev->lock);
+        double fs = dev->sample_rate;
+        uint64_t pos = dev->fill_pos;
+        size_t n = (fs > 0.0 || !dev->realtime) ? dev->ops->fill(dev->impl, dev->block, SDR_BLOCK_BYTES) : 0;
+        dev->fill_pos += n;
+        pthread_mutex_unlock(&dev->lock);
+
+        if (fs <= 0.0 && dev->realtime) {
+            // No rate yet: nothing to pace against
+            struct timespec ts = { 0, 10 * 1000000L };
+            nanosleep(&ts, NULL);
+            t_due = mono_ns();
+            continue;
+        }
+        if (n == 0) {
+            printf("[HAL] %s: end of stream\n", sdr_backend_name(dev->backend));
+            break;
+        }
+
+        if (dev->realtime) {
+            t_due += (uint64_t)((double)(n / 2) * 1e9 / fs);
+            uint64_t now = mono_ns();
+            if (t_due > now) {
+                sleep_until_ns(t_due);
+            } else if (now - t_due > (uint64_t)(SDR_RESYNC_S * 1e9)) {
+                // The consumer stalled: restart the clock instead of bursting to catch up
+                late_blocks++;
+                fprintf(stderr, "[HAL] %s: %.0f ms behind real time, resyncing (%lu so far)\n",
+                        sdr_backend_name(dev->backend), (double)(now - t_due) / 1e6, late_blocks);
+                t_due = now;
+            }
+        }
+
+        if (deliver(dev, dev->block, n, mono_ns(), pos) != 0) break;
+    }
+    dev->streaming = false;
+    return NULL;
+}
+
+// =========================================================
+// Dispatch
+sdr_dev_t* sdr_open(const sdr_open_cfg_t *cfg) {
+    if (!cfg) return NULL;
+
+    sdr_dev_t *dev = (sdr_dev_t*)calloc(1, sizeof(sdr_dev_t));
+    if (!dev) return NULL;
+    dev->backend = cfg->backend;
+    dev->realtime = cfg->realtime;
+
+    switch (cfg->backend) {
+    case SDR_BACKEND_HACKRF: dev->impl = hackrf_be_open(cfg, &dev->ops); break;
+    case SDR_BACKEND_FILE:   dev->impl = sdr_file_open(cfg, &dev->ops); break;
+    case SDR_BACKEND_SIM:    dev->impl = sdr_sim_open(cfg, &dev->ops); break;
+    }
+    if (!dev->impl) {
+        free(dev);
+        return NULL;
+    }
+
+    if (dev->ops->fill) {
+        dev->block = (uint8_t*)malloc(SDR_BLOCK_BYTES);
+        if (!dev->block) {
+            dev->ops->close(dev->impl);
+            free(dev);
+            return NULL;
+        }
+        pthread_mutex_init(&dev->lock, NULL);
+    }
+    pthread_mutex_init(&dev->settle_lock, NULL);
+    return dev;
+}
+
+int sdr_apply_cfg(sdr_dev_t *dev, SDR_cfg_t *cfg) {
+    if (!dev || !cfg) return -1;
+
+    unsigned changed = dev->applied_valid ? cfg_diff(cfg, &dev->applied) : SDR_CHG_ALL;
+    if (changed == 0) return 0;
+
+    uint64_t t0 = mono_ns();
+    int rc;
+    uint64_t pos = 0;
+    if (dev->ops->fill) {
+        pthread_mutex_lock(&dev->lock);
+        rc = dev->ops->apply(dev->impl, cfg, changed);
+        if (rc == 0) dev->sample_rate = cfg->sample_rate;
+        pos = dev->fill_pos;
+        pthread_mutex_unlock(&dev->lock);
+    } else {
+        rc = dev->ops->apply(dev->impl, cfg, changed);
+    }
+    uint64_t t1 = mono_ns();
+
+    if (rc != 0) {
+        // Unknown hardware state: the next apply sends everything
+        dev->applied_valid = false;
+        return -1;
+    }
+    dev->applied = *cfg;
+    dev->applied_valid = true;
+
+    pthread_mutex_lock(&dev->settle_lock);
+    if (!dev->pend_active) {
+        memset(&dev->pend, 0, sizeof(dev->pend));
+        dev->pend_t0_ns = t0;
+        dev->pend_active = true;
+    }
+    dev->pend.changed |= changed;
+    dev->pend.apply_us += (double)(t1 - t0) / 1e3;
+    dev->pend_fs = cfg->sample_rate;
+    dev->valid_t_ns = t1 + (dev->ops->fill ? 0 : settle_ns_of(changed));
+    dev->valid_pos = pos;
+    pthread_mutex_unlock(&dev->settle_lock);
+    return (int)changed;
+}
+
+uint64_t sdr_get_retune(sdr_dev_t *dev, sdr_retune_t *out) {
+    if (!dev) return 0;
+    pthread_mutex_lock(&dev->settle_lock);
+    if (out) *out = dev->last;
+    uint64_t seq = dev->last.seq;
+    pthread_mutex_unlock(&dev->settle_lock);
+    return seq;
+}
+
+int sdr_start(sdr_dev_t *dev, sdr_rx_cb_t cb, void *ctx) {
+    if (!dev || !cb || dev->streaming) return -1;
+    dev->cb = cb;
+    dev->cb_ctx = ctx;
+
+    if (!dev->ops->fill) {
+        if (dev->ops->start(dev->impl, dev) != 0) return -1;
+        dev->streaming = true;
+        return 0;
+    }
+
+    dev->streaming = true;
+    if (pthread_create(&dev->thread, NULL, soft_thread_fn, dev) != 0) {
+        dev->streaming = false;
+        dev->cb = NULL;
+        return -1;
+    }
+    return 0;
+}
+
+int sdr_stop(sdr_dev_t *dev) {
+    if (!dev) return -1;
+    if (!dev->ops->fill) {
+        if (!dev->streaming) return 0;
+        dev->streaming = false;
+        return dev->ops->stop(dev->impl);
+    }
+
+    // The thread may have ended on its own (EOF, callback asked to stop): join either way
+    if (dev->cb) {
+        dev->streaming = false;
+        pthread_join(dev->thread, NULL);
+        dev->cb = NULL;
+    }
+    return 0;
+}
+
+void sdr_close(sdr_dev_t *dev) {
+    if (!dev) return;
+    sdr_stop(dev);
+    dev->ops->close(dev->impl);
+    if (dev->ops->fill) {
+        pthread_mutex_destroy(&dev->lock);
+        free(dev->block);
+    }
+    pthread_mutex_destroy(&dev->settle_lock);
+    free(dev);
+}
+
+sdr_backend_t sdr_backend(const sdr_dev_t *dev) {
+    return dev->backend;
+}
+
+const char* sdr_backend_name(sdr_backend_t backend) {
+    switch (backend) {
+    case SDR_BACKEND_HACKRF: return "hackrf";
+    case SDR_BACKEND_FILE:   return "file";
+    case SDR_BACKEND_SIM:    return "sim";
+    }
+    return "?";
+}
+
+int sdr_backend_parse(const char *s) {
+    if (!s || !*s || strcasecmp(s, "hackrf") == 0) return SDR_BACKEND_HACKRF;
+    if (strcasecmp(s, "file") == 0) return SDR_BACKEND_FILE;
+    if (strcasecmp(s, "sim") == 0) return SDR_BACKEND_SIM;
+    return -1;
+}
+
+sdr_iq_format_t sdr_iq_format_parse(const char *s, const char *path) {
+    if (!s || !*s) {
+        const char *ext = path ? strrchr(path, '.') : NULL;
+        s = ext ? ext + 1 : "int8";
+    }
+    if (strcasecmp(s, "cs16") == 0 || strcasecmp(s, "sc16") == 0) return SDR_IQ_CS16;
+    if (strcasecmp(s, "cf32") == 0 || strcasecmp(s, "cfile") == 0 || strcasecmp(s, "fc32") == 0) return SDR_IQ_CF32;
+    return SDR_IQ_INT8;
+}
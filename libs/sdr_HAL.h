@@ -3,6 +3,7 @@
 #define SDR_HAL_H
 
 #include <stdint.h>
+#include <stddef.h>
 #include <stdbool.h>
 #include <libhackrf/hackrf.h>
 
@@ -19,6 +20,163 @@ typedef struct {
     int ppm_error;
 } SDR_cfg_t;
 
+// Gains used when a config does not carry them (the values hackrf_apply_cfg used to force)
+#define SDR_LNA_GAIN_DEFAULT  28
+#define SDR_VGA_GAIN_DEFAULT  32
+
+/**
+ * @brief Full (non-differential) apply on a bare libhackrf handle. LNA/VGA are
+ * rounded down to the MAX2837 steps (8 dB up to 40, 2 dB up to 62).
+ */
 void hackrf_apply_cfg(hackrf_device* dev, SDR_cfg_t *cfg);
 
-#endif
\ No newline at end of file
+// =========================================================
+// Backends: every source hands the callback interleaved int8 IQ, the HackRF wire
+// format, so rx_callback and everything behind it run unchanged on replayed or
+// synthetic samples.
+typedef enum {
+    SDR_BACKEND_HACKRF = 0,
+    SDR_BACKEND_FILE,           // mmap'd IQ recording
+    SDR_BACKEND_SIM             // synthetic generator
+} sdr_backend_t;
+
+typedef enum {
+    SDR_IQ_INT8 = 0,            // HackRF native (.cs8 / .iq)
+    SDR_IQ_CS16,                // int16 I/Q (.cs16), top byte kept
+    SDR_IQ_CF32                 // float I/Q in [-1, 1) (.cf32 / .cfile)
+} sdr_iq_format_t;
+
+#define SDR_BLOCK_BYTES      262144  // one libhackrf transfer; file/sim deliver the same size
+#define SDR_RESYNC_S         1.0     // paced source this late gives up catching up
+#define SDR_SIM_MAX_SIGNALS  16
+#define SDR_SERIAL_LEN       40      // HackRF serials are 32 hex digits
+
+typedef enum {
+    SDR_SIM_TONE = 0,           // carrier at offset_hz
+    SDR_SIM_FM,                 // carrier FM-modulated by a tone of audio_hz, deviation dev_hz
+    SDR_SIM_NOISE,              // complex white Gaussian noise (level = total power)
+    SDR_SIM_BURST               // carrier keyed on for on_ms out of every period_ms
+} sdr_sim_kind_t;
+
+typedef struct {
+    sdr_sim_kind_t kind;
+    double offset_hz;           // from the tuned center frequency
+    double level_dbfs;          // 0 dBFS = int8 full scale
+    double audio_hz;
+    double dev_hz;
+    double on_ms;
+    double period_ms;
+} sdr_sim_signal_t;
+
+typedef struct {
+    sdr_backend_t backend;
+    bool realtime;              // file/sim: pace at the configured sample rate (false = as fast as possible)
+
+    // SDR_BACKEND_HACKRF
+    const char *serial;         // hackrf_open_by_serial (trailing digits are enough); NULL = first board
+
+    // SDR_BACKEND_FILE
+    const char *path;
+    sdr_iq_format_t format;
+    bool loop;                  // rewind at EOF (false = stop delivering)
+
+    // SDR_BACKEND_SIM
+    sdr_sim_signal_t sim[SDR_SIM_MAX_SIGNALS];
+    int n_sim;
+    uint32_t seed;
+} sdr_open_cfg_t;
+
+/**
+ * @brief Sample callback: len bytes of interleaved int8 IQ. Return non-zero to stop the source.
+ */
+typedef int (*sdr_rx_cb_t)(const uint8_t *buf, size_t len, void *ctx);
+
+// --- Differential apply: what sdr_apply_cfg changed ---
+#define SDR_CHG_FREQ   (1u << 0)    // center_freq or ppm_error
+#define SDR_CHG_RATE   (1u << 1)
+#define SDR_CHG_AMP    (1u << 2)
+#define SDR_CHG_LNA    (1u << 3)
+#define SDR_CHG_VGA    (1u << 4)
+#define SDR_CHG_ALL    (SDR_CHG_FREQ | SDR_CHG_RATE | SDR_CHG_AMP | SDR_CHG_LNA | SDR_CHG_VGA)
+
+// Settling after a HackRF change, counted from the end of the libhackrf call: samples
+// captured earlier are discarded before the callback. Frequency follows hackrf_sweep,
+// which throws away 2 x 16 KiB after each hop (0.8 ms at 20 MS/s); the rest are margins
+// for the Si5351 (rate) and the MAX2837/RF amp (gains). File/sim sources need none: the
+// first block generated after the apply is valid.
+#define SDR_SETTLE_FREQ_US   1000
+#define SDR_SETTLE_RATE_US   10000
+#define SDR_SETTLE_GAIN_US   200
+
+typedef struct {
+    unsigned changed;           // SDR_CHG_* (merged if applies overlap)
+    double apply_us;            // time inside the backend calls
+    double valid_us;            // sdr_apply_cfg entry -> first valid sample handed to the callback
+    uint64_t discarded_samples; // settling samples dropped before it
+    uint64_t seq;               // completed operations since sdr_open
+} sdr_retune_t;
+
+typedef struct sdr_dev sdr_dev_t;
+
+/**
+ * @brief Opens a source. HackRF: hackrf_init (once) + hackrf_open. File: mmap of the
+ * whole recording. Sim: builds the oscillators. NULL on failure.
+ */
+sdr_dev_t* sdr_open(const sdr_open_cfg_t *cfg);
+
+/**
+ * @brief Applies only what differs from the last successful apply (everything the first
+ * time or after an error). Safe while streaming: samples from before the change plus the
+ * settling time never reach the callback. File/sim re-pace on the next block.
+ * @return SDR_CHG_* mask of what was applied (0 = nothing to do), -1 on error.
+ */
+int sdr_apply_cfg(sdr_dev_t *dev, SDR_cfg_t *cfg);
+
+/**
+ * @brief Last completed operation (changed != 0 and the first valid sample delivered).
+ * @return Its seq (0 = none yet).
+ */
+uint64_t sdr_get_retune(sdr_dev_t *dev, sdr_retune_t *out);
+
+/**
+ * @brief Starts delivering blocks to cb. File/sim run their own thread; HackRF uses the libusb one.
+ */
+int sdr_start(sdr_dev_t *dev, sdr_rx_cb_t cb, void *ctx);
+
+int sdr_stop(sdr_dev_t *dev);
+
+/**
+ * @brief Stops if needed and releases the source.
+ */
+void sdr_close(sdr_dev_t *dev);
+
+/**
+ * @brief Serial numbers of the HackRFs on the bus (hackrf_device_list).
+ * @return Entries written (at most max), -1 if libhackrf cannot start.
+ */
+int sdr_hackrf_list(char serials[][SDR_SERIAL_LEN], int max);
+
+sdr_backend_t sdr_backend(const sdr_dev_t *dev);
+const char* sdr_backend_name(sdr_backend_t backend);
+
+/**
+ * @brief "hackrf" | "file" | "sim". -1 if unknown.
+ */
+int sdr_backend_parse(const char *s);
+
+/**
+ * @brief "int8"/"cs8" | "cs16" | "cf32"/"cfile". NULL or unknown -> guessed from the path extension (int8).
+ */
+sdr_iq_format_t sdr_iq_format_parse(const char *s, const char *path);
+
+/**
+ * @brief Parses a comma separated signal list:
+ *   tone:<offset_hz>:<dbfs>
+ *   fm:<offset_hz>:<dbfs>:<audio_hz>:<dev_hz>
+ *   noise:<dbfs>
+ *   burst:<offset_hz>:<dbfs>:<on_ms>:<period_ms>
+ * @return Signals written to out, -1 on a malformed entry.
+ */
+int sdr_sim_parse(const char *spec, sdr_sim_signal_t *out, int max);
+
+#endif
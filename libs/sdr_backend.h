@@ -0,0 +1,57 @@
+//libs/sdr_backend.h
+// Internal to sdr_HAL*.c: what a backend provides and the device handle they share.
+#ifndef SDR_BACKEND_H
+#define SDR_BACKEND_H
+
+#include <pthread.h>
+#include "sdr_HAL.h"
+
+/**
+ * Hardware sources implement start/stop and hand blocks to sdr_HAL.c from their own thread.
+ * Software sources implement fill instead: sdr_HAL.c runs the delivery thread, paces it
+ * with the sample rate from apply and serializes fill against apply.
+ * apply gets the SDR_CHG_* mask sdr_HAL.c computed and touches only those settings.
+ */
+typedef struct {
+    int    (*apply)(void *impl, SDR_cfg_t *cfg, unsigned changed);
+    int    (*start)(void *impl, sdr_dev_t *dev);
+    int    (*stop)(void *impl);
+    size_t (*fill)(void *impl, uint8_t *dst, size_t len);  // int8 IQ bytes written, 0 = end of stream
+    void   (*close)(void *impl);
+} sdr_ops_t;
+
+struct sdr_dev {
+    sdr_backend_t backend;
+    const sdr_ops_t *ops;
+    void *impl;
+
+    sdr_rx_cb_t cb;
+    void *cb_ctx;
+    volatile bool streaming;
+
+    SDR_cfg_t applied;          // last successful apply (main thread)
+    bool applied_valid;
+
+    // Settling: blocks delivered before the change took effect are dropped
+    pthread_mutex_t settle_lock;
+    bool pend_active;
+    sdr_retune_t pend;
+    uint64_t pend_t0_ns;        // sdr_apply_cfg entry
+    uint64_t valid_t_ns;        // hardware: first sample time that counts
+    uint64_t valid_pos;         // software: first stream byte that counts
+    double pend_fs;
+    sdr_retune_t last;
+
+    // Software sources only
+    bool realtime;
+    double sample_rate;         // guarded by lock
+    pthread_mutex_t lock;
+    pthread_t thread;
+    uint8_t *block;
+    uint64_t fill_pos;          // bytes filled so far, guarded by lock
+};
+
+void* sdr_file_open(const sdr_open_cfg_t *cfg, const sdr_ops_t **ops);
+void* sdr_sim_open(const sdr_open_cfg_t *cfg, const sdr_ops_t **ops);
+
+#endif
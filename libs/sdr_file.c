@@ -0,0 +1,160 @@
+//libs/sdr_file.c
+// SDR_BACKEND_FILE: replays an IQ recording from an mmap, converted to int8 IQ.
+#include "sdr_backend.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+typedef struct {
+    const uint8_t *map;
+    size_t map_len;
+    size_t n_samples;           // complete IQ pairs in the file
+    size_t pos;                 // next sample to deliver
+    size_t sample_bytes;        // 2, 4 or 8
+    sdr_iq_format_t format;
+    bool loop;
+    uint64_t loops;
+    double file_s;              // duration at the configured rate (for the log)
+} sdr_file_t;
+
+static size_t sample_bytes_of(sdr_iq_format_t f) {
+    switch (f) {
+    case SDR_IQ_CS16: return 4;
+    case SDR_IQ_CF32: return 8;
+    default:          return 2;
+    }
+}
+
+static const char* format_name(sdr_iq_format_t f) {
+    switch (f) {
+    case SDR_IQ_CS16: return "cs16";
+    case SDR_IQ_CF32: return "cf32";
+    default:          return "int8";
+    }
+}
+
+static inline int8_t f32_to_s8(float v) {
+    long q = lrintf(v * 127.0f);
+    if (q > 127) q = 127;
+    if (q < -128) q = -128;
+    return (int8_t)q;
+}
+
+static void convert(const sdr_file_t *f, int8_t *dst, size_t first, size_t n) {
+    const uint8_t *src = f->map + first * f->sample_bytes;
+    switch (f->format) {
+    case SDR_IQ_INT8:
+        memcpy(dst, src, n * 2);
+        break;
+    case SDR_IQ_CS16: {
+        const int16_t *s = (const int16_t*)src;
+        for (size_t i = 0; i < n * 2; i++) dst[i] = (int8_t)(s[i] >> 8);
+        break;
+    }
+    case SDR_IQ_CF32: {
+        const float *s = (const float*)src;
+        for (size_t i = 0; i < n * 2; i++) dst[i] = f32_to_s8(s[i]);
+        break;
+    }
+    }
+}
+
+static int file_apply(void *impl, SDR_cfg_t *cfg, unsigned changed) {
+    sdr_file_t *f = (sdr_file_t*)impl;
+    if (!(changed & SDR_CHG_RATE)) return 0;
+    if (cfg->sample_rate > 0.0) f->file_s = (double)f->n_samples / cfg->sample_rate;
+    printf("[HAL] file: %.0f Hz, %.1f s per pass (center %lu Hz is nominal)\n",
+           cfg->sample_rate, f->file_s, cfg->center_freq);
+    return 0;
+}
+
+static size_t file_fill(void *impl, uint8_t *dst, size_t len) {
+    sdr_file_t *f = (sdr_file_t*)impl;
+    size_t want = len / 2;
+    size_t done = 0;
+
+    while (done < want) {
+        if (f->pos >= f->n_samples) {
+            if (!f->loop) break;
+            f->pos = 0;
+            f->loops++;
+        }
+        size_t n = f->n_samples - f->pos;
+        if (n > want - done) n = want - done;
+        convert(f, (int8_t*)dst + done * 2, f->pos, n);
+        f->pos += n;
+        done += n;
+    }
+    return done * 2;
+}
+
+static void file_close(void *impl) {
+    sdr_file_t *f = (sdr_file_t*)impl;
+    if (!f) return;
+    if (f->loops) printf("[HAL] file: replayed %lu full passes\n", f->loops);
+    munmap((void*)f->map, f->map_len);
+    free(f);
+}
+
+static const sdr_ops_t file_ops = {
+    .apply = file_apply,
+    .start = NULL,
+    .stop  = NULL,
+    .fill  = file_fill,
+    .close = file_close,
+};
+
+void* sdr_file_open(const sdr_open_cfg_t *cfg, const sdr_ops_t **ops) {
+    if (!cfg->path || !*cfg->path) {
+        fprintf(stderr, "[HAL] file: no path (SDR_FILE)\n");
+        return NULL;
+    }
+
+    int fd = open(cfg->path, O_RDONLY);
+    if (fd < 0) {
+        fprintf(stderr, "[HAL] file: cannot open %s\n", cfg->path);
+        return NULL;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+        fprintf(stderr, "[HAL] file: %s is empty\n", cfg->path);
+        close(fd);
+        return NULL;
+    }
+
+    void *map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        fprintf(stderr, "[HAL] file: mmap of %s failed\n", cfg->path);
+        return NULL;
+    }
+    madvise(map, (size_t)st.st_size, MADV_SEQUENTIAL);
+
+    sdr_file_t *f = (sdr_file_t*)calloc(1, sizeof(sdr_file_t));
+    if (!f) {
+        munmap(map, (size_t)st.st_size);
+        return NULL;
+    }
+    f->map = (const uint8_t*)map;
+    f->map_len = (size_t)st.st_size;
+    f->format = cfg->format;
+    f->sample_bytes = sample_bytes_of(cfg->format);
+    f->n_samples = f->map_len / f->sample_bytes;
+    f->loop = cfg->loop;
+
+    if (f->n_samples == 0) {
+        fprintf(stderr, "[HAL] file: %s holds no complete %s sample\n", cfg->path, format_name(f->format));
+        file_close(f);
+        return NULL;
+    }
+
+    printf("[HAL] file: %s, %s, %zu samples, %s%s\n", cfg->path, format_name(f->format), f->n_samples,
+           cfg->realtime ? "real-time" : "as fast as possible", f->loop ? ", looping" : "");
+    *ops = &file_ops;
+    return f;
+}
@@ -0,0 +1,67 @@
+// libs/shm_ring.h
+#ifndef SHM_RING_H
+#define SHM_RING_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define SHM_RING_MAGIC       0x52465230u  // 'RFR0'
+#define SHM_RING_VERSION     1
+#define SHM_RING_WRAP        0xFFFFFFFFu  // record len: skip to the start of the data area
+#define SHM_RING_REC_HDR     16           // u32 len, u32 reserved, u64 t_ns (CLOCK_MONOTONIC)
+
+// --- Shared layout (little endian, read by shm_reader.py) ---
+// head is written only by the engine, tail only by the reader; each sits on its own
+// cache line. Records are 8-byte aligned; a record that would straddle the end is
+// preceded by a SHM_RING_WRAP marker.
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t capacity;          // data bytes (power of two)
+    uint64_t data_offset;       // from the start of the mapping
+    uint64_t dropped;           // records refused because the reader fell behind
+    uint8_t  pad0[32];
+    volatile uint64_t head;     // bytes produced (monotonic)
+    uint8_t  pad1[56];
+    volatile uint64_t tail;     // bytes consumed (monotonic)
+    uint8_t  pad2[56];
+} shm_ring_hdr_t;
+
+typedef struct {
+    uint64_t records;
+    uint64_t bytes;
+    uint64_t dropped;
+    int reader;                 // 1 while a reader holds the eventfd
+} shm_ring_stats_t;
+
+typedef struct shm_ring shm_ring_t;
+
+/**
+ * @brief Creates (or recreates) the POSIX shm object and the unix socket readers use to
+ * fetch the wakeup eventfd (SCM_RIGHTS).
+ * @param name shm name, e.g. "/rf_audio" (mapped at /dev/shm/rf_audio).
+ * @param capacity Data bytes, rounded up to a power of two.
+ * @param sock_path NULL = "/tmp<name>.sock".
+ */
+shm_ring_t* shm_ring_create(const char *name, size_t capacity, const char *sock_path);
+
+/**
+ * @brief Appends one record made of two parts (header + payload) and signals the eventfd.
+ * Single producer. Never blocks: a full ring drops the record (the reader owns tail).
+ * @return 0 on success, -1 when dropped.
+ */
+int shm_ring_write(shm_ring_t *r, const void *a, size_t na, const void *b, size_t nb);
+
+/**
+ * @brief Accepts a pending reader connection and hands it the eventfd (non-blocking).
+ */
+void shm_ring_poll(shm_ring_t *r);
+
+void shm_ring_get_stats(const shm_ring_t *r, shm_ring_stats_t *out);
+
+/**
+ * @brief Unmaps and unlinks the shm object and the socket.
+ */
+void shm_ring_destroy(shm_ring_t *r);
+
+#endif
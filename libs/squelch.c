@@ -0,0 +1,91 @@
+// libs/squelch.c
+#include "squelch.h"
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <stdio.h>
+#include <math.h>
+
+#define SQ_LEVEL_TAU_S   0.02     // power smoothing
+#define SQ_FLOOR_DOWN_S  0.5      // floor follows quieter stretches quickly...
+#define SQ_FLOOR_UP_S    20.0     // ...and creeps up under long transmissions
+#define SQ_MIN_DB        -150.0f
+
+void squelch_cfg_from_env(squelch_cfg_t *cfg) {
+    memset(cfg, 0, sizeof(*cfg));
+    cfg->hyst_db = SQUELCH_HYST_DB_DEFAULT;
+    cfg->hang_ms = SQUELCH_HANG_MS_DEFAULT;
+
+    const char *env_lvl  = getenv("SQUELCH_DBFS");
+    const char *env_snr  = getenv("SQUELCH_SNR_DB");
+    const char *env_hyst = getenv("SQUELCH_HYST_DB");
+    const char *env_hang = getenv("SQUELCH_HANG_MS");
+
+    if (!env_lvl || !env_lvl[0]) return;
+
+    cfg->enabled = 1;
+    if (strcasecmp(env_lvl, "auto") == 0) {
+        cfg->auto_floor = 1;
+        cfg->open_db = (env_snr && env_snr[0]) ? (float)atof(env_snr) : SQUELCH_SNR_DB_DEFAULT;
+    } else {
+        cfg->open_db = (float)atof(env_lvl);
+    }
+    if (env_hyst && env_hyst[0]) cfg->hyst_db = fabsf((float)atof(env_hyst));
+    if (env_hang && env_hang[0]) cfg->hang_ms = atoi(env_hang);
+    if (cfg->hang_ms < 0) cfg->hang_ms = 0;
+}
+
+void squelch_init(squelch_t *sq, const squelch_cfg_t *cfg, double fs) {
+    memset(sq, 0, sizeof(*sq));
+    if (cfg) sq->cfg = *cfg;
+    sq->fs = fs;
+    sq->level_db = SQ_MIN_DB;
+    sq->floor_db = SQ_MIN_DB;
+}
+
+int squelch_update(squelch_t *sq, const float *iq, size_t n) {
+    if (!sq->cfg.enabled) return 1;
+    if (n == 0 || sq->fs <= 0.0) return sq->open;
+
+    float acc = 0.0f;
+    for (size_t i = 0; i < n; i++) {
+        acc += iq[2*i] * iq[2*i] + iq[2*i + 1] * iq[2*i + 1];
+    }
+    float p = acc / (float)n;
+
+    // Block-size independent time constants
+    double dt = (double)n / sq->fs;
+    if (!sq->have_level) {
+        sq->power = p;
+    } else {
+        sq->power += (float)(1.0 - exp(-dt / SQ_LEVEL_TAU_S)) * (p - sq->power);
+    }
+    sq->level_db = (sq->power > 1e-15f) ? 10.0f * log10f(sq->power) : SQ_MIN_DB;
+
+    float ref = 0.0f;
+    if (sq->cfg.auto_floor) {
+        if (!sq->have_level) {
+            sq->floor_db = sq->level_db;
+        } else {
+            double tau = (sq->level_db < sq->floor_db) ? SQ_FLOOR_DOWN_S : SQ_FLOOR_UP_S;
+            sq->floor_db += (float)(1.0 - exp(-dt / tau)) * (sq->level_db - sq->floor_db);
+        }
+        ref = sq->floor_db;
+    }
+    sq->have_level = 1;
+
+    float open_at  = ref + sq->cfg.open_db;
+    float close_at = open_at - sq->cfg.hyst_db;
+
+    if (sq->level_db >= open_at) {
+        sq->open = 1;
+        sq->hang_left = (long)((double)sq->cfg.hang_ms * 1e-3 * sq->fs);
+    } else if (sq->open && sq->level_db < close_at) {
+        sq->hang_left -= (long)n;
+        if (sq->hang_left <= 0) sq->open = 0;
+    } else if (sq->open) {
+        // Inside the hysteresis band: hold, re-arm the hang
+        sq->hang_left = (long)((double)sq->cfg.hang_ms * 1e-3 * sq->fs);
+    }
+    return sq->open;
+}
@@ -0,0 +1,51 @@
+// libs/squelch.h
+#ifndef SQUELCH_H
+#define SQUELCH_H
+
+#include <stddef.h>
+
+#define SQUELCH_HYST_DB_DEFAULT   3.0f
+#define SQUELCH_HANG_MS_DEFAULT   300
+#define SQUELCH_SNR_DB_DEFAULT    10.0f
+
+// --- Settings (SQUELCH_DBFS, SQUELCH_SNR_DB, SQUELCH_HYST_DB, SQUELCH_HANG_MS) ---
+typedef struct {
+    int enabled;
+    int auto_floor;         // 1 = open_db is an SNR above the tracked noise floor
+    float open_db;          // dBFS (or dB above the floor) that opens the gate
+    float hyst_db;          // gate closes hyst_db below the open level
+    int hang_ms;            // stays open this long after the level drops
+} squelch_cfg_t;
+
+// --- Channel power squelch with hysteresis and hang time ---
+typedef struct {
+    squelch_cfg_t cfg;
+    double fs;
+
+    float power;            // smoothed channel power (linear, full scale = 1)
+    float level_db;
+    float floor_db;         // auto_floor: follows drops fast, rises slowly
+    int have_level;
+
+    int open;
+    long hang_left;         // samples
+} squelch_t;
+
+/**
+ * @brief Parses SQUELCH_DBFS ("auto" or a dBFS level) and the related knobs.
+ * Unset SQUELCH_DBFS leaves the squelch disabled.
+ */
+void squelch_cfg_from_env(squelch_cfg_t *cfg);
+
+/**
+ * @brief Resets the gate (closed) for a channel running at fs.
+ */
+void squelch_init(squelch_t *sq, const squelch_cfg_t *cfg, double fs);
+
+/**
+ * @brief Feeds one block of channel IQ (interleaved float) and updates the gate.
+ * @return 1 while the gate is open (always 1 when disabled).
+ */
+int squelch_update(squelch_t *sq, const float *iq, size_t n);
+
+#endif
@@ -0,0 +1,166 @@
+// libs/trace.c
+#include "trace.h"
+#include "latency.h"
+#include "rt_policy.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+
+typedef struct {
+    uint64_t ts_ns;
+    const char *name;
+    char ph;
+} trace_ev_t;
+
+// One per traced thread. A thread's ring is taken over by the next new thread once it
+// exits; its events are dropped then (first moves past them).
+typedef struct trace_ring {
+    struct trace_ring *next;
+    int in_use;
+    pid_t tid;
+    char name[16];
+    uint64_t first;                     // index of the owner's first event
+    uint64_t head;                      // events written (release)
+    trace_ev_t ev[TRACE_RING_EVENTS];
+} trace_ring_t;
+
+int trace_on = 0;
+static uint64_t t_clear_ns;             // events older than this are not dumped
+
+static trace_ring_t *rings;
+static __thread trace_ring_t *my_ring;
+static pthread_key_t ring_key;
+static pthread_once_t ring_once = PTHREAD_ONCE_INIT;
+static pthread_mutex_t dump_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static void ring_release(void *p) {
+    __atomic_store_n(&((trace_ring_t*)p)->in_use, 0, __ATOMIC_RELEASE);
+}
+
+static void ring_key_init(void) {
+    pthread_key_create(&ring_key, ring_release);
+}
+
+static trace_ring_t* get_ring(void) {
+    pthread_once(&ring_once, ring_key_init);
+
+    trace_ring_t *r = NULL;
+    for (trace_ring_t *it = __atomic_load_n(&rings, __ATOMIC_ACQUIRE); it; it = it->next) {
+        int free_slot = 0;
+        if (__atomic_compare_exchange_n(&it->in_use, &free_slot, 1, false, __ATOMIC_ACQ_REL, __ATOMIC_RELAXED)) {
+            r = it;
+            break;
+        }
+    }
+    if (!r) {
+        r = (trace_ring_t*)calloc(1, sizeof(trace_ring_t));
+        if (!r) return NULL;
+        r->in_use = 1;
+        r->next = __atomic_load_n(&rings, __ATOMIC_RELAXED);
+        while (!__atomic_compare_exchange_n(&rings, &r->next, r, true, __ATOMIC_RELEASE, __ATOMIC_RELAXED)) {}
+    }
+    r->tid = (pid_t)syscall(SYS_gettid);
+    if (pthread_getname_np(pthread_self(), r->name, sizeof(r->name)) != 0) r->name[0] = '\0';
+    __atomic_store_n(&r->first, __atomic_load_n(&r->head, __ATOMIC_RELAXED), __ATOMIC_RELEASE);
+    pthread_setspecific(ring_key, r);
+    my_ring = r;
+    return r;
+}
+
+void trace_event(const char *name, char ph) {
+    trace_ring_t *r = my_ring ? my_ring : get_ring();
+    if (!r) return;
+    uint64_t h = r->head;
+    trace_ev_t *e = &r->ev[h & (TRACE_RING_EVENTS - 1)];
+    e->ts_ns = lat_now_ns();
+    e->name = name;
+    e->ph = ph;
+    __atomic_store_n(&r->head, h + 1, __ATOMIC_RELEASE);
+}
+
+void trace_enable(bool on, bool clear) {
+    if (clear) __atomic_store_n(&t_clear_ns, lat_now_ns(), __ATOMIC_RELAXED);
+    __atomic_store_n(&trace_on, on ? 1 : 0, __ATOMIC_RELAXED);
+}
+
+bool trace_enabled(void) {
+    return __atomic_load_n(&trace_on, __ATOMIC_RELAXED) != 0;
+}
+
+/** RT_POLICY label of tid, else the thread name seen when its ring was created */
+static const char* ring_label(const trace_ring_t *r, const rt_placement_t *th, int n_th) {
+    for (int i = 0; i < n_th; i++) if (th[i].tid == r->tid) return th[i].label;
+    return r->name;
+}
+
+/** Copies the live part of r into out; events the owner may have overwritten meanwhile are cut */
+static size_t ring_copy(const trace_ring_t *r, trace_ev_t *out) {
+    uint64_t h1 = __atomic_load_n(&r->head, __ATOMIC_ACQUIRE);
+    uint64_t first = __atomic_load_n(&r->first, __ATOMIC_ACQUIRE);
+    uint64_t start = h1 > TRACE_RING_EVENTS ? h1 - TRACE_RING_EVENTS : 0;
+    if (start < first) start = first;
+    for (uint64_t i = start; i < h1; i++) out[i - start] = r->ev[i & (TRACE_RING_EVENTS - 1)];
+
+    // The owner may be writing slot h2 (= slot h2 - CAP) right now
+    uint64_t h2 = __atomic_load_n(&r->head, __ATOMIC_ACQUIRE);
+    uint64_t safe = h2 >= TRACE_RING_EVENTS ? h2 - TRACE_RING_EVENTS + 1 : 0;
+    if (safe <= start) return (size_t)(h1 - start);
+    if (safe >= h1) return 0;
+    memmove(out, out + (safe - start), (size_t)(h1 - safe) * sizeof(trace_ev_t));
+    return (size_t)(h1 - safe);
+}
+
+long trace_dump(const char *path) {
+    if (!path || !path[0]) return -1;
+    trace_ev_t *buf = (trace_ev_t*)malloc(sizeof(trace_ev_t) * TRACE_RING_EVENTS);
+    if (!buf) return -1;
+    FILE *f = fopen(path, "w");
+    if (!f) {
+        free(buf);
+        return -1;
+    }
+
+    pthread_mutex_lock(&dump_lock);
+    rt_placement_t th[RT_MAX_THREADS];
+    int n_th = rt_policy_threads(th, RT_MAX_THREADS);
+    uint64_t t_clear = __atomic_load_n(&t_clear_ns, __ATOMIC_RELAXED);
+    int pid = (int)getpid();
+    long n_out = 0;
+
+    fprintf(f, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+    fprintf(f, "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":%d,\"tid\":0,\"args\":{\"name\":\"rf_engine\"}}", pid);
+    for (trace_ring_t *r = __atomic_load_n(&rings, __ATOMIC_ACQUIRE); r; r = r->next) {
+        size_t n = ring_copy(r, buf);
+        const char *label = ring_label(r, th, n_th);
+        fprintf(f, ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%d,\"tid\":%d,\"args\":{\"name\":\"%s\"}}",
+                pid, (int)r->tid, label[0] ? label : "?");
+
+        // An end whose begin was overwritten (or cleared) would close nothing: skip it
+        int depth = 0;
+        for (size_t i = 0; i < n; i++) {
+            const trace_ev_t *e = &buf[i];
+            if (e->ts_ns < t_clear) continue;
+            if (e->ph == 'E') {
+                if (depth == 0) continue;
+                depth--;
+            } else if (e->ph == 'B') {
+                depth++;
+            }
+            fprintf(f, ",\n{\"name\":\"%s\",\"ph\":\"%c\",\"ts\":%.3f,\"pid\":%d,\"tid\":%d%s}",
+                    e->name, e->ph, 1e-3 * (double)e->ts_ns, pid, (int)r->tid,
+                    e->ph == 'i' ? ",\"s\":\"t\"" : "");
+            n_out++;
+        }
+    }
+    fprintf(f, "\n]}\n");
+    pthread_mutex_unlock(&dump_lock);
+
+    int err = ferror(f);
+    if (fclose(f) != 0) err = 1;
+    free(buf);
+    return err ? -1 : n_out;
+}
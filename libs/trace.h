@@ -0,0 +1,53 @@
+// libs/trace.h
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+// --- Trace spans: per-thread rings of begin/end events, Chrome / Perfetto JSON export ---
+//
+// trace_begin / trace_end around a stage record a CLOCK_MONOTONIC stamp into the calling
+// thread's ring (created on its first event, TRACE_RING_EVENTS long, oldest overwritten).
+// Only the owner writes a ring; the dump copies it while it runs. Disabled (the default),
+// a span costs one relaxed load and a predicted branch.
+//
+// Names must be string literals (or otherwise outlive the dump): only the pointer is stored.
+// The dump is the JSON Object Format of chrome://tracing, also opened by ui.perfetto.dev.
+
+#define TRACE_RING_EVENTS   16384       // per thread, power of two (~384 KiB)
+
+extern int trace_on;
+
+void trace_event(const char *name, char ph);
+
+static inline void trace_begin(const char *name) {
+    if (__builtin_expect(__atomic_load_n(&trace_on, __ATOMIC_RELAXED), 0)) trace_event(name, 'B');
+}
+
+static inline void trace_end(const char *name) {
+    if (__builtin_expect(__atomic_load_n(&trace_on, __ATOMIC_RELAXED), 0)) trace_event(name, 'E');
+}
+
+/** Zero-length marker (a burst, a retune). */
+static inline void trace_instant(const char *name) {
+    if (__builtin_expect(__atomic_load_n(&trace_on, __ATOMIC_RELAXED), 0)) trace_event(name, 'i');
+}
+
+/**
+ * @brief Starts / stops recording. Starting with clear = true forgets earlier events.
+ */
+void trace_enable(bool on, bool clear);
+
+bool trace_enabled(void);
+
+/**
+ * @brief Writes every ring as {"traceEvents":[...]} to path (threads named after their
+ * RT_POLICY label when they have one). Recording goes on; events overwritten during the
+ * copy are left out.
+ * @return Number of events written, -1 if the file cannot be written.
+ */
+long trace_dump(const char *path);
+
+#endif
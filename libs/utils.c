@@ -41,4 +41,27 @@ char *getenv_c(const char *key) {
     free(search_prefix);
     fclose(file);
     return NULL;
-}
\ No newline at end of file
+}
+
+int parse_cpu_list(const char *s, cpu_set_t *cpus) {
+    CPU_ZERO(cpus);
+    int n = 0;
+    while (s && *s) {
+        char *end;
+        long a = strtol(s, &end, 10);
+        if (end == s || a < 0) return -1;
+        long b = a;
+        if (*end == '-') {
+            s = end + 1;
+            b = strtol(s, &end, 10);
+            if (end == s || b < a) return -1;
+        }
+        for (long c = a; c <= b && c < CPU_SETSIZE; c++) {
+            CPU_SET((int)c, cpus);
+            n++;
+        }
+        s = (*end == ',') ? end + 1 : end;
+        if (*end && *end != ',') return -1;
+    }
+    return n;
+}
@@ -5,6 +5,7 @@
 #include <stdlib.h>
 #include <stdbool.h>
 #include <string.h>
+#include <sched.h>
 
 /**
  * @brief Reads a specific key from a local .env file.
@@ -14,4 +15,10 @@
  */
 char *getenv_c(const char *key);
 
+/**
+ * @brief Parses a CPU list like "0-3,6" (taskset -c syntax).
+ * @return Number of CPUs set in cpus, -1 on a malformed list.
+ */
+int parse_cpu_list(const char *s, cpu_set_t *cpus);
+
 #endif
\ No newline at end of file
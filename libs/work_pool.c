@@ -0,0 +1,287 @@
+// libs/work_pool.c
+#include "work_pool.h"
+#include "rt_policy.h"
+#include "trace.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+typedef struct {
+    wp_task_fn fn;
+    void *arg;
+    wp_group_t *g;
+} wp_task_t;
+
+// Ring deque: the owner works at the bottom (newest), thieves take from the top (oldest)
+typedef struct {
+    wp_task_t buf[WP_DEQUE_CAP];
+    unsigned top, bottom;
+} wp_deque_t;
+
+typedef struct {
+    pthread_t thread;
+    int id;
+    pthread_mutex_t lock;               // both deques
+    wp_deque_t dq[WP_PRIO_LEVELS];
+    wp_worker_stats_t st;               // written by the worker only
+} wp_worker_t;
+
+static struct {
+    volatile bool running;
+    int n;
+    wp_worker_t *w;
+    pthread_mutex_t lock;               // sleeping workers
+    pthread_cond_t wake;
+    int sleeping;
+    int queued;                         // tasks sitting in any deque
+    unsigned rr;                        // next deque for submits from outside the pool
+    uint64_t t0;
+    uint64_t submitted[WP_PRIO_LEVELS];
+    uint64_t helped;
+    uint64_t inline_runs;
+} pool = { .lock = PTHREAD_MUTEX_INITIALIZER, .wake = PTHREAD_COND_INITIALIZER };
+
+static __thread int tls_worker = -1;   // index of the calling worker, -1 outside the pool
+
+static uint64_t mono_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static bool dq_push(wp_worker_t *w, wp_prio_t prio, const wp_task_t *t) {
+    wp_deque_t *d = &w->dq[prio];
+    pthread_mutex_lock(&w->lock);
+    bool ok = d->bottom - d->top < WP_DEQUE_CAP;
+    if (ok) d->buf[d->bottom++ % WP_DEQUE_CAP] = *t;
+    pthread_mutex_unlock(&w->lock);
+    if (ok) __atomic_add_fetch(&pool.queued, 1, __ATOMIC_RELEASE);
+    return ok;
+}
+
+static bool dq_pop(wp_worker_t *w, wp_prio_t prio, bool oldest, wp_task_t *out) {
+    wp_deque_t *d = &w->dq[prio];
+    pthread_mutex_lock(&w->lock);
+    bool ok = d->bottom != d->top;
+    if (ok) *out = oldest ? d->buf[d->top++ % WP_DEQUE_CAP] : d->buf[--d->bottom % WP_DEQUE_CAP];
+    pthread_mutex_unlock(&w->lock);
+    if (ok) __atomic_sub_fetch(&pool.queued, 1, __ATOMIC_RELEASE);
+    return ok;
+}
+
+/** Most urgent task first: own deque, then the other workers', one priority level at a time */
+static bool take_task(int self, wp_prio_t max_prio, wp_task_t *out, bool *stolen) {
+    if (__atomic_load_n(&pool.queued, __ATOMIC_ACQUIRE) == 0) return false;
+    for (int p = 0; p <= (int)max_prio; p++) {
+        if (self >= 0 && dq_pop(&pool.w[self], (wp_prio_t)p, false, out)) {
+            *stolen = false;
+            return true;
+        }
+        int start = self >= 0 ? self + 1 : 0;
+        for (int k = 0; k < pool.n; k++) {
+            int v = (start + k) % pool.n;
+            if (v == self) continue;
+            if (dq_pop(&pool.w[v], (wp_prio_t)p, true, out)) {
+                *stolen = true;
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+static void run_task(const wp_task_t *t) {
+    trace_begin("pool_task");
+    t->fn(t->arg);
+    trace_end("pool_task");
+    if (!t->g) return;
+    pthread_mutex_lock(&t->g->lock);
+    if (--t->g->pending == 0) pthread_cond_broadcast(&t->g->done);
+    pthread_mutex_unlock(&t->g->lock);
+}
+
+/** Runs one task on behalf of the caller (worker or waiting submitter). */
+static bool run_one(int self, wp_prio_t max_prio) {
+    wp_task_t t;
+    bool stolen = false;
+    if (!take_task(self, max_prio, &t, &stolen)) return false;
+
+    uint64_t t0 = mono_ns();
+    run_task(&t);
+    if (self >= 0) {
+        wp_worker_stats_t *st = &pool.w[self].st;
+        __atomic_store_n(&st->busy_ns, st->busy_ns + (mono_ns() - t0), __ATOMIC_RELAXED);
+        __atomic_store_n(&st->tasks, st->tasks + 1, __ATOMIC_RELAXED);
+        if (stolen) __atomic_store_n(&st->steals, st->steals + 1, __ATOMIC_RELAXED);
+    } else {
+        __atomic_add_fetch(&pool.helped, 1, __ATOMIC_RELAXED);
+    }
+    return true;
+}
+
+static void* worker_fn(void *arg) {
+    wp_worker_t *w = (wp_worker_t*)arg;
+    tls_worker = w->id;
+
+    char label[RT_LABEL_LEN];
+    snprintf(label, sizeof(label), "pool/%d", w->id);
+    pthread_setname_np(pthread_self(), label);
+    rt_policy_apply("pool", label);
+
+    // Drains what is queued before leaving, so stop never strands a waiting group
+    while (pool.running || __atomic_load_n(&pool.queued, __ATOMIC_ACQUIRE) > 0) {
+        if (run_one(w->id, (wp_prio_t)(WP_PRIO_LEVELS - 1))) continue;
+
+        pthread_mutex_lock(&pool.lock);
+        if (pool.running && __atomic_load_n(&pool.queued, __ATOMIC_ACQUIRE) == 0) {
+            pool.sleeping++;
+            pthread_cond_wait(&pool.wake, &pool.lock);
+            pool.sleeping--;
+        }
+        pthread_mutex_unlock(&pool.lock);
+    }
+    return NULL;
+}
+
+int work_pool_start(int n_workers) {
+    if (pool.running) return 0;
+    if (n_workers <= 0) {
+        long ncpu = sysconf(_SC_NPROCESSORS_ONLN);
+        n_workers = ncpu > 0 ? (int)ncpu : 1;
+    }
+    if (n_workers > WP_MAX_WORKERS) n_workers = WP_MAX_WORKERS;
+
+    pool.w = (wp_worker_t*)calloc((size_t)n_workers, sizeof(wp_worker_t));
+    if (!pool.w) return -1;
+    pool.queued = 0;
+    pool.t0 = mono_ns();
+    pool.running = true;
+
+    int started = 0;
+    for (int i = 0; i < n_workers; i++) {
+        pool.w[i].id = i;
+        pthread_mutex_init(&pool.w[i].lock, NULL);
+    }
+    pool.n = n_workers;         // visible to submitters only once every deque lock exists
+    for (int i = 0; i < n_workers; i++) {
+        if (pthread_create(&pool.w[i].thread, NULL, worker_fn, &pool.w[i]) != 0) break;
+        started++;
+    }
+    if (started == 0) {
+        fprintf(stderr, "[POOL] ERROR: no worker could be started\n");
+        pool.running = false;
+        pool.n = 0;
+        for (int i = 0; i < n_workers; i++) pthread_mutex_destroy(&pool.w[i].lock);
+        free(pool.w);
+        pool.w = NULL;
+        return -1;
+    }
+    // Deques of workers that failed to start are still stolen from, so nothing is lost
+    printf("[POOL] %d worker%s\n", started, started == 1 ? "" : "s");
+    return 0;
+}
+
+void work_pool_stop(void) {
+    if (!pool.running) return;
+    pthread_mutex_lock(&pool.lock);
+    pool.running = false;
+    pthread_cond_broadcast(&pool.wake);
+    pthread_mutex_unlock(&pool.lock);
+
+    int n = pool.n;
+    for (int i = 0; i < n; i++) {
+        if (pool.w[i].thread) pthread_join(pool.w[i].thread, NULL);
+    }
+    pool.n = 0;
+    for (int i = 0; i < n; i++) pthread_mutex_destroy(&pool.w[i].lock);
+    free(pool.w);
+    pool.w = NULL;
+}
+
+int work_pool_size(void) {
+    return pool.running ? pool.n : 0;
+}
+
+void wp_group_init(wp_group_t *g) {
+    g->pending = 0;
+    g->prio = (wp_prio_t)(WP_PRIO_LEVELS - 1);
+    pthread_mutex_init(&g->lock, NULL);
+    pthread_cond_init(&g->done, NULL);
+}
+
+void wp_group_destroy(wp_group_t *g) {
+    pthread_cond_destroy(&g->done);
+    pthread_mutex_destroy(&g->lock);
+}
+
+void work_pool_submit(wp_group_t *g, wp_prio_t prio, wp_task_fn fn, void *arg) {
+    if (!fn) return;
+    if ((unsigned)prio >= WP_PRIO_LEVELS) prio = WP_PRIO_NORMAL;
+    wp_task_t t = { fn, arg, g };
+
+    if (g) {
+        pthread_mutex_lock(&g->lock);
+        g->pending++;
+        if (prio < g->prio) g->prio = prio;
+        pthread_mutex_unlock(&g->lock);
+    }
+    __atomic_add_fetch(&pool.submitted[prio], 1, __ATOMIC_RELAXED);
+
+    int n = work_pool_size();
+    if (n > 0) {
+        int self = tls_worker;
+        int target = self >= 0 ? self : (int)(__atomic_fetch_add(&pool.rr, 1, __ATOMIC_RELAXED) % (unsigned)n);
+        if (dq_push(&pool.w[target], prio, &t)) {
+            pthread_mutex_lock(&pool.lock);
+            if (pool.sleeping > 0) pthread_cond_signal(&pool.wake);
+            pthread_mutex_unlock(&pool.lock);
+            return;
+        }
+    }
+    __atomic_add_fetch(&pool.inline_runs, 1, __ATOMIC_RELAXED);
+    run_task(&t);
+}
+
+void wp_group_wait(wp_group_t *g) {
+    if (!g) return;
+    int self = tls_worker;
+    for (;;) {
+        pthread_mutex_lock(&g->lock);
+        if (g->pending == 0) {
+            g->prio = (wp_prio_t)(WP_PRIO_LEVELS - 1);
+            pthread_mutex_unlock(&g->lock);
+            return;
+        }
+        wp_prio_t prio = g->prio;
+        pthread_mutex_unlock(&g->lock);
+
+        if (pool.w && run_one(self, prio)) continue;
+
+        // Nothing we may run is queued: the rest of the group is running on workers
+        pthread_mutex_lock(&g->lock);
+        if (g->pending > 0) pthread_cond_wait(&g->done, &g->lock);
+        pthread_mutex_unlock(&g->lock);
+    }
+}
+
+void work_pool_get_stats(wp_stats_t *out) {
+    memset(out, 0, sizeof(*out));
+    int n = work_pool_size();
+    out->workers = n;
+    if (n > 0) out->uptime_ns = mono_ns() - pool.t0;
+    for (int p = 0; p < WP_PRIO_LEVELS; p++) out->submitted[p] = __atomic_load_n(&pool.submitted[p], __ATOMIC_RELAXED);
+    out->helped = __atomic_load_n(&pool.helped, __ATOMIC_RELAXED);
+    out->inline_runs = __atomic_load_n(&pool.inline_runs, __ATOMIC_RELAXED);
+    for (int i = 0; i < n; i++) {
+        wp_worker_stats_t *s = &pool.w[i].st;
+        out->worker[i].tasks = __atomic_load_n(&s->tasks, __ATOMIC_RELAXED);
+        out->worker[i].steals = __atomic_load_n(&s->steals, __ATOMIC_RELAXED);
+        out->worker[i].busy_ns = __atomic_load_n(&s->busy_ns, __ATOMIC_RELAXED);
+        out->tasks += out->worker[i].tasks;
+        out->steals += out->worker[i].steals;
+        out->busy_ns += out->worker[i].busy_ns;
+    }
+}
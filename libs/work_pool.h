@@ -0,0 +1,92 @@
+// libs/work_pool.h
+#ifndef WORK_POOL_H
+#define WORK_POOL_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <pthread.h>
+
+// --- Process-wide work-stealing pool for DSP tasks ---
+//
+// One pool per process (work_pool_start in main, WORK_POOL_THREADS, default = core count).
+// Each worker owns one deque per priority: it pops its own newest task first and, when
+// empty, steals the oldest task of another worker. Every HIGH deque is drained before
+// any NORMAL one, so channel audio never queues behind a PSD frame.
+//
+// Fork-join: tasks are submitted into a wp_group_t and the submitter waits on the group.
+// A waiting caller runs queued tasks of its group's priority or higher instead of
+// sleeping, so a wait never deadlocks (also from inside a task) and a HIGH waiter never
+// ends up inside a NORMAL task. Without a pool everything runs inline on the caller.
+
+#define WP_MAX_WORKERS   32
+#define WP_DEQUE_CAP     256            // per worker and priority; a full deque runs the task inline
+
+typedef enum {
+    WP_PRIO_HIGH = 0,                   // audio deadline: channel demod + Opus encode
+    WP_PRIO_NORMAL,                     // PSD (Welch segments), post-processing
+    WP_PRIO_LEVELS
+} wp_prio_t;
+
+typedef void (*wp_task_fn)(void *arg);
+
+typedef struct {
+    int pending;                        // submitted and not finished
+    wp_prio_t prio;                     // most urgent priority submitted into the group
+    pthread_mutex_t lock;
+    pthread_cond_t done;
+} wp_group_t;
+
+typedef struct {
+    uint64_t tasks;                     // executed by this worker
+    uint64_t steals;                    // ... taken from another worker's deque
+    uint64_t busy_ns;                   // time inside tasks
+} wp_worker_stats_t;
+
+typedef struct {
+    int workers;                        // 0 = no pool
+    uint64_t uptime_ns;
+    uint64_t submitted[WP_PRIO_LEVELS];
+    uint64_t tasks;                     // sum over workers
+    uint64_t steals;
+    uint64_t busy_ns;
+    uint64_t helped;                    // run by a waiting caller
+    uint64_t inline_runs;               // run at submit: no pool or deque full
+    wp_worker_stats_t worker[WP_MAX_WORKERS];
+} wp_stats_t;
+
+/**
+ * @brief Starts the process-wide pool. n_workers <= 0 = one per online CPU.
+ * Workers apply the RT_POLICY role "pool" (labels pool/0, pool/1, ...).
+ * @return 0 on success (or already started), -1 on error.
+ */
+int work_pool_start(int n_workers);
+
+/**
+ * @brief Runs what is queued, then joins the workers. Submit falls back to inline afterwards.
+ */
+void work_pool_stop(void);
+
+/**
+ * @return Number of workers, 0 if the pool is not running (callers may skip splitting work).
+ */
+int work_pool_size(void);
+
+void wp_group_init(wp_group_t *g);
+void wp_group_destroy(wp_group_t *g);
+
+/**
+ * @brief Queues fn(arg) in group g. Runs it on the caller if there is no pool or the deque is full.
+ */
+void work_pool_submit(wp_group_t *g, wp_prio_t prio, wp_task_fn fn, void *arg);
+
+/**
+ * @brief Returns once every task submitted into g has finished; helps while waiting.
+ */
+void wp_group_wait(wp_group_t *g);
+
+/**
+ * @brief Cumulative counters (utilization = busy_ns delta / (uptime delta * workers)).
+ */
+void work_pool_get_stats(wp_stats_t *out);
+
+#endif
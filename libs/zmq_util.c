@@ -1,5 +1,6 @@
 
 #include "zmq_util.h"
+#include "rt_policy.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -50,6 +51,7 @@ static int internal_connect(zpair_t *pair) {
 
 static void* listener_thread(void *arg) {
     zpair_t *pair = (zpair_t*)arg;
+    rt_policy_apply("zmq", NULL);
     
     printf("[C-PAIR] Listener thread started (Watchdog: %.1fs).\n", WATCHDOG_TIMEOUT);
 
@@ -81,8 +83,10 @@ static void* listener_thread(void *arg) {
                     fprintf(stderr, "[C-PAIR] ⚠️  Watchdog Triggered (%.1fs silence). Reconnecting...\n", (now - last_msg_time));
                 }
                 
-                // Force Reconnection
+                // Force Reconnection (senders must not see a closed socket)
+                pthread_mutex_lock(&pair->send_lock);
                 internal_connect(pair);
+                pthread_mutex_unlock(&pair->send_lock);
                 
                 // Reset timer so we don't spam reconnections instantly
                 last_msg_time = get_time_sec();
@@ -105,6 +109,7 @@ zpair_t* zpair_init(const char *ipc_addr, msg_callback_t cb, int verbose) {
     pair->context = zmq_ctx_new();
     pair->callback = cb;
     pair->verbose = verbose;
+    pthread_mutex_init(&pair->send_lock, NULL);
 
     // Initial Connection
     if (internal_connect(pair) != 0) {
@@ -125,7 +130,9 @@ int zpair_send(zpair_t *pair, const char *json_payload) {
 
     int len = strlen(json_payload);
     // Use DONTWAIT so we don't hang main thread if socket is rebuilding
+    pthread_mutex_lock(&pair->send_lock);
     int bytes_sent = zmq_send(pair->socket, json_payload, len, ZMQ_DONTWAIT);
+    pthread_mutex_unlock(&pair->send_lock);
 
     if (pair->verbose && bytes_sent > 0) {
         printf("[C-PAIR] >> SENT to Py\n");
@@ -142,6 +149,7 @@ void zpair_close(zpair_t *pair) {
         if (pair->socket) zmq_close(pair->socket);
         if (pair->context) zmq_ctx_term(pair->context);
         if (pair->addr) free(pair->addr);
+        pthread_mutex_destroy(&pair->send_lock);
         
         free(pair);
         printf("[C-PAIR] Closed.\n");
@@ -15,6 +15,7 @@ typedef struct {
     char *addr;           // Stored address for reconnection
     char buffer[ZBUF_SIZE];
     pthread_t thread_id;
+    pthread_mutex_t send_lock; // PSD (main), acks (listener) and latency (audio) all send
     msg_callback_t callback;
     int running;
     int verbose;
@@ -0,0 +1,61 @@
+#!/usr/bin/env bash
+set -euo pipefail
+
+# =========================================================
+# Configuración general
+# =========================================================
+OUT="rf_load"            # generador de carga extremo a extremo (PAIR -> rf_engine)
+LIBDIR="./libs"
+BENCHDIR="./bench"
+
+# Con LOAD_ENGINE=1 el script arranca ./rf_engine con fuente simulada (SDR_BACKEND=sim)
+# y lo detiene al terminar; si no, el motor debe estar corriendo aparte.
+LOAD_ENGINE="${LOAD_ENGINE:-0}"
+LOAD_SIM_SIGNALS="${LOAD_SIM_SIGNALS:-fm:250000:-20:1000:3000,noise:-40}"
+
+# =========================================================
+# Flags de compilación (mismos que build.sh)
+# =========================================================
+CFLAGS=(
+  -O2
+  -Wall
+  -Wextra
+  -std=gnu11
+  -D_GNU_SOURCE
+  -I"$LIBDIR"
+)
+
+SRCS=(
+  "$BENCHDIR/rf_load.c"    # comandos al ritmo pedido + latencia comando -> primer frame PSD válido
+)
+
+LIBS=(
+  -lzmq
+  -lcjson
+  -lm
+)
+
+# =========================================================
+# Build + run
+# =========================================================
+echo "[LOAD] Compilando $OUT ..."
+gcc "${CFLAGS[@]}" "${SRCS[@]}" -o "$OUT" "${LIBS[@]}"
+echo "[LOAD] OK → ./$OUT"
+
+# El resumen JSON (--json) va etiquetado con BENCH_REV, como bench.sh
+export BENCH_REV="${BENCH_REV:-$(git rev-parse --short HEAD 2>/dev/null || echo unknown)}"
+
+if [[ "${1:-}" == "--build-only" ]]; then
+  exit 0
+fi
+
+ENGINE_PID=""
+if [[ "$LOAD_ENGINE" == "1" ]]; then
+  SDR_BACKEND=sim SDR_SIM_SIGNALS="$LOAD_SIM_SIGNALS" ./rf_engine > rf_load_engine.log 2>&1 &
+  ENGINE_PID=$!
+  trap '[[ -n "$ENGINE_PID" ]] && kill "$ENGINE_PID" 2>/dev/null || true' EXIT
+  echo "[LOAD] rf_engine (sim) PID $ENGINE_PID, log en rf_load_engine.log"
+fi
+
+# Código de salida: 0 dentro de presupuesto, 1 presupuesto excedido, 2 error de arranque
+./"$OUT" "$@"
@@ -22,8 +22,9 @@
 #include <complex.h>
 #include <sys/time.h>
 #include <errno.h>
+#include <time.h>
+#include <sched.h>
 
-#include <libhackrf/hackrf.h>
 #include <cjson/cJSON.h>
 
 // Project Includes
@@ -34,6 +35,18 @@
 #include "zmq_util.h"
 #include "utils.h"
 #include "fm_radio.h"
+#include "ddc.h"
+#include "demod.h"
+#include "chan_bank.h"
+#include "squelch.h"
+#include "shm_ring.h"
+#include "latency.h"
+#include "iq_recorder.h"
+#include "dataflow.h"
+#include "rt_policy.h"
+#include "work_pool.h"
+#include "metrics.h"
+#include "trace.h"
 
 // NEW: Opus TX (TCP framing matches your Python gateway: !IIIHH, magic 'OPU0')
 #include "opus_tx.h"
@@ -47,41 +60,147 @@
 // ========================= Opus streaming defaults (to Python gateway)
 #define AUDIO_TCP_DEFAULT_HOST "127.0.0.1"
 #define AUDIO_TCP_DEFAULT_PORT 9000
+#define AUDIO_RTP_DEFAULT_PORT 5004  // AUDIO_TRANSPORT=rtp: RFC 7587 over UDP, no gateway hop
+#define AUDIO_SHM_DEFAULT_NAME "/rf_audio"  // AUDIO_TRANSPORT=shm: OPU0 records in /dev/shm
+
+// PSD_TRANSPORT=shm: publish_results JSON goes to a shm ring, commands/acks stay on PAIR
+#define PSD_SHM_DEFAULT_NAME   "/rf_psd"
+#define PSD_SHM_BYTES          (8 * 1024 * 1024)
 
 #define OPUS_FRAME_MS_DEFAULT  20
 #define OPUS_BITRATE_DEFAULT   32000
 #define OPUS_COMPLEXITY_DEFAULT 5
 #define OPUS_VBR_DEFAULT       0    // 0 = CBR, 1 = VBR
+#define OPUS_DTX_DEFAULT       0    // 1 = skip frames the encoder flags as silence
 
-// =========================================================
-// GLOBALS
-zpair_t *zmq_channel = NULL;
-hackrf_device* device = NULL;
+#define AUDIO_CPU_REPORT_S     10   // audio thread CPU report period (seconds of audio)
 
-// Two ring buffers:
-//   rb         = large buffer used for acquisition/full-PSD (main thread reads)
-//   audio_rb   = small buffer used only by audio thread (audio thread reads)
-ring_buffer_t rb;
-ring_buffer_t audio_rb;
+// AUDIO_LOW_LATENCY=1: blocks follow what audio_rb holds instead of a fixed AUDIO_CHUNK_SAMPLES
+#define LL_FRAME_MS_DEFAULT    5    // Opus frame unless OPUS_FRAME_MS is set
+#define LL_TARGET_MS_DEFAULT   30   // AUDIO_LATENCY_TARGET_MS: capture -> dequeue budget
+#define LL_DUTY_HIGH           0.5  // per-block overhead too high: grow the block
+#define LL_DUTY_LOW            0.2  // headroom: shrink toward LL_BLOCKS_PER_FRAME
+#define LL_BLOCKS_PER_FRAME    4    // smallest block: a quarter of an Opus frame of input
 
-volatile bool config_received = false;
+// SDR_BACKEND=sim without SDR_SIM_SIGNALS: NFM voice channel, WFM station, a carrier,
+// a 10% duty burst and a noise floor, all inside the default 2 MHz span
+#define SDR_SIM_DEFAULT_SIGNALS "fm:-250000:-25:1000:5000,fm:400000:-15:800:75000," \
+                                "tone:150000:-30,burst:-600000:-20:100:1000,noise:-45"
+#define SDR_OPEN_RETRY_S       5
 
-DesiredCfg_t desired_config = {0};
-PsdConfig_t psd_cfg = {0};
-SDR_cfg_t hack_cfg = {0};
-RB_cfg_t rb_cfg = {0};
+#define REC_DEFAULT_DIR        "."  // REC_DIR: where record_start without an absolute path writes
 
-// Audio thread control
-pthread_t audio_thread;
-volatile bool audio_thread_running = false;
+// RF_DEVICES: one pipeline per SDR. Device N > 0 streams audio on the device 0 ports
+// + N * RF_DEV_PORT_STEP and suffixes its shm names with "_dev<N>".
+#define RF_MAX_DEVICES         8
+#define RF_DEV_PORT_STEP       100
+#define RF_THROUGHPUT_REPORT_S 10
+#define RT_REPORT_DELAY_S      3    // startup placement report (RT_POLICY)
+#define TRACE_DEFAULT_FILE     "/tmp/rf_engine_trace.json"  // TRACE_FILE: trace_dump / exit dump
 
-// Track whether RX is currently running and last applied config
-static bool rx_running = false;
-static SDR_cfg_t last_applied_cfg;
-static bool last_cfg_valid = false;
+// =========================================================
+// GLOBALS
+zpair_t *zmq_channel = NULL;
+static char *trace_file = NULL;     // TRACE_FILE, default TRACE_DEFAULT_FILE
+static volatile sig_atomic_t stop_requested = 0;
+static sdr_open_cfg_t sdr_source;  // SDR_BACKEND: hackrf (default) | file | sim; each device copies it
+
+typedef struct audio_stream_ctx audio_stream_ctx_t;
+
+// Full-band PSD frame buffers for one configuration, all carved from one arena: the
+// steady-state loop (same config, frame after frame) makes no heap allocation.
+typedef struct {
+    arena_t arena;
+    bool ready;
+    size_t total_bytes;             // key: capture size + PSD parameters
+    PsdConfig_t cfg;
+    psd_workspace_t ws;             // window, FFTW plan, slice buffers
+    int8_t *raw;                    // linear copy of the capture
+    signal_iq_t sig;
+    double *freq;
+    double *psd;
+    char *json;                     // publish_results output
+    size_t json_cap;
+} psd_frame_t;
+
+
+// One SDR and everything fed from it: acquisition/PSD thread, audio thread, channel bank,
+// recorder. Pipelines share only zmq_channel.
+typedef struct {
+    int id;                         // "device" in commands and results
+    char serial[SDR_SERIAL_LEN];    // "" = first HackRF / software source
+    sdr_open_cfg_t source;
+    sdr_dev_t *device;
+
+    pthread_t thread;               // acquisition + PSD (the old main loop)
+    cpu_set_t cpus;                 // RF_DEVICE_CPUS; every thread the pipeline starts inherits it
+    bool pinned;
+
+    // Two ring buffers:
+    //   rb         = large buffer used for acquisition/full-PSD (pipeline thread reads)
+    //   audio_rb   = small buffer used only by audio thread (audio thread reads)
+    ring_buffer_t rb;
+    ring_buffer_t audio_rb;
+
+    // Capture time of every audio_rb byte (rx_callback marks, audio thread looks up)
+    lat_timeline_t audio_tl;
+    uint64_t audio_wr_bytes;
+
+    volatile bool config_received;
+    DesiredCfg_t desired_config;
+    PsdConfig_t psd_cfg;
+    SDR_cfg_t hack_cfg;
+    RB_cfg_t rb_cfg;
+
+    // Multi-channel monitoring (PFB + per-channel demod/Opus), idle until a channel is attached
+    chan_bank_t chan_bank;
+    const char *chan_default_host;
+    int chan_default_port;
+    int chan_port_step;             // RTP keeps even ports (RTCP convention)
+    bool chan_shm;                  // AUDIO_TRANSPORT=shm: one ring per channel, "<name>_ch<id>"
+
+    shm_ring_t *psd_shm;            // NULL = PSD frames over zmq_channel
+    psd_frame_t psd;                // pipeline thread only (device_json reads the sizes)
+    iq_rec_t *recorder;             // SigMF raw IQ (record_start / record_stop commands)
+
+    // Dataflow graph fed by rx_callback (graph_start / graph_stop / graph_stats, RF_GRAPH)
+    df_graph_t *graph;
+    pthread_mutex_t graph_lock;     // the pointer: rx_callback pushes, rebuilds swap
+    pthread_mutex_t graph_ctl;      // serializes build / stop / stats
+    char *graph_spec;               // last accepted spec, rebuilt when the tuner moves
+    volatile bool graph_pending;    // build once the device has a config
+    bool graph_taps;                // spec reads the device stream: rebuild when the tuner moves
+    SDR_cfg_t graph_cfg;            // tuner settings the running graph was built for
+
+    // Audio thread control
+    audio_stream_ctx_t *audio;
+    pthread_t audio_thread;
+    volatile bool audio_thread_running;
+
+    // Track whether RX is currently running and last applied config
+    bool rx_running;
+    SDR_cfg_t last_applied_cfg;
+    bool last_cfg_valid;
+
+    // Throughput: rx_callback / pipeline thread count, the report in main reads
+    volatile uint64_t rx_bytes;
+    volatile uint64_t psd_frames;
+    uint64_t rep_rx_bytes, rep_psd_frames;
+
+    // Registry ids ("devN/..."), registered by the pipeline thread before RX starts
+    struct {
+        metric_id_t rx_bytes;
+        metric_id_t psd_rb_dropped, audio_rb_dropped, chan_rb_dropped;
+        metric_id_t psd_computed, psd_published;
+        metric_id_t psd_wait, psd_compute, psd_publish;
+    } m;
+} rf_dev_t;
+
+static rf_dev_t rf_devs[RF_MAX_DEVICES];
+static int n_rf_devs = 0;
 
 // Forward decls
-void publish_results(double*, double*, int, SDR_cfg_t*);
+void publish_results(rf_dev_t*, double*, double*, int, SDR_cfg_t*, uint64_t);
 void on_command_received(const char *payload);
 
 // =========================================================
@@ -110,67 +229,852 @@ static bool sdr_cfg_equal(const SDR_cfg_t *a, const SDR_cfg_t *b) {
     return true;
 }
 
+/**
+ * SDR_BACKEND=hackrf|file|sim, SDR_PACE=realtime|fast (file/sim),
+ * SDR_FILE + SDR_FILE_FORMAT (int8|cs16|cf32, default from the extension) + SDR_FILE_LOOP,
+ * SDR_SIM_SIGNALS (see sdr_sim_parse) + SDR_SIM_SEED.
+ */
+static int sdr_source_from_env(sdr_open_cfg_t *src) {
+    const char *env_be   = getenv("SDR_BACKEND");
+    const char *env_pace = getenv("SDR_PACE");
+    const char *env_file = getenv("SDR_FILE");
+    const char *env_fmt  = getenv("SDR_FILE_FORMAT");
+    const char *env_loop = getenv("SDR_FILE_LOOP");
+    const char *env_sim  = getenv("SDR_SIM_SIGNALS");
+    const char *env_seed = getenv("SDR_SIM_SEED");
+
+    memset(src, 0, sizeof(*src));
+    int be = sdr_backend_parse(env_be);
+    if (be < 0) {
+        fprintf(stderr, "[RF] Unknown SDR_BACKEND '%s' (hackrf, file, sim)\n", env_be);
+        return -1;
+    }
+    src->backend = (sdr_backend_t)be;
+    src->realtime = !(env_pace && strcmp(env_pace, "fast") == 0);
+
+    src->path = env_file;
+    src->format = sdr_iq_format_parse(env_fmt, env_file);
+    src->loop = !(env_loop && (strcmp(env_loop, "0") == 0 || strcmp(env_loop, "false") == 0));
+
+    if (src->backend == SDR_BACKEND_SIM) {
+        src->n_sim = sdr_sim_parse(env_sim ? env_sim : SDR_SIM_DEFAULT_SIGNALS, src->sim, SDR_SIM_MAX_SIGNALS);
+        if (src->n_sim < 0) return -1;
+        src->seed = env_seed ? (uint32_t)strtoul(env_seed, NULL, 0) : 0;
+    }
+    return 0;
+}
+
 // =========================================================
 // RX CALLBACK (duplicate incoming bytes to both ring buffers)
-int rx_callback(hackrf_transfer* transfer) {
-    if (transfer->valid_length > 0) {
-        rb_write(&rb, transfer->buffer, transfer->valid_length);
-        rb_write(&audio_rb, transfer->buffer, transfer->valid_length);
+int rx_callback(const uint8_t *buf, size_t len, void *ctx) {
+    rf_dev_t *d = (rf_dev_t*)ctx;
+    // The delivery thread belongs to the backend (libusb event thread, file/sim reader):
+    // it is placed on its first callback.
+    static __thread bool rt_placed = false;
+    if (!rt_placed) {
+        char label[RT_LABEL_LEN];
+        snprintf(label, sizeof(label), "dev%d/rx", d->id);
+        rt_policy_apply("rx", label);
+        rt_placed = true;
+    }
+    if (len > 0) {
+        trace_begin("rx_callback");
+        size_t w = rb_write(&d->rb, buf, len);
+        if (w < len) metrics_add(d->m.psd_rb_dropped, len - w);
+        w = rb_write(&d->audio_rb, buf, len);
+        if (w > 0) {
+            d->audio_wr_bytes += w;
+            lat_timeline_mark(&d->audio_tl, d->audio_wr_bytes, lat_now_ns());
+        }
+        if (w < len) metrics_add(d->m.audio_rb_dropped, len - w);
+        size_t lost = chan_bank_push(&d->chan_bank, buf, len);
+        if (lost > 0) metrics_add(d->m.chan_rb_dropped, lost);
+        iq_rec_push(d->recorder, buf, len);
+        if (d->graph) {
+            pthread_mutex_lock(&d->graph_lock);
+            df_graph_push(d->graph, buf, len);
+            pthread_mutex_unlock(&d->graph_lock);
+        }
+        d->rx_bytes += len;
+        metrics_add(d->m.rx_bytes, len);
+        trace_end("rx_callback");
     }
     return 0;
 }
 
-int recover_hackrf(void) {
-    printf("\n[RECOVERY] Initiating Hardware Reset sequence...\n");
-    if (device != NULL) {
-        if (rx_running) {
-            hackrf_stop_rx(device);
-            rx_running = false;
+int recover_sdr(rf_dev_t *d) {
+    printf("\n[RECOVERY] dev%d: Initiating Hardware Reset sequence...\n", d->id);
+    if (d->device != NULL) {
+        if (d->rx_running) {
+            sdr_stop(d->device);
+            d->rx_running = false;
         }
-        hackrf_close(device);
-        device = NULL;
+        sdr_close(d->device);
+        d->device = NULL;
     }
 
     int attempts = 0;
     while (attempts < 3) {
         usleep(500000);
-        int status = hackrf_open(&device);
-        if (status == HACKRF_SUCCESS) {
-            printf("[RECOVERY] Device Re-opened successfully.\n");
+        d->device = sdr_open(&d->source);
+        if (d->device) {
+            printf("[RECOVERY] dev%d: Device Re-opened successfully.\n", d->id);
             return 0;
         }
         attempts++;
-        fprintf(stderr, "[RECOVERY] Attempt %d failed.\n", attempts);
+        fprintf(stderr, "[RECOVERY] dev%d: Attempt %d failed.\n", d->id, attempts);
     }
     return -1;
 }
 
+/** "device": id or serial (trailing digits); absent = device 0. NULL if nothing matches. */
+static rf_dev_t* rf_dev_from_json(const cJSON *root) {
+    const cJSON *dv = cJSON_GetObjectItemCaseSensitive(root, "device");
+    if (!dv) return &rf_devs[0];
+    if (cJSON_IsNumber(dv)) {
+        return (dv->valueint >= 0 && dv->valueint < n_rf_devs) ? &rf_devs[dv->valueint] : NULL;
+    }
+    if (cJSON_IsString(dv) && dv->valuestring && dv->valuestring[0]) {
+        size_t want = strlen(dv->valuestring);
+        for (int i = 0; i < n_rf_devs; i++) {
+            size_t have = strlen(rf_devs[i].serial);
+            if (have >= want && strcmp(rf_devs[i].serial + have - want, dv->valuestring) == 0) return &rf_devs[i];
+        }
+    }
+    return NULL;
+}
+
 // =========================================================
-// PUBLISH (unchanged)
-void publish_results(double* freq_array, double* psd_array, int length, SDR_cfg_t *local_hack) {
-    if (!zmq_channel || !freq_array || !psd_array || length <= 0) return;
-    cJSON *root = cJSON_CreateObject();
+// PUBLISH
+void publish_results(rf_dev_t *d, double* freq_array, double* psd_array, int length, SDR_cfg_t *local_hack,
+                     uint64_t seq) {
+    if ((!zmq_channel && !d->psd_shm) || !freq_array || !psd_array || length <= 0) return;
+    // Written straight into the frame's buffer (sized for nperseg bins) instead of a cJSON tree
+    char *out = d->psd.json;
+    if (!out) return;
     double start_abs = freq_array[0] + (double)local_hack->center_freq;
     double end_abs   = freq_array[length-1] + (double)local_hack->center_freq;
-    cJSON_AddNumberToObject(root, "start_freq_hz", start_abs);
-    cJSON_AddNumberToObject(root, "end_freq_hz", end_abs);
-    cJSON *pxx_array = cJSON_CreateDoubleArray(psd_array, length);
-    cJSON_AddItemToObject(root, "Pxx", pxx_array);
+    size_t n = psd_json_write(out, d->psd.json_cap, d->id, seq, start_abs, end_abs, psd_array, length);
+    if (n == 0) return;
+
+    if (d->psd_shm) {
+        shm_ring_poll(d->psd_shm);
+        if (shm_ring_write(d->psd_shm, out, n, NULL, 0) != 0) {
+            printf("[RF] Warning: dev%d PSD shm ring full, frame dropped.\n", d->id);
+        }
+    } else {
+        zpair_send(zmq_channel, out);
+    }
+}
+
+/**
+ * @brief Makes d->psd match this capture size and PSD configuration. Rebuilds the arena
+ * only when one of them changed; otherwise the previous frame's buffers are reused as is.
+ * @return 0 when the buffers are ready, -1 if they could not be allocated.
+ */
+static int psd_frame_prepare(rf_dev_t *d, const RB_cfg_t *rb_cfg, const PsdConfig_t *psd_cfg) {
+    psd_frame_t *f = &d->psd;
+    if (f->ready && f->total_bytes == rb_cfg->total_bytes && f->cfg.nperseg == psd_cfg->nperseg &&
+        f->cfg.noverlap == psd_cfg->noverlap && f->cfg.window_type == psd_cfg->window_type &&
+        f->cfg.sample_rate == psd_cfg->sample_rate) {
+        return 0;
+    }
+
+    psd_workspace_release(&f->ws);
+    f->ready = false;
+    size_t n_samples = rb_cfg->total_bytes / 2;
+    size_t bins = (size_t)psd_cfg->nperseg;
+    f->json_cap = PSD_JSON_BYTES(bins);
+    size_t bytes = ARENA_SIZE(rb_cfg->total_bytes)
+                 + ARENA_SIZE(n_samples * sizeof(double complex))
+                 + 2 * ARENA_SIZE(bins * sizeof(double))
+                 + ARENA_SIZE(f->json_cap)
+                 + psd_workspace_bytes(psd_cfg);
+    if (arena_reserve(&f->arena, bytes) != 0) {
+        fprintf(stderr, "[RF] dev%d: Error: cannot allocate %zu bytes for the PSD frame\n", d->id, bytes);
+        return -1;
+    }
+    f->raw = (int8_t*)arena_alloc(&f->arena, rb_cfg->total_bytes);
+    f->sig.signal_iq = (double complex*)arena_alloc(&f->arena, n_samples * sizeof(double complex));
+    f->sig.n_signal = 0;
+    f->freq = (double*)arena_alloc(&f->arena, bins * sizeof(double));
+    f->psd = (double*)arena_alloc(&f->arena, bins * sizeof(double));
+    f->json = (char*)arena_alloc(&f->arena, f->json_cap);
+    if (!f->raw || !f->sig.signal_iq || !f->freq || !f->psd || !f->json ||
+        psd_workspace_init(&f->ws, psd_cfg, &f->arena) != 0) {
+        fprintf(stderr, "[RF] dev%d: Error: PSD workspace setup failed\n", d->id);
+        psd_workspace_release(&f->ws);
+        return -1;
+    }
+
+    f->total_bytes = rb_cfg->total_bytes;
+    f->cfg = *psd_cfg;
+    f->ready = true;
+    printf("[RF] dev%d: PSD arena %.1f MiB for %zu samples x %zu bins (peak %.1f MiB, %u allocation%s)\n",
+           d->id, (double)f->arena.cap / 1048576.0, n_samples, bins, (double)f->arena.peak / 1048576.0,
+           f->arena.resizes, f->arena.resizes == 1 ? "" : "s");
+    return 0;
+}
+
+// =========================================================
+// CHANNEL COMMANDS
+static void send_ack(const char *cmd, int dev_id, int id, int ok) {
+    if (!zmq_channel) return;
+    // cmd comes from the client: cJSON escapes it and has no length cap
+    cJSON *ack = cJSON_CreateObject();
+    cJSON_AddStringToObject(ack, "ack", cmd);
+    cJSON_AddNumberToObject(ack, "device", dev_id);
+    cJSON_AddNumberToObject(ack, "id", id);
+    cJSON_AddBoolToObject(ack, "ok", ok);
+    char *txt = cJSON_PrintUnformatted(ack);
+    if (txt) zpair_send(zmq_channel, txt);
+    free(txt);
+    cJSON_Delete(ack);
+}
+
+static void add_latency_stage(cJSON *stages, const char *name, const lat_hist_t *h) {
+    cJSON *o = cJSON_CreateObject();
+    cJSON_AddNumberToObject(o, "n", (double)h->n);
+    cJSON_AddNumberToObject(o, "mean_ms", h->n ? 1e-6 * (double)h->sum_ns / (double)h->n : 0.0);
+    cJSON_AddNumberToObject(o, "p50_ms", 1e-6 * (double)lat_hist_quantile_ns(h, 0.50));
+    cJSON_AddNumberToObject(o, "p90_ms", 1e-6 * (double)lat_hist_quantile_ns(h, 0.90));
+    cJSON_AddNumberToObject(o, "p99_ms", 1e-6 * (double)lat_hist_quantile_ns(h, 0.99));
+    cJSON_AddNumberToObject(o, "max_ms", 1e-6 * (double)h->max_ns);
+
+    // Counts up to the last used bucket; edges in "bucket_us"
+    int last = 0;
+    for (int b = 0; b < LAT_HIST_BUCKETS; b++) if (h->count[b]) last = b + 1;
+    cJSON *counts = cJSON_CreateArray();
+    for (int b = 0; b < last; b++) cJSON_AddItemToArray(counts, cJSON_CreateNumber(h->count[b]));
+    cJSON_AddItemToObject(o, "hist", counts);
+    cJSON_AddItemToObject(stages, name, o);
+}
+
+/**
+ * @brief Publishes {"latency":{...}}: per-stage delay since the IQ capture of each frame.
+ */
+static void publish_latency(int dev_id, double window_s, const lat_hist_t *rb_wait, const lat_hist_t *dequeued,
+                            const lat_hist_t *demodulated, const lat_hist_t *encoded, const lat_hist_t *sent) {
+    if (!zmq_channel) return;
+    cJSON *root = cJSON_CreateObject();
+    cJSON *lat = cJSON_CreateObject();
+    cJSON_AddNumberToObject(lat, "device", dev_id);
+    cJSON_AddNumberToObject(lat, "window_s", window_s);
+
+    cJSON *edges = cJSON_CreateArray();
+    for (int b = 0; b < LAT_HIST_BUCKETS; b++) {
+        cJSON_AddItemToArray(edges, cJSON_CreateNumber(1e-3 * (double)lat_hist_bucket_upper_ns(b)));
+    }
+    cJSON_AddItemToObject(lat, "bucket_us", edges);
+
+    cJSON *stages = cJSON_CreateObject();
+    add_latency_stage(stages, "rb_wait", rb_wait);
+    add_latency_stage(stages, "dequeued", dequeued);
+    add_latency_stage(stages, "demodulated", demodulated);
+    add_latency_stage(stages, "encoded", encoded);
+    add_latency_stage(stages, "sent", sent);
+    cJSON_AddItemToObject(lat, "stages", stages);
+    cJSON_AddItemToObject(root, "latency", lat);
+
     char *json_string = cJSON_PrintUnformatted(root);
-    zpair_send(zmq_channel, json_string);
+    if (json_string) zpair_send(zmq_channel, json_string);
     free(json_string);
     cJSON_Delete(root);
 }
 
+/**
+ * Logs and publishes one sdr_apply_cfg operation: {"retune":{changed, apply_us, valid_us, discarded_samples}}
+ */
+static void publish_retune(const rf_dev_t *d, const sdr_retune_t *rt) {
+    static const struct { unsigned bit; const char *name; } chg[] = {
+        { SDR_CHG_FREQ, "freq" }, { SDR_CHG_RATE, "rate" }, { SDR_CHG_AMP, "amp" },
+        { SDR_CHG_LNA, "lna" }, { SDR_CHG_VGA, "vga" },
+    };
+    char names[48] = "";
+    cJSON *arr = cJSON_CreateArray();
+    for (size_t i = 0; i < sizeof(chg) / sizeof(chg[0]); i++) {
+        if (!(rt->changed & chg[i].bit)) continue;
+        size_t used = strlen(names);
+        snprintf(names + used, sizeof(names) - used, "%s%s", used ? "+" : "", chg[i].name);
+        cJSON_AddItemToArray(arr, cJSON_CreateString(chg[i].name));
+    }
+    printf("[RF] dev%d retune %s: apply %.2f ms, first valid sample after %.2f ms, %lu settling samples discarded\n",
+           d->id, names, rt->apply_us / 1e3, rt->valid_us / 1e3, rt->discarded_samples);
+
+    if (!zmq_channel) {
+        cJSON_Delete(arr);
+        return;
+    }
+    cJSON *root = cJSON_CreateObject();
+    cJSON *o = cJSON_CreateObject();
+    cJSON_AddNumberToObject(o, "device", d->id);
+    cJSON_AddItemToObject(o, "changed", arr);
+    cJSON_AddNumberToObject(o, "apply_us", rt->apply_us);
+    cJSON_AddNumberToObject(o, "valid_us", rt->valid_us);
+    cJSON_AddNumberToObject(o, "discarded_samples", (double)rt->discarded_samples);
+    cJSON_AddItemToObject(root, "retune", o);
+    char *txt = cJSON_PrintUnformatted(root);
+    if (txt) zpair_send(zmq_channel, txt);
+    free(txt);
+    cJSON_Delete(root);
+}
+
+// =========================================================
+// DEVICES
+static cJSON* device_json(const rf_dev_t *d, uint64_t rx, uint64_t frames) {
+    cJSON *o = cJSON_CreateObject();
+    cJSON_AddNumberToObject(o, "device", d->id);
+    cJSON_AddStringToObject(o, "serial", d->serial);
+    cJSON_AddStringToObject(o, "backend", sdr_backend_name(d->source.backend));
+    cJSON_AddBoolToObject(o, "streaming", d->rx_running);
+    cJSON_AddNumberToObject(o, "center_freq", (double)d->last_applied_cfg.center_freq);
+    cJSON_AddNumberToObject(o, "sample_rate", d->last_applied_cfg.sample_rate);
+    cJSON_AddNumberToObject(o, "rx_bytes", (double)rx);
+    cJSON_AddNumberToObject(o, "psd_frames", (double)frames);
+    cJSON_AddNumberToObject(o, "psd_arena_kb", (double)(d->psd.arena.cap / 1024));
+    cJSON_AddNumberToObject(o, "psd_arena_peak_kb", (double)(d->psd.arena.peak / 1024));
+    return o;
+}
+
+/** {"cmd":"device_list"} -> {"ack":"device_list","ok":true,"devices":[...]} */
+static void send_device_list(const char *cmd) {
+    if (!zmq_channel) return;
+    cJSON *root = cJSON_CreateObject();
+    cJSON_AddStringToObject(root, "ack", cmd);
+    cJSON_AddBoolToObject(root, "ok", 1);
+    cJSON *arr = cJSON_CreateArray();
+    for (int i = 0; i < n_rf_devs; i++) {
+        cJSON_AddItemToArray(arr, device_json(&rf_devs[i], rf_devs[i].rx_bytes, rf_devs[i].psd_frames));
+    }
+    cJSON_AddItemToObject(root, "devices", arr);
+    char *txt = cJSON_PrintUnformatted(root);
+    if (txt) zpair_send(zmq_channel, txt);
+    free(txt);
+    cJSON_Delete(root);
+}
+
+/** {"cmd":"thread_report"} -> {"ack":"thread_report","ok":true,"mlockall":..,"threads":[...]} */
+static void send_thread_report(const char *cmd) {
+    if (!zmq_channel) return;
+    cJSON *root = rt_policy_report_json();
+    if (!root) return;
+    cJSON_AddStringToObject(root, "ack", cmd);
+    cJSON_AddBoolToObject(root, "ok", 1);
+    char *txt = cJSON_PrintUnformatted(root);
+    if (txt) zpair_send(zmq_channel, txt);
+    free(txt);
+    cJSON_Delete(root);
+}
+
+// =========================================================
+// METRICS
+static double rb_fill_pct(void *ctx) {
+    ring_buffer_t *rb = (ring_buffer_t*)ctx;
+    return rb->size ? 100.0 * (double)rb_available(rb) / (double)rb->size : 0.0;
+}
+
+/** Registers the device's counters, ring gauges and PSD stage histograms (before RX starts) */
+static void dev_metrics_register(rf_dev_t *d) {
+    d->m.rx_bytes         = metrics_counter("dev%d/rx_bytes", d->id);
+    d->m.psd_rb_dropped   = metrics_counter("dev%d/psd_rb/dropped_bytes", d->id);
+    d->m.audio_rb_dropped = metrics_counter("dev%d/audio_rb/dropped_bytes", d->id);
+    d->m.chan_rb_dropped  = metrics_counter("dev%d/chan_rb/dropped_bytes", d->id);
+    d->m.psd_computed     = metrics_counter("dev%d/psd/frames_computed", d->id);
+    d->m.psd_published    = metrics_counter("dev%d/psd/frames_published", d->id);
+    d->m.psd_wait         = metrics_histogram("dev%d/psd/acquire_ns", d->id);
+    d->m.psd_compute      = metrics_histogram("dev%d/psd/compute_ns", d->id);
+    d->m.psd_publish      = metrics_histogram("dev%d/psd/publish_ns", d->id);
+    metrics_gauge_fn(rb_fill_pct, &d->rb, "dev%d/psd_rb/fill_pct", d->id);
+    metrics_gauge_fn(rb_fill_pct, &d->audio_rb, "dev%d/audio_rb/fill_pct", d->id);
+}
+
+/** Registry snapshot as {"stats":{..}} (periodic) or {"ack":"stats","ok":true,"stats":{..}} */
+static void send_stats(const char *ack) {
+    if (!zmq_channel) return;
+    cJSON *root = cJSON_CreateObject();
+    if (ack) {
+        cJSON_AddStringToObject(root, "ack", ack);
+        cJSON_AddBoolToObject(root, "ok", 1);
+    }
+    cJSON_AddItemToObject(root, "stats", metrics_snapshot_json());
+    char *txt = cJSON_PrintUnformatted(root);
+    if (txt) zpair_send(zmq_channel, txt);
+    free(txt);
+    cJSON_Delete(root);
+}
+
+// =========================================================
+// TRACE COMMANDS
+/**
+ * {"cmd":"trace_start","clear":true}  record spans (clear = forget earlier events, default)
+ * {"cmd":"trace_stop"}
+ * {"cmd":"trace_dump","path":"/abs/file.json"}  Chrome / Perfetto JSON (default TRACE_FILE)
+ * Acks: {"ack":..,"ok":..,"enabled":..} (+ "path","events" for trace_dump).
+ */
+static void handle_trace_command(cJSON *root, const char *cmd) {
+    int ok = 1;
+    long events = -1;
+    const char *path = NULL;
+    if (strcmp(cmd, "trace_start") == 0) {
+        const cJSON *clear = cJSON_GetObjectItemCaseSensitive(root, "clear");
+        trace_enable(true, !cJSON_IsFalse(clear));
+        printf("[TRACE] recording\n");
+    } else if (strcmp(cmd, "trace_stop") == 0) {
+        trace_enable(false, false);
+        printf("[TRACE] stopped\n");
+    } else if (strcmp(cmd, "trace_dump") == 0) {
+        const cJSON *p = cJSON_GetObjectItemCaseSensitive(root, "path");
+        path = (cJSON_IsString(p) && p->valuestring[0]) ? p->valuestring : trace_file;
+        events = trace_dump(path);
+        ok = events >= 0;
+        if (ok) printf("[TRACE] %ld events -> %s\n", events, path);
+        else fprintf(stderr, "[TRACE] ERROR: cannot write %s\n", path);
+    } else {
+        ok = 0;
+    }
+
+    if (!zmq_channel) return;
+    cJSON *ack = cJSON_CreateObject();
+    cJSON_AddStringToObject(ack, "ack", cmd);
+    cJSON_AddBoolToObject(ack, "ok", ok);
+    cJSON_AddBoolToObject(ack, "enabled", trace_enabled());
+    if (path) {
+        cJSON_AddStringToObject(ack, "path", path);
+        cJSON_AddNumberToObject(ack, "events", (double)events);
+    }
+    char *txt = cJSON_PrintUnformatted(ack);
+    if (txt) zpair_send(zmq_channel, txt);
+    free(txt);
+    cJSON_Delete(ack);
+}
+
+static void on_stop_signal(int sig) {
+    (void)sig;
+    stop_requested = 1;
+}
+
+/** Logs and publishes {"throughput":{"window_s":..,"devices":[{..,"msps":..,"psd_fps":..}]}} */
+static void publish_throughput(double window_s) {
+    cJSON *root = cJSON_CreateObject();
+    cJSON *tp = cJSON_CreateObject();
+    cJSON_AddNumberToObject(tp, "window_s", window_s);
+    cJSON *arr = cJSON_CreateArray();
+    for (int i = 0; i < n_rf_devs; i++) {
+        rf_dev_t *d = &rf_devs[i];
+        uint64_t rx = d->rx_bytes, frames = d->psd_frames;
+        double msps = (double)(rx - d->rep_rx_bytes) / 2.0 / window_s / 1e6;
+        double fps = (double)(frames - d->rep_psd_frames) / window_s;
+        d->rep_rx_bytes = rx;
+        d->rep_psd_frames = frames;
+        printf("[RF] dev%d %s: %.2f MS/s in, %.2f PSD frames/s\n", d->id, d->serial[0] ? d->serial : "-", msps, fps);
+
+        cJSON *o = device_json(d, rx, frames);
+        cJSON_AddNumberToObject(o, "msps", msps);
+        cJSON_AddNumberToObject(o, "psd_fps", fps);
+        cJSON_AddItemToArray(arr, o);
+    }
+    cJSON_AddItemToObject(tp, "devices", arr);
+
+    // Shared DSP pool over the same window: utilization per worker, steals, priorities
+    static wp_stats_t prev_pool;
+    wp_stats_t ps;
+    work_pool_get_stats(&ps);
+    if (ps.workers > 0) {
+        double wall = (double)(ps.uptime_ns - prev_pool.uptime_ns);
+        double util = wall > 0 ? 100.0 * (double)(ps.busy_ns - prev_pool.busy_ns) / (wall * ps.workers) : 0.0;
+        uint64_t tasks = ps.tasks - prev_pool.tasks, steals = ps.steals - prev_pool.steals;
+        printf("[POOL] %d workers: %.1f%% busy, %llu tasks (%llu stolen, %llu helped, %llu inline)\n",
+               ps.workers, util, (unsigned long long)tasks, (unsigned long long)steals,
+               (unsigned long long)(ps.helped - prev_pool.helped),
+               (unsigned long long)(ps.inline_runs - prev_pool.inline_runs));
+
+        cJSON *po = cJSON_CreateObject();
+        cJSON_AddNumberToObject(po, "workers", ps.workers);
+        cJSON_AddNumberToObject(po, "busy_pct", util);
+        cJSON_AddNumberToObject(po, "tasks", (double)tasks);
+        cJSON_AddNumberToObject(po, "steals", (double)steals);
+        cJSON_AddNumberToObject(po, "helped", (double)(ps.helped - prev_pool.helped));
+        cJSON_AddNumberToObject(po, "inline", (double)(ps.inline_runs - prev_pool.inline_runs));
+        cJSON_AddNumberToObject(po, "high_tasks", (double)(ps.submitted[WP_PRIO_HIGH] - prev_pool.submitted[WP_PRIO_HIGH]));
+        cJSON_AddNumberToObject(po, "normal_tasks", (double)(ps.submitted[WP_PRIO_NORMAL] - prev_pool.submitted[WP_PRIO_NORMAL]));
+        cJSON *wa = cJSON_CreateArray();
+        for (int w = 0; w < ps.workers; w++) {
+            double wb = wall > 0 ? 100.0 * (double)(ps.worker[w].busy_ns - prev_pool.worker[w].busy_ns) / wall : 0.0;
+            cJSON_AddItemToArray(wa, cJSON_CreateNumber(wb));
+        }
+        cJSON_AddItemToObject(po, "worker_busy_pct", wa);
+        cJSON_AddItemToObject(tp, "pool", po);
+        prev_pool = ps;
+    }
+    cJSON_AddItemToObject(root, "throughput", tp);
+    char *txt = zmq_channel ? cJSON_PrintUnformatted(root) : NULL;
+    if (txt) zpair_send(zmq_channel, txt);
+    free(txt);
+    cJSON_Delete(root);
+}
+
+// =========================================================
+// RECORDING COMMANDS
+static void send_record_ack(const rf_dev_t *d, const char *cmd, int ok) {
+    if (!zmq_channel) return;
+    iq_rec_stats_t st;
+    iq_rec_get_stats(d->recorder, &st);
+
+    cJSON *root = cJSON_CreateObject();
+    cJSON_AddStringToObject(root, "ack", cmd);
+    cJSON_AddNumberToObject(root, "device", d->id);
+    cJSON_AddBoolToObject(root, "ok", ok);
+    cJSON_AddBoolToObject(root, "recording", st.active);
+    cJSON_AddStringToObject(root, "path", st.base);
+    cJSON_AddNumberToObject(root, "bytes_written", (double)st.bytes_written);
+    cJSON_AddNumberToObject(root, "dropped_bytes", (double)st.bytes_dropped);
+    cJSON_AddNumberToObject(root, "seconds", st.seconds);
+    cJSON_AddNumberToObject(root, "write_mb_s", st.write_mb_s);
+    cJSON_AddBoolToObject(root, "o_direct", st.direct);
+    cJSON_AddNumberToObject(root, "retunes", st.retunes);
+    if (st.write_errno) cJSON_AddStringToObject(root, "error", strerror(st.write_errno));
+    char *txt = cJSON_PrintUnformatted(root);
+    if (txt) {
+        zpair_send(zmq_channel, txt);
+        free(txt);
+    }
+    cJSON_Delete(root);
+}
+
+/**
+ * {"cmd":"record_start","path":"name or /abs/base","max_bytes":N,"max_seconds":S,"description":"..."}
+ * {"cmd":"record_stop"} | {"cmd":"record_status"}
+ */
+static void handle_record_command(rf_dev_t *d, cJSON *root, const char *cmd) {
+    int ok = 0;
+
+    if (strcmp(cmd, "record_start") == 0) {
+        cJSON *path = cJSON_GetObjectItemCaseSensitive(root, "path");
+        cJSON *maxb = cJSON_GetObjectItemCaseSensitive(root, "max_bytes");
+        cJSON *maxs = cJSON_GetObjectItemCaseSensitive(root, "max_seconds");
+        cJSON *desc = cJSON_GetObjectItemCaseSensitive(root, "description");
+
+        iq_rec_req_t req;
+        memset(&req, 0, sizeof(req));
+        const char *dir = getenv("REC_DIR");
+        if (!dir || !*dir) dir = REC_DEFAULT_DIR;
+        if (cJSON_IsString(path) && path->valuestring && path->valuestring[0] == '/') {
+            snprintf(req.base, sizeof(req.base), "%s", path->valuestring);
+        } else if (cJSON_IsString(path) && path->valuestring && path->valuestring[0]) {
+            snprintf(req.base, sizeof(req.base), "%s/%s", dir, path->valuestring);
+        } else {
+            time_t now = time(NULL);
+            struct tm tm;
+            gmtime_r(&now, &tm);
+            char stamp[32];
+            strftime(stamp, sizeof(stamp), "%Y%m%dT%H%M%SZ", &tm);
+            if (d->id == 0) {
+                snprintf(req.base, sizeof(req.base), "%s/rf_%s_%lu", dir, stamp, (unsigned long)d->hack_cfg.center_freq);
+            } else {
+                snprintf(req.base, sizeof(req.base), "%s/rf_dev%d_%s_%lu", dir, d->id, stamp,
+                         (unsigned long)d->hack_cfg.center_freq);
+            }
+        }
+        req.max_bytes = cJSON_IsNumber(maxb) && maxb->valuedouble > 0 ? (uint64_t)maxb->valuedouble : 0;
+        req.max_seconds = cJSON_IsNumber(maxs) ? maxs->valuedouble : 0.0;
+        if (cJSON_IsString(desc) && desc->valuestring) {
+            snprintf(req.description, sizeof(req.description), "%s", desc->valuestring);
+        }
+        if (d->source.backend == SDR_BACKEND_HACKRF && d->serial[0]) {
+            snprintf(req.hw, sizeof(req.hw), "HackRF One %s", d->serial);
+        } else {
+            snprintf(req.hw, sizeof(req.hw), "%s", d->source.backend == SDR_BACKEND_HACKRF ? "HackRF One" :
+                     (d->source.backend == SDR_BACKEND_FILE ? "file replay" : "rf_engine simulator"));
+        }
+        ok = (iq_rec_start(d->recorder, &req) == 0);
+    } else if (strcmp(cmd, "record_stop") == 0) {
+        ok = (iq_rec_stop(d->recorder) == 0);
+    } else if (strcmp(cmd, "record_status") == 0) {
+        ok = 1;
+    } else {
+        fprintf(stderr, ">>> [RF] Unknown cmd '%s'\n", cmd);
+    }
+
+    printf(">>> [RF] dev%d %s -> %s\n", d->id, cmd, ok ? "OK" : "REJECTED");
+    send_record_ack(d, cmd, ok);
+}
+
+// =========================================================
+// DATAFLOW GRAPH COMMANDS
+
+/** Graph output -> {...block fields,"device":N,"block":"name"} on the PAIR socket */
+static void graph_publish(const char *block, const char *json, void *ctx) {
+    rf_dev_t *d = (rf_dev_t*)ctx;
+    if (!zmq_channel) return;
+    cJSON *root = cJSON_Parse(json);
+    if (!cJSON_IsObject(root)) {
+        cJSON_Delete(root);
+        return;
+    }
+    // block is the client's name from the graph spec: cJSON escapes it
+    cJSON_DeleteItemFromObjectCaseSensitive(root, "device");
+    cJSON_DeleteItemFromObjectCaseSensitive(root, "block");
+    cJSON_AddNumberToObject(root, "device", d->id);
+    cJSON_AddStringToObject(root, "block", block);
+    char *txt = cJSON_PrintUnformatted(root);
+    if (txt) zpair_send(zmq_channel, txt);
+    free(txt);
+    cJSON_Delete(root);
+}
+
+/**
+ * @brief Replaces the device graph with one built from d->graph_spec (none if NULL).
+ * Taps get the last applied tuner settings; without them the build waits (graph_pending).
+ * Caller holds graph_ctl.
+ * @return 0 on success or while pending, -1 with a message in err.
+ */
+static int dev_graph_rebuild(rf_dev_t *d, char *err, size_t err_len) {
+    pthread_mutex_lock(&d->graph_lock);
+    df_graph_t *old = d->graph;
+    d->graph = NULL;
+    pthread_mutex_unlock(&d->graph_lock);
+    if (old) df_graph_destroy(old);
+    if (!d->graph_spec) return 0;
+
+    cJSON *spec = cJSON_Parse(d->graph_spec);
+    if (!spec) {
+        snprintf(err, err_len, "graph is not valid JSON");
+        return -1;
+    }
+    d->graph_taps = false;
+    const cJSON *b;
+    cJSON_ArrayForEach(b, cJSON_GetObjectItemCaseSensitive(spec, "blocks")) {
+        const cJSON *type = cJSON_GetObjectItemCaseSensitive(b, "type");
+        if (cJSON_IsString(type) && type->valuestring && strcmp(type->valuestring, "tap") == 0) d->graph_taps = true;
+    }
+    if (d->graph_taps && !d->last_cfg_valid) {
+        // Taps need the tuner settings: build after the first config
+        cJSON_Delete(spec);
+        d->graph_pending = true;
+        printf("[DF] dev%d: graph waits for a device config\n", d->id);
+        return 0;
+    }
+    df_format_t tap = {0};
+    tap.type = DF_IQ_S8;
+    tap.fs = d->last_applied_cfg.sample_rate;
+    tap.center_hz = (double)d->last_applied_cfg.center_freq;
+
+    df_graph_t *g = df_graph_from_json(spec, d->last_cfg_valid ? &tap : NULL, err, err_len);
+    cJSON_Delete(spec);
+    if (!g) return -1;
+    df_graph_set_publish(g, graph_publish, d);
+    if (df_graph_start(g) != 0) {
+        snprintf(err, err_len, "graph did not start");
+        df_graph_destroy(g);
+        return -1;
+    }
+    d->graph_pending = false;
+    d->graph_cfg = d->last_applied_cfg;
+
+    pthread_mutex_lock(&d->graph_lock);
+    d->graph = g;
+    pthread_mutex_unlock(&d->graph_lock);
+    return 0;
+}
+
+/** Pipeline thread, after an apply: first build of a pending graph, rebuild when the tuner moved */
+static void dev_graph_follow_tuner(rf_dev_t *d) {
+    if (!d->graph_spec) return;
+    pthread_mutex_lock(&d->graph_ctl);
+    bool moved = d->graph && d->graph_taps && (d->graph_cfg.center_freq != d->last_applied_cfg.center_freq ||
+                              d->graph_cfg.sample_rate != d->last_applied_cfg.sample_rate);
+    if (d->graph_spec && (d->graph_pending || moved)) {
+        char err[256] = {0};
+        if (dev_graph_rebuild(d, err, sizeof(err)) != 0) {
+            fprintf(stderr, "[DF] dev%d: graph dropped: %s\n", d->id, err);
+            free(d->graph_spec);
+            d->graph_spec = NULL;
+            d->graph_pending = false;
+        } else if (d->graph) {
+            printf("[DF] dev%d: graph built for %lu Hz, %.0f S/s\n", d->id,
+                   (unsigned long)d->graph_cfg.center_freq, d->graph_cfg.sample_rate);
+        }
+    }
+    pthread_mutex_unlock(&d->graph_ctl);
+}
+
+/**
+ * {"cmd":"graph_start","graph":{"blocks":[...],"threads":{...}}} (see dataflow.h)
+ * {"cmd":"graph_stop"} | {"cmd":"graph_stats"}
+ * graph_start replaces the running graph (if the new one is rejected, none runs).
+ * Ack: {"ack":cmd,"device":N,"ok":..,"pending":..,"error":"..","stats":{...}}
+ */
+static void handle_graph_command(rf_dev_t *d, cJSON *root, const char *cmd) {
+    char err[256] = {0};
+    int ok = 0;
+    cJSON *stats = NULL;
+
+    pthread_mutex_lock(&d->graph_ctl);
+    if (strcmp(cmd, "graph_start") == 0) {
+        cJSON *graph = cJSON_GetObjectItemCaseSensitive(root, "graph");
+        char *txt = cJSON_IsObject(graph) ? cJSON_PrintUnformatted(graph) : NULL;
+        if (!txt) {
+            snprintf(err, sizeof(err), "missing \"graph\" object");
+        } else {
+            free(d->graph_spec);
+            d->graph_spec = txt;
+            ok = (dev_graph_rebuild(d, err, sizeof(err)) == 0);
+            if (!ok) {
+                free(d->graph_spec);
+                d->graph_spec = NULL;
+            }
+        }
+    } else if (strcmp(cmd, "graph_stop") == 0) {
+        free(d->graph_spec);
+        d->graph_spec = NULL;
+        d->graph_pending = false;
+        ok = (dev_graph_rebuild(d, err, sizeof(err)) == 0);
+    } else if (strcmp(cmd, "graph_stats") == 0) {
+        ok = (d->graph != NULL);
+        if (ok) stats = df_graph_stats_json(d->graph);
+        else snprintf(err, sizeof(err), d->graph_pending ? "graph waits for a device config" : "no graph running");
+    } else {
+        snprintf(err, sizeof(err), "unknown graph command");
+    }
+    bool pending = d->graph_pending;
+    pthread_mutex_unlock(&d->graph_ctl);
+
+    printf(">>> [RF] dev%d %s -> %s%s%s\n", d->id, cmd, ok ? "OK" : "REJECTED", err[0] ? ": " : "", err);
+    if (!zmq_channel) {
+        cJSON_Delete(stats);
+        return;
+    }
+    cJSON *ack = cJSON_CreateObject();
+    cJSON_AddStringToObject(ack, "ack", cmd);
+    cJSON_AddNumberToObject(ack, "device", d->id);
+    cJSON_AddBoolToObject(ack, "ok", ok);
+    cJSON_AddBoolToObject(ack, "pending", pending);
+    if (err[0]) cJSON_AddStringToObject(ack, "error", err);
+    if (stats) cJSON_AddItemToObject(ack, "stats", stats);
+    char *txt = cJSON_PrintUnformatted(ack);
+    if (txt) zpair_send(zmq_channel, txt);
+    free(txt);
+    cJSON_Delete(ack);
+}
+
+/**
+ * @brief Handles {"cmd":"channel_attach"|"channel_detach", ...}.
+ * channel_attach takes freq_hz and optional bw_hz, mode ("wfm", "nfm", "am", "usb", "lsb"), host, port.
+ * @return 1 if the payload was a channel command, 0 if it is a regular config.
+ */
+static int handle_channel_command(const char *payload) {
+    cJSON *root = cJSON_Parse(payload);
+    if (!root) return 0;
+
+    cJSON *cmd = cJSON_GetObjectItemCaseSensitive(root, "cmd");
+    if (!cJSON_IsString(cmd) || !cmd->valuestring) {
+        cJSON_Delete(root);
+        return 0;
+    }
+
+    cJSON *id = cJSON_GetObjectItemCaseSensitive(root, "id");
+    int ch_id = cJSON_IsNumber(id) ? id->valueint : -1;
+    int ok = 0;
+
+    if (strcmp(cmd->valuestring, "device_list") == 0) {
+        send_device_list(cmd->valuestring);
+        cJSON_Delete(root);
+        return 1;
+    }
+    if (strcmp(cmd->valuestring, "thread_report") == 0) {
+        send_thread_report(cmd->valuestring);
+        cJSON_Delete(root);
+        return 1;
+    }
+    if (strcmp(cmd->valuestring, "stats") == 0) {
+        send_stats(cmd->valuestring);
+        cJSON_Delete(root);
+        return 1;
+    }
+    if (strncmp(cmd->valuestring, "trace_", 6) == 0) {
+        handle_trace_command(root, cmd->valuestring);
+        cJSON_Delete(root);
+        return 1;
+    }
+
+    rf_dev_t *d = rf_dev_from_json(root);
+    if (!d) {
+        fprintf(stderr, ">>> [RF] %s: no such device\n", cmd->valuestring);
+        send_ack(cmd->valuestring, -1, ch_id, 0);
+        cJSON_Delete(root);
+        return 1;
+    }
+
+    if (strcmp(cmd->valuestring, "channel_attach") == 0) {
+        cJSON *freq = cJSON_GetObjectItemCaseSensitive(root, "freq_hz");
+        cJSON *bw   = cJSON_GetObjectItemCaseSensitive(root, "bw_hz");
+        cJSON *host = cJSON_GetObjectItemCaseSensitive(root, "host");
+        cJSON *port = cJSON_GetObjectItemCaseSensitive(root, "port");
+        cJSON *mode = cJSON_GetObjectItemCaseSensitive(root, "mode");
+
+        if (cJSON_IsNumber(freq)) {
+            chan_spec_t spec;
+            memset(&spec, 0, sizeof(spec));
+            spec.id = ch_id;
+            spec.freq_hz = freq->valuedouble;
+            spec.bw_hz = cJSON_IsNumber(bw) ? bw->valuedouble : 0.0;
+            spec.mode = FM_MODE;
+            if (cJSON_IsString(mode) && mode->valuestring) {
+                rf_mode_from_string(mode->valuestring, &spec.mode);
+            }
+            if (cJSON_IsString(host) && host->valuestring) {
+                snprintf(spec.host, sizeof(spec.host), "%s", host->valuestring);
+            } else if (d->chan_shm) {
+                snprintf(spec.host, sizeof(spec.host), "%s_ch%d", d->chan_default_host, ch_id);
+            } else {
+                snprintf(spec.host, sizeof(spec.host), "%s", d->chan_default_host);
+            }
+            // Default: one port per channel above the main audio port
+            spec.port = cJSON_IsNumber(port) ? port->valueint : d->chan_default_port + d->chan_port_step * (1 + ch_id);
+            ok = (chan_bank_attach(&d->chan_bank, &spec) == 0);
+        }
+        printf(">>> [RF] dev%d channel_attach id=%d -> %s\n", d->id, ch_id, ok ? "OK" : "REJECTED");
+    } else if (strcmp(cmd->valuestring, "channel_detach") == 0) {
+        ok = (chan_bank_detach(&d->chan_bank, ch_id) == 0);
+        printf(">>> [RF] dev%d channel_detach id=%d -> %s\n", d->id, ch_id, ok ? "OK" : "UNKNOWN");
+    } else if (strncmp(cmd->valuestring, "record_", 7) == 0) {
+        handle_record_command(d, root, cmd->valuestring);
+        cJSON_Delete(root);
+        return 1;
+    } else if (strncmp(cmd->valuestring, "graph_", 6) == 0) {
+        handle_graph_command(d, root, cmd->valuestring);
+        cJSON_Delete(root);
+        return 1;
+    } else {
+        fprintf(stderr, ">>> [RF] Unknown cmd '%s'\n", cmd->valuestring);
+    }
+
+    send_ack(cmd->valuestring, d->id, ch_id, ok);
+    cJSON_Delete(root);
+    return 1;
+}
+
 // =========================================================
-// ZMQ CALLBACK (unchanged)
+// ZMQ CALLBACK
 void on_command_received(const char *payload) {
     printf("\n>>> [RF] Received Command Payload.\n");
-    memset(&desired_config, 0, sizeof(DesiredCfg_t));
-    if (parse_config_rf(payload, &desired_config) == 0) {
-        find_params_psd(desired_config, &hack_cfg, &psd_cfg, &rb_cfg);
-        print_config_summary(&desired_config, &hack_cfg, &psd_cfg, &rb_cfg);
-        config_received = true;
+    if (handle_channel_command(payload)) return;
+
+    // Regular config: "device" picks the pipeline (default 0)
+    cJSON *root = cJSON_Parse(payload);
+    rf_dev_t *d = root ? rf_dev_from_json(root) : &rf_devs[0];
+    if (root) cJSON_Delete(root);
+    if (!d) {
+        fprintf(stderr, ">>> [RF] Config for an unknown device ignored.\n");
+        return;
+    }
+
+    memset(&d->desired_config, 0, sizeof(DesiredCfg_t));
+    if (parse_config_rf(payload, &d->desired_config) == 0) {
+        find_params_psd(d->desired_config, &d->hack_cfg, &d->psd_cfg, &d->rb_cfg);
+        if (n_rf_devs > 1) printf(">>> [RF] Config for dev%d\n", d->id);
+        print_config_summary(&d->desired_config, &d->hack_cfg, &d->psd_cfg, &d->rb_cfg);
+        d->config_received = true;
     } else {
         fprintf(stderr, ">>> [PARSER] Failed to parse JSON configuration.\n");
     }
@@ -178,25 +1082,63 @@ void on_command_received(const char *payload) {
 
 // =========================================================
 // AUDIO STREAMING CONTEXT
+
+// DSP parameters owned by the audio thread (DDC channel + demodulator)
 typedef struct {
-    fm_radio_t *radio;
+    double fs;          // tuner sample rate
+    double offset_hz;   // demod carrier relative to tuner center
+    double bw_hz;       // demod channel bandwidth
+    rf_mode_t mode;     // selects the demodulator
+} audio_dsp_cfg_t;
+
+struct audio_stream_ctx {
+    rf_dev_t *dev;          // source of audio_rb / audio_tl
+    demod_t *demod;
+    ddc_t *ddc;
 
     // TCP destination for opus_tx (Python gateway listener)
     const char *tcp_host;
     int tcp_port;
 
+    // Direct RTP/UDP output (AUDIO_TRANSPORT=rtp), unicast or multicast
+    int transport;          // OPUS_TX_OPU0_TCP | OPUS_TX_RTP_UDP | OPUS_TX_SHM
+    const char *shm_name;   // AUDIO_TRANSPORT=shm
+    const char *rtp_host;
+    int rtp_port;
+    uint32_t rtp_ssrc;      // 0 = random
+    int rtp_pt;
+    int rtp_ttl;
+
     // Opus parameters
     int opus_sample_rate;   // must be 8000/12000/16000/24000/48000 (we use 48000)
-    int opus_channels;      // 1
+    int opus_channels;      // follows the demodulator (2 for WFM stereo)
     int bitrate;            // e.g., 32000
     int complexity;         // 0..10
     int vbr;                // 0/1
-    int frame_ms;           // 20ms is typical
-} audio_stream_ctx_t;
-
-static void audio_stream_ctx_defaults(audio_stream_ctx_t *ctx, fm_radio_t *radio) {
+    int dtx;                // 0/1 (OPUS_DTX)
+    int tx_queue_frames;    // send queue depth, drop-oldest (OPUS_TX_QUEUE)
+    double frame_ms;        // 20ms is typical; 2.5..10 in low-latency mode
+    int ts_ext;             // 1 = 'OPU1' headers carrying capture/encode times (OPUS_TS_EXT)
+    int low_latency;        // AUDIO_LOW_LATENCY: adaptive blocks aligned to the decimation
+    double latency_target_ms;
+    int fast_disc;          // 1 = DDC + demod, 0 = full-rate double atan2 FM reference
+    int stereo;             // 1 = decode WFM stereo (pilot PLL + L-R), Opus at 2 channels
+    squelch_cfg_t squelch;  // closed gate skips demod tail + encoder (SQUELCH_DBFS)
+
+    // DSP config requested by main, applied by the audio thread
+    // (init reallocates filter taps, so it must not race the demod)
+    pthread_mutex_t cfg_lock;
+    audio_dsp_cfg_t pending;
+    volatile bool reinit_pending;
+
+    char shm_name_dev[64];  // shm_name + "_dev<N>" for devices past the first
+};
+
+static void audio_stream_ctx_defaults(audio_stream_ctx_t *ctx, rf_dev_t *dev, demod_t *demod, ddc_t *ddc) {
     memset(ctx, 0, sizeof(*ctx));
-    ctx->radio = radio;
+    ctx->dev = dev;
+    ctx->demod = demod;
+    ctx->ddc = ddc;
 
     // allow overrides via env for convenience
     const char *env_host = getenv("AUDIO_TCP_HOST");
@@ -205,6 +1147,20 @@ static void audio_stream_ctx_defaults(audio_stream_ctx_t *ctx, fm_radio_t *radio
     const char *env_cplx = getenv("OPUS_COMPLEXITY");
     const char *env_vbr  = getenv("OPUS_VBR");
     const char *env_fms  = getenv("OPUS_FRAME_MS");
+    const char *env_disc = getenv("FM_DISCRIMINATOR");
+    const char *env_st   = getenv("FM_STEREO");
+    const char *env_dtx  = getenv("OPUS_DTX");
+    const char *env_txq  = getenv("OPUS_TX_QUEUE");
+    const char *env_tr   = getenv("AUDIO_TRANSPORT");
+    const char *env_rhst = getenv("AUDIO_RTP_HOST");
+    const char *env_rprt = getenv("AUDIO_RTP_PORT");
+    const char *env_ssrc = getenv("RTP_SSRC");
+    const char *env_pt   = getenv("RTP_PT");
+    const char *env_ttl  = getenv("RTP_TTL");
+    const char *env_shm  = getenv("AUDIO_SHM_NAME");
+    const char *env_tsx  = getenv("OPUS_TS_EXT");
+    const char *env_ll   = getenv("AUDIO_LOW_LATENCY");
+    const char *env_llt  = getenv("AUDIO_LATENCY_TARGET_MS");
 
     ctx->tcp_host = (env_host && env_host[0]) ? env_host : AUDIO_TCP_DEFAULT_HOST;
 
@@ -214,29 +1170,156 @@ static void audio_stream_ctx_defaults(audio_stream_ctx_t *ctx, fm_radio_t *radio
         if (p > 0 && p < 65536) ctx->tcp_port = p;
     }
 
+    ctx->transport = OPUS_TX_OPU0_TCP;
+    if (env_tr && strcmp(env_tr, "rtp") == 0) ctx->transport = OPUS_TX_RTP_UDP;
+    if (env_tr && strcmp(env_tr, "shm") == 0) ctx->transport = OPUS_TX_SHM;
+    ctx->shm_name = (env_shm && env_shm[0] == '/') ? env_shm : AUDIO_SHM_DEFAULT_NAME;
+    ctx->rtp_host = (env_rhst && env_rhst[0]) ? env_rhst : AUDIO_TCP_DEFAULT_HOST;
+    ctx->rtp_port = AUDIO_RTP_DEFAULT_PORT;
+    if (env_rprt && env_rprt[0]) {
+        int p = atoi(env_rprt);
+        if (p > 0 && p < 65536) ctx->rtp_port = p;
+    }
+    ctx->rtp_ssrc = (env_ssrc && env_ssrc[0]) ? (uint32_t)strtoul(env_ssrc, NULL, 0) : 0;
+    ctx->rtp_pt   = (env_pt && env_pt[0]) ? atoi(env_pt) : OPUS_TX_RTP_PT_DEFAULT;
+    ctx->rtp_ttl  = (env_ttl && env_ttl[0]) ? atoi(env_ttl) : 1;
+
     ctx->opus_sample_rate = AUDIO_FS;
     ctx->opus_channels    = 1;
 
     ctx->bitrate    = (env_br && env_br[0]) ? atoi(env_br) : OPUS_BITRATE_DEFAULT;
     ctx->complexity = (env_cplx && env_cplx[0]) ? atoi(env_cplx) : OPUS_COMPLEXITY_DEFAULT;
     ctx->vbr        = (env_vbr && env_vbr[0]) ? atoi(env_vbr) : OPUS_VBR_DEFAULT;
-    ctx->frame_ms   = (env_fms && env_fms[0]) ? atoi(env_fms) : OPUS_FRAME_MS_DEFAULT;
+    ctx->low_latency = (env_ll && (strcmp(env_ll, "1") == 0 || strcmp(env_ll, "true") == 0)) ? 1 : 0;
+    ctx->latency_target_ms = (env_llt && env_llt[0]) ? atof(env_llt) : LL_TARGET_MS_DEFAULT;
+    if (ctx->latency_target_ms <= 0.0) ctx->latency_target_ms = LL_TARGET_MS_DEFAULT;
+    ctx->frame_ms   = (env_fms && env_fms[0]) ? atof(env_fms)
+                    : (ctx->low_latency ? LL_FRAME_MS_DEFAULT : OPUS_FRAME_MS_DEFAULT);
 
     if (ctx->complexity < 0) ctx->complexity = 0;
     if (ctx->complexity > 10) ctx->complexity = 10;
     if (ctx->frame_ms <= 0) ctx->frame_ms = OPUS_FRAME_MS_DEFAULT;
+    ctx->frame_ms = opus_tx_snap_frame_ms(ctx->frame_ms);
     if (ctx->bitrate <= 0) ctx->bitrate = OPUS_BITRATE_DEFAULT;
     ctx->vbr = ctx->vbr ? 1 : 0;
+    ctx->tx_queue_frames = (env_txq && env_txq[0]) ? atoi(env_txq) : OPUS_TX_QUEUE_DEFAULT;
+    if (ctx->tx_queue_frames <= 0) ctx->tx_queue_frames = OPUS_TX_QUEUE_DEFAULT;
+    ctx->dtx = (env_dtx && env_dtx[0]) ? (atoi(env_dtx) ? 1 : 0) : OPUS_DTX_DEFAULT;
+    squelch_cfg_from_env(&ctx->squelch);
+    ctx->ts_ext = (env_tsx && env_tsx[0]) ? (atoi(env_tsx) ? 1 : 0) : 0;
+
+    // "reference" keeps the double complex + atan2 path for A/B comparisons
+    ctx->fast_disc = !(env_disc && strcmp(env_disc, "reference") == 0);
+    ctx->stereo = (env_st && (strcmp(env_st, "1") == 0 || strcmp(env_st, "true") == 0)) ? 1 : 0;
+
+    // Device N: its own ports, SSRC and shm ring so the streams never collide
+    if (dev->id > 0) {
+        ctx->tcp_port += dev->id * RF_DEV_PORT_STEP;
+        ctx->rtp_port += dev->id * RF_DEV_PORT_STEP;
+        if (ctx->rtp_ssrc) ctx->rtp_ssrc += (uint32_t)dev->id << 16;
+        snprintf(ctx->shm_name_dev, sizeof(ctx->shm_name_dev), "%s_dev%d", ctx->shm_name, dev->id);
+        ctx->shm_name = ctx->shm_name_dev;
+    }
+
+    pthread_mutex_init(&ctx->cfg_lock, NULL);
+}
+
+/** Ask the audio thread to apply a new sample rate / demod channel */
+static void audio_request_config(audio_stream_ctx_t *ctx, const audio_dsp_cfg_t *cfg) {
+    pthread_mutex_lock(&ctx->cfg_lock);
+    ctx->pending = *cfg;
+    ctx->reinit_pending = true;
+    pthread_mutex_unlock(&ctx->cfg_lock);
+}
+
+/** Derive the DDC channel from the user config; offsets outside the capture fall back to center */
+static void audio_dsp_cfg_from(const DesiredCfg_t *des, const SDR_cfg_t *hw, int stereo, audio_dsp_cfg_t *out) {
+    const demod_ops_t *ops = demod_ops_for(des->rf_mode, stereo);
+
+    memset(out, 0, sizeof(*out));
+    out->mode = des->rf_mode;
+    out->fs = hw->sample_rate;
+    out->bw_hz = (des->demode_config.bw_hz > 0) ? des->demode_config.bw_hz : ops->default_bw_hz;
+    if (out->bw_hz > hw->sample_rate) out->bw_hz = hw->sample_rate;
+
+    out->offset_hz = 0.0;
+    if (des->demode_config.center_freq > 0) {
+        out->offset_hz = des->demode_config.center_freq - (double)hw->center_freq;
+    }
+
+    double max_offset = 0.5 * (hw->sample_rate - out->bw_hz);
+    if (fabs(out->offset_hz) > max_offset) {
+        fprintf(stderr, "[AUDIO] WARN: demod offset %.0f Hz outside capture (+/-%.0f Hz). Using tuner center.\n",
+                out->offset_hz, max_offset);
+        out->offset_hz = 0.0;
+    }
+}
+
+// =========================================================
+// LOW-LATENCY BLOCK CONTROL
+// The audio thread takes whatever audio_rb holds (up to AUDIO_CHUNK_SAMPLES) once at least
+// min_block samples are there, cut to a multiple of the DDC decimation so every block yields
+// the same PCM count. min_block starts at a quarter Opus frame of input and doubles while the
+// fixed per-block cost dominates (duty high), halving back when there is headroom; it never
+// exceeds half the latency target.
+typedef struct {
+    size_t align;           // samples per DDC output sample
+    size_t floor;           // 1/LL_BLOCKS_PER_FRAME of an Opus frame of input
+    size_t ceil;
+    size_t min_block;
+    double duty;            // EWMA of processing time / block duration
+} ll_ctl_t;
+
+static size_t ll_align_up(size_t n, size_t a) {
+    return ((n + a - 1) / a) * a;
+}
+
+static void ll_reset(ll_ctl_t *ll, double fs, size_t align, double frame_ms, double target_ms) {
+    ll->align = (align > 0) ? align : 1;
+    size_t max_aligned = AUDIO_CHUNK_SAMPLES - AUDIO_CHUNK_SAMPLES % ll->align;
+
+    ll->floor = ll_align_up((size_t)(fs * frame_ms / 1000.0 / LL_BLOCKS_PER_FRAME), ll->align);
+    ll->ceil = ll_align_up((size_t)(fs * target_ms / 2000.0), ll->align);
+    if (ll->floor > max_aligned) ll->floor = max_aligned;
+    if (ll->ceil > max_aligned) ll->ceil = max_aligned;
+    if (ll->ceil < ll->floor) ll->ceil = ll->floor;
+    ll->min_block = ll->floor;
+    ll->duty = 0.0;
+}
+
+/** Samples to read now (0 = keep waiting) */
+static size_t ll_block(const ll_ctl_t *ll, size_t avail) {
+    if (avail < ll->min_block) return 0;
+    size_t n = (avail < AUDIO_CHUNK_SAMPLES) ? avail : AUDIO_CHUNK_SAMPLES;
+    return n - n % ll->align;
+}
+
+static void ll_update(ll_ctl_t *ll, double fs, size_t n, uint64_t busy_ns) {
+    double block_s = (double)n / fs;
+    if (block_s <= 0.0) return;
+    ll->duty = 0.9 * ll->duty + 0.1 * (1e-9 * (double)busy_ns / block_s);
+
+    if (ll->duty > LL_DUTY_HIGH && ll->min_block * 2 <= ll->ceil) {
+        ll->min_block *= 2;
+        ll->duty = 0.5 * (LL_DUTY_HIGH + LL_DUTY_LOW);
+    } else if (ll->duty < LL_DUTY_LOW && ll->min_block / 2 >= ll->floor) {
+        ll->min_block = ll_align_up(ll->min_block / 2, ll->align);
+        ll->duty = 0.5 * (LL_DUTY_HIGH + LL_DUTY_LOW);
+    }
 }
 
 // =========================================================
 // AUDIO THREAD: drains audio_rb, converts IQ->PCM, encodes Opus, sends via TCP
 void* audio_thread_fn(void* arg) {
     audio_stream_ctx_t *ctx = (audio_stream_ctx_t*)arg;
-    if (!ctx || !ctx->radio) {
-        fprintf(stderr, "[AUDIO] FATAL: ctx or radio is NULL\n");
+    if (!ctx || !ctx->dev || !ctx->demod || !ctx->ddc) {
+        fprintf(stderr, "[AUDIO] FATAL: ctx, dev, demod or ddc is NULL\n");
         return NULL;
     }
+    rf_dev_t *d = ctx->dev;
+    char rt_label[RT_LABEL_LEN];
+    snprintf(rt_label, sizeof(rt_label), "dev%d/audio", d->id);
+    rt_policy_apply("audio", rt_label);
 
     // sanity: Opus expects one of the standard rates; we use 48000
     if (!(ctx->opus_sample_rate == 8000  || ctx->opus_sample_rate == 12000 ||
@@ -246,34 +1329,44 @@ void* audio_thread_fn(void* arg) {
         return NULL;
     }
 
-    const int frame_samples = (ctx->opus_sample_rate * ctx->frame_ms) / 1000; // e.g., 960 @48k/20ms
+    const int frame_samples = (int)lrint(ctx->opus_sample_rate * ctx->frame_ms / 1000.0); // e.g., 960 @48k/20ms
     if (frame_samples <= 0) {
         fprintf(stderr, "[AUDIO] FATAL: invalid frame_samples\n");
         return NULL;
     }
 
     int8_t  *raw_iq_chunk = (int8_t*)malloc((size_t)AUDIO_CHUNK_SAMPLES * 2);
-    int16_t *pcm_out      = (int16_t*)malloc((size_t)AUDIO_CHUNK_SAMPLES * sizeof(int16_t));
+    // Up to 2 interleaved channels (WFM stereo)
+    int16_t *pcm_out      = (int16_t*)malloc((size_t)AUDIO_CHUNK_SAMPLES * 2 * sizeof(int16_t));
 
     signal_iq_t audio_sig;
     audio_sig.n_signal = AUDIO_CHUNK_SAMPLES;
     audio_sig.signal_iq = (double complex*)malloc((size_t)AUDIO_CHUNK_SAMPLES * sizeof(double complex));
 
-    int16_t *pcm_accum = (int16_t*)malloc((size_t)frame_samples * sizeof(int16_t));
+    // DDC output never exceeds its input (D >= 1); slack covers filter phase
+    float *chan_iq = (float*)malloc(((size_t)AUDIO_CHUNK_SAMPLES + 64) * 2 * sizeof(float));
+
+    int16_t *pcm_accum = (int16_t*)malloc((size_t)frame_samples * 2 * sizeof(int16_t));
     int accum_len = 0;
 
-    if (!raw_iq_chunk || !pcm_out || !audio_sig.signal_iq || !pcm_accum) {
+    if (!raw_iq_chunk || !pcm_out || !audio_sig.signal_iq || !chan_iq || !pcm_accum) {
         fprintf(stderr, "[AUDIO] FATAL: malloc failed\n");
         free(raw_iq_chunk);
         free(pcm_out);
         free(audio_sig.signal_iq);
+        free(chan_iq);
         free(pcm_accum);
         return NULL;
     }
 
+    // Squelch runs on the DDC output; while closed, audio time is counted as gap frames
+    squelch_t sq;
+    squelch_init(&sq, &ctx->squelch, 0.0);
+    double gap_samples = 0.0;   // per-channel audio samples not yet reported as gap
+
     opus_tx_t *tx = NULL;
 
-    // local helper: (re)connect opus tx
+    // local helper: encoder + send queue; the connection itself is retried inside opus_tx
     auto int ensure_tx(void) {
         if (tx) return 0;
 
@@ -284,73 +1377,298 @@ void* audio_thread_fn(void* arg) {
         cfg.bitrate     = ctx->bitrate;
         cfg.complexity  = ctx->complexity;
         cfg.vbr         = ctx->vbr;
-
-        tx = opus_tx_create(ctx->tcp_host, ctx->tcp_port, &cfg);
+        cfg.dtx         = ctx->dtx;
+        cfg.queue_frames = ctx->tx_queue_frames;
+        cfg.frame_ms    = ctx->frame_ms;
+        cfg.ts_ext      = ctx->ts_ext;
+        cfg.transport   = ctx->transport;
+        cfg.rtp_ssrc    = ctx->rtp_ssrc;
+        cfg.rtp_pt      = ctx->rtp_pt;
+        cfg.rtp_ttl     = ctx->rtp_ttl;
+
+        const bool rtp = (ctx->transport == OPUS_TX_RTP_UDP);
+        const bool shm = (ctx->transport == OPUS_TX_SHM);
+        const char *host = rtp ? ctx->rtp_host : (shm ? ctx->shm_name : ctx->tcp_host);
+        const int port = rtp ? ctx->rtp_port : (shm ? 0 : ctx->tcp_port);
+        const char *kind = rtp ? "rtp" : (shm ? "shm" : "opu0");
+
+        tx = opus_tx_create(host, port, &cfg);
         if (!tx) {
-            fprintf(stderr,
-                    "[AUDIO] WARN: opus_tx_create failed (%s:%d). Will retry.\n",
-                    ctx->tcp_host, ctx->tcp_port);
+            fprintf(stderr, "[AUDIO] WARN: Opus TX init failed (%s %s:%d sr=%d ch=%d). Will retry.\n",
+                    kind, host, port, cfg.sample_rate, cfg.channels);
             return -1;
         }
 
         fprintf(stderr,
-                "[AUDIO] Connected Opus TX to %s:%d (sr=%d ch=%d frame_ms=%d bitrate=%d vbr=%d cplx=%d)\n",
-                ctx->tcp_host, ctx->tcp_port,
-                cfg.sample_rate, cfg.channels, ctx->frame_ms, cfg.bitrate, cfg.vbr, cfg.complexity);
+                "[AUDIO] Opus TX (%s) to %s:%d (sr=%d ch=%d frame_ms=%g bitrate=%d vbr=%d cplx=%d dtx=%d queue=%d%s)\n",
+                kind, host, port,
+                cfg.sample_rate, cfg.channels, ctx->frame_ms, cfg.bitrate, cfg.vbr, cfg.complexity, cfg.dtx,
+                cfg.queue_frames > 0 ? cfg.queue_frames : OPUS_TX_QUEUE_DEFAULT,
+                (cfg.ts_ext && !rtp) ? " ts=OPU1" : "");
 
         return 0;
     }
 
-    audio_thread_running = true;
+    bool radio_ready = false;
+    bool use_reference = false;
+    audio_dsp_cfg_t applied = {0};
+    ll_ctl_t ll = {0};
+
+    // CPU and uplink per second of audio covered (thread CPU clock), open share of the squelch
+    struct timespec cpu_t0;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &cpu_t0);
+    double cpu_audio_s = 0.0;
+    double open_audio_s = 0.0;
+    uint64_t tx_bytes0 = 0;
+
+    // Latency since the capture of each frame's first IQ sample (rx_callback clock).
+    // rb_wait is per chunk: how long its newest sample sat in audio_rb.
+    uint64_t rd_bytes = 0;          // audio_rb bytes consumed, matches audio_wr_bytes
+    uint64_t frame_cap_ns = 0;      // capture time of pcm_accum[0]
+    lat_hist_t lat_rb, lat_deq, lat_demod, lat_enc, lat_sent;
+    lat_hist_reset(&lat_rb);
+    lat_hist_reset(&lat_deq);
+    lat_hist_reset(&lat_demod);
+
+    // Registry (cumulative; the windows above reset at every report)
+    const metric_id_t m_dsp      = metrics_histogram("dev%d/audio/dsp_ns", d->id);
+    const metric_id_t m_rb_wait  = metrics_histogram("dev%d/audio/rb_wait_ns", d->id);
+    const metric_id_t m_to_demod = metrics_histogram("dev%d/audio/capture_to_demod_ns", d->id);
+    const metric_id_t m_frames   = metrics_counter("dev%d/audio/frames", d->id);
+    const metric_id_t m_enc_fail = metrics_counter("dev%d/audio/encode_failed", d->id);
+    const metric_id_t m_tx_sent  = metrics_counter("dev%d/audio/tx_frames_sent", d->id);
+    const metric_id_t m_tx_drop  = metrics_counter("dev%d/audio/tx_frames_dropped", d->id);
+    const metric_id_t m_tx_reconn = metrics_counter("dev%d/audio/tx_reconnects", d->id);
+    const metric_id_t m_tx_queue = metrics_gauge("dev%d/audio/tx_queue", d->id);
+    uint64_t tx_sent0 = 0, tx_drop0 = 0, tx_reconn0 = 0;
+
+    d->audio_thread_running = true;
+
+    while (d->audio_thread_running) {
+
+        // Apply pending DSP config from main
+        if (ctx->reinit_pending) {
+            pthread_mutex_lock(&ctx->cfg_lock);
+            audio_dsp_cfg_t want = ctx->pending;
+            ctx->reinit_pending = false;
+            pthread_mutex_unlock(&ctx->cfg_lock);
+
+            bool same_chain = radio_ready &&
+                              want.mode == applied.mode &&
+                              fabs(want.fs - applied.fs) < 1e-6 &&
+                              fabs(want.bw_hz - applied.bw_hz) < 1e-6;
+
+            if (same_chain) {
+                // Channel move inside the capture: NCO only, no hardware or filter change
+                demod_front_end_retune(ctx->ddc, want.mode, want.offset_hz);
+                printf("[AUDIO] DDC retuned to offset %+.0f Hz\n", want.offset_hz);
+            } else {
+                ddc_free(ctx->ddc);
+                demod_free(ctx->demod);
+                // Demod runs at the DDC rate; the double atan2 reference (mono WFM only) at the full rate
+                // IMPORTANT: output rate must match opus_sample_rate (typically 48000)
+                use_reference = !ctx->fast_disc && demod_ops_for(want.mode, 0) == demod_ops_for(FM_MODE, 0);
+                int stereo = use_reference ? 0 : ctx->stereo;
+
+                radio_ready = (demod_front_end_init(ctx->ddc, want.mode, stereo, want.fs, want.offset_hz, want.bw_hz) == 0);
+                double radio_fs = use_reference ? want.fs : ctx->ddc->fs_out;
+                if (radio_ready) {
+                    radio_ready = (demod_init(ctx->demod, want.mode, stereo, radio_fs, ctx->opus_sample_rate) == 0);
+                }
 
-    while (audio_thread_running) {
+                // Channel count changed (e.g. stereo WFM -> AM): restart the encoder
+                if (radio_ready && ctx->demod->ops->channels != ctx->opus_channels) {
+                    ctx->opus_channels = ctx->demod->ops->channels;
+                    if (tx) {
+                        opus_tx_destroy(tx);
+                        tx = NULL;
+                    }
+                    accum_len = 0;
+                }
+                if (!radio_ready) {
+                    fprintf(stderr, "[AUDIO] ERROR: DSP init failed for fs=%.0f\n", want.fs);
+                } else {
+                    squelch_init(&sq, &ctx->squelch, use_reference ? 0.0 : ctx->ddc->fs_out);
+                }
+            }
+            applied = want;
+            if (radio_ready && ctx->low_latency) {
+                ll_reset(&ll, want.fs, use_reference ? 1 : (size_t)ctx->ddc->decim,
+                         ctx->frame_ms, ctx->latency_target_ms);
+                printf("[AUDIO] Low latency: blocks of %zu..%zu samples (step %zu), target %.0f ms\n",
+                       ll.floor, ll.ceil, ll.align, ctx->latency_target_ms);
+            }
+        }
 
-        // Wait for enough IQ bytes
-        if (rb_available(&audio_rb) < (size_t)(AUDIO_CHUNK_SAMPLES * 2)) {
+        if (!radio_ready) {
             usleep(1000);
             continue;
         }
 
-        // Drain one chunk
-        rb_read(&audio_rb, raw_iq_chunk, AUDIO_CHUNK_SAMPLES * 2);
+        // Wait for enough IQ bytes: a fixed chunk, or in low-latency mode whatever is
+        // there once it covers min_block (sleeping about as long as the rest takes to arrive)
+        size_t n_iq = AUDIO_CHUNK_SAMPLES;
+        if (ctx->low_latency) {
+            size_t avail = rb_available(&d->audio_rb) / 2;
+            n_iq = ll_block(&ll, avail);
+            if (n_iq == 0) {
+                double wait_us = 1e6 * (double)(ll.min_block - avail) / applied.fs;
+                usleep((useconds_t)fmin(2000.0, fmax(100.0, wait_us)));
+                continue;
+            }
+        } else if (rb_available(&d->audio_rb) < (size_t)(AUDIO_CHUNK_SAMPLES * 2)) {
+            usleep(1000);
+            continue;
+        }
 
-        // Convert int8 IQ -> complex double
-        for (int i = 0; i < AUDIO_CHUNK_SAMPLES; ++i) {
-            double real = ((double)raw_iq_chunk[2*i]) / 128.0;
-            double imag = ((double)raw_iq_chunk[2*i + 1]) / 128.0;
-            audio_sig.signal_iq[i] = real + imag * I;
+        // Drain one block
+        size_t got = rb_read(&d->audio_rb, raw_iq_chunk, n_iq * 2);
+        n_iq = got / 2;
+        const uint64_t t_deq = lat_now_ns();
+        const double iq_bytes_per_s = 2.0 * applied.fs;
+        const uint64_t chunk_cap_ns = lat_timeline_lookup(&d->audio_tl, rd_bytes, iq_bytes_per_s);
+        rd_bytes += got;
+        const uint64_t chunk_end_ns = lat_timeline_lookup(&d->audio_tl, rd_bytes, iq_bytes_per_s);
+        if (chunk_end_ns && t_deq > chunk_end_ns) {
+            lat_hist_add(&lat_rb, t_deq - chunk_end_ns);
+            metrics_observe_ns(m_rb_wait, t_deq - chunk_end_ns);
         }
 
+        const double chunk_audio_s = (double)n_iq / applied.fs;
+        const int ch = ctx->opus_channels;
+
         // IQ -> PCM (output at AUDIO_FS)
-        int samples_gen = fm_radio_iq_to_pcm(ctx->radio, &audio_sig, pcm_out);
-        if (samples_gen <= 0) continue;
+        trace_begin("audio_demod");
+        int samples_gen;
+        bool sq_open = true;
+        if (!use_reference) {
+            // Extract the demod channel, then demodulate at the channel rate
+            int n_chan = ddc_process_s8(ctx->ddc, raw_iq_chunk, n_iq, chan_iq);
+            bool was_open = sq.open;
+            sq_open = squelch_update(&sq, chan_iq, (size_t)n_chan);
+            if (sq_open) {
+                if (!was_open && ctx->squelch.enabled) demod_reset(ctx->demod);
+                samples_gen = demod_process(ctx->demod, chan_iq, (size_t)n_chan, pcm_out);
+            } else {
+                // Closed: no demod tail, no encoder; the partial frame joins the gap
+                gap_samples += chunk_audio_s * (double)ctx->opus_sample_rate + (double)(accum_len / ch);
+                accum_len = 0;
+                samples_gen = 0;
+            }
+        } else {
+            // Reference path demodulates the tuner center at the full rate
+            // Convert int8 IQ -> complex double
+            for (size_t i = 0; i < n_iq; ++i) {
+                double real = ((double)raw_iq_chunk[2*i]) / 128.0;
+                double imag = ((double)raw_iq_chunk[2*i + 1]) / 128.0;
+                audio_sig.signal_iq[i] = real + imag * I;
+            }
+            audio_sig.n_signal = n_iq;
+            samples_gen = fm_radio_iq_to_pcm(&ctx->demod->fm, &audio_sig, pcm_out);
+        }
+        const uint64_t t_demod = lat_now_ns();
+        trace_end("audio_demod");
+        metrics_observe_ns(m_dsp, t_demod - t_deq);
+        if (ctx->low_latency) ll_update(&ll, applied.fs, n_iq, t_demod - t_deq);
+
+        cpu_audio_s += chunk_audio_s;
+        if (sq_open) open_audio_s += chunk_audio_s;
+        if (cpu_audio_s >= (double)AUDIO_CPU_REPORT_S) {
+            struct timespec cpu_t1;
+            clock_gettime(CLOCK_THREAD_CPUTIME_ID, &cpu_t1);
+            double cpu_s = (double)(cpu_t1.tv_sec - cpu_t0.tv_sec) + 1e-9 * (double)(cpu_t1.tv_nsec - cpu_t0.tv_nsec);
+            opus_tx_stats_t st;
+            opus_tx_get_stats(tx, &st);
+            uint64_t tx_bytes = (st.bytes_sent >= tx_bytes0) ? st.bytes_sent - tx_bytes0 : st.bytes_sent;
+            // The encoder's counters restart when it is recreated
+            metrics_add(m_tx_sent, (st.frames_sent >= tx_sent0) ? st.frames_sent - tx_sent0 : st.frames_sent);
+            metrics_add(m_tx_drop, (st.frames_dropped >= tx_drop0) ? st.frames_dropped - tx_drop0 : st.frames_dropped);
+            metrics_add(m_tx_reconn, (st.reconnects >= tx_reconn0) ? st.reconnects - tx_reconn0 : st.reconnects);
+            metrics_set(m_tx_queue, st.queue_depth);
+            printf("[AUDIO] %s: %.1f ms CPU per s of audio | squelch open %.0f%% | uplink %.0f B/s"
+                   " | tx queue %d (max %d) dropped %" PRIu64 "%s%s\n",
+                   ctx->demod->ops->name, 1e3 * cpu_s / cpu_audio_s, 100.0 * open_audio_s / cpu_audio_s,
+                   (double)tx_bytes / cpu_audio_s, st.queue_depth, st.queue_max, st.frames_dropped,
+                   (tx && !st.connected) ? " (gateway down)" : "",
+                   (ctx->demod->ops->channels == 2) ? (fm_stereo_locked(&ctx->demod->st) ? " (pilot locked)" : " (mono, no pilot)") : "");
+
+            opus_tx_take_latency(tx, &lat_enc, &lat_sent);
+            printf("[AUDIO] latency p50/p99 ms: rb_wait %.1f/%.1f | dequeued %.1f/%.1f | demod %.1f/%.1f"
+                   " | encoded %.1f/%.1f | sent %.1f/%.1f\n",
+                   1e-6 * lat_hist_quantile_ns(&lat_rb, 0.5),    1e-6 * lat_hist_quantile_ns(&lat_rb, 0.99),
+                   1e-6 * lat_hist_quantile_ns(&lat_deq, 0.5),   1e-6 * lat_hist_quantile_ns(&lat_deq, 0.99),
+                   1e-6 * lat_hist_quantile_ns(&lat_demod, 0.5), 1e-6 * lat_hist_quantile_ns(&lat_demod, 0.99),
+                   1e-6 * lat_hist_quantile_ns(&lat_enc, 0.5),   1e-6 * lat_hist_quantile_ns(&lat_enc, 0.99),
+                   1e-6 * lat_hist_quantile_ns(&lat_sent, 0.5),  1e-6 * lat_hist_quantile_ns(&lat_sent, 0.99));
+            if (ctx->low_latency) {
+                printf("[AUDIO] low latency: min block %zu samples (%.2f ms), DSP duty %.0f%%\n",
+                       ll.min_block, 1e3 * (double)ll.min_block / applied.fs, 100.0 * ll.duty);
+            }
+            publish_latency(d->id, cpu_audio_s, &lat_rb, &lat_deq, &lat_demod, &lat_enc, &lat_sent);
+            lat_hist_reset(&lat_rb);
+            lat_hist_reset(&lat_deq);
+            lat_hist_reset(&lat_demod);
+
+            cpu_t0 = cpu_t1;
+            cpu_audio_s = 0.0;
+            open_audio_s = 0.0;
+            tx_bytes0 = st.bytes_sent;
+            tx_sent0 = st.frames_sent;
+            tx_drop0 = st.frames_dropped;
+            tx_reconn0 = st.reconnects;
+        }
 
-        // Ensure TCP/Opus encoder is ready
+        if (samples_gen <= 0 && gap_samples < (double)frame_samples) continue;
+
+        // Ensure the Opus encoder exists (a slow or absent gateway only fills its queue)
         if (ensure_tx() != 0) {
-            // Drop audio while reconnecting (keeps draining to avoid backlog)
-            msleep_int(200);
+            accum_len = 0;
+            gap_samples = 0.0;
             continue;
         }
 
-        // Accumulate into exact Opus frames
+        // Squelched stretch: advance seq so the gateway keeps its clock
+        if (gap_samples >= (double)frame_samples) {
+            int gap_frames = (int)(gap_samples / (double)frame_samples);
+            gap_samples -= (double)gap_frames * (double)frame_samples;
+            opus_tx_send_gap(tx, gap_frames);
+        }
+
+        // Accumulate into exact Opus frames (interleaved int16 when stereo)
+        const int frame_len = frame_samples * ch;
+        const int total = samples_gen * ch;
         int idx = 0;
-        while (idx < samples_gen) {
-            int space = frame_samples - accum_len;
-            int take  = samples_gen - idx;
+        while (idx < total) {
+            int space = frame_len - accum_len;
+            int take  = total - idx;
             if (take > space) take = space;
 
+            // A frame starting here: its first sample is idx/ch output samples into the chunk
+            // (filter group delay, a few hundred us, is not subtracted)
+            if (accum_len == 0) {
+                frame_cap_ns = chunk_cap_ns
+                    ? chunk_cap_ns + (uint64_t)(1e9 * (double)(idx / ch) / (double)ctx->opus_sample_rate)
+                    : 0;
+            }
             memcpy(&pcm_accum[accum_len], &pcm_out[idx], (size_t)take * sizeof(int16_t));
             accum_len += take;
             idx += take;
 
-            if (accum_len == frame_samples) {
-                if (opus_tx_send_frame(tx, pcm_accum, frame_samples) != 0) {
-                    fprintf(stderr, "[AUDIO] WARN: opus_tx_send_frame failed. Reconnecting...\n");
-                    opus_tx_destroy(tx);
-                    tx = NULL;
-                    accum_len = 0; // drop partial frame for simplicity
-                    msleep_int(200);
-                    break; // exit inner loop; next outer iteration will reconnect
+            if (accum_len == frame_len) {
+                if (frame_cap_ns) {
+                    lat_hist_add(&lat_deq, t_deq - frame_cap_ns);
+                    lat_hist_add(&lat_demod, t_demod - frame_cap_ns);
+                    metrics_observe_ns(m_to_demod, t_demod - frame_cap_ns);
+                }
+                // Queues and returns; only an encoder error fails (frame dropped)
+                trace_begin("audio_encode");
+                int enc_rc = opus_tx_send_frame_at(tx, pcm_accum, frame_samples, frame_cap_ns);
+                trace_end("audio_encode");
+                if (enc_rc != 0) {
+                    fprintf(stderr, "[AUDIO] WARN: opus_encode failed, frame dropped.\n");
+                    metrics_add(m_enc_fail, 1);
+                } else {
+                    metrics_add(m_frames, 1);
                 }
                 accum_len = 0;
             }
@@ -361,55 +1679,53 @@ void* audio_thread_fn(void* arg) {
     free(raw_iq_chunk);
     free(pcm_out);
     free(audio_sig.signal_iq);
+    free(chan_iq);
     free(pcm_accum);
     return NULL;
 }
 
 // =========================================================
-// MAIN
-int main() {
-    char *raw_verbose = getenv_c("VERBOSE");
-    bool verbose_mode = (raw_verbose != NULL && strcmp(raw_verbose, "true") == 0);
-    if (raw_verbose) free(raw_verbose);
+// PIPELINE: one thread per device running the acquisition/PSD loop; the audio thread,
+// channel bank workers and source thread it starts inherit its CPU mask
+static void* pipeline_thread_fn(void *arg) {
+    rf_dev_t *d = (rf_dev_t*)arg;
 
-    char *ipc_addr = getenv_c("IPC_ADDR");
-    if (!ipc_addr) ipc_addr = strdup("ipc:///tmp/rf_engine");
-
-    printf("[RF] Starting. IPC=%s, VERBOSE=%d\n", ipc_addr, verbose_mode);
-
-    zmq_channel = zpair_init(ipc_addr, on_command_received, verbose_mode ? 1 : 0);
-    if (!zmq_channel) {
-        fprintf(stderr, "[RF] FATAL: Failed to initialize ZMQ at %s\n", ipc_addr);
-        if (ipc_addr) free(ipc_addr);
-        return 1;
+    if (d->pinned && pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &d->cpus) != 0) {
+        fprintf(stderr, "[RF] dev%d: Warning: could not pin to RF_DEVICE_CPUS\n", d->id);
     }
-    zpair_start(zmq_channel);
-
-    // Init HackRF
-    printf("[RF] Initializing HackRF Library...\n");
-    while (hackrf_init() != HACKRF_SUCCESS) {
-        fprintf(stderr, "[RF] Error: HackRF Init failed. Retrying in 5s...\n");
-        sleep(5);
+    // An RT_POLICY "psd" / "devN/psd" entry overrides RF_DEVICE_CPUS
+    char rt_label[RT_LABEL_LEN];
+    snprintf(rt_label, sizeof(rt_label), "dev%d/psd", d->id);
+    rt_policy_apply("psd", rt_label);
+
+    printf("[RF] dev%d: Opening %s source%s%s...\n", d->id, sdr_backend_name(d->source.backend),
+           d->serial[0] ? " " : "", d->serial);
+    while ((d->device = sdr_open(&d->source)) == NULL) {
+        if (d->source.backend != SDR_BACKEND_HACKRF) {
+            // A missing file will not appear by waiting
+            fprintf(stderr, "[RF] FATAL: cannot open %s source\n", sdr_backend_name(d->source.backend));
+            exit(1);
+        }
+        fprintf(stderr, "[RF] dev%d: Warning: Initial Open failed. Retrying in %ds...\n", d->id, SDR_OPEN_RETRY_S);
+        sleep(SDR_OPEN_RETRY_S);
     }
-    printf("[RF] HackRF Library Initialized.\n");
+    printf("[RF] dev%d: %s source opened.\n", d->id, sdr_backend_name(d->source.backend));
 
-    // Open device
-    while (hackrf_open(&device) != HACKRF_SUCCESS) {
-        fprintf(stderr, "[RF] Warning: Initial Open failed. Retrying in 5s...\n");
-        sleep(5);
-    }
-    printf("[RF] HackRF Device Opened.\n");
+    d->recorder = iq_rec_create();
+    if (!d->recorder) fprintf(stderr, "[RF] dev%d: Warning: IQ recorder unavailable\n", d->id);
 
     // Initialize BOTH ring buffers
     size_t FIXED_BUFFER_SIZE = 100 * 1024 * 1024;
-    rb_init(&rb, FIXED_BUFFER_SIZE);
+    rb_init(&d->rb, FIXED_BUFFER_SIZE);
     size_t AUDIO_BUFFER_SIZE = AUDIO_CHUNK_SAMPLES * 2 * 8;
-    rb_init(&audio_rb, AUDIO_BUFFER_SIZE);
+    rb_init(&d->audio_rb, AUDIO_BUFFER_SIZE);
 
-    printf("[RF] Ring Buffers: big=%zu MB, audio=%zu KB\n",
+    printf("[RF] dev%d: Ring Buffers: big=%zu MB, audio=%zu KB\n", d->id,
            FIXED_BUFFER_SIZE / (1024*1024), AUDIO_BUFFER_SIZE / 1024);
+    dev_metrics_register(d);
 
     bool needs_recovery = false;
+    uint64_t last_retune_seq = 0;
 
     // Local copies
     SDR_cfg_t local_hack_cfg;
@@ -417,122 +1733,214 @@ int main() {
     PsdConfig_t local_psd_cfg;
     DesiredCfg_t local_desired_cfg;
 
-    int8_t *linear_buffer = NULL;
-    double *f_axis = NULL;
-    double *p_vals = NULL;
-
     // audio resources
-    fm_radio_t *radio_ptr = (fm_radio_t*)malloc(sizeof(fm_radio_t));
-    if (!radio_ptr) {
-        fprintf(stderr, "[RF] FATAL: malloc radio_ptr failed\n");
-        return 1;
+    demod_t *demod_ptr = (demod_t*)calloc(1, sizeof(demod_t));
+    if (!demod_ptr) {
+        fprintf(stderr, "[RF] FATAL: malloc demod_ptr failed\n");
+        exit(1);
+    }
+
+    ddc_t *ddc_ptr = (ddc_t*)calloc(1, sizeof(ddc_t));
+    if (!ddc_ptr) {
+        fprintf(stderr, "[RF] FATAL: malloc ddc_ptr failed\n");
+        exit(1);
     }
-    memset(radio_ptr, 0, sizeof(fm_radio_t));
 
     bool audio_thread_created = false;
-    double last_radio_sample_rate = 0.0;
+    audio_dsp_cfg_t last_audio_cfg = {0};
 
     // NEW: audio streaming context
     audio_stream_ctx_t audio_ctx;
-    audio_stream_ctx_defaults(&audio_ctx, radio_ptr);
-
-    fprintf(stderr, "[AUDIO] Stream target TCP %s:%d (Opus sr=%d ch=%d frame_ms=%d bitrate=%d)\n",
-            audio_ctx.tcp_host, audio_ctx.tcp_port,
+    audio_stream_ctx_defaults(&audio_ctx, d, demod_ptr, ddc_ptr);
+    d->audio = &audio_ctx;
+
+    const bool audio_rtp = (audio_ctx.transport == OPUS_TX_RTP_UDP);
+    const bool audio_shm = (audio_ctx.transport == OPUS_TX_SHM);
+    fprintf(stderr, "[AUDIO] dev%d stream target %s %s:%d (Opus sr=%d ch=%d frame_ms=%g bitrate=%d disc=%s stereo=%d%s)\n",
+            d->id, audio_rtp ? "RTP/UDP" : (audio_shm ? "SHM" : "TCP"),
+            audio_rtp ? audio_ctx.rtp_host : (audio_shm ? audio_ctx.shm_name : audio_ctx.tcp_host),
+            audio_rtp ? audio_ctx.rtp_port : (audio_shm ? 0 : audio_ctx.tcp_port),
             audio_ctx.opus_sample_rate, audio_ctx.opus_channels,
-            audio_ctx.frame_ms, audio_ctx.bitrate);
+            audio_ctx.frame_ms, audio_ctx.bitrate,
+            audio_ctx.fast_disc ? "fast" : "reference", audio_ctx.stereo,
+            audio_ctx.low_latency ? " low-latency" : "");
+    if (audio_ctx.squelch.enabled) {
+        fprintf(stderr, "[AUDIO] Squelch %s %.1f dB%s, hysteresis %.1f dB, hang %d ms, dtx=%d\n",
+                audio_ctx.squelch.auto_floor ? "floor +" : "at", audio_ctx.squelch.open_db,
+                audio_ctx.squelch.auto_floor ? "" : "FS", audio_ctx.squelch.hyst_db,
+                audio_ctx.squelch.hang_ms, audio_ctx.dtx);
+    }
+    if (audio_shm) {
+        fprintf(stderr, "[AUDIO] Read with: python3 shm_reader.py %s\n", audio_ctx.shm_name);
+    }
+    if (audio_ctx.transport == OPUS_TX_RTP_UDP) {
+        // udpsrc joins the group itself when address is multicast
+        fprintf(stderr, "[AUDIO] Receive with: gst-launch-1.0 udpsrc address=%s port=%d caps=\"application/x-rtp,media=audio,"
+                "encoding-name=OPUS,clock-rate=48000,payload=%d\" ! rtpjitterbuffer ! rtpopusdepay ! opusdec ! autoaudiosink\n",
+                audio_ctx.rtp_host, audio_ctx.rtp_port, audio_ctx.rtp_pt);
+    }
+
+    // Channel bank shares the Opus settings of the main stream
+    if (audio_ctx.transport == OPUS_TX_RTP_UDP) {
+        d->chan_default_host = audio_ctx.rtp_host;
+        d->chan_default_port = audio_ctx.rtp_port;
+        d->chan_port_step = 2;
+    } else if (audio_ctx.transport == OPUS_TX_SHM) {
+        d->chan_default_host = audio_ctx.shm_name;
+        d->chan_shm = true;
+    } else {
+        d->chan_default_host = audio_ctx.tcp_host;
+        d->chan_default_port = audio_ctx.tcp_port;
+    }
+    {
+        opus_tx_cfg_t bank_opus;
+        memset(&bank_opus, 0, sizeof(bank_opus));
+        bank_opus.sample_rate = audio_ctx.opus_sample_rate;
+        bank_opus.channels    = 1;
+        bank_opus.bitrate     = audio_ctx.bitrate;
+        bank_opus.complexity  = audio_ctx.complexity;
+        bank_opus.vbr         = audio_ctx.vbr;
+        bank_opus.dtx         = audio_ctx.dtx;
+        bank_opus.queue_frames = audio_ctx.tx_queue_frames;
+        bank_opus.frame_ms    = audio_ctx.frame_ms;
+        bank_opus.transport   = audio_ctx.transport;
+        bank_opus.rtp_ssrc    = audio_ctx.rtp_ssrc;     // chan_bank offsets it per channel
+        bank_opus.rtp_pt      = audio_ctx.rtp_pt;
+        bank_opus.rtp_ttl     = audio_ctx.rtp_ttl;
+
+        char *raw_spacing = getenv_c("PFB_SPACING_HZ");
+        double spacing = raw_spacing ? atof(raw_spacing) : CHAN_BANK_SPACING_HZ;
+        if (raw_spacing) free(raw_spacing);
+
+        if (chan_bank_start(&d->chan_bank, &bank_opus, &audio_ctx.squelch, audio_ctx.frame_ms, spacing) != 0) {
+            fprintf(stderr, "[RF] dev%d: Warning: failed to start channel bank\n", d->id);
+        } else {
+            d->chan_bank.m_pass_ns = metrics_histogram("dev%d/chan/pass_ns", d->id);
+            d->chan_bank.m_passes = metrics_counter("dev%d/chan/passes", d->id);
+            metrics_gauge_fn(rb_fill_pct, &d->chan_bank.rb, "dev%d/chan_rb/fill_pct", d->id);
+        }
+    }
 
     while (1) {
-        if (!config_received) {
+        if (!d->config_received) {
             usleep(50000);
             continue;
         }
 
-        if (device == NULL) { needs_recovery = true; goto error_handler; }
+        if (d->device == NULL) { needs_recovery = true; goto error_handler; }
 
         /* Snapshot global config structs (atomically used below) */
-        memcpy(&local_hack_cfg, &hack_cfg, sizeof(SDR_cfg_t));
-        memcpy(&local_rb_cfg, &rb_cfg, sizeof(RB_cfg_t));
-        memcpy(&local_psd_cfg, &psd_cfg, sizeof(PsdConfig_t));
-        memcpy(&local_desired_cfg, &desired_config, sizeof(DesiredCfg_t));
-        config_received = false;
-
-        if (local_rb_cfg.total_bytes > rb.size) {
-            printf("[RF] Error: Request bytes (%zu) exceeds buffer size!\n", local_rb_cfg.total_bytes);
+        memcpy(&local_hack_cfg, &d->hack_cfg, sizeof(SDR_cfg_t));
+        memcpy(&local_rb_cfg, &d->rb_cfg, sizeof(RB_cfg_t));
+        memcpy(&local_psd_cfg, &d->psd_cfg, sizeof(PsdConfig_t));
+        memcpy(&local_desired_cfg, &d->desired_config, sizeof(DesiredCfg_t));
+        d->config_received = false;
+
+        if (local_rb_cfg.total_bytes > d->rb.size) {
+            printf("[RF] dev%d: Error: Request bytes (%zu) exceeds buffer size!\n", d->id, local_rb_cfg.total_bytes);
             continue;
         }
 
-        /* re-alloc PSD arrays */
-        if (f_axis) free(f_axis);
-        if (p_vals) free(p_vals);
-        f_axis = (double*)malloc((size_t)local_psd_cfg.nperseg * sizeof(double));
-        p_vals = (double*)malloc((size_t)local_psd_cfg.nperseg * sizeof(double));
-
         // If RX not running yet -> apply cfg and start RX
-        if (!rx_running) {
-            hackrf_apply_cfg(device, &local_hack_cfg);
-            if (hackrf_start_rx(device, rx_callback, NULL) != HACKRF_SUCCESS) {
-                fprintf(stderr, "[RF] Error: hackrf_start_rx failed on initial start.\n");
+        if (!d->rx_running) {
+            if (sdr_apply_cfg(d->device, &local_hack_cfg) < 0) {
+                fprintf(stderr, "[RF] dev%d: Error: sdr_apply_cfg failed on initial start.\n", d->id);
+                needs_recovery = true; goto error_handler;
+            }
+            iq_rec_set_tuner(d->recorder, &local_hack_cfg);
+            if (sdr_start(d->device, rx_callback, d) != 0) {
+                fprintf(stderr, "[RF] dev%d: Error: sdr_start failed on initial start.\n", d->id);
                 needs_recovery = true; goto error_handler;
             }
-            rx_running = true;
-            last_applied_cfg = local_hack_cfg;
-            last_cfg_valid = true;
+            d->rx_running = true;
+            d->last_applied_cfg = local_hack_cfg;
+            d->last_cfg_valid = true;
         } else {
             // If RX running and config differs from last applied -> apply new cfg (but do not restart RX)
-            if (!last_cfg_valid || !sdr_cfg_equal(&local_hack_cfg, &last_applied_cfg)) {
+            if (!d->last_cfg_valid || !sdr_cfg_equal(&local_hack_cfg, &d->last_applied_cfg)) {
                 printf("[RF] New SDR config differs from last - applying.\n");
-                hackrf_apply_cfg(device, &local_hack_cfg);
-                last_applied_cfg = local_hack_cfg;
-                last_cfg_valid = true;
+                if (sdr_apply_cfg(d->device, &local_hack_cfg) < 0) {
+                    fprintf(stderr, "[RF] dev%d: Error: sdr_apply_cfg failed.\n", d->id);
+                    needs_recovery = true; goto error_handler;
+                }
+                // Everything still queued was captured with the old settings
+                rb_discard(&d->rb);
+                iq_rec_set_tuner(d->recorder, &local_hack_cfg);
+                d->last_applied_cfg = local_hack_cfg;
+                d->last_cfg_valid = true;
             } else {
-                // identical config -> skip hackrf_apply_cfg() to avoid interruption
+                // identical config -> skip sdr_apply_cfg() to avoid interruption
             }
         }
 
-        // Initialize or re-init FM radio only if sample_rate changed
-        if (!audio_thread_created || fabs(last_radio_sample_rate - local_hack_cfg.sample_rate) > 1e-6) {
-            // IMPORTANT: output rate must match audio_ctx.opus_sample_rate (typically 48000)
-            fm_radio_init(radio_ptr, local_hack_cfg.sample_rate, audio_ctx.opus_sample_rate, 75);
-            last_radio_sample_rate = local_hack_cfg.sample_rate;
+        dev_graph_follow_tuner(d);
+
+        // Push sample rate / demod channel changes to the audio thread (applied there)
+        audio_dsp_cfg_t audio_cfg;
+        audio_dsp_cfg_from(&local_desired_cfg, &local_hack_cfg, audio_ctx.stereo, &audio_cfg);
+        if (!audio_thread_created || memcmp(&audio_cfg, &last_audio_cfg, sizeof(audio_cfg)) != 0) {
+            audio_request_config(&audio_ctx, &audio_cfg);
+            last_audio_cfg = audio_cfg;
         }
 
+        chan_bank_set_tuner(&d->chan_bank, local_hack_cfg.sample_rate, (double)local_hack_cfg.center_freq);
+
         // Start audio thread once (it will keep running and drain audio_rb)
         if (!audio_thread_created) {
-            if (pthread_create(&audio_thread, NULL, audio_thread_fn, (void*)&audio_ctx) == 0) {
+            if (pthread_create(&d->audio_thread, NULL, audio_thread_fn, (void*)&audio_ctx) == 0) {
                 audio_thread_created = true;
             } else {
-                fprintf(stderr, "[RF] Warning: failed to create audio thread\n");
+                fprintf(stderr, "[RF] dev%d: Warning: failed to create audio thread\n", d->id);
             }
         }
 
         // Wait until big buffer has filled (do NOT stop RX) - time-based timeout
+        uint64_t t_acq = lat_now_ns();
         uint64_t start_ms = now_ms();
         const uint64_t timeout_ms = 5000;
         bool bigbuffer_full = false;
 
+        trace_begin("psd_fill_wait");
         while (now_ms() - start_ms < timeout_ms) {
-            if (rb_available(&rb) >= local_rb_cfg.total_bytes) { bigbuffer_full = true; break; }
+            if (rb_available(&d->rb) >= local_rb_cfg.total_bytes) { bigbuffer_full = true; break; }
             usleep(5000);
         }
+        trace_end("psd_fill_wait");
 
         if (!bigbuffer_full) {
-            fprintf(stderr, "[RF] Error: Acquisition Timeout.\n");
+            fprintf(stderr, "[RF] dev%d: Error: Acquisition Timeout.\n", d->id);
             needs_recovery = true;
             goto error_handler;
         }
 
-        // Read linear buffer for full-band PSD while RX remains running
-        linear_buffer = (int8_t*)malloc(local_rb_cfg.total_bytes);
-        if (linear_buffer) {
-            rb_read(&rb, linear_buffer, local_rb_cfg.total_bytes);
-            signal_iq_t *sig = load_iq_from_buffer(linear_buffer, local_rb_cfg.total_bytes);
-
-            double *freq = (double*)malloc((size_t)local_psd_cfg.nperseg * sizeof(double));
-            double *psd  = (double*)malloc((size_t)local_psd_cfg.nperseg * sizeof(double));
+        sdr_retune_t retune;
+        uint64_t retune_seq = sdr_get_retune(d->device, &retune);
+        if (retune_seq != last_retune_seq) {
+            last_retune_seq = retune_seq;
+            publish_retune(d, &retune);
+        }
 
-            if (sig && freq && psd) {
-                execute_welch_psd(sig, &local_psd_cfg, freq, psd);
+        // Read linear buffer for full-band PSD while RX remains running (buffers reused
+        // across frames of the same configuration)
+        if (psd_frame_prepare(d, &local_rb_cfg, &local_psd_cfg) == 0) {
+            psd_frame_t *pf = &d->psd;
+            rb_read(&d->rb, pf->raw, local_rb_cfg.total_bytes);
+            double *freq = pf->freq;
+            double *psd  = pf->psd;
+
+            uint64_t t_comp = lat_now_ns();
+            metrics_observe_ns(d->m.psd_wait, t_comp - t_acq);
+
+            if (load_iq_into(&pf->sig, local_rb_cfg.total_bytes / 2, pf->raw, local_rb_cfg.total_bytes) == 0) {
+                trace_begin("welch");
+                execute_welch_psd_ws(&pf->ws, &pf->sig, freq, psd);
+                trace_end("welch");
+                trace_begin("scale");
                 scale_psd(psd, local_psd_cfg.nperseg, local_desired_cfg.scale);
+                trace_end("scale");
+                uint64_t t_pub = lat_now_ns();
+                metrics_observe_ns(d->m.psd_compute, t_pub - t_comp);
+                metrics_add(d->m.psd_computed, 1);
 
                 double half_span = local_desired_cfg.span / 2.0;
                 int start_idx = 0, end_idx = local_psd_cfg.nperseg - 1;
@@ -545,43 +1953,299 @@ int main() {
                 }
                 int valid_len = end_idx - start_idx + 1;
                 if (valid_len > 0) {
-                    publish_results(&freq[start_idx], &psd[start_idx], valid_len, &local_hack_cfg);
+                    trace_begin("publish");
+                    publish_results(d, &freq[start_idx], &psd[start_idx], valid_len, &local_hack_cfg,
+                                    local_desired_cfg.seq);
+                    trace_end("publish");
+                    d->psd_frames++;
+                    metrics_observe_ns(d->m.psd_publish, lat_now_ns() - t_pub);
+                    metrics_add(d->m.psd_published, 1);
                 } else {
-                    printf("[RF] Warning: Span resulted in 0 bins.\n");
+                    printf("[RF] dev%d: Warning: Span resulted in 0 bins.\n", d->id);
                 }
             }
-
-            free(linear_buffer);
-            if (freq) free(freq);
-            if (psd) free(psd);
-            free_signal_iq(sig);
         }
 
         continue;
 
 error_handler:
         // Try to recover hardware
-        if (rx_running && device) {
-            hackrf_stop_rx(device);
-            rx_running = false;
+        if (d->rx_running && d->device) {
+            sdr_stop(d->device);
+            d->rx_running = false;
         }
         if (needs_recovery) {
-            recover_hackrf();
+            recover_sdr(d);
             needs_recovery = false;
-            last_cfg_valid = false; // force reapply on next good config
+            last_retune_seq = 0;    // a reopened device counts from zero
+            d->last_cfg_valid = false; // force reapply on next good config
         }
     }
 
     // Cleanup (unreachable normally)
-    audio_thread_running = false;
-    if (audio_thread_created) pthread_join(audio_thread, NULL);
-    if (radio_ptr) free(radio_ptr);
-    if (f_axis) free(f_axis);
-    if (p_vals) free(p_vals);
-    zpair_close(zmq_channel);
-    rb_free(&rb);
-    rb_free(&audio_rb);
-    if (ipc_addr) free(ipc_addr);
+    d->audio_thread_running = false;
+    if (audio_thread_created) pthread_join(d->audio_thread, NULL);
+    free(d->graph_spec);
+    d->graph_spec = NULL;
+    char graph_err[64];
+    dev_graph_rebuild(d, graph_err, sizeof(graph_err));
+    chan_bank_stop(&d->chan_bank);
+    iq_rec_destroy(d->recorder);
+    shm_ring_destroy(d->psd_shm);
+    if (demod_ptr) {
+        demod_free(demod_ptr);
+        free(demod_ptr);
+    }
+    if (ddc_ptr) {
+        ddc_free(ddc_ptr);
+        free(ddc_ptr);
+    }
+    psd_workspace_release(&d->psd.ws);
+    arena_free(&d->psd.arena);
+    rb_free(&d->rb);
+    rb_free(&d->audio_rb);
+    return NULL;
+}
+
+// =========================================================
+// DEVICES FROM ENV
+
+/**
+ * RF_DEVICES: unset = one device (first HackRF / the SDR_BACKEND source);
+ * "all" = every HackRF on the bus; "serial,serial,..." = those boards (trailing digits are enough);
+ * a count N with SDR_BACKEND=file|sim = N independent software sources.
+ * RF_DEVICE_CPUS: one CPU list per device separated by ';' ("0-1;2-3"); unset with more than one
+ * device = the CPUs this process may use, split into equal contiguous groups.
+ */
+static int rf_devices_from_env(void) {
+    const char *env_dev  = getenv("RF_DEVICES");
+    const char *env_cpus = getenv("RF_DEVICE_CPUS");
+    char serials[RF_MAX_DEVICES][SDR_SERIAL_LEN];
+    int n = 0;
+
+    memset(serials, 0, sizeof(serials));
+    if (!env_dev || !env_dev[0]) {
+        n = 1;
+    } else if (sdr_source.backend != SDR_BACKEND_HACKRF) {
+        n = atoi(env_dev);
+        if (n < 1 || n > RF_MAX_DEVICES) {
+            fprintf(stderr, "[RF] RF_DEVICES with a %s source is a count (1..%d)\n",
+                    sdr_backend_name(sdr_source.backend), RF_MAX_DEVICES);
+            return -1;
+        }
+    } else if (strcmp(env_dev, "all") == 0) {
+        n = sdr_hackrf_list(serials, RF_MAX_DEVICES);
+        if (n < 0) return -1;
+        if (n == 0) {
+            fprintf(stderr, "[RF] Warning: RF_DEVICES=all found no HackRF, waiting for the first one\n");
+            n = 1;
+        }
+    } else {
+        char *copy = strdup(env_dev);
+        char *save = NULL;
+        for (char *tok = strtok_r(copy, ", ", &save); tok && n < RF_MAX_DEVICES; tok = strtok_r(NULL, ", ", &save)) {
+            snprintf(serials[n++], SDR_SERIAL_LEN, "%s", tok);
+        }
+        free(copy);
+        if (n == 0) return -1;
+    }
+
+    // CPU groups: explicit, or an even split of our affinity mask
+    cpu_set_t allowed;
+    int n_allowed = 0, cpu_ids[CPU_SETSIZE];
+    if (sched_getaffinity(0, sizeof(allowed), &allowed) == 0) {
+        for (int c = 0; c < CPU_SETSIZE; c++) if (CPU_ISSET(c, &allowed)) cpu_ids[n_allowed++] = c;
+    }
+    char *cpu_copy = env_cpus ? strdup(env_cpus) : NULL;
+    char *cpu_save = NULL;
+    char *cpu_tok = cpu_copy ? strtok_r(cpu_copy, ";", &cpu_save) : NULL;
+    int per = (n > 1) ? n_allowed / n : 0;
+    if (!env_cpus && n > 1 && per == 0) {
+        fprintf(stderr, "[RF] Warning: %d CPUs for %d devices, pipelines left unpinned\n", n_allowed, n);
+    }
+
+    for (int i = 0; i < n; i++) {
+        rf_dev_t *d = &rf_devs[i];
+        d->id = i;
+        memcpy(d->serial, serials[i], sizeof(d->serial));
+        d->source = sdr_source;
+        d->source.serial = d->serial[0] ? d->serial : NULL;
+        if (i > 0) d->source.seed = sdr_source.seed + 0x9E3779B9u * (uint32_t)i;   // distinct noise per sim device
+        d->chan_default_host = AUDIO_TCP_DEFAULT_HOST;
+        d->chan_default_port = AUDIO_TCP_DEFAULT_PORT;
+        d->chan_port_step = 1;
+        pthread_mutex_init(&d->graph_lock, NULL);
+        pthread_mutex_init(&d->graph_ctl, NULL);
+
+        if (cpu_tok) {
+            if (parse_cpu_list(cpu_tok, &d->cpus) <= 0) {
+                fprintf(stderr, "[RF] Bad RF_DEVICE_CPUS entry '%s'\n", cpu_tok);
+                free(cpu_copy);
+                return -1;
+            }
+            d->pinned = true;
+            cpu_tok = strtok_r(NULL, ";", &cpu_save);
+        } else if (!env_cpus && per > 0) {
+            CPU_ZERO(&d->cpus);
+            for (int k = 0; k < per; k++) CPU_SET(cpu_ids[i * per + k], &d->cpus);
+            d->pinned = true;
+        }
+    }
+    free(cpu_copy);
+    n_rf_devs = n;
+
+    for (int i = 0; i < n; i++) {
+        rf_dev_t *d = &rf_devs[i];
+        char cpus[128] = "any";
+        if (d->pinned) {
+            size_t used = 0;
+            for (int c = 0; c < CPU_SETSIZE && used + 8 < sizeof(cpus); c++) {
+                if (CPU_ISSET(c, &d->cpus)) used += (size_t)snprintf(cpus + used, sizeof(cpus) - used, "%s%d", used ? "," : "", c);
+            }
+        }
+        printf("[RF] dev%d: %s %s, CPUs %s\n", d->id, sdr_backend_name(d->source.backend),
+               d->serial[0] ? d->serial : (d->source.backend == SDR_BACKEND_HACKRF ? "(first board)" : "-"), cpus);
+    }
     return 0;
 }
 
+// =========================================================
+// MAIN
+int main() {
+    char *raw_verbose = getenv_c("VERBOSE");
+    bool verbose_mode = (raw_verbose != NULL && strcmp(raw_verbose, "true") == 0);
+    if (raw_verbose) free(raw_verbose);
+
+    char *ipc_addr = getenv_c("IPC_ADDR");
+    if (!ipc_addr) ipc_addr = strdup("ipc:///tmp/rf_engine");
+
+    printf("[RF] Starting. IPC=%s, VERBOSE=%d\n", ipc_addr, verbose_mode);
+
+    // RT_POLICY: per-role CPU placement / scheduling (see rt_policy.h). Loaded before any
+    // thread exists; every thread applies its own entry when it starts.
+    char *raw_rt = getenv_c("RT_POLICY");
+    char rt_err[160];
+    if (rt_policy_load(raw_rt, rt_err, sizeof(rt_err)) != 0) {
+        fprintf(stderr, "[RF] FATAL: invalid RT_POLICY: %s\n", rt_err);
+        free(raw_rt);
+        return 1;
+    }
+    free(raw_rt);
+    rt_policy_lock_memory();
+    rt_policy_apply("main", NULL);
+
+    // TRACE=1: record trace spans from the start (trace_start / trace_stop at runtime).
+    // While recording, SIGINT / SIGTERM dump them to TRACE_FILE before exiting.
+    char *raw_trace = getenv_c("TRACE");
+    if (raw_trace && (strcmp(raw_trace, "1") == 0 || strcmp(raw_trace, "true") == 0)) trace_enable(true, true);
+    free(raw_trace);
+    trace_file = getenv_c("TRACE_FILE");
+    if (!trace_file) trace_file = strdup(TRACE_DEFAULT_FILE);
+    struct sigaction sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = on_stop_signal;
+    sigemptyset(&sa.sa_mask);
+    sigaction(SIGINT, &sa, NULL);
+    sigaction(SIGTERM, &sa, NULL);
+
+    // WORK_POOL_THREADS: shared DSP pool (Welch slices, channel chains). Unset = one
+    // worker per core, 0 = no pool (everything runs on the calling thread).
+    char *raw_pool = getenv_c("WORK_POOL_THREADS");
+    int pool_threads = raw_pool ? atoi(raw_pool) : -1;
+    free(raw_pool);
+    if (pool_threads != 0 && work_pool_start(pool_threads) != 0) {
+        fprintf(stderr, "[RF] Warning: work pool unavailable, DSP runs on the pipeline threads\n");
+    }
+
+    // Sample sources (HackRF unless SDR_BACKEND says otherwise), one pipeline each.
+    // The device table is complete before the first command can arrive.
+    if (sdr_source_from_env(&sdr_source) != 0) {
+        fprintf(stderr, "[RF] FATAL: invalid SDR_BACKEND settings\n");
+        return 1;
+    }
+    if (rf_devices_from_env() != 0) {
+        fprintf(stderr, "[RF] FATAL: invalid RF_DEVICES / RF_DEVICE_CPUS\n");
+        return 1;
+    }
+
+    zmq_channel = zpair_init(ipc_addr, on_command_received, verbose_mode ? 1 : 0);
+    if (!zmq_channel) {
+        fprintf(stderr, "[RF] FATAL: Failed to initialize ZMQ at %s\n", ipc_addr);
+        if (ipc_addr) free(ipc_addr);
+        return 1;
+    }
+    zpair_start(zmq_channel);
+
+    char *raw_psd_tr = getenv_c("PSD_TRANSPORT");
+    if (raw_psd_tr && strcmp(raw_psd_tr, "shm") == 0) {
+        char *raw_psd_shm = getenv_c("PSD_SHM_NAME");
+        const char *base = raw_psd_shm ? raw_psd_shm : PSD_SHM_DEFAULT_NAME;
+        for (int i = 0; i < n_rf_devs; i++) {
+            char name[128];
+            if (i == 0) snprintf(name, sizeof(name), "%s", base);
+            else snprintf(name, sizeof(name), "%s_dev%d", base, i);
+            rf_devs[i].psd_shm = shm_ring_create(name, PSD_SHM_BYTES, NULL);
+            if (!rf_devs[i].psd_shm) fprintf(stderr, "[RF] Warning: dev%d PSD shm ring unavailable, publishing over ZMQ\n", i);
+        }
+        if (raw_psd_shm) free(raw_psd_shm);
+    }
+    if (raw_psd_tr) free(raw_psd_tr);
+
+    // RF_GRAPH: dataflow graph (JSON file, see dataflow.h) for dev0, built after its first config
+    const char *env_graph = getenv("RF_GRAPH");
+    if (env_graph && env_graph[0]) {
+        FILE *gf = fopen(env_graph, "rb");
+        char *txt = NULL;
+        long sz = -1;
+        if (gf && fseek(gf, 0, SEEK_END) == 0 && (sz = ftell(gf)) > 0 && fseek(gf, 0, SEEK_SET) == 0) {
+            txt = (char*)calloc(1, (size_t)sz + 1);
+            if (txt && fread(txt, 1, (size_t)sz, gf) != (size_t)sz) {
+                free(txt);
+                txt = NULL;
+            }
+        }
+        if (gf) fclose(gf);
+        cJSON *spec = txt ? cJSON_Parse(txt) : NULL;
+        free(txt);
+        if (!spec) {
+            fprintf(stderr, "[RF] FATAL: RF_GRAPH %s is not a readable JSON graph\n", env_graph);
+            return 1;
+        }
+        rf_devs[0].graph_spec = cJSON_PrintUnformatted(spec);
+        rf_devs[0].graph_pending = true;
+        cJSON_Delete(spec);
+        printf("[RF] dev0: graph from %s\n", env_graph);
+    }
+
+    for (int i = 0; i < n_rf_devs; i++) {
+        if (pthread_create(&rf_devs[i].thread, NULL, pipeline_thread_fn, &rf_devs[i]) != 0) {
+            fprintf(stderr, "[RF] FATAL: cannot start the dev%d pipeline\n", i);
+            return 1;
+        }
+    }
+
+    // Effective placement, once the pipelines, the listener and the first callbacks are up
+    sleep(RT_REPORT_DELAY_S);
+    rt_policy_report();
+
+    // Per-device throughput report, then the metrics registry ({"stats":..})
+    uint64_t t_rep = now_ms();
+    while (!stop_requested) {
+        sleep(1);
+        uint64_t t = now_ms();
+        if (t - t_rep < RF_THROUGHPUT_REPORT_S * 1000ULL) continue;
+        publish_throughput((double)(t - t_rep) / 1000.0);
+        send_stats(NULL);
+        t_rep = t;
+    }
+
+    // SIGINT / SIGTERM: the pipelines never return, so leave from here
+    if (trace_enabled()) {
+        long n = trace_dump(trace_file);
+        if (n >= 0) printf("[TRACE] %ld events -> %s\n", n, trace_file);
+        else fprintf(stderr, "[TRACE] ERROR: cannot write %s\n", trace_file);
+    }
+    printf("[RF] Stopped by signal.\n");
+    fflush(stdout);
+    _exit(0);
+}
@@ -12,6 +12,9 @@ SERVER_WS = f"ws://localhost:4000/ws/sensor/{SENSOR_ID}" #"wss://rsm.ane.gov.co:
 HDR_FMT = "!IIIHH"  # magic, seq, sample_rate, channels, payload_len
 HDR_SIZE = struct.calcsize(HDR_FMT)
 MAGIC = 0x4F505530  # 'OPU0'
+MAGIC_TS = 0x4F505531  # 'OPU1': header + TS_FMT + payload (OPUS_TS_EXT=1 en el motor)
+TS_FMT = "!QQ"  # captura de la primera muestra IQ, salida del encoder (ns Unix)
+TS_SIZE = struct.calcsize(TS_FMT)
 
 CFG_TEXT = f'{{"sensor_id":"{SENSOR_ID}","codec":"opus","sample_rate":48000,"channels":1,"frame_ms":20}}'
 
@@ -36,21 +39,31 @@ async def handle_client(reader, writer):
     bytes_ = 0
     t0 = time.time()
     last_seq = None
+    lat_ms = []
 
     try:
         while True:
             hdr = await reader.readexactly(HDR_SIZE)
             magic, seq, sr, ch, plen = struct.unpack(HDR_FMT, hdr)
 
-            if magic != MAGIC:
+            if magic == MAGIC_TS:
+                cap_ns, _enc_ns = struct.unpack(TS_FMT, await reader.readexactly(TS_SIZE))
+                if cap_ns:
+                    lat_ms.append((time.time_ns() - cap_ns) / 1e6)
+                # Hacia el WS sigue saliendo OPU0: los clientes no conocen la extensión
+                hdr = struct.pack(HDR_FMT, MAGIC, seq, sr, ch, plen)
+            elif magic != MAGIC:
                 print("[PY] Magic inválido, cerrando.")
                 break
 
             payload = await reader.readexactly(plen)
 
-            if last_seq is not None and seq != (last_seq + 1):
+            # plen == 0: marcador de squelch/DTX, el salto de seq es intencional
+            if last_seq is not None and seq != (last_seq + 1) and plen != 0:
                 print(f"[PY] WARNING: salto de seq {last_seq} -> {seq}")
             last_seq = seq
+            if plen == 0:
+                continue
 
             try:
                 await ws.send(hdr + payload)
@@ -66,7 +79,12 @@ async def handle_client(reader, writer):
             bytes_ += (HDR_SIZE + plen)
             now = time.time()
             if now - t0 >= 1.0:
-                print(f"[PY] RX {frames}/s {(bytes_/1024):.1f} KiB/s (last_seq={seq})")
+                lat_txt = ""
+                if lat_ms:
+                    lat_ms.sort()
+                    lat_txt = f" captura->gateway p50 {lat_ms[len(lat_ms)//2]:.1f} ms max {lat_ms[-1]:.1f} ms"
+                    lat_ms.clear()
+                print(f"[PY] RX {frames}/s {(bytes_/1024):.1f} KiB/s (last_seq={seq}){lat_txt}")
                 frames = 0
                 bytes_ = 0
                 t0 = now
@@ -0,0 +1,162 @@
+"""
+Lector del ring de memoria compartida de rf_engine (AUDIO_TRANSPORT=shm / PSD_TRANSPORT=shm).
+
+Uso:
+    python3 shm_reader.py /rf_audio     # frames OPU0: frames/s, huecos y latencia
+    python3 shm_reader.py /rf_psd       # JSON de PSD: bins y latencia
+
+Layout (libs/shm_ring.h): header de 4 KiB con head/tail en líneas de caché separadas,
+registros alineados a 8 bytes = u32 len, u32 reservado, u64 t_ns (CLOCK_MONOTONIC) + datos.
+El eventfd para despertar llega por /tmp<nombre>.sock (SCM_RIGHTS).
+"""
+import mmap
+import os
+import select
+import socket
+import struct
+import sys
+import time
+
+SHM_RING_MAGIC = 0x52465230  # 'RFR0'
+SHM_RING_WRAP = 0xFFFFFFFF
+REC_HDR_FMT = "<IIQ"         # len, reservado, t_ns
+REC_HDR_SIZE = struct.calcsize(REC_HDR_FMT)
+
+OFF_MAGIC, OFF_CAPACITY, OFF_DATA, OFF_DROPPED = 0, 8, 16, 24
+OFF_HEAD, OFF_TAIL = 64, 128
+
+HDR_FMT = "!IIIHH"  # magic, seq, sample_rate, channels, payload_len
+HDR_SIZE = struct.calcsize(HDR_FMT)
+MAGIC = 0x4F505530  # 'OPU0'
+MAGIC_TS = 0x4F505531  # 'OPU1': header + !QQ (captura, encoder; ns Unix) + payload
+TS_FMT = "!QQ"
+
+REPORT_S = 5.0
+
+
+class ShmRingReader:
+    def __init__(self, name, sock_path=None):
+        self.name = name
+        fd = os.open("/dev/shm" + name, os.O_RDWR)
+        try:
+            self.map = mmap.mmap(fd, 0)
+        finally:
+            os.close(fd)
+
+        magic, = struct.unpack_from("<I", self.map, OFF_MAGIC)
+        if magic != SHM_RING_MAGIC:
+            raise RuntimeError(f"{name}: magic inválido 0x{magic:08x}")
+        self.capacity, = struct.unpack_from("<Q", self.map, OFF_CAPACITY)
+        self.data_off, = struct.unpack_from("<Q", self.map, OFF_DATA)
+        self.mask = self.capacity - 1
+
+        # El motor sólo escribe el eventfd mientras hay un lector con el socket abierto
+        self.sock = socket.socket(socket.AF_UNIX, socket.SOCK_STREAM)
+        self.sock.connect(sock_path or f"/tmp{name}.sock")
+        _, fds, _, _ = socket.recv_fds(self.sock, 1, 1)
+        if not fds:
+            raise RuntimeError(f"{name}: no llegó el eventfd")
+        self.efd = fds[0]
+
+        # Empezamos en el head actual: lo viejo ya no interesa
+        self.tail = self._load(OFF_HEAD)
+        self._store(OFF_TAIL, self.tail)
+
+    def _load(self, off):
+        return struct.unpack_from("<Q", self.map, off)[0]
+
+    def _store(self, off, value):
+        struct.pack_into("<Q", self.map, off, value)
+
+    def dropped(self):
+        return self._load(OFF_DROPPED)
+
+    def wait(self, timeout_s=1.0):
+        # eventfd no bloqueante (EFD_NONBLOCK viaja con el descriptor): poll + read
+        r, _, _ = select.select([self.efd], [], [], timeout_s)
+        if r:
+            try:
+                os.read(self.efd, 8)
+            except BlockingIOError:
+                pass
+
+    def records(self):
+        """Devuelve [(t_ns, bytes)] de todo lo publicado desde la última llamada."""
+        out = []
+        head = self._load(OFF_HEAD)
+        tail = self.tail
+        while tail < head:
+            pos = self.data_off + (tail & self.mask)
+            length, _, t_ns = struct.unpack_from(REC_HDR_FMT, self.map, pos)
+            if length == SHM_RING_WRAP:
+                tail += self.capacity - (tail & self.mask)
+                continue
+            start = pos + REC_HDR_SIZE
+            out.append((t_ns, bytes(self.map[start:start + length])))
+            tail += (REC_HDR_SIZE + length + 7) & ~7
+        self.tail = tail
+        self._store(OFF_TAIL, tail)
+        return out
+
+    def close(self):
+        os.close(self.efd)
+        self.sock.close()
+        self.map.close()
+
+
+def main():
+    name = sys.argv[1] if len(sys.argv) > 1 else "/rf_audio"
+    ring = ShmRingReader(name)
+    print(f"[SHM] {name}: {ring.capacity // 1024} KiB, leyendo...")
+
+    frames = gaps = payload_bytes = 0
+    lat_us = []
+    cap_ms = []     # captura IQ -> lector, sólo con OPU1 (OPUS_TS_EXT=1)
+    last_seq = None
+    t_report = time.monotonic()
+
+    try:
+        while True:
+            ring.wait()
+            now_ns = time.monotonic_ns()
+            for t_ns, rec in ring.records():
+                lat_us.append((now_ns - t_ns) / 1000.0)
+                if len(rec) >= HDR_SIZE and struct.unpack_from("!I", rec)[0] in (MAGIC, MAGIC_TS):
+                    magic, seq, sr, ch, plen = struct.unpack_from(HDR_FMT, rec)
+                    if magic == MAGIC_TS:
+                        cap_ns, _ = struct.unpack_from(TS_FMT, rec, HDR_SIZE)
+                        if cap_ns:
+                            cap_ms.append((time.time_ns() - cap_ns) / 1e6)
+                    if plen == 0:
+                        gaps += 1
+                    elif last_seq is not None and seq != last_seq + 1:
+                        print(f"[SHM] salto de seq {last_seq} -> {seq}")
+                    last_seq = seq
+                    payload_bytes += plen
+                else:
+                    payload_bytes += len(rec)
+                frames += 1
+
+            if time.monotonic() - t_report >= REPORT_S:
+                dt = time.monotonic() - t_report
+                lat_us.sort()
+                p50 = lat_us[len(lat_us) // 2] if lat_us else 0.0
+                p99 = lat_us[len(lat_us) * 99 // 100] if lat_us else 0.0
+                cap_txt = ""
+                if cap_ms:
+                    cap_ms.sort()
+                    cap_txt = f", captura->lector p50 {cap_ms[len(cap_ms) // 2]:.1f} ms"
+                print(f"[SHM] {frames / dt:.1f} reg/s, {payload_bytes / dt:.0f} B/s, huecos {gaps}, "
+                      f"latencia p50 {p50:.0f} us p99 {p99:.0f} us, descartados {ring.dropped()}{cap_txt}")
+                frames = gaps = payload_bytes = 0
+                lat_us.clear()
+                cap_ms.clear()
+                t_report = time.monotonic()
+    except KeyboardInterrupt:
+        pass
+    finally:
+        ring.close()
+
+
+if __name__ == "__main__":
+    main()